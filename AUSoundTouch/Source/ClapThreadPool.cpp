@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "ClapThreadPool.h"
+
+std::atomic<ClapThreadPool::Registration*>& ClapThreadPool::getRegistrations()
+{
+    static std::atomic<Registration*> registrations { nullptr };
+    return registrations;
+}
+
+// The unbound instance whose batch is running, if any
+std::atomic<ClapThreadPool*>& ClapThreadPool::getBindingPool()
+{
+    static std::atomic<ClapThreadPool*> bindingPool { nullptr };
+    return bindingPool;
+}
+
+ClapThreadPool* ClapThreadPool::findPool(const clap_plugin_t* plugin)
+{
+    // Unbound entries hold null, so a wrapper that left plugin_data unset
+    // keeps every batch going through the binding path
+    if (plugin->plugin_data != nullptr)
+        for (auto* entry = getRegistrations().load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+            if (entry->pluginData.load(std::memory_order_acquire) == plugin->plugin_data)
+                if (auto* pool = entry->pool.load(std::memory_order_acquire))
+                    return pool;
+    
+    auto* pool = getBindingPool().load(std::memory_order_acquire);
+    
+    if (pool != nullptr)
+        pool->registration->pluginData.store(plugin->plugin_data, std::memory_order_release);
+    
+    return pool;
+}
+
+void CLAP_ABI ClapThreadPool::exec(const clap_plugin_t* plugin, uint32_t taskIndex)
+{
+    if (plugin == nullptr)
+        return;
+    
+    if (auto* pool = findPool(plugin))
+        pool->task(static_cast<int>(taskIndex));
+}
+
+ClapThreadPool::ClapThreadPool(Task taskToRun)
+    : task(std::move(taskToRun))
+{
+    auto& registrations = getRegistrations();
+    
+    // Reuse a destroyed instance's entry, or add one
+    for (auto* entry = registrations.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+    {
+        ClapThreadPool* expected = nullptr;
+        
+        if (entry->pool.compare_exchange_strong(expected, this))
+        {
+            registration = entry;
+            return;
+        }
+    }
+    
+    // Entries live as long as the process, since exec() may walk the list at any time
+    registration = new Registration();
+    registration->pool.store(this);
+    registration->next = registrations.load();
+    
+    while (! registrations.compare_exchange_weak(registration->next, registration))
+    {
+    }
+}
+
+ClapThreadPool::~ClapThreadPool()
+{
+    registration->pluginData.store(nullptr, std::memory_order_release);
+    registration->pool.store(nullptr, std::memory_order_release);
+}
+
+void ClapThreadPool::attachHost(const clap_host_t* hostToUse)
+{
+    host = hostToUse;
+    hostThreadPool = nullptr;
+    
+    if (host != nullptr && host->get_extension != nullptr)
+        hostThreadPool = static_cast<const clap_host_thread_pool_t*>(host->get_extension(host, CLAP_EXT_THREAD_POOL));
+}
+
+const clap_plugin_thread_pool_t* ClapThreadPool::getPluginExtension() const
+{
+    static constexpr clap_plugin_thread_pool_t extension { &exec };
+    return &extension;
+}
+
+bool ClapThreadPool::execute(int numTasks)
+{
+    if (! isHostPoolAvailable() || numTasks <= 0)
+        return false;
+    
+    if (registration->pluginData.load(std::memory_order_acquire) != nullptr)
+        return hostThreadPool->request_exec(host, static_cast<uint32_t>(numTasks));
+    
+    // Until this instance knows its plugin_data, it runs a batch only while no
+    // other unbound one does, and the caller runs the tasks itself otherwise
+    ClapThreadPool* expected = nullptr;
+    
+    if (! getBindingPool().compare_exchange_strong(expected, this, std::memory_order_acq_rel))
+        return false;
+    
+    const bool ran = hostThreadPool->request_exec(host, static_cast<uint32_t>(numTasks));
+    getBindingPool().store(nullptr, std::memory_order_release);
+    return ran;
+}
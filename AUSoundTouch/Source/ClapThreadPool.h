@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <clap/clap.h>
+#include <atomic>
+#include <functional>
+
+// Runs a batch of tasks on the CLAP host's own worker threads through the
+// clap.thread-pool extension. CLAP hands exec() only the clap_plugin pointer,
+// so every instance shares one extension table and is found again from the
+// plugin's plugin_data, which the wrapper sets once per instance. That pointer
+// is only seen inside exec(), so each instance learns it from the first batch
+// it runs; no other unbound instance runs a batch meanwhile, so tasks with an
+// unknown plugin_data can only be that instance's.
+class ClapThreadPool
+{
+public:
+    using Task = std::function<void(int taskIndex)>;
+    
+    explicit ClapThreadPool(Task taskToRun);
+    ~ClapThreadPool();
+    
+    // Main thread: binds the host this instance was created for
+    void attachHost(const clap_host_t* host);
+    
+    bool isHostPoolAvailable() const { return host != nullptr && hostThreadPool != nullptr; }
+    
+    // Plugin-side extension table advertised to the host
+    const clap_plugin_thread_pool_t* getPluginExtension() const;
+    
+    // Audio thread: runs tasks [0, numTasks) and returns once all are done.
+    // Returns false if the host declined, or another instance was still
+    // learning its plugin_data, in which case nothing ran.
+    bool execute(int numTasks);
+    
+private:
+    // One per live instance, in a list that only grows; an instance's entry
+    // is handed to the next one created once it is destroyed
+    struct Registration
+    {
+        std::atomic<ClapThreadPool*> pool { nullptr };
+        std::atomic<void*> pluginData { nullptr };
+        Registration* next = nullptr;
+    };
+    
+    static void CLAP_ABI exec(const clap_plugin_t* plugin, uint32_t taskIndex);
+    static ClapThreadPool* findPool(const clap_plugin_t* plugin);
+    static std::atomic<Registration*>& getRegistrations();
+    static std::atomic<ClapThreadPool*>& getBindingPool();
+    
+    Task task;
+    Registration* registration = nullptr;
+    const clap_host_t* host = nullptr;
+    const clap_host_thread_pool_t* hostThreadPool = nullptr;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ClapThreadPool)
+};
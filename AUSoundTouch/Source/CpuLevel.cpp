@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "CpuLevel.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    CpuLevel getHighestBuiltLevel()
+    {
+       #if AUSOUNDTOUCH_X86_LEVELS
+        return CpuLevel::X86_64_V4;
+       #else
+        return CpuLevel::Baseline;
+       #endif
+    }
+    
+    CpuLevel selectCpuLevel()
+    {
+        int level = std::min(static_cast<int>(detectCpuLevel()), static_cast<int>(getHighestBuiltLevel()));
+        
+        if (const char* requested = std::getenv("AUSOUNDTOUCH_CPU_LEVEL"))
+        {
+            const int requestedLevel = std::atoi(requested);
+            
+            if (requestedLevel >= static_cast<int>(CpuLevel::Baseline))
+                level = std::min(level, requestedLevel);
+        }
+        
+        return static_cast<CpuLevel>(level);
+    }
+}
+
+CpuLevel detectCpuLevel()
+{
+   #if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    // __builtin_cpu_supports() reads CPUID and, for AVX and AVX-512, whether
+    // the OS saves those registers (XGETBV). LZCNT, MOVBE and F16C, also part
+    // of v3, aren't separately queryable everywhere; every CPU with AVX2, FMA
+    // and BMI2 has them.
+    __builtin_cpu_init();
+    
+    const bool v2 = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1")
+                 && __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+    
+    if (! v2)
+        return CpuLevel::Baseline;
+    
+    const bool v3 = __builtin_cpu_supports("avx") && __builtin_cpu_supports("avx2")
+                 && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi")
+                 && __builtin_cpu_supports("bmi2");
+    
+    if (! v3)
+        return CpuLevel::X86_64_V2;
+    
+    const bool v4 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                 && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq")
+                 && __builtin_cpu_supports("avx512vl");
+    
+    return v4 ? CpuLevel::X86_64_V4 : CpuLevel::X86_64_V3;
+   #else
+    return CpuLevel::Baseline;
+   #endif
+}
+
+CpuLevel getCpuLevel()
+{
+    // Fixed for the life of the process, so every instance runs the same code
+    static const CpuLevel level = selectCpuLevel();
+    return level;
+}
+
+bool isCpuLevelAvailable(CpuLevel level)
+{
+    return static_cast<int>(level) <= static_cast<int>(detectCpuLevel())
+        && static_cast<int>(level) <= static_cast<int>(getHighestBuiltLevel());
+}
+
+const char* getCpuLevelName(CpuLevel level)
+{
+    switch (level)
+    {
+        case CpuLevel::X86_64_V2: return "x86-64-v2";
+        case CpuLevel::X86_64_V3: return "x86-64-v3";
+        case CpuLevel::X86_64_V4: return "x86-64-v4";
+        case CpuLevel::Baseline:  break;
+    }
+    
+    return "Baseline";
+}
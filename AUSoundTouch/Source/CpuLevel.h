@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+// x86-64 microarchitecture levels that SoundTouch and the wrapper's loops are
+// built for. With AUSOUNDTOUCH_X86_LEVELS the build adds copies for v2
+// (SSE4.2, POPCNT), v3 (AVX2, FMA, BMI2) and v4 (AVX-512F/BW/CD/DQ/VL) next
+// to the baseline; everywhere else, Apple Silicon included, only Baseline exists.
+//
+// This header stays free of JUCE: SoundTouchVariant.cpp includes it while
+// being built for the newer instruction sets.
+enum class CpuLevel
+{
+    Baseline = 1,
+    X86_64_V2,
+    X86_64_V3,
+    X86_64_V4
+};
+
+// The highest level this CPU and OS support, from CPUID (the OS check
+// matters for AVX and AVX-512 state), whether or not it was built
+CpuLevel detectCpuLevel();
+
+// The level every engine and wrapper uses: the highest one that was built and
+// that this CPU runs, chosen once when first asked. AUSOUNDTOUCH_CPU_LEVEL=1..4
+// in the environment can lower it, never raise it.
+CpuLevel getCpuLevel();
+
+// Whether code for this level was built and this CPU can run it
+bool isCpuLevelAvailable(CpuLevel level);
+
+const char* getCpuLevelName(CpuLevel level);
@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "GranularEngine.h"
+#include <algorithm>
+#include <cmath>
+
+void GranularEngine::prepare(double sampleRate, int engineNumChannels, int maxBlockFrames)
+{
+    numChannels = engineNumChannels;
+    
+    // Even, so the unshifted tap sits on a whole frame
+    grainFrames = 2 * std::max(16, static_cast<int>(std::lround(GRAIN_SECONDS * sampleRate * 0.5)));
+    searchFrames = grainFrames / 2;
+    latencyFrames = MIN_DELAY_FRAMES + grainFrames / 2 + searchFrames / 2;
+    
+    const int delayFrames = juce::nextPowerOfTwo(MIN_DELAY_FRAMES + searchFrames + grainFrames + CORRELATION_FRAMES + 4);
+    delayLine.assign(static_cast<size_t>(delayFrames * numChannels), 0.0f);
+    monoLine.assign(static_cast<size_t>(delayFrames), 0.0f);
+    delayMask = delayFrames - 1;
+    
+    // flush() pushes a whole latency's worth of silence through at once
+    outputCapacity = std::max(maxBlockFrames, latencyFrames);
+    output.assign(static_cast<size_t>(outputCapacity * numChannels), 0.0f);
+    
+    setRatios(1.0f, 1.0f, 1.0f);
+    clear();
+}
+
+void GranularEngine::setRatios(float pitch, float tempo, float rate)
+{
+    juce::ignoreUnused(tempo, rate);
+    
+    const float previousStep = phaseStep;
+    
+    // Reading at the pitch ratio changes each tap's delay by (1 - pitch) per frame
+    phaseStep = (1.0f - pitch) / static_cast<float>(grainFrames);
+    
+    // A tap wraps every half grain of phase; cover the whole search range by then
+    const float framesBetweenWraps = 0.5f / std::max(std::abs(phaseStep), 1.0e-9f);
+    lagsPerFrame = phaseStep == 0.0f ? 0
+                 : static_cast<int>(std::ceil(static_cast<float>(searchFrames + 1) / std::max(1.0f, framesBetweenWraps)));
+    
+    // The tap being searched for depends on which way the phase runs
+    if ((previousStep > 0.0f) != (phaseStep > 0.0f))
+        restartSearch();
+}
+
+void GranularEngine::putSamples(const float* interleaved, int numFrames)
+{
+    if (outputReadFrame == numOutputFrames)
+        numOutputFrames = outputReadFrame = 0;
+    
+    for (int frame = 0; frame < numFrames; ++frame)
+        processFrame(interleaved + frame * numChannels);
+}
+
+int GranularEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    const int framesToCopy = std::min(maxFrames, numOutputFrames - outputReadFrame);
+    
+    std::copy_n(output.begin() + outputReadFrame * numChannels, framesToCopy * numChannels, interleaved);
+    outputReadFrame += framesToCopy;
+    
+    return framesToCopy;
+}
+
+float GranularEngine::getDelay(const Tap& tap) const
+{
+    return static_cast<float>(MIN_DELAY_FRAMES + searchFrames + tap.offset) + tap.phase * static_cast<float>(grainFrames);
+}
+
+void GranularEngine::processFrame(const float* inputFrame)
+{
+    float mono = 0.0f;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        delayLine[static_cast<size_t>(writeFrame * numChannels + channel)] = inputFrame[channel];
+        mono += inputFrame[channel];
+    }
+    
+    monoLine[static_cast<size_t>(writeFrame)] = mono;
+    searchSplice(lagsPerFrame);
+    
+    // Equal-gain Hann crossfade: each tap is silent where its delay wraps
+    const float s = std::sin(juce::MathConstants<float>::pi * taps[0].phase);
+    const float gainA = s * s;
+    const float gainB = 1.0f - gainA;
+    const float delayA = getDelay(taps[0]);
+    const float delayB = getDelay(taps[1]);
+    
+    // Until the delay line holds a full latency's worth, the output is warm-up silence
+    if (framesToSkip > 0)
+    {
+        --framesToSkip;
+    }
+    else if (numOutputFrames < outputCapacity)
+    {
+        float* destination = output.data() + numOutputFrames * numChannels;
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            destination[channel] = gainA * readTap(channel, delayA) + gainB * readTap(channel, delayB);
+        
+        ++numOutputFrames;
+    }
+    
+    writeFrame = (writeFrame + 1) & delayMask;
+    
+    // Move both taps on; one that crosses the wrap point is silent there and
+    // restarts at the best splice found for it
+    for (auto& tap : taps)
+    {
+        tap.phase += phaseStep;
+        
+        if (tap.phase >= 1.0f || tap.phase < 0.0f)
+        {
+            tap.phase -= std::floor(tap.phase);
+            tap.offset = bestOffset;
+            restartSearch();
+        }
+    }
+}
+
+// The tap that wraps next is the one furthest along towards the wrap point;
+// the other will be at full gain, half a grain away, when it does
+void GranularEngine::restartSearch()
+{
+    nextLag = 0;
+    bestOffset = -searchFrames / 2;
+    bestScore = -1.0f;
+}
+
+// Scores a few candidate restart delays for the wrapping tap against the
+// content the playing tap will be reading at the wrap, assuming the signal
+// changes little over half a grain
+void GranularEngine::searchSplice(int numLags)
+{
+    if (numLags == 0 || nextLag > searchFrames)
+        return;
+    
+    const bool phaseRising = phaseStep > 0.0f;
+    const int wrapping = phaseRising == (taps[0].phase > 0.5f) ? 0 : 1;
+    const Tap& playing = taps[1 - wrapping];
+    
+    const int anchorDelay = MIN_DELAY_FRAMES + searchFrames + playing.offset + grainFrames / 2;
+    const int restartDelay = MIN_DELAY_FRAMES + searchFrames + (phaseRising ? 0 : grainFrames);
+    
+    const int anchor = writeFrame - anchorDelay;
+    
+    for (int i = 0; i < numLags && nextLag <= searchFrames; ++i, ++nextLag)
+    {
+        const int offset = -nextLag;
+        const int candidate = writeFrame - (restartDelay + offset);
+        
+        float correlation = 0.0f;
+        float energy = 1.0e-9f;
+        
+        for (int frame = 0; frame < CORRELATION_FRAMES; ++frame)
+        {
+            const float a = monoLine[static_cast<size_t>((anchor - frame) & delayMask)];
+            const float b = monoLine[static_cast<size_t>((candidate - frame) & delayMask)];
+            correlation += a * b;
+            energy += b * b;
+        }
+        
+        const float score = correlation / std::sqrt(energy);
+        
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestOffset = offset;
+        }
+    }
+}
+
+// Catmull-Rom between the two frames either side of the tap
+float GranularEngine::readTap(int channel, float delayFrames) const
+{
+    const int wholeFrames = static_cast<int>(delayFrames);
+    const float t = 1.0f - (delayFrames - static_cast<float>(wholeFrames));
+    const int index = writeFrame - wholeFrames - 1;
+    
+    auto sample = [&](int offset)
+    {
+        return delayLine[static_cast<size_t>(((index + offset) & delayMask) * numChannels + channel)];
+    };
+    
+    const float ym1 = sample(-1);
+    const float y0 = sample(0);
+    const float y1 = sample(1);
+    const float y2 = sample(2);
+    
+    const float c1 = 0.5f * (y1 - ym1);
+    const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+    const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+    
+    return ((c3 * t + c2) * t + c1) * t + y0;
+}
+
+void GranularEngine::flush()
+{
+    if (outputReadFrame == numOutputFrames)
+        numOutputFrames = outputReadFrame = 0;
+    
+    const float silence[MAX_CHANNELS] = {};
+    
+    for (int frame = 0; frame < latencyFrames; ++frame)
+        processFrame(silence);
+}
+
+void GranularEngine::clear()
+{
+    std::fill(delayLine.begin(), delayLine.end(), 0.0f);
+    std::fill(monoLine.begin(), monoLine.end(), 0.0f);
+    writeFrame = 0;
+    
+    // The second tap starts at full gain, centred in its range, so unity pitch
+    // is a plain delay of exactly the latency
+    taps[0] = { 0.0f, -searchFrames / 2 };
+    taps[1] = { 0.5f, -searchFrames / 2 };
+    restartSearch();
+    
+    numOutputFrames = 0;
+    outputReadFrame = 0;
+    framesToSkip = latencyFrames;
+}
+
+double GranularEngine::getOutputPerInput(float tempo, float rate) const
+{
+    juce::ignoreUnused(tempo, rate);
+    return 1.0;
+}
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include <vector>
+
+// Pitch shifting for live monitoring: two taps read a short delay line at the
+// pitch ratio, crossfaded with Hann windows half a grain apart so each one is
+// silent when its delay wraps around. Where a tap restarts is chosen by
+// correlating against the tap that is playing, so the splice stays in phase;
+// that search is spread evenly over the frames before the wrap. Every input
+// frame yields one output frame with the same amount of work, so the cost per
+// block stays flat down to tiny host buffers. Only the pitch ratio applies;
+// tempo and rate can't change the duration of a live stream.
+class GranularEngine : public TimeStretchEngine
+{
+public:
+    GranularEngine() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    // The taps' average delay, which is exactly the delay at unity pitch
+    int getInitialLatency() const override { return latencyFrames; }
+    int getNumUnprocessedFrames() const override { return latencyFrames - framesToSkip; }
+    double getOutputPerInput(float tempo, float rate) const override;
+    bool hasConstantLatency() const override { return true; }
+    
+    // Keeps the latency under 4 ms with room to search for the splice
+    static constexpr double GRAIN_SECONDS = 0.005;
+    
+private:
+    // The cubic interpolator reads two frames ahead of a tap, which must not
+    // pass the frame just written
+    static constexpr int MIN_DELAY_FRAMES = 2;
+    
+    // Frames compared when scoring a splice point
+    static constexpr int CORRELATION_FRAMES = 32;
+    
+    struct Tap
+    {
+        float phase = 0.0f;  // Position in the grain, 0-1
+        int offset = 0;      // Splice alignment, -searchFrames to 0
+    };
+    
+    void processFrame(const float* inputFrame);
+    void searchSplice(int numLags);
+    void restartSearch();
+    float readTap(int channel, float delayFrames) const;
+    float getDelay(const Tap& tap) const;
+    
+    int numChannels = 2;
+    int grainFrames = 0;
+    int searchFrames = 0;
+    int latencyFrames = 0;
+    
+    // Interleaved ring buffer, a power of two in frames, plus a mono mix of it
+    // for the splice search
+    std::vector<float> delayLine;
+    std::vector<float> monoLine;
+    int delayMask = 0;
+    int writeFrame = 0;
+    
+    Tap taps[2];
+    float phaseStep = 0.0f;
+    int lagsPerFrame = 0;
+    
+    // Best offset found so far for the tap that wraps next
+    int nextLag = 0;
+    int bestOffset = 0;
+    float bestScore = 0.0f;
+    
+    // Output of the last putSamples(), waiting for receiveSamples()
+    std::vector<float> output;
+    int outputCapacity = 0;
+    int numOutputFrames = 0;
+    int outputReadFrame = 0;
+    int framesToSkip = 0;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GranularEngine)
+};
@@ -0,0 +1,523 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "Harmonizer.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void Harmonizer::prepare(double sampleRate, int harmonizerNumChannels, int maxBlockFrames)
+{
+    currentSampleRate = sampleRate;
+    numChannels = harmonizerNumChannels;
+    maxBlockSize = juce::jmax(1, maxBlockFrames);
+    latencySamples = PsolaAnalysis::getLatency(sampleRate);
+    
+    dryDelay.assign(static_cast<size_t>(numChannels), std::vector<float>(static_cast<size_t>(latencySamples)));
+    dryDelayPosition = 0;
+    
+    // A voice the pool gave up on may still be rendering, and must finish
+    // before anything it touches is reallocated. It should be done within the
+    // wait; if not, the dry signal goes through the delay line until it is and
+    // refresh() reallocates.
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(MAX_PREPARE_WAIT_MS);
+    
+    while (workerPool.isStalled() && juce::Time::getMillisecondCounter() < deadline)
+        juce::Thread::sleep(1);
+    
+    stalled = workerPool.isStalled();
+    resetAfterStall = stalled;
+    preparePending.store(stalled);
+    
+    if (! stalled)
+    {
+        prepareVoices();
+        reset();
+    }
+    
+    refresh();
+}
+
+// Sized from the settings prepare() recorded
+void Harmonizer::prepareVoices()
+{
+    analysis.prepare(currentSampleRate, numChannels, maxBlockSize);
+    jassert(analysis.getLatency() == latencySamples);
+    
+    for (auto& voice : voices)
+    {
+        voice.synthesis.prepare(analysis, maxBlockSize);
+        voice.output.resize(static_cast<size_t>(numChannels));
+        voice.outputPointers.resize(static_cast<size_t>(numChannels));
+        
+        for (int c = 0; c < numChannels; ++c)
+        {
+            voice.output[static_cast<size_t>(c)].resize(static_cast<size_t>(maxBlockSize));
+            voice.outputPointers[static_cast<size_t>(c)] = voice.output[static_cast<size_t>(c)].data();
+        }
+    }
+    
+    attackStep = static_cast<float>(1.0 / (ATTACK_SECONDS * currentSampleRate));
+    releaseStep = static_cast<float>(1.0 / (RELEASE_SECONDS * currentSampleRate));
+}
+
+void Harmonizer::refresh()
+{
+    if (preparePending.load(std::memory_order_acquire) && ! workerPool.isStalled())
+    {
+        prepareVoices();
+        preparePending.store(false, std::memory_order_release);
+    }
+    
+    if (maxVoices.load() > 0)
+        workerPool.acquire();
+    else
+        workerPool.release();
+}
+
+void Harmonizer::reset()
+{
+    if (latencySamples == 0)
+        return;
+    
+    for (auto& line : dryDelay)
+        std::fill(line.begin(), line.end(), 0.0f);
+    
+    dryDelayPosition = 0;
+    
+    if (stalled)
+    {
+        resetAfterStall = true;
+        return;
+    }
+    
+    // Silence ahead of the input, so the delayed dry signal starts inside it
+    analysis.reset();
+    analysis.appendInterleaved(nullptr, latencySamples);
+    clearVoices();
+}
+
+void Harmonizer::clearVoices()
+{
+    for (auto& voice : voices)
+    {
+        voice.note = -1;
+        voice.gain = 0.0f;
+        voice.targetGain = 0.0f;
+    }
+    
+    numActiveVoices.store(0, std::memory_order_relaxed);
+}
+
+void Harmonizer::setMaxVoices(int numVoices)
+{
+    maxVoices.store(juce::jlimit(0, MAX_VOICES, numVoices));
+}
+
+void Harmonizer::setReferenceNote(int note)
+{
+    referenceNote.store(juce::jlimit(0, 127, note));
+}
+
+void Harmonizer::trackHeldNotes(const juce::MidiBuffer& midi)
+{
+    for (const auto metadata : midi)
+    {
+        const auto message = metadata.getMessage();
+        
+        if (message.isNoteOn())
+            heldVelocities[static_cast<size_t>(message.getNoteNumber())] = message.getFloatVelocity();
+        else if (message.isNoteOff())
+            heldVelocities[static_cast<size_t>(message.getNoteNumber())] = 0.0f;
+        else if (message.isAllNotesOff() || message.isAllSoundOff())
+            heldVelocities.fill(0.0f);
+    }
+}
+
+// The input went by unanalysed during the stall, so the analysis starts over
+// from the delay line, which holds just the input the dry signal hasn't
+// reached yet. The voices carry on with the notes still held, fading back in,
+// unless reset() was called meanwhile.
+void Harmonizer::restartAfterStall()
+{
+    stalled = false;
+    
+    analysis.reset();
+    
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const auto& line = dryDelay[static_cast<size_t>(c)];
+        std::rotate_copy(line.begin(), line.begin() + dryDelayPosition, line.end(), analysis.getWritePointer(c));
+    }
+    
+    analysis.commit(latencySamples);
+    
+    if (std::exchange(resetAfterStall, false))
+    {
+        clearVoices();
+        return;
+    }
+    
+    for (auto& voice : voices)
+    {
+        if (! voice.isActive())
+            continue;
+        
+        voice.gain = 0.0f;
+        voice.targetGain = heldVelocities[static_cast<size_t>(voice.note)];
+        voice.synthesis.reset(analysis, getDryStart());
+    }
+    
+    for (int note = 0; note < static_cast<int>(heldVelocities.size()); ++note)
+    {
+        const float velocity = heldVelocities[static_cast<size_t>(note)];
+        
+        if (velocity > 0.0f)
+            startNote(note, velocity);
+    }
+}
+
+void Harmonizer::handleMidiMessage(const juce::MidiMessage& message)
+{
+    if (message.isNoteOn())
+        startNote(message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        releaseNote(message.getNoteNumber());
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        releaseAllNotes();
+}
+
+// A note that is already sounding, or fading out, is picked up again as it is.
+// Otherwise a free voice starts on the next output frame, or past the limit
+// the oldest one is taken over, released voices first.
+void Harmonizer::startNote(int note, float velocity)
+{
+    const int limit = maxVoices.load();
+    
+    if (limit == 0)
+        return;
+    
+    Voice* freeVoice = nullptr;
+    Voice* oldestVoice = nullptr;
+    int numSounding = 0;
+    
+    for (auto& voice : voices)
+    {
+        if (voice.note == note)
+        {
+            voice.targetGain = velocity;
+            return;
+        }
+        
+        if (! voice.isActive())
+        {
+            if (freeVoice == nullptr)
+                freeVoice = &voice;
+            
+            continue;
+        }
+        
+        ++numSounding;
+        
+        const bool isOlder = oldestVoice == nullptr
+                          || (voice.targetGain == 0.0f) > (oldestVoice->targetGain == 0.0f)
+                          || ((voice.targetGain == 0.0f) == (oldestVoice->targetGain == 0.0f)
+                              && voice.startOrder < oldestVoice->startOrder);
+        
+        if (isOlder)
+            oldestVoice = &voice;
+    }
+    
+    auto* voice = numSounding < limit && freeVoice != nullptr ? freeVoice : oldestVoice;
+    
+    if (voice == nullptr)
+        return;
+    
+    voice->note = note;
+    voice->gain = 0.0f;
+    voice->targetGain = velocity;
+    voice->startOrder = ++noteCounter;
+    voice->synthesis.reset(analysis, getDryStart());
+}
+
+void Harmonizer::releaseNote(int note)
+{
+    for (auto& voice : voices)
+        if (voice.note == note)
+            voice.targetGain = 0.0f;
+}
+
+void Harmonizer::releaseAllNotes()
+{
+    for (auto& voice : voices)
+        voice.targetGain = 0.0f;
+}
+
+// Drops input that neither the delayed dry signal nor any voice's next grain
+// can still reach
+void Harmonizer::makeRoomForInput(int numFrames)
+{
+    if (numFrames <= analysis.getFreeFrames())
+        return;
+    
+    const int dryStart = getDryStart();
+    int firstMark = analysis.findMarkBefore(dryStart);
+    
+    for (const auto& voice : voices)
+        if (voice.isActive())
+            firstMark = juce::jmin(firstMark, voice.synthesis.getCursor());
+    
+    const int consumed = analysis.discard(firstMark, dryStart);
+    
+    if (consumed > 0)
+        for (auto& voice : voices)
+            if (voice.isActive())
+                voice.synthesis.inputDiscarded(consumed, firstMark);
+    
+    // Only a voice stuck far behind could hold this much; start over rather
+    // than overrun
+    if (numFrames > analysis.getFreeFrames())
+        reset();
+}
+
+template <typename SampleType>
+void Harmonizer::processBlockInternal(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi)
+{
+    trackHeldNotes(midi);
+    
+    // Borrowed for the block, so it can't be let go meanwhile
+    auto* pool = workerPool.claim();
+    const int numSamples = buffer.getNumSamples();
+    
+    // Until the voice the pool gave up on is done, only the dry signal goes out
+    if (stalled)
+    {
+        if (pool == nullptr || pool->isStalled(*this) || preparePending.load(std::memory_order_acquire))
+        {
+            delayDry(buffer, 0, numSamples);
+            workerPool.restore(pool);
+            return;
+        }
+        
+        restartAfterStall();
+    }
+    
+    // Notes change at the start of the block they arrive in
+    for (const auto metadata : midi)
+        handleMidiMessage(metadata.getMessage());
+    
+    if (maxVoices.load() == 0)
+        releaseAllNotes();
+    
+    int start = 0;
+    
+    for (; start < numSamples && ! stalled; start += maxBlockSize)
+        processChunk(buffer, pool, start, juce::jmin(maxBlockSize, numSamples - start));
+    
+    workerPool.restore(pool);
+    
+    if (stalled)
+    {
+        delayDry(buffer, start, numSamples - start);
+        return;
+    }
+    
+    int numActive = 0;
+    
+    for (const auto& voice : voices)
+        numActive += voice.isActive() ? 1 : 0;
+    
+    numActiveVoices.store(numActive, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+void Harmonizer::processChunk(juce::AudioBuffer<SampleType>& buffer, VoiceWorkerPool* pool, int startSample, int numSamples)
+{
+    makeRoomForInput(numSamples);
+    
+    const int dryStart = getDryStart();
+    const int numBufferChannels = juce::jmin(numChannels, buffer.getNumChannels());
+    
+    // The one de-interleave and analysis pass every voice shares
+    for (int c = 0; c < numChannels; ++c)
+    {
+        float* destination = analysis.getWritePointer(c);
+        
+        if (c < numBufferChannels)
+        {
+            const SampleType* source = buffer.getReadPointer(c, startSample);
+            
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<float>(source[i]);
+        }
+        else
+        {
+            std::fill_n(destination, numSamples, 0.0f);
+        }
+    }
+    
+    analysis.commit(numSamples);
+    
+    const int reference = referenceNote.load();
+    numRendering = 0;
+    chunkFrames = numSamples;
+    
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        auto& voice = voices[static_cast<size_t>(i)];
+        
+        if (! voice.isActive())
+            continue;
+        
+        voice.synthesis.setRatios(std::exp2(static_cast<float>(voice.note - reference) / 12.0f), 1.0f);
+        renderList[static_cast<size_t>(numRendering++)] = i;
+    }
+    
+    // Past the deadline a voice is still rendering into its output, so this
+    // chunk goes out dry and the rest of the block through the delay line
+    if (pool != nullptr)
+        stalled = ! pool->execute(*this, numRendering, VoiceWorkerPool::getMaxWaitMs(numSamples, currentSampleRate));
+    else
+        VoiceWorkerPool::runAlone(*this, numRendering);
+    
+    for (int c = 0; c < numBufferChannels; ++c)
+    {
+        SampleType* destination = buffer.getWritePointer(c, startSample);
+        const float* dry = analysis.getChannel(c) + dryStart;
+        
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<SampleType>(dry[i]);
+        
+        for (int r = 0; r < numRendering && ! stalled; ++r)
+        {
+            const float* wet = voices[static_cast<size_t>(renderList[static_cast<size_t>(r)])].output[static_cast<size_t>(c)].data();
+            
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] += static_cast<SampleType>(wet[i]);
+        }
+    }
+    
+    if (stalled)
+    {
+        // The stalled voice only reads the analysis, so the input it holds
+        // past this chunk can still be copied out into the delay line
+        for (int c = 0; c < numChannels; ++c)
+            std::copy_n(analysis.getChannel(c) + dryStart + numSamples, latencySamples, dryDelay[static_cast<size_t>(c)].data());
+        
+        dryDelayPosition = 0;
+        return;
+    }
+    
+    // A released voice is free once it has faded out
+    for (auto& voice : voices)
+        if (voice.isActive() && voice.gain == 0.0f && voice.targetGain == 0.0f)
+            voice.note = -1;
+}
+
+// While stalled: the input goes through the delay line, which stands in for
+// the analysis as the dry signal's delay
+template <typename SampleType>
+void Harmonizer::delayDry(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    if (numSamples <= 0 || latencySamples == 0)
+        return;
+    
+    const int numBufferChannels = juce::jmin(numChannels, buffer.getNumChannels());
+    int position = dryDelayPosition;
+    
+    // Channels the buffer lacks were fed silence, and still are
+    for (int c = 0; c < numChannels; ++c)
+    {
+        float* line = dryDelay[static_cast<size_t>(c)].data();
+        SampleType* samples = c < numBufferChannels ? buffer.getWritePointer(c, startSample) : nullptr;
+        position = dryDelayPosition;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float input = samples != nullptr ? static_cast<float>(samples[i]) : 0.0f;
+            
+            if (samples != nullptr)
+                samples[i] = static_cast<SampleType>(line[position]);
+            
+            line[position] = input;
+            
+            if (++position == latencySamples)
+                position = 0;
+        }
+    }
+    
+    dryDelayPosition = position;
+}
+
+void Harmonizer::runTask(int taskIndex)
+{
+    renderVoice(voices[static_cast<size_t>(renderList[static_cast<size_t>(taskIndex)])], chunkFrames);
+}
+
+// Runs on a pool thread or the audio thread; touches only this voice and reads
+// the shared analysis
+void Harmonizer::renderVoice(Voice& voice, int numFrames)
+{
+    auto& synthesis = voice.synthesis;
+    
+    if (synthesis.needsCompacting(numFrames))
+        synthesis.compact();
+    
+    // The latency covers the input these grains need
+    while (synthesis.getNumFinalFrames() < numFrames && synthesis.synthesizeGrain(analysis))
+    {
+    }
+    
+    synthesis.readPlanar(voice.outputPointers.data(), numFrames);
+    
+    if (voice.gain == voice.targetGain)
+    {
+        for (auto* output : voice.outputPointers)
+            juce::FloatVectorOperations::multiply(output, voice.gain, numFrames);
+        
+        return;
+    }
+    
+    // Linear ramps: attack towards the note's velocity, release down to silence
+    float gain = voice.gain;
+    const float target = voice.targetGain;
+    
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        gain = gain < target ? juce::jmin(target, gain + attackStep)
+                             : juce::jmax(target, gain - releaseStep);
+        
+        for (auto* output : voice.outputPointers)
+            output[frame] *= gain;
+    }
+    
+    voice.gain = gain;
+}
+
+void Harmonizer::processBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi)
+{
+    processBlockInternal(buffer, midi);
+}
+
+void Harmonizer::processBlock(juce::AudioBuffer<double>& buffer, const juce::MidiBuffer& midi)
+{
+    processBlockInternal(buffer, midi);
+}
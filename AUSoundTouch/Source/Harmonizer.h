@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "PsolaAnalysis.h"
+#include "PsolaSynthesis.h"
+#include "VoiceWorkerPool.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+// MIDI harmonizer: every held note adds a copy of the input shifted by its
+// distance from the reference note, mixed under the dry signal. The input is
+// de-interleaved, pitch-tracked and marked once per block by a shared
+// PsolaAnalysis; each voice is only a PsolaSynthesis reading from it, so a
+// voice costs one windowed copy per grain and the voices render concurrently
+// on the shared VoiceWorkerPool. The dry signal is delayed to line up with
+// them, and the whole path reports PSOLA's fixed latency.
+//
+// If the pool gives up waiting on a voice, that voice still owns the voices
+// and the analysis until it finishes, so the dry signal goes on through a
+// delay line of the same latency meanwhile; then the analysis starts over
+// from what the line holds and the held notes fade back in. prepare() leaves
+// them to a stalled voice the same way, past a short wait, and refresh()
+// reallocates them once it is done.
+//
+// The shared pool is only held while voices are allowed (see refresh()).
+//
+// prepare() and refresh() allocate; process() and the setters are safe on the
+// audio thread.
+class Harmonizer : private VoiceWorkerPool::Batch
+{
+public:
+    Harmonizer() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames);
+    void reset();
+    
+    // Off the audio thread, serialised with prepare(): takes up the pool once
+    // voices are allowed and lets it go once they aren't, and finishes a
+    // prepare() that had to leave the voices to a stalled one
+    void refresh();
+    
+    // Voices beyond the limit steal the oldest; 0 stops them all
+    void setMaxVoices(int numVoices);
+    int getMaxVoices() const { return maxVoices.load(); }
+    
+    // The MIDI note that plays back at the input's own pitch
+    void setReferenceNote(int note);
+    int getReferenceNote() const { return referenceNote.load(); }
+    
+    void processBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi);
+    void processBlock(juce::AudioBuffer<double>& buffer, const juce::MidiBuffer& midi);
+    
+    int getLatencySamples() const { return latencySamples; }
+    int getNumActiveVoices() const { return numActiveVoices.load(std::memory_order_relaxed); }
+    
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int DEFAULT_REFERENCE_NOTE = 60;
+    
+    static constexpr double ATTACK_SECONDS = 0.01;
+    static constexpr double RELEASE_SECONDS = 0.08;
+    
+    // How long prepare() waits for a stalled voice before leaving the
+    // reallocation to refresh()
+    static constexpr int MAX_PREPARE_WAIT_MS = 50;
+    
+private:
+    struct Voice
+    {
+        PsolaSynthesis synthesis;
+        std::vector<std::vector<float>> output;
+        std::vector<float*> outputPointers;
+        int note = -1;
+        float gain = 0.0f;
+        float targetGain = 0.0f;
+        juce::uint32 startOrder = 0;
+        
+        bool isActive() const { return note >= 0; }
+    };
+    
+    template <typename SampleType>
+    void processBlockInternal(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi);
+    
+    template <typename SampleType>
+    void processChunk(juce::AudioBuffer<SampleType>& buffer, VoiceWorkerPool* pool, int startSample, int numSamples);
+    
+    template <typename SampleType>
+    void delayDry(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    
+    void prepareVoices();
+    void clearVoices();
+    void trackHeldNotes(const juce::MidiBuffer& midi);
+    void restartAfterStall();
+    void handleMidiMessage(const juce::MidiMessage& message);
+    void startNote(int note, float velocity);
+    void releaseNote(int note);
+    void releaseAllNotes();
+    void makeRoomForInput(int numFrames);
+    int getDryStart() const { return analysis.getNumFrames() - latencySamples; }
+    
+    void runTask(int taskIndex) override;
+    void renderVoice(Voice& voice, int numFrames);
+    
+    double currentSampleRate = 44100.0;
+    int numChannels = 2;
+    int maxBlockSize = 512;
+    int latencySamples = 0;
+    float attackStep = 0.0f;
+    float releaseStep = 0.0f;
+    
+    PsolaAnalysis analysis;
+    std::array<Voice, MAX_VOICES> voices;
+    
+    // Active voices for the chunk being rendered, by index into voices
+    std::array<int, MAX_VOICES> renderList {};
+    int numRendering = 0;
+    int chunkFrames = 0;
+    
+    juce::uint32 noteCounter = 0;
+    
+    // Velocity of every held note, kept through a stall so the notes can be
+    // picked up again after it (see restartAfterStall())
+    std::array<float, 128> heldVelocities {};
+    
+    // Set when the pool gives up on a voice; reset() while it is, is deferred
+    bool stalled = false;
+    bool resetAfterStall = false;
+    
+    // Audio thread: the input not yet sent out while stalled, latencySamples
+    // of it per channel, as a ring starting at dryDelayPosition
+    std::vector<std::vector<float>> dryDelay;
+    int dryDelayPosition = 0;
+    
+    // Set by a prepare() that left the voices to a stalled one
+    std::atomic<bool> preparePending { false };
+    
+    std::atomic<int> maxVoices { 0 };
+    std::atomic<int> referenceNote { DEFAULT_REFERENCE_NOTE };
+    std::atomic<int> numActiveVoices { 0 };
+    
+    VoiceWorkerPool::Handle workerPool { *this };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Harmonizer)
+};
@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "OutputLayers.h"
+#include <algorithm>
+#include <cmath>
+
+void OutputLayers::prepare(double sampleRate, int blockSize, int layersNumChannels,
+                           const std::array<bool, MAX_LAYERS>& enabledLayers)
+{
+    currentSampleRate = sampleRate;
+    numChannels = layersNumChannels;
+    maxBlockSize = juce::jmax(1, blockSize);
+    active = enabledLayers;
+    
+    // A layer the pool gave up on may still be rendering, and must finish
+    // before anything it touches is reallocated. It should be done within the
+    // wait; if not, the buses carry the dry input until it is and
+    // releaseRetiredState() reallocates.
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(MAX_PREPARE_WAIT_MS);
+    
+    while (workerPool.isStalled() && juce::Time::getMillisecondCounter() < deadline)
+        juce::Thread::sleep(1);
+    
+    stalled = workerPool.isStalled();
+    preparePending.store(stalled);
+    
+    if (! stalled)
+        prepareLayers();
+    
+    if (getNumActiveLayers() > 0)
+        workerPool.acquire();
+    else
+        workerPool.release();
+}
+
+// Sized from the settings prepare() recorded
+void OutputLayers::prepareLayers()
+{
+    interleavedInput.resize(static_cast<size_t>(maxBlockSize * numChannels));
+    floatKernels = getSoundTouchKernels<float>(numChannels);
+    doubleKernels = getSoundTouchKernels<double>(numChannels);
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+    {
+        if (! active[static_cast<size_t>(layer)])
+            continue;
+        
+        layers[static_cast<size_t>(layer)].prepare(currentSampleRate, maxBlockSize, numChannels);
+        
+        auto& output = outputs[static_cast<size_t>(layer)];
+        output.floatSamples.resize(static_cast<size_t>(maxBlockSize * numChannels));
+        output.doubleSamples.resize(static_cast<size_t>(maxBlockSize * numChannels));
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            output.floatChannels[static_cast<size_t>(channel)] = output.floatSamples.data() + channel * maxBlockSize;
+            output.doubleChannels[static_cast<size_t>(channel)] = output.doubleSamples.data() + channel * maxBlockSize;
+        }
+    }
+}
+
+// While a layer is stalled the layers are left alone; they are reset anyway
+// once it is done
+void OutputLayers::reset()
+{
+    if (stalled)
+        return;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        if (isActive(layer))
+            layers[static_cast<size_t>(layer)].reset();
+}
+
+// Idle layers get the configuration too, so one enabled later starts on it
+void OutputLayers::configure(const SoundTouchWrapper::Configuration& configuration)
+{
+    for (auto& layer : layers)
+        layer.configure(configuration);
+}
+
+void OutputLayers::crossfadeTo(const SoundTouchWrapper::Configuration& configuration,
+                               float pitch, float tempo, float rate)
+{
+    const float semitones = 12.0f * std::log2(pitch);
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        layers[static_cast<size_t>(layer)].crossfadeTo(configuration,
+                                                       SoundTouchWrapper::semitonesToNative(getLayerPitch(layer, semitones)),
+                                                       tempo, rate);
+}
+
+// Also moves each active layer to or from the phase vocoder on its own
+// stretch factor, which its offset makes differ from the main engine's,
+// finishes a prepare() that had to leave the layers to a stalled one, and lets
+// the pool go if prepare() couldn't
+void OutputLayers::releaseRetiredState()
+{
+    if (preparePending.load(std::memory_order_acquire) && ! workerPool.isStalled())
+    {
+        prepareLayers();
+        preparePending.store(false, std::memory_order_release);
+    }
+    
+    if (getNumActiveLayers() == 0)
+        workerPool.release();
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+    {
+        auto& wrapper = layers[static_cast<size_t>(layer)];
+        wrapper.releaseRetiredState();
+        
+        if (isActive(layer))
+            wrapper.updateAutomaticEngine();
+    }
+}
+
+void OutputLayers::setRatios(float pitchSemitones, float tempoPercent, float ratePercent)
+{
+    if (stalled)
+        return;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+    {
+        if (! isActive(layer))
+            continue;
+        
+        auto& wrapper = layers[static_cast<size_t>(layer)];
+        wrapper.setPitch(getLayerPitch(layer, pitchSemitones));
+        wrapper.setTempo(tempoPercent);
+        wrapper.setRate(ratePercent);
+    }
+}
+
+float OutputLayers::getLayerPitch(int layer, float pitchSemitones) const
+{
+    return juce::jlimit(-MAX_PITCH_SEMITONES, MAX_PITCH_SEMITONES, pitchSemitones + getOffset(layer));
+}
+
+void OutputLayers::setOffset(int layer, float semitones)
+{
+    if (juce::isPositiveAndBelow(layer, MAX_LAYERS))
+        offsets[static_cast<size_t>(layer)].store(juce::jlimit(MIN_OFFSET_SEMITONES, MAX_OFFSET_SEMITONES, semitones));
+}
+
+float OutputLayers::getOffset(int layer) const
+{
+    return juce::isPositiveAndBelow(layer, MAX_LAYERS) ? offsets[static_cast<size_t>(layer)].load() : 0.0f;
+}
+
+int OutputLayers::getNumActiveLayers() const
+{
+    return static_cast<int>(std::count(active.begin(), active.end(), true));
+}
+
+int OutputLayers::getReportedLatencySamples() const
+{
+    int latencySamples = 0;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        if (isActive(layer))
+            latencySamples = juce::jmax(latencySamples, layers[static_cast<size_t>(layer)].getReportedLatencySamples());
+    
+    return latencySamples;
+}
+
+int OutputLayers::getTailLengthSamples() const
+{
+    int tailSamples = 0;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        if (isActive(layer))
+            tailSamples = juce::jmax(tailSamples, layers[static_cast<size_t>(layer)].getTailLengthSamples());
+    
+    return tailSamples;
+}
+
+template <typename SampleType>
+void OutputLayers::processBlockInternal(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                                        const std::array<SampleType* const*, MAX_LAYERS>& layerChannels)
+{
+    if (mainBuffer.getNumChannels() != numChannels)
+        return;
+    
+    // Borrowed for the block, so it can't be let go meanwhile
+    auto* pool = workerPool.claim();
+    
+    if (stalled)
+    {
+        if (pool == nullptr || pool->isStalled(*this) || preparePending.load(std::memory_order_acquire))
+        {
+            passThrough(mainBuffer, mainEngine, layerChannels, 0);
+            workerPool.restore(pool);
+            return;
+        }
+        
+        stalled = false;
+        reset();
+    }
+    
+    processChunks(mainBuffer, mainEngine, layerChannels, pool);
+    workerPool.restore(pool);
+}
+
+template <typename SampleType>
+void OutputLayers::processChunks(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                                 const std::array<SampleType* const*, MAX_LAYERS>& layerChannels, VoiceWorkerPool* pool)
+{
+    if (interleavedInput.empty())
+        return;
+    
+    numTasks = 0;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        if (isActive(layer) && layerChannels[static_cast<size_t>(layer)] != nullptr)
+            taskLayers[static_cast<size_t>(numTasks++)] = layer;
+    
+    if (numTasks == 0 && mainEngine == nullptr)
+        return;
+    
+    // The main engine, when given, runs on this thread and renders in place
+    chunkMainEngine = mainEngine;
+    chunkIsDouble = std::is_same_v<SampleType, double>;
+    
+    if constexpr (std::is_same_v<SampleType, float>)
+        chunkMainFloatChannels = mainBuffer.getArrayOfWritePointers();
+    else
+        chunkMainDoubleChannels = mainBuffer.getArrayOfWritePointers();
+    
+    const int numSamples = mainBuffer.getNumSamples();
+    
+    for (chunkStart = 0; chunkStart < numSamples; chunkStart += maxBlockSize)
+    {
+        chunkFrames = juce::jmin(maxBlockSize, numSamples - chunkStart);
+        
+        // The one interleave and conversion pass every engine shares, and the
+        // dry input each layer falls back on while its FIFO runs short. Both
+        // happen before the main engine writes over the main buffer.
+        if constexpr (std::is_same_v<SampleType, float>)
+            floatKernels.interleave(mainBuffer.getArrayOfReadPointers(), chunkStart, interleavedInput.data(), chunkFrames, numChannels);
+        else
+            doubleKernels.interleave(mainBuffer.getArrayOfReadPointers(), chunkStart, interleavedInput.data(), chunkFrames, numChannels);
+        
+        for (int task = 0; task < numTasks; ++task)
+        {
+            auto* const* channels = getChannels<SampleType>(outputs[static_cast<size_t>(taskLayers[static_cast<size_t>(task)])]);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::copy_n(mainBuffer.getReadPointer(channel, chunkStart), chunkFrames, channels[channel]);
+        }
+        
+        if (pool == nullptr)
+        {
+            VoiceWorkerPool::runAlone(*this, numTasks);
+        }
+        else if (! pool->execute(*this, numTasks, VoiceWorkerPool::getMaxWaitMs(chunkFrames, currentSampleRate)))
+        {
+            // The interleaved copy is all that is left of this chunk's dry input
+            for (int task = 0; task < numTasks; ++task)
+            {
+                auto* const* channels = layerChannels[static_cast<size_t>(taskLayers[static_cast<size_t>(task)])];
+                
+                if constexpr (std::is_same_v<SampleType, float>)
+                    floatKernels.deinterleave(interleavedInput.data(), channels, chunkStart, chunkFrames, numChannels);
+                else
+                    doubleKernels.deinterleave(interleavedInput.data(), channels, chunkStart, chunkFrames, numChannels);
+            }
+            
+            stalled = true;
+            passThrough(mainBuffer, mainEngine, layerChannels, chunkStart + chunkFrames);
+            return;
+        }
+        
+        for (int task = 0; task < numTasks; ++task)
+        {
+            const int layer = taskLayers[static_cast<size_t>(task)];
+            auto* const* rendered = getChannels<SampleType>(outputs[static_cast<size_t>(layer)]);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::copy_n(rendered[channel], chunkFrames, layerChannels[static_cast<size_t>(layer)][channel] + chunkStart);
+        }
+    }
+}
+
+// Audio thread, while a layer is stalled: from startSample on, the main engine
+// runs on its own and every enabled layer bus carries the dry input
+template <typename SampleType>
+void OutputLayers::passThrough(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                               const std::array<SampleType* const*, MAX_LAYERS>& layerChannels, int startSample)
+{
+    const int numSamples = mainBuffer.getNumSamples() - startSample;
+    
+    if (numSamples <= 0)
+        return;
+    
+    for (int layer = 0; layer < MAX_LAYERS; ++layer)
+        if (isActive(layer) && layerChannels[static_cast<size_t>(layer)] != nullptr)
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::copy_n(mainBuffer.getReadPointer(channel, startSample), numSamples,
+                            layerChannels[static_cast<size_t>(layer)][channel] + startSample);
+    
+    if (mainEngine != nullptr)
+    {
+        juce::AudioBuffer<SampleType> rest(mainBuffer.getArrayOfWritePointers(), numChannels, startSample, numSamples);
+        mainEngine->processBlock(rest);
+    }
+}
+
+// Any pool thread or the audio thread; each engine writes only its own channels
+template <typename SampleType>
+void OutputLayers::render(SoundTouchWrapper& engine, SampleType* const* channels, int startSample)
+{
+    juce::AudioBuffer<SampleType> output(channels, numChannels, startSample, chunkFrames);
+    engine.processInterleaved(interleavedInput.data(), output);
+}
+
+template <typename SampleType>
+SampleType* const* OutputLayers::getChannels(LayerOutput& output)
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+        return output.floatChannels.data();
+    else
+        return output.doubleChannels.data();
+}
+
+void OutputLayers::runTask(int taskIndex)
+{
+    auto& output = outputs[static_cast<size_t>(taskLayers[static_cast<size_t>(taskIndex)])];
+    auto& engine = layers[static_cast<size_t>(taskLayers[static_cast<size_t>(taskIndex)])];
+    
+    if (chunkIsDouble)
+        render(engine, output.doubleChannels.data(), 0);
+    else
+        render(engine, output.floatChannels.data(), 0);
+}
+
+void OutputLayers::runPosterTask()
+{
+    if (chunkMainEngine == nullptr)
+        return;
+    
+    if (chunkIsDouble)
+        render(*chunkMainEngine, chunkMainDoubleChannels, chunkStart);
+    else
+        render(*chunkMainEngine, chunkMainFloatChannels, chunkStart);
+}
+
+void OutputLayers::processBlock(juce::AudioBuffer<float>& mainBuffer, SoundTouchWrapper* mainEngine,
+                                const std::array<float* const*, MAX_LAYERS>& layerChannels)
+{
+    processBlockInternal(mainBuffer, mainEngine, layerChannels);
+}
+
+void OutputLayers::processBlock(juce::AudioBuffer<double>& mainBuffer, SoundTouchWrapper* mainEngine,
+                                const std::array<double* const*, MAX_LAYERS>& layerChannels)
+{
+    processBlockInternal(mainBuffer, mainEngine, layerChannels);
+}
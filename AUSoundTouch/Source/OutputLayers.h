@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "SoundTouchWrapper.h"
+#include "VoiceWorkerPool.h"
+#include <array>
+#include <atomic>
+
+// The auxiliary output buses: each enabled one carries the input at the main
+// pitch plus its own offset, at the main tempo and rate so it stays in time
+// with the main output. Every layer is a SoundTouchWrapper of its own, since
+// the stretch depends on the ratio, but the input is interleaved and narrowed
+// to float once per chunk and that one copy feeds the main engine and every
+// layer, which then run side by side on the shared VoiceWorkerPool.
+//
+// The main engine always runs on the audio thread, and the layers render into
+// buffers of their own that are copied to the buses once every layer is done.
+// A layer the pool gives up on is left to finish on its own: until it has,
+// every layer bus carries the dry input and the layers are left alone, and
+// once it has they all start over from reset(). prepare() leaves them to a
+// stalled layer the same way, past a short wait, and releaseRetiredState()
+// reallocates them once it is done.
+//
+// The shared pool is only held while some layer is enabled.
+//
+// prepare() allocates and configure() rebuilds as for a wrapper; processBlock()
+// and the setters are safe on the audio thread.
+class OutputLayers : private VoiceWorkerPool::Batch
+{
+public:
+    static constexpr int MAX_LAYERS = 3;
+    static constexpr float MIN_OFFSET_SEMITONES = -24.0f;
+    static constexpr float MAX_OFFSET_SEMITONES = 24.0f;
+    
+    // The main pitch parameter's bound, which offset layers are held to as well
+    static constexpr float MAX_PITCH_SEMITONES = 39.8f;
+    
+    // How long prepare() waits for a stalled layer before leaving the
+    // reallocation to releaseRetiredState()
+    static constexpr int MAX_PREPARE_WAIT_MS = 50;
+    
+    OutputLayers() = default;
+    
+    // Prepares the layers whose bus is enabled; the rest sit idle until a later
+    // prepare() enables them. Called with the audio thread stopped, and
+    // serialised with releaseRetiredState().
+    void prepare(double sampleRate, int blockSize, int numChannels,
+                 const std::array<bool, MAX_LAYERS>& enabledLayers);
+    void reset();
+    
+    // The main engines' configuration, with the same threading as the wrapper's
+    void configure(const SoundTouchWrapper::Configuration& configuration);
+    void crossfadeTo(const SoundTouchWrapper::Configuration& configuration, float pitch, float tempo, float rate);
+    void releaseRetiredState();
+    
+    // Audio thread, every block: the main settings, in parameter units
+    void setRatios(float pitchSemitones, float tempoPercent, float ratePercent);
+    
+    // Semitones from the main pitch; takes effect with the next block
+    void setOffset(int layer, float semitones);
+    float getOffset(int layer) const;
+    
+    bool isActive(int layer) const { return juce::isPositiveAndBelow(layer, MAX_LAYERS) && active[static_cast<size_t>(layer)]; }
+    int getNumActiveLayers() const;
+    int getReportedLatencySamples() const;
+    int getTailLengthSamples() const;
+    
+    // Runs mainEngine on mainBuffer in place, if given, and each active layer
+    // into its bus channels, which start from a copy of the dry input. Entries
+    // of layerChannels are null for buses the host has disabled.
+    void processBlock(juce::AudioBuffer<float>& mainBuffer, SoundTouchWrapper* mainEngine,
+                      const std::array<float* const*, MAX_LAYERS>& layerChannels);
+    void processBlock(juce::AudioBuffer<double>& mainBuffer, SoundTouchWrapper* mainEngine,
+                      const std::array<double* const*, MAX_LAYERS>& layerChannels);
+    
+private:
+    // Where a layer renders a chunk; the pointers are set up in prepare(), so
+    // pool threads never touch a juce::AudioBuffer they share
+    struct LayerOutput
+    {
+        std::vector<float> floatSamples;
+        std::vector<double> doubleSamples;
+        std::array<float*, SoundTouchWrapper::MAX_CHANNELS> floatChannels {};
+        std::array<double*, SoundTouchWrapper::MAX_CHANNELS> doubleChannels {};
+    };
+    
+    template <typename SampleType>
+    void processBlockInternal(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                              const std::array<SampleType* const*, MAX_LAYERS>& layerChannels);
+    
+    template <typename SampleType>
+    void processChunks(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                       const std::array<SampleType* const*, MAX_LAYERS>& layerChannels, VoiceWorkerPool* pool);
+    
+    template <typename SampleType>
+    void passThrough(juce::AudioBuffer<SampleType>& mainBuffer, SoundTouchWrapper* mainEngine,
+                     const std::array<SampleType* const*, MAX_LAYERS>& layerChannels, int startSample);
+    
+    template <typename SampleType>
+    void render(SoundTouchWrapper& engine, SampleType* const* channels, int startSample);
+    
+    template <typename SampleType>
+    static SampleType* const* getChannels(LayerOutput& output);
+    
+    void runTask(int taskIndex) override;
+    void runPosterTask() override;
+    void prepareLayers();
+    float getLayerPitch(int layer, float pitchSemitones) const;
+    
+    int numChannels = 2;
+    int maxBlockSize = 512;
+    
+    std::array<SoundTouchWrapper, MAX_LAYERS> layers;
+    std::array<bool, MAX_LAYERS> active {};
+    std::array<std::atomic<float>, MAX_LAYERS> offsets {};
+    
+    // Sized for maxBlockSize frames in prepare(); read by every task of a chunk
+    std::vector<float> interleavedInput;
+    SoundTouchKernels<float> floatKernels;
+    SoundTouchKernels<double> doubleKernels;
+    
+    std::array<LayerOutput, MAX_LAYERS> outputs;
+    double currentSampleRate = 44100.0;
+    
+    // The chunk being rendered: the layers running as tasks, and the main
+    // engine with the channels it writes in place, if any
+    std::array<int, MAX_LAYERS> taskLayers {};
+    int numTasks = 0;
+    int chunkStart = 0;
+    int chunkFrames = 0;
+    bool chunkIsDouble = false;
+    SoundTouchWrapper* chunkMainEngine = nullptr;
+    float* const* chunkMainFloatChannels = nullptr;
+    double* const* chunkMainDoubleChannels = nullptr;
+    
+    // Audio thread only: a layer was given up on and nothing has reset them since
+    bool stalled = false;
+    
+    // Set by a prepare() that left the layers to a stalled one
+    std::atomic<bool> preparePending { false };
+    
+    VoiceWorkerPool::Handle workerPool { *this };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputLayers)
+};
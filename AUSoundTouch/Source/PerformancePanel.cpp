@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PerformancePanel.h"
+
+PerformancePanel::PerformancePanel (AUSoundTouchProcessor& p)
+    : audioProcessor (p)
+{
+    setOpaque (true);
+    update (audioProcessor.getPerformanceSnapshot());
+}
+
+// Nothing is polled while the panel or its editor is hidden
+void PerformancePanel::visibilityChanged()
+{
+    if (isVisible())
+        startTimerHz (REFRESH_HZ);
+    else
+        stopTimer();
+}
+
+void PerformancePanel::timerCallback()
+{
+    update (audioProcessor.getPerformanceSnapshot());
+}
+
+void PerformancePanel::update (const AUSoundTouchProcessor::PerformanceSnapshot& snapshot)
+{
+    std::array<juce::String, numCells> newTexts;
+    newTexts[loadCell] = "DSP " + juce::String (juce::roundToInt (snapshot.dspLoad * 100.0f)) + "%";
+    newTexts[fifoCell] = snapshot.fifoTargetFrames > 0
+                       ? "FIFO " + juce::String (snapshot.fifoFrames) + " / " + juce::String (snapshot.fifoTargetFrames)
+                       : juce::String ("FIFO -");
+    newTexts[latencyCell] = "Latency " + juce::String (snapshot.latencyMs, 1) + " ms";
+    newTexts[underrunCell] = "Underruns " + juce::String (snapshot.underruns);
+    newTexts[droppedCell] = "Dropped " + juce::String (snapshot.droppedFrames);
+    
+    // The load bar moves with the load even when the rounded percentage doesn't
+    const bool loadBarMoved = std::abs (snapshot.dspLoad - dspLoad) * static_cast<float> (cellBounds[loadCell].getWidth()) >= 1.0f;
+    dspLoad = snapshot.dspLoad;
+    
+    for (int cell = 0; cell < numCells; ++cell)
+    {
+        const auto index = static_cast<size_t> (cell);
+        
+        if (newTexts[index] != texts[index] || (cell == loadCell && loadBarMoved))
+        {
+            texts[index] = newTexts[index];
+            repaint (cellBounds[index]);
+        }
+    }
+}
+
+juce::Colour PerformancePanel::getLoadColour() const
+{
+    if (dspLoad >= OVERLOAD_LOAD)
+        return juce::Colours::red;
+    
+    if (dspLoad >= WARNING_LOAD)
+        return juce::Colours::orange;
+    
+    return juce::Colours::green;
+}
+
+void PerformancePanel::paint (juce::Graphics& g)
+{
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId).darker (0.2f));
+    
+    // The load cell doubles as a meter, full width at 100%
+    const auto& loadBounds = cellBounds[loadCell];
+    g.setColour (getLoadColour().withAlpha (0.5f));
+    g.fillRect (loadBounds.withWidth (juce::roundToInt (static_cast<float> (loadBounds.getWidth()) * juce::jlimit (0.0f, 1.0f, dspLoad))));
+    
+    g.setColour (juce::Colours::white);
+    g.setFont (13.0f);
+    
+    for (size_t cell = 0; cell < texts.size(); ++cell)
+        g.drawFittedText (texts[cell], cellBounds[cell].reduced (4, 0), juce::Justification::centredLeft, 1);
+}
+
+void PerformancePanel::resized()
+{
+    // Widths in proportion to the longest text each cell shows
+    constexpr std::array<int, numCells> weights { 3, 5, 5, 4, 4 };
+    int totalWeight = 0;
+    
+    for (int weight : weights)
+        totalWeight += weight;
+    
+    auto bounds = getLocalBounds();
+    const int totalWidth = bounds.getWidth();
+    
+    for (size_t cell = 0; cell < cellBounds.size(); ++cell)
+        cellBounds[cell] = bounds.removeFromLeft (totalWidth * weights[cell] / totalWeight);
+    
+    cellBounds[droppedCell] = cellBounds[droppedCell].getUnion (bounds);
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <array>
+
+// A one-line strip of live figures for the editor: DSP load, FIFO fill against
+// its target, the latency actually held back, and underrun and drop counts.
+// Polls the processor's published snapshot on a low-rate timer while visible,
+// and repaints only the cells whose text changed, so an editor buffered to an
+// image re-renders a few small rectangles rather than itself.
+class PerformancePanel : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit PerformancePanel (AUSoundTouchProcessor&);
+    
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+    
+    static constexpr int REFRESH_HZ = 10;
+    
+    // Loads from here on are drawn as a warning, and from the next as an overload
+    static constexpr float WARNING_LOAD = 0.7f;
+    static constexpr float OVERLOAD_LOAD = 0.9f;
+    
+private:
+    enum Cell { loadCell, fifoCell, latencyCell, underrunCell, droppedCell, numCells };
+    
+    void timerCallback() override;
+    void update (const AUSoundTouchProcessor::PerformanceSnapshot&);
+    juce::Colour getLoadColour() const;
+    
+    AUSoundTouchProcessor& audioProcessor;
+    
+    std::array<juce::String, numCells> texts;
+    std::array<juce::Rectangle<int>, numCells> cellBounds;
+    float dspLoad = 0.0f;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformancePanel)
+};
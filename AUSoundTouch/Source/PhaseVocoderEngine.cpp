@@ -0,0 +1,375 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PhaseVocoderEngine.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float twoPi = juce::MathConstants<float>::twoPi;
+    
+    // Bins quieter than this aren't worth locking to (about -140 dB)
+    constexpr float peakFloor = 1.0e-7f;
+    
+    // The kernels below are branch-free straight-line loops over contiguous
+    // arrays, so the compiler vectorises them; std::atan2/sin/cos would not be.
+    
+    inline float wrapPhase(float x)
+    {
+        return x - twoPi * std::floor(x * (1.0f / twoPi) + 0.5f);
+    }
+    
+    // Minimax atan on [0, 1] folded to all four quadrants, error ~1e-5 rad
+    inline float fastAtan2(float y, float x)
+    {
+        const float ax = std::abs(x);
+        const float ay = std::abs(y);
+        const float a = std::min(ax, ay) / (std::max(ax, ay) + 1.0e-30f);
+        const float s = a * a;
+        
+        float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+        r = ay > ax ? 1.57079637f - r : r;
+        r = x < 0.0f ? 3.14159274f - r : r;
+        return y < 0.0f ? -r : r;
+    }
+    
+    // Taylor series to x^9 on [-pi/2, pi/2] after folding, error ~4e-6
+    inline float fastSin(float x)
+    {
+        x = wrapPhase(x);
+        x = x > 1.57079637f ? 3.14159274f - x : x;
+        x = x < -1.57079637f ? -3.14159274f - x : x;
+        
+        const float s = x * x;
+        return x * (1.0f + s * (-1.0f / 6.0f + s * (1.0f / 120.0f + s * (-1.0f / 5040.0f + s * (1.0f / 362880.0f)))));
+    }
+    
+    // JUCE's real FFT output: interleaved {re, im} for bins 0..numBins-1
+    void computeMagnitudeAndPhase(const float* spectrum, float* magnitude, float* phase, int numBins)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float re = spectrum[2 * bin];
+            const float im = spectrum[2 * bin + 1];
+            magnitude[bin] = std::sqrt(re * re + im * im);
+            phase[bin] = fastAtan2(im, re);
+        }
+    }
+    
+    void polarToSpectrum(const float* magnitude, const float* phase, float* spectrum, int numBins)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            spectrum[2 * bin] = magnitude[bin] * fastSin(phase[bin] + 1.57079637f);
+            spectrum[2 * bin + 1] = magnitude[bin] * fastSin(phase[bin]);
+        }
+    }
+}
+
+void PhaseVocoderEngine::prepare(double sampleRate, int engineNumChannels, int maxBlockFrames)
+{
+    // Keep the frame near 46 ms so frequency resolution doesn't drop at high rates
+    const int fftOrder = sampleRate > 96000.0 ? 13 : (sampleRate > 48000.0 ? 12 : 11);
+    
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    fftSize = fft->getSize();
+    hopSize = fftSize / OVERLAP;
+    numBins = fftSize / 2 + 1;
+    numChannels = engineNumChannels;
+    
+    // After every receiveSamples() pass less than one frame is left unread
+    inputCapacity = fftSize + std::max(maxBlockFrames, hopSize);
+    
+    channels.resize(static_cast<size_t>(numChannels));
+    
+    for (auto& channel : channels)
+    {
+        channel.input.resize(static_cast<size_t>(inputCapacity));
+        channel.accumulator.resize(static_cast<size_t>(fftSize));
+        channel.analysisPhase.resize(static_cast<size_t>(numBins));
+        channel.synthesisPhase.resize(static_cast<size_t>(numBins));
+    }
+    
+    // Periodic Hann for both windows; Hann squared overlapped four times sums to
+    // 1.5, which the synthesis window divides out
+    analysisWindow.resize(static_cast<size_t>(fftSize));
+    synthesisWindow.resize(static_cast<size_t>(fftSize));
+    
+    for (int i = 0; i < fftSize; ++i)
+    {
+        const float w = 0.5f - 0.5f * std::cos(twoPi * static_cast<float>(i) / static_cast<float>(fftSize));
+        analysisWindow[static_cast<size_t>(i)] = w;
+        synthesisWindow[static_cast<size_t>(i)] = w / 1.5f;
+    }
+    
+    fftBuffer.resize(static_cast<size_t>(fftSize * 2));
+    magnitude.resize(static_cast<size_t>(numBins));
+    phase.resize(static_cast<size_t>(numBins));
+    peaks.resize(static_cast<size_t>(numBins));
+    hopOutput.resize(static_cast<size_t>(hopSize * numChannels));
+    
+    resampler.prepare(sampleRate, numChannels, hopSize);
+    
+    setRatios(1.0f, 1.0f, 1.0f);
+    clear();
+}
+
+void PhaseVocoderEngine::setRatios(float pitch, float tempo, float rate)
+{
+    // Stretch by p/t with a fixed synthesis hop, then resample by p*r: the
+    // duration changes by 1/(t*r) and the pitch by p*r, as with SoundTouch.
+    // The analysis hop stays at least one frame, which caps the stretch.
+    analysisHop = juce::jlimit(1.0, static_cast<double>(fftSize) * 4.0,
+                               hopSize * static_cast<double>(tempo) / pitch);
+    
+    const float step = pitch * rate;
+    resampler.setRatios(1.0f, 1.0f, step);
+    
+    // The resampler has no anti-alias filter of its own, so when it reads
+    // faster than one frame per frame, whatever would land past Nyquist is
+    // removed here, in the spectrum, before it is resynthesised
+    cutoffBin = step > 1.0f ? static_cast<float>(numBins - 1) / step : static_cast<float>(numBins);
+}
+
+void PhaseVocoderEngine::makeRoomForInput(int numFrames)
+{
+    if (numInputFrames + numFrames <= inputCapacity)
+        return;
+    
+    // Everything before the next frame start has been analysed
+    const int consumed = std::min(numInputFrames, static_cast<int>(analysisPosition));
+    
+    if (consumed <= 0)
+        return;
+    
+    for (auto& channel : channels)
+        std::copy(channel.input.begin() + consumed, channel.input.begin() + numInputFrames, channel.input.begin());
+    
+    numInputFrames -= consumed;
+    analysisPosition -= consumed;
+    previousFrameStart -= consumed;
+}
+
+void PhaseVocoderEngine::putSamples(const float* interleaved, int numFrames)
+{
+    makeRoomForInput(numFrames);
+    
+    const int framesToCopy = std::min(numFrames, inputCapacity - numInputFrames);
+    
+    for (int c = 0; c < numChannels; ++c)
+    {
+        float* destination = channels[static_cast<size_t>(c)].input.data() + numInputFrames;
+        
+        for (int frame = 0; frame < framesToCopy; ++frame)
+            destination[frame] = interleaved[frame * numChannels + c];
+    }
+    
+    numInputFrames += framesToCopy;
+}
+
+int PhaseVocoderEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    int framesWritten = 0;
+    
+    while (framesWritten < maxFrames)
+    {
+        framesWritten += resampler.receiveSamples(interleaved + framesWritten * numChannels, maxFrames - framesWritten);
+        
+        if (framesWritten == maxFrames || synthesizeHop())
+            continue;
+        
+        if (pendingFlushFrames == 0)
+            break;
+        
+        // Pad a hop's worth of silence at a time until the last frame is out
+        const int silentFrames = std::min(pendingFlushFrames, hopSize);
+        makeRoomForInput(silentFrames);
+        
+        const int framesToAdd = std::min(silentFrames, inputCapacity - numInputFrames);
+        
+        for (auto& channel : channels)
+            std::fill_n(channel.input.begin() + numInputFrames, framesToAdd, 0.0f);
+        
+        numInputFrames += framesToAdd;
+        pendingFlushFrames -= framesToAdd;
+    }
+    
+    return framesWritten;
+}
+
+bool PhaseVocoderEngine::synthesizeHop()
+{
+    const int frameStart = static_cast<int>(analysisPosition);
+    
+    if (frameStart + fftSize > numInputFrames)
+        return false;
+    
+    const int analysisHopFrames = std::max(1, frameStart - previousFrameStart);
+    
+    for (auto& channel : channels)
+        processFrame(channel, frameStart, analysisHopFrames);
+    
+    isFirstFrame = false;
+    previousFrameStart = frameStart;
+    analysisPosition += analysisHop;
+    
+    // The first hop of every accumulator is now complete
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& accumulator = channels[static_cast<size_t>(c)].accumulator;
+        
+        for (int frame = 0; frame < hopSize; ++frame)
+            hopOutput[static_cast<size_t>(frame * numChannels + c)] = accumulator[static_cast<size_t>(frame)];
+        
+        std::copy(accumulator.begin() + hopSize, accumulator.end(), accumulator.begin());
+        std::fill(accumulator.end() - hopSize, accumulator.end(), 0.0f);
+    }
+    
+    resampler.putSamples(hopOutput.data(), hopSize);
+    return true;
+}
+
+void PhaseVocoderEngine::processFrame(Channel& channel, int frameStart, int analysisHopFrames)
+{
+    // Analysis
+    juce::FloatVectorOperations::multiply(fftBuffer.data(), channel.input.data() + frameStart,
+                                          analysisWindow.data(), fftSize);
+    fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+    computeMagnitudeAndPhase(fftBuffer.data(), magnitude.data(), phase.data(), numBins);
+    
+    auto& synthesisPhase = channel.synthesisPhase;
+    
+    if (isFirstFrame)
+    {
+        std::copy(phase.begin(), phase.end(), synthesisPhase.begin());
+    }
+    else
+    {
+        int numPeaks = 0;
+        
+        for (int bin = 1; bin < numBins - 1; ++bin)
+            if (magnitude[static_cast<size_t>(bin)] > peakFloor
+                && magnitude[static_cast<size_t>(bin)] > magnitude[static_cast<size_t>(bin - 1)]
+                && magnitude[static_cast<size_t>(bin)] >= magnitude[static_cast<size_t>(bin + 1)])
+                peaks[static_cast<size_t>(numPeaks++)] = bin;
+        
+        const float binFrequency = twoPi / static_cast<float>(fftSize);
+        const float hopRatio = static_cast<float>(hopSize) / static_cast<float>(analysisHopFrames);
+        
+        // Peaks advance at their measured instantaneous frequency
+        auto advance = [&](int bin)
+        {
+            const float expected = binFrequency * static_cast<float>(bin) * static_cast<float>(analysisHopFrames);
+            const float deviation = wrapPhase(phase[static_cast<size_t>(bin)]
+                                              - channel.analysisPhase[static_cast<size_t>(bin)] - expected);
+            const float advanceBy = (expected + deviation) * hopRatio;
+            synthesisPhase[static_cast<size_t>(bin)] = wrapPhase(synthesisPhase[static_cast<size_t>(bin)] + advanceBy);
+        };
+        
+        if (numPeaks == 0)
+        {
+            for (int bin = 0; bin < numBins; ++bin)
+                advance(bin);
+        }
+        else
+        {
+            for (int i = 0; i < numPeaks; ++i)
+                advance(peaks[static_cast<size_t>(i)]);
+            
+            // Every other bin keeps its analysis phase offset from the nearest peak
+            int nearest = 0;
+            
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                while (nearest + 1 < numPeaks
+                       && peaks[static_cast<size_t>(nearest + 1)] - bin < bin - peaks[static_cast<size_t>(nearest)])
+                    ++nearest;
+                
+                const int peak = peaks[static_cast<size_t>(nearest)];
+                
+                if (bin != peak)
+                    synthesisPhase[static_cast<size_t>(bin)] = synthesisPhase[static_cast<size_t>(peak)]
+                                                             + phase[static_cast<size_t>(bin)] - phase[static_cast<size_t>(peak)];
+            }
+        }
+    }
+    
+    std::copy(phase.begin(), phase.end(), channel.analysisPhase.begin());
+    
+    applyCutoff();
+    
+    // Synthesis
+    polarToSpectrum(magnitude.data(), synthesisPhase.data(), fftBuffer.data(), numBins);
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+    juce::FloatVectorOperations::addWithMultiply(channel.accumulator.data(), fftBuffer.data(),
+                                                 synthesisWindow.data(), fftSize);
+}
+
+// Fades the bins out over CUTOFF_TRANSITION below cutoffBin, which keeps the
+// filter's ringing shorter than a frame
+void PhaseVocoderEngine::applyCutoff()
+{
+    if (cutoffBin >= static_cast<float>(numBins))
+        return;
+    
+    const float fadeStart = cutoffBin * (1.0f - CUTOFF_TRANSITION);
+    const float fadeWidth = cutoffBin - fadeStart;
+    
+    for (int bin = std::max(0, static_cast<int>(fadeStart)); bin < numBins; ++bin)
+    {
+        const float gain = juce::jlimit(0.0f, 1.0f, (cutoffBin - static_cast<float>(bin)) / fadeWidth);
+        magnitude[static_cast<size_t>(bin)] *= gain;
+    }
+}
+
+void PhaseVocoderEngine::flush()
+{
+    pendingFlushFrames = fftSize;
+}
+
+void PhaseVocoderEngine::clear()
+{
+    // Half a frame of silence ahead of the input centres the first frame on it
+    numInputFrames = fftSize / 2;
+    analysisPosition = 0.0;
+    previousFrameStart = 0;
+    isFirstFrame = true;
+    pendingFlushFrames = 0;
+    
+    for (auto& channel : channels)
+    {
+        std::fill(channel.input.begin(), channel.input.begin() + numInputFrames, 0.0f);
+        std::fill(channel.accumulator.begin(), channel.accumulator.end(), 0.0f);
+    }
+    
+    resampler.clear();
+}
+
+int PhaseVocoderEngine::getNumUnprocessedFrames() const
+{
+    return std::max(0, numInputFrames - static_cast<int>(analysisPosition));
+}
+
+double PhaseVocoderEngine::getOutputPerInput(float tempo, float rate) const
+{
+    return 1.0 / (static_cast<double>(tempo) * rate);
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include "ResamplingEngine.h"
+#include <vector>
+
+// FFT phase vocoder with identity phase locking (Laroche & Dolson): each bin
+// keeps its phase offset to the nearest spectral peak, which avoids the
+// phasiness of a plain vocoder and the splicing artefacts WSOLA shows at large
+// stretch factors. Time is stretched by p/t with a fixed synthesis hop, so the
+// cost is one forward and one inverse FFT per channel per hop of output,
+// whatever the ratios. The result is then resampled by p*r for pitch and rate,
+// with anything that would alias cut from the spectrum first.
+class PhaseVocoderEngine : public TimeStretchEngine
+{
+public:
+    PhaseVocoderEngine() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    // A frame has to be complete before its first hop can be output
+    int getInitialLatency() const override { return fftSize; }
+    int getNumUnprocessedFrames() const override;
+    double getOutputPerInput(float tempo, float rate) const override;
+    
+    int getFftSize() const { return fftSize; }
+    
+    // Synthesis frames overlap by this factor
+    static constexpr int OVERLAP = 4;
+    
+private:
+    struct Channel
+    {
+        std::vector<float> input;
+        std::vector<float> accumulator;
+        std::vector<float> analysisPhase;
+        std::vector<float> synthesisPhase;
+    };
+    
+    bool synthesizeHop();
+    void processFrame(Channel& channel, int frameStart, int analysisHopFrames);
+    void makeRoomForInput(int numFrames);
+    void applyCutoff();
+    
+    // Share of the pass band the cutoff fades over
+    static constexpr float CUTOFF_TRANSITION = 0.1f;
+    
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 2048;
+    int hopSize = fftSize / OVERLAP;
+    int numBins = fftSize / 2 + 1;
+    int numChannels = 2;
+    
+    std::vector<Channel> channels;
+    int inputCapacity = 0;
+    int numInputFrames = 0;
+    double analysisPosition = 0.0;
+    double analysisHop = 0.0;
+    int previousFrameStart = 0;
+    bool isFirstFrame = true;
+    int pendingFlushFrames = 0;
+    float cutoffBin = static_cast<float>(fftSize / 2 + 1);
+    
+    std::vector<float> analysisWindow;
+    std::vector<float> synthesisWindow;
+    std::vector<float> fftBuffer;
+    std::vector<float> magnitude;
+    std::vector<float> phase;
+    std::vector<int> peaks;
+    std::vector<float> hopOutput;
+    
+    // Pitch and rate, applied after the stretch
+    ResamplingEngine resampler;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PhaseVocoderEngine)
+};
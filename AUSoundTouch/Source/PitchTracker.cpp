@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PitchTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Quieter windows (about -60 dBFS RMS) are treated as unvoiced
+    constexpr double silenceEnergyPerSample = 1.0e-6;
+}
+
+void PitchTracker::prepare(double sampleRate, double minFrequency, double maxFrequency)
+{
+    decimation = std::max(1, static_cast<int>(sampleRate / ANALYSIS_RATE));
+    const double analysisRate = sampleRate / decimation;
+    
+    minLag = std::max(2, static_cast<int>(std::floor(analysisRate / maxFrequency)));
+    maxLag = static_cast<int>(std::ceil(analysisRate / minFrequency)) + 1;
+    
+    // YIN needs a window at least as long as the longest period it looks for
+    windowSize = maxLag;
+    
+    historySize = windowSize + maxLag + 2;
+    history.assign(static_cast<size_t>(historySize * 2), 0.0f);
+    difference.assign(static_cast<size_t>(maxLag + 2), 0.0f);
+    normalised.assign(static_cast<size_t>(maxLag + 2), 1.0f);
+    
+    reset();
+}
+
+void PitchTracker::reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    std::fill(difference.begin(), difference.end(), 0.0f);
+    position = 0;
+    windowEnergy = 0.0;
+    decimationCount = 0;
+    decimationSum = 0.0f;
+    samplesUntilEstimate = ESTIMATE_INTERVAL;
+    samplesUntilRefresh = REFRESH_INTERVAL;
+    period = 0.0f;
+    aperiodicity = 1.0f;
+}
+
+void PitchTracker::push(const float* mono, int numFrames)
+{
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        // Box-filter decimation: crude, but YIN only needs the low partials
+        decimationSum += mono[frame];
+        
+        if (++decimationCount == decimation)
+        {
+            pushDecimated(decimationSum / static_cast<float>(decimation));
+            decimationSum = 0.0f;
+            decimationCount = 0;
+        }
+    }
+}
+
+void PitchTracker::pushDecimated(float sample)
+{
+    // Newest first: step back one slot and write the mirror too
+    position = position == 0 ? historySize - 1 : position - 1;
+    history[static_cast<size_t>(position)] = sample;
+    history[static_cast<size_t>(position + historySize)] = sample;
+    
+    // d(lag) = sum over the window of (x[t] - x[t - lag])^2: add the new term,
+    // drop the one that just left the window
+    const float* recent = history.data() + position;
+    const float* leaving = recent + windowSize;
+    const float newest = recent[0];
+    const float oldest = leaving[0];
+    float* d = difference.data();
+    
+    for (int lag = 1; lag <= maxLag; ++lag)
+    {
+        const float added = newest - recent[lag];
+        const float removed = oldest - leaving[lag];
+        d[lag] += added * added - removed * removed;
+    }
+    
+    windowEnergy += static_cast<double>(newest) * newest - static_cast<double>(oldest) * oldest;
+    
+    if (--samplesUntilRefresh == 0)
+    {
+        recomputeDifference();
+        samplesUntilRefresh = REFRESH_INTERVAL;
+    }
+    
+    if (--samplesUntilEstimate == 0)
+    {
+        estimate();
+        samplesUntilEstimate = ESTIMATE_INTERVAL;
+    }
+}
+
+void PitchTracker::recomputeDifference()
+{
+    const float* recent = history.data() + position;
+    
+    for (int lag = 1; lag <= maxLag; ++lag)
+    {
+        float sum = 0.0f;
+        
+        for (int i = 0; i < windowSize; ++i)
+        {
+            const float delta = recent[i] - recent[i + lag];
+            sum += delta * delta;
+        }
+        
+        difference[static_cast<size_t>(lag)] = sum;
+    }
+    
+    double energy = 0.0;
+    
+    for (int i = 0; i < windowSize; ++i)
+        energy += static_cast<double>(recent[i]) * recent[i];
+    
+    windowEnergy = energy;
+}
+
+void PitchTracker::estimate()
+{
+    if (windowEnergy < silenceEnergyPerSample * windowSize)
+    {
+        period = 0.0f;
+        aperiodicity = 1.0f;
+        return;
+    }
+    
+    // Cumulative mean normalised difference
+    float runningSum = 0.0f;
+    
+    for (int lag = 1; lag <= maxLag; ++lag)
+    {
+        const float d = std::max(0.0f, difference[static_cast<size_t>(lag)]);
+        runningSum += d;
+        normalised[static_cast<size_t>(lag)] = runningSum > 0.0f ? d * static_cast<float>(lag) / runningSum : 1.0f;
+    }
+    
+    // The first dip below the threshold, followed down to its minimum, avoids
+    // picking a multiple of the period
+    int lag = minLag;
+    
+    while (lag < maxLag && normalised[static_cast<size_t>(lag)] >= VOICING_THRESHOLD)
+        ++lag;
+    
+    if (lag >= maxLag)
+    {
+        period = 0.0f;
+        aperiodicity = *std::min_element(normalised.begin() + minLag, normalised.begin() + maxLag);
+        return;
+    }
+    
+    while (lag + 1 < maxLag && normalised[static_cast<size_t>(lag + 1)] < normalised[static_cast<size_t>(lag)])
+        ++lag;
+    
+    // Parabolic interpolation between the neighbouring lags
+    const float before = normalised[static_cast<size_t>(lag - 1)];
+    const float at = normalised[static_cast<size_t>(lag)];
+    const float after = normalised[static_cast<size_t>(lag + 1)];
+    const float curvature = before - 2.0f * at + after;
+    const float shift = curvature > 0.0f ? juce::jlimit(-0.5f, 0.5f, 0.5f * (before - after) / curvature) : 0.0f;
+    
+    period = (static_cast<float>(lag) + shift) * static_cast<float>(decimation);
+    aperiodicity = at;
+}
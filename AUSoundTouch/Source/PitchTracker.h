@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Monophonic pitch detection with YIN (de Cheveigné & Kawahara), run on a
+// decimated mono signal. The difference function is kept as a running sum over
+// a sliding window: each new sample adds its term and drops the oldest one for
+// every lag, instead of recomputing the whole window per estimate. That update
+// is one straight loop over contiguous lags, which the compiler vectorises.
+//
+// prepare() allocates; push() and the getters are safe on the audio thread.
+class PitchTracker
+{
+public:
+    PitchTracker() = default;
+    
+    void prepare(double sampleRate, double minFrequency, double maxFrequency);
+    void reset();
+    
+    // Feeds mono samples at the full sample rate
+    void push(const float* mono, int numFrames);
+    
+    // Of the latest estimate, in full-rate frames; 0 while unvoiced
+    float getPeriod() const { return period; }
+    bool isVoiced() const { return period > 0.0f; }
+    
+    // YIN's normalised difference at the chosen lag: 0 for a perfectly
+    // periodic signal, towards 1 for noise
+    float getAperiodicity() const { return aperiodicity; }
+    
+    // A lag is taken as the period when its normalised difference is below this
+    static constexpr float VOICING_THRESHOLD = 0.15f;
+    
+private:
+    void pushDecimated(float sample);
+    void estimate();
+    void recomputeDifference();
+    
+    // Decimated rate is at least this, enough for the fundamental and a few partials
+    static constexpr double ANALYSIS_RATE = 11025.0;
+    
+    // Decimated samples between estimates
+    static constexpr int ESTIMATE_INTERVAL = 32;
+    
+    // The running sums are rebuilt from scratch this often, so float rounding
+    // can't build up
+    static constexpr int REFRESH_INTERVAL = 16384;
+    
+    int decimation = 1;
+    int decimationCount = 0;
+    float decimationSum = 0.0f;
+    
+    int minLag = 1;
+    int maxLag = 2;
+    int windowSize = 2;
+    
+    // Decimated history, newest first and written twice so any window of it is
+    // contiguous: history[position + lag] is the sample lag steps back
+    std::vector<float> history;
+    int historySize = 0;
+    int position = 0;
+    
+    std::vector<float> difference;
+    std::vector<float> normalised;
+    double windowEnergy = 0.0;
+    int samplesUntilEstimate = ESTIMATE_INTERVAL;
+    int samplesUntilRefresh = REFRESH_INTERVAL;
+    
+    float period = 0.0f;
+    float aperiodicity = 1.0f;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchTracker)
+};
@@ -26,7 +26,7 @@ AUSoundTouchEditor::AUSoundTouchEditor (AUSoundTouchProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     // Minimal setup - just set size and optimization flags
-    setSize (680, 320); // Wider to accommodate unit labels
+    setSize (680, 560); // Wider to accommodate unit labels
     
     // Option 4: Rendering optimizations
     setOpaque(true); // No transparency needed - improves performance
@@ -69,15 +69,100 @@ void AUSoundTouchEditor::setupUI()
     bufferingComboBox.addItem("Minimal", 1);
     bufferingComboBox.addItem("Normal", 2);
     bufferingComboBox.addItem("Extra", 3);
+    bufferingComboBox.addItem("Live", 4);
     bufferingComboBox.setSelectedId(audioProcessor.getBufferingMode()); // Get current mode from processor
     addAndMakeVisible(bufferingComboBox);
     
-    // Handle buffering changes
+    // Handle buffering changes; the processor may move the quality along with it
     bufferingComboBox.onChange = [this]() {
         const int bufferingMode = bufferingComboBox.getSelectedId();
         audioProcessor.setBufferingMode(bufferingMode);
+        qualityComboBox.setSelectedId(audioProcessor.getQualityMode(), juce::dontSendNotification);
     };
     
+    // Setup quality control
+    qualityLabel.setText("Quality:", juce::dontSendNotification);
+    qualityLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(qualityLabel);
+    
+    qualityComboBox.addItem("Fast", 1);
+    qualityComboBox.addItem("Balanced", 2);
+    qualityComboBox.addItem("High", 3);
+    qualityComboBox.addItem("Monophonic", 4);
+    qualityComboBox.addItem("Speech", 5);
+    qualityComboBox.setSelectedId(audioProcessor.getQualityMode());
+    addAndMakeVisible(qualityComboBox);
+    
+    // The processor rebuilds its engines off the audio thread, and may move the
+    // buffering along with the quality
+    qualityComboBox.onChange = [this]() {
+        audioProcessor.setQualityMode(qualityComboBox.getSelectedId());
+        bufferingComboBox.setSelectedId(audioProcessor.getBufferingMode(), juce::dontSendNotification);
+    };
+    
+    // Setup harmony controls; item ids are the voice count plus one, since
+    // ComboBox ids can't be 0
+    harmonyLabel.setText("Harmony:", juce::dontSendNotification);
+    harmonyLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(harmonyLabel);
+    
+    harmonyComboBox.addItem("Off", 1);
+    
+    for (int voices = 1; voices <= Harmonizer::MAX_VOICES; ++voices)
+        harmonyComboBox.addItem(juce::String(voices) + (voices == 1 ? " voice" : " voices"), voices + 1);
+    
+    harmonyComboBox.setSelectedId(audioProcessor.getHarmonyVoices() + 1);
+    addAndMakeVisible(harmonyComboBox);
+    
+    harmonyComboBox.onChange = [this]() {
+        audioProcessor.setHarmonyVoices(harmonyComboBox.getSelectedId() - 1);
+    };
+    
+    // The note that plays the input back unshifted; ids are MIDI note numbers
+    referenceNoteLabel.setText("Unison:", juce::dontSendNotification);
+    referenceNoteLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(referenceNoteLabel);
+    
+    for (int note = 36; note <= 84; ++note)
+        referenceNoteComboBox.addItem(juce::MidiMessage::getMidiNoteName(note, true, true, 4), note);
+    
+    referenceNoteComboBox.setSelectedId(audioProcessor.getHarmonyReferenceNote());
+    addAndMakeVisible(referenceNoteComboBox);
+    
+    referenceNoteComboBox.onChange = [this]() {
+        audioProcessor.setHarmonyReferenceNote(referenceNoteComboBox.getSelectedId());
+    };
+    
+    // One offset per layer bus; item ids are the offset in semitones plus 25,
+    // since ComboBox ids can't be 0 or negative
+    layersLabel.setText("Layers:", juce::dontSendNotification);
+    layersLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(layersLabel);
+    
+    const int minOffset = static_cast<int>(OutputLayers::MIN_OFFSET_SEMITONES);
+    const int maxOffset = static_cast<int>(OutputLayers::MAX_OFFSET_SEMITONES);
+    
+    for (int layer = 0; layer < OutputLayers::MAX_LAYERS; ++layer)
+    {
+        auto& comboBox = layerOffsetComboBoxes[static_cast<size_t>(layer)];
+        
+        for (int offset = minOffset; offset <= maxOffset; ++offset)
+            comboBox.addItem(juce::String(offset > 0 ? "+" : "") + juce::String(offset) + " st", offset + 1 - minOffset);
+        
+        comboBox.setSelectedId(juce::roundToInt(audioProcessor.getLayerOffset(layer)) + 1 - minOffset);
+        addAndMakeVisible(comboBox);
+        
+        comboBox.onChange = [this, layer, &comboBox, minOffset]() {
+            audioProcessor.setLayerOffset(layer, static_cast<float>(comboBox.getSelectedId() - 1 + minOffset));
+        };
+    }
+    
+    // Starts polling the processor once visible
+    addAndMakeVisible(performancePanel);
+    
+    // Switches capture on in the processor once visible
+    addAndMakeVisible(signalScopeView);
+    
     uiInitialized = true;
 }
 
@@ -227,4 +312,39 @@ void AUSoundTouchEditor::resized()
     bufferingLabel.setBounds(bufferingBounds.removeFromLeft(labelWidth));
     bufferingBounds.removeFromLeft(spacing);
     bufferingComboBox.setBounds(bufferingBounds.removeFromLeft(150));
+    
+    // Quality control, on the same row
+    bufferingBounds.removeFromLeft(spacing * 3);
+    qualityLabel.setBounds(bufferingBounds.removeFromLeft(labelWidth));
+    bufferingBounds.removeFromLeft(spacing);
+    qualityComboBox.setBounds(bufferingBounds.removeFromLeft(150));
+    bounds.removeFromTop(10);
+    
+    // Harmony controls on the row below
+    auto harmonyBounds = bounds.removeFromTop(30);
+    harmonyLabel.setBounds(harmonyBounds.removeFromLeft(labelWidth));
+    harmonyBounds.removeFromLeft(spacing);
+    harmonyComboBox.setBounds(harmonyBounds.removeFromLeft(150));
+    
+    harmonyBounds.removeFromLeft(spacing * 3);
+    referenceNoteLabel.setBounds(harmonyBounds.removeFromLeft(labelWidth));
+    harmonyBounds.removeFromLeft(spacing);
+    referenceNoteComboBox.setBounds(harmonyBounds.removeFromLeft(150));
+    bounds.removeFromTop(10);
+    
+    // Layer offsets on the row below that
+    auto layersBounds = bounds.removeFromTop(30);
+    layersLabel.setBounds(layersBounds.removeFromLeft(labelWidth));
+    
+    for (auto& comboBox : layerOffsetComboBoxes)
+    {
+        layersBounds.removeFromLeft(spacing);
+        comboBox.setBounds(layersBounds.removeFromLeft(100));
+    }
+    bounds.removeFromTop(10);
+    
+    performancePanel.setBounds(bounds.removeFromTop(24));
+    bounds.removeFromTop(10);
+    
+    signalScopeView.setBounds(bounds.removeFromTop(150));
 }
\ No newline at end of file
@@ -23,6 +23,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "PerformancePanel.h"
+#include "SignalScopeView.h"
 
 class AUSoundTouchEditor : public juce::AudioProcessorEditor,
                            private juce::Timer
@@ -57,6 +59,26 @@ private:
     juce::Label bufferingLabel;
     juce::ComboBox bufferingComboBox;
     
+    // Quality control
+    juce::Label qualityLabel;
+    juce::ComboBox qualityComboBox;
+    
+    // Harmony controls
+    juce::Label harmonyLabel;
+    juce::ComboBox harmonyComboBox;
+    juce::Label referenceNoteLabel;
+    juce::ComboBox referenceNoteComboBox;
+    
+    // Pitch offsets of the auxiliary output buses
+    juce::Label layersLabel;
+    std::array<juce::ComboBox, OutputLayers::MAX_LAYERS> layerOffsetComboBoxes;
+    
+    // Live DSP load, FIFO, latency and underrun figures along the bottom
+    PerformancePanel performancePanel { audioProcessor };
+    
+    // Input and output waveform and spectrum, captured only while it exists
+    SignalScopeView signalScopeView { audioProcessor };
+    
     bool uiInitialized = false;
     
     void timerCallback() override;
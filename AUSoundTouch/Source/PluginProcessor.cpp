@@ -21,6 +21,80 @@
 */
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PresetBank.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr juce::uint32 makeStateKey (const char (&chars)[5])
+    {
+        return (static_cast<juce::uint32> (static_cast<juce::uint8> (chars[0])) << 24)
+             | (static_cast<juce::uint32> (static_cast<juce::uint8> (chars[1])) << 16)
+             | (static_cast<juce::uint32> (static_cast<juce::uint8> (chars[2])) << 8)
+             |  static_cast<juce::uint32> (static_cast<juce::uint8> (chars[3]));
+    }
+    
+    // Binary state: magic, version and entry count, then {fourcc key, float value}
+    // entries, all little-endian. Unknown keys are skipped so sessions from newer
+    // versions still load; anything without the magic is legacy XML.
+    constexpr juce::uint32 STATE_MAGIC = makeStateKey ("ASTS");
+    constexpr juce::uint16 STATE_VERSION = 1;
+    constexpr size_t STATE_HEADER_SIZE = 8;
+    constexpr size_t STATE_ENTRY_SIZE = 8;
+    
+    constexpr juce::uint32 STATE_PITCH_KEY = makeStateKey ("ptch");
+    constexpr juce::uint32 STATE_TEMPO_KEY = makeStateKey ("tmpo");
+    constexpr juce::uint32 STATE_SPEED_KEY = makeStateKey ("sped");
+    constexpr juce::uint32 STATE_BUFFERING_MODE_KEY = makeStateKey ("bufm");
+    constexpr juce::uint32 STATE_QUALITY_MODE_KEY = makeStateKey ("qual");
+    constexpr juce::uint32 STATE_PROGRAM_KEY = makeStateKey ("prog");
+    constexpr juce::uint32 STATE_HARMONY_VOICES_KEY = makeStateKey ("harv");
+    constexpr juce::uint32 STATE_HARMONY_REFERENCE_KEY = makeStateKey ("hkey");
+    constexpr juce::uint32 STATE_LAYER_OFFSET_KEYS[] = { makeStateKey ("lyr1"), makeStateKey ("lyr2"), makeStateKey ("lyr3") };
+    
+    static_assert (std::size (STATE_LAYER_OFFSET_KEYS) == OutputLayers::MAX_LAYERS, "One state key per output layer");
+    
+    void writeStateUint32 (char* dest, juce::uint32 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (value));
+    }
+    
+    void writeStateUint16 (char* dest, juce::uint16 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (value));
+    }
+    
+    void writeStateFloat (char* dest, float value)
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        writeStateUint32 (dest, bits);
+    }
+    
+    juce::uint32 readStateUint32 (const char* source)
+    {
+        juce::uint32 value;
+        std::memcpy (&value, source, sizeof (value));
+        return juce::ByteOrder::swapIfBigEndian (value);
+    }
+    
+    juce::uint16 readStateUint16 (const char* source)
+    {
+        juce::uint16 value;
+        std::memcpy (&value, source, sizeof (value));
+        return juce::ByteOrder::swapIfBigEndian (value);
+    }
+    
+    float readStateFloat (const char* source)
+    {
+        const auto bits = readStateUint32 (source);
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+}
 
 AUSoundTouchProcessor::AUSoundTouchProcessor()
      : AudioProcessor (BusesProperties()
@@ -29,17 +103,39 @@ AUSoundTouchProcessor::AUSoundTouchProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Layer 1", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Layer 2", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Layer 3", juce::AudioChannelSet::stereo(), false)
                      #endif
                        ),
        parameters(*this, nullptr, juce::Identifier("AUSoundTouchParameters"), createParameterLayout())
+      #if AUSOUNDTOUCH_CLAP
+       , clapThreadPool([this](int groupIndex) { runChannelGroupTask(groupIndex); })
+      #endif
 {
+    channelGroups.add(new SoundTouchWrapper());
+    
+    // Build the bank here rather than on the first program change, which the
+    // audio thread may be the one to act on
+    PresetBank::getFactoryBank();
+    
     pitchParameter = parameters.getRawParameterValue("pitch");
     tempoParameter = parameters.getRawParameterValue("tempo");
     speedParameter = parameters.getRawParameterValue("speed");
+    
+    stateParameters = {{
+        { STATE_PITCH_KEY, parameters.getParameter("pitch"), pitchParameter },
+        { STATE_TEMPO_KEY, parameters.getParameter("tempo"), tempoParameter },
+        { STATE_SPEED_KEY, parameters.getParameter("speed"), speedParameter }
+    }};
+    
+    reconfigurationWorker->addClient(*this);
 }
 
 AUSoundTouchProcessor::~AUSoundTouchProcessor()
 {
+    reconfigurationWorker->removeClient(*this);
+    cancelPendingUpdate();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout AUSoundTouchProcessor::createParameterLayout()
@@ -125,28 +221,203 @@ bool AUSoundTouchProcessor::isMidiEffect() const
 
 double AUSoundTouchProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Tracks the current tempo/rate, so slowed-down material reports a longer
+    // tail. Hosts ask on the message thread, so this reads the published value
+    // rather than waiting out a rebuild on the worker.
+    //
+    // There is no end-of-input flush: hosts have no end-of-stream call, and
+    // the silence they render for the tail pushes out everything the engines
+    // hold back, just as flushing would, without padding anything after it.
+    const double sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? reportedTailSamples.load(std::memory_order_relaxed) / sampleRate : 0.0;
+}
+
+int AUSoundTouchProcessor::getTailLengthSamples() const
+{
+    if (harmonizer.getMaxVoices() > 0)
+        return harmonizer.getLatencySamples() + juce::roundToInt(Harmonizer::RELEASE_SECONDS * getSampleRate());
+    
+    int tailSamples = outputLayers.getTailLengthSamples();
+    
+    for (auto* group : channelGroups)
+        tailSamples = juce::jmax(tailSamples, group->getTailLengthSamples());
+    
+    return tailSamples;
 }
 
 int AUSoundTouchProcessor::getNumPrograms()
 {
-    return 1;
+    return PresetBank::getFactoryBank().size();
 }
 
 int AUSoundTouchProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
+// VST3 hosts change programs through a parameter inside process(), so this may
+// be the audio thread. Switching back to the program last left is instant: the
+// channel groups keep a warm standby engine for it, which the audio thread
+// crossfades to at its next block (see refreshStandby()). Any other program,
+// or a switch made while the last is still being published, is left to the
+// worker at its next poll, which builds the preset's engines and crossfades to
+// them once they have warmed up (see applyPendingProgram()).
 void AUSoundTouchProcessor::setCurrentProgram (int index)
 {
-    juce::ignoreUnused (index);
+    if (! juce::isPositiveAndBelow(index, PresetBank::getFactoryBank().size()) || index == currentProgram.load())
+        return;
+    
+    // Keep parameter changes away from the engines until the new ones are
+    // published, so the outgoing sound holds steady into the crossfade
+    const bool settled = ! holdParameters.exchange(true);
+    previousProgram.store(currentProgram.exchange(index));
+    
+    if (settled && index == standbyProgram.load())
+    {
+        requestedStandbyProgram.store(index);
+        return;
+    }
+    
+    pendingProgram.store(index);
+    reconfigurationWorker->requestReconfigurationAtNextPoll(*this);
+}
+
+// Audio thread, at the start of a block: every group swaps to its standby on
+// this block, or none does and the worker builds the program as usual
+void AUSoundTouchProcessor::switchToStandbyProgram (int index)
+{
+    const bool ready = harmonizer.getMaxVoices() == 0 && outputLayers.getNumActiveLayers() == 0
+                    && std::all_of(channelGroups.begin(), channelGroups.end(),
+                                   [index] (const SoundTouchWrapper* group) { return group->isStandbyReady(index); });
+    
+    if (ready)
+    {
+        for (auto* group : channelGroups)
+            group->swapInStandby();
+        
+        swappedProgram.store(index);
+    }
+    else
+    {
+        pendingProgram.store(index);
+    }
+    
+    reconfigurationWorker->requestReconfigurationAtNextPoll(*this);
+}
+
+// Worker thread, under channelGroupLock: each group builds an engine with the
+// preset's modes and precomputed settings and crossfades to it once it has
+// warmed up. Returns the program applied, or -1.
+int AUSoundTouchProcessor::applyPendingProgram()
+{
+    const int index = pendingProgram.exchange(-1);
+    
+    if (index < 0)
+        return -1;
+    
+    const auto& preset = PresetBank::getFactoryBank()[index];
+    const auto configuration = getProgramEngineConfiguration(index);
+    
+    for (auto* group : channelGroups)
+        group->crossfadeTo(configuration, preset.nativePitch, preset.nativeTempo, preset.nativeRate);
+    
+    outputLayers.crossfadeTo(configuration, preset.nativePitch, preset.nativeTempo, preset.nativeRate);
+    
+    bufferingMode.store(preset.bufferingMode);
+    qualityMode.store(preset.qualityMode);
+    tunedProgram.store(index);
+    return index;
+}
+
+// Worker thread, under channelGroupLock: records the modes of a program the
+// audio thread has swapped the standbys in for. Returns it, or -1.
+int AUSoundTouchProcessor::takeUpSwappedProgram()
+{
+    const int index = swappedProgram.exchange(-1);
+    
+    if (index < 0)
+        return -1;
+    
+    const auto& preset = PresetBank::getFactoryBank()[index];
+    bufferingMode.store(preset.bufferingMode);
+    qualityMode.store(preset.qualityMode);
+    tunedProgram.store(index);
+    
+    // The standbys are running now; the layers, idle, only follow the modes
+    outputLayers.configure(getProgramEngineConfiguration(index));
+    groupsHaveStandby = false;
+    standbyProgram.store(-1);
+    return index;
+}
+
+// Worker thread, under channelGroupLock: keeps the groups' standbys built for
+// the program last switched away from, the one a performer flipping between
+// two is going back to. Each standby costs as much processing as its group,
+// so there are none until the host first changes programs, nor while harmony
+// voices or output layers run, which take other paths.
+void AUSoundTouchProcessor::refreshStandby()
+{
+    const int program = previousProgram.load();
+    const bool wanted = program >= 0 && program != currentProgram.load()
+                     && harmonizer.getMaxVoices() == 0 && outputLayers.getNumActiveLayers() == 0;
+    
+    if (! wanted)
+    {
+        if (groupsHaveStandby)
+            for (auto* group : channelGroups)
+                group->clearStandby();
+        
+        groupsHaveStandby = false;
+        standbyProgram.store(-1);
+        return;
+    }
+    
+    if (groupsHaveStandby && standbyProgram.load() == program)
+        return;
+    
+    // Withdrawn first, so no switch is made to a standby half rebuilt
+    standbyProgram.store(-1);
+    
+    const auto& preset = PresetBank::getFactoryBank()[program];
+    const auto configuration = getProgramEngineConfiguration(program);
+    
+    for (auto* group : channelGroups)
+        group->prepareStandby(configuration, preset.nativePitch, preset.nativeTempo, preset.nativeRate, program);
+    
+    groupsHaveStandby = true;
+    standbyProgram.store(program);
+}
+
+// Worker thread, outside channelGroupLock: moves the parameters to the preset
+// so the audio thread reads them as the new engines land, then lifts the
+// hold. Only the parameters' own listeners run here; the host hears about the
+// change from the message thread (see handleAsyncUpdate()).
+void AUSoundTouchProcessor::publishProgramParameters (int index)
+{
+    const auto& preset = PresetBank::getFactoryBank()[index];
+    
+    for (const auto& entry : stateParameters)
+    {
+        const float value = entry.key == STATE_PITCH_KEY ? preset.pitchSemitones
+                          : entry.key == STATE_TEMPO_KEY ? preset.tempoPercent
+                                                         : preset.speedPercent;
+        const float normalisedValue = entry.parameter->convertTo0to1(value);
+        entry.parameter->setValue(normalisedValue);
+        entry.parameter->sendValueChangedMessageToListeners(normalisedValue);
+    }
+    
+    // A program requested meanwhile keeps the hold until its own engines are in
+    if (pendingProgram.load() < 0)
+        holdParameters.store(false);
+    
+    programParametersChanged.store(true);
+    triggerAsyncUpdate();
 }
 
 const juce::String AUSoundTouchProcessor::getProgramName (int index)
 {
-    juce::ignoreUnused (index);
-    return {};
+    const auto& bank = PresetBank::getFactoryBank();
+    return juce::isPositiveAndBelow(index, bank.size()) ? bank[index].name : juce::String();
 }
 
 void AUSoundTouchProcessor::changeProgramName (int index, const juce::String& newName)
@@ -156,20 +427,291 @@ void AUSoundTouchProcessor::changeProgramName (int index, const juce::String& ne
 
 void AUSoundTouchProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    soundTouch.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    {
+        // Hosts re-prepare after every layout change with the audio thread stopped,
+        // so this is the only place groups are added or removed and their buffers
+        // sized. The lock keeps the worker from rebuilding a group meanwhile.
+        const juce::ScopedLock sl(channelGroupLock);
+        
+        // A switch to the standby never made is left to the worker, and the
+        // standbys themselves are rebuilt for the new layout at its next poll
+        if (const int requested = requestedStandbyProgram.exchange(-1); requested >= 0)
+            pendingProgram.store(requested);
+        
+        groupsHaveStandby = false;
+        standbyProgram.store(-1);
+        
+        const int numChannels = juce::jmax(1, getMainBusNumOutputChannels());
+        const int groupSize = canRunChannelGroupsInParallel() ? CHANNELS_PER_GROUP : numChannels;
+        const int numGroups = (numChannels + groupSize - 1) / groupSize;
+        
+        while (channelGroups.size() < numGroups)
+            channelGroups.add(new SoundTouchWrapper());
+        
+        channelGroups.removeLast(channelGroups.size() - numGroups);
+        
+        for (int i = 0; i < numGroups; ++i)
+        {
+            auto* group = channelGroups[i];
+            group->configure(getCurrentEngineConfiguration());
+            group->prepare(sampleRate, samplesPerBlock, juce::jmin(groupSize, numChannels - i * groupSize));
+            group->setHoldsPendingState(numGroups > 1);
+        }
+        
+        // Layer buses always match the main layout (see isBusesLayoutSupported())
+        std::array<bool, OutputLayers::MAX_LAYERS> enabledLayers {};
+        
+        for (int layer = 0; layer < OutputLayers::MAX_LAYERS; ++layer)
+            if (auto* bus = getBus(false, layer + 1))
+                enabledLayers[static_cast<size_t>(layer)] = bus->isEnabled();
+        
+        outputLayers.configure(getCurrentEngineConfiguration());
+        outputLayers.prepare(sampleRate, samplesPerBlock, numChannels, enabledLayers);
+        
+        harmonizer.prepare(sampleRate, numChannels, samplesPerBlock);
+        signalScope.prepare(samplesPerBlock);
+        blockTimes.reset();
+        harmonizerWasRunning = harmonizer.getMaxVoices() > 0;
+        
+        reportedLatencySamples.store(computeReportedLatency());
+        reportedTailSamples.store(getTailLengthSamples());
+    }
+    
+    // Hosts read the latency back as soon as this returns, so it is set here
+    // rather than left to the message thread; outside the lock, since the
+    // host's listeners may call straight back in
+    handleAsyncUpdate();
+    
+    if (pendingProgram.load() >= 0)
+        reconfigurationWorker->requestReconfiguration(*this);
+}
+
+bool AUSoundTouchProcessor::canRunChannelGroupsInParallel() const
+{
+   #if AUSOUNDTOUCH_CLAP
+    return clapThreadPool.isHostPoolAvailable();
+   #else
+    return false;
+   #endif
 }
 
 void AUSoundTouchProcessor::releaseResources()
 {
 }
 
+// Called by hosts on a transport jump. Drops the buffered audio from before the
+// seek so it doesn't play out, keeping every engine and its memory in place.
+void AUSoundTouchProcessor::reset()
+{
+    for (auto* group : channelGroups)
+        group->reset();
+    
+    outputLayers.reset();
+    harmonizer.reset();
+}
+
 void AUSoundTouchProcessor::setBufferingMode(int mode)
 {
-    if (mode >= Minimal && mode <= Extra)
+    if (mode >= Minimal && mode <= Live)
     {
         bufferingMode.store(mode);
-        soundTouch.setBufferingMode(mode);
+        tunedProgram.store(-1);
+        
+        if (! isModeCombinationSupported(mode, qualityMode.load()))
+            qualityMode.store(High);
+        
+        reconfigurationWorker->requestReconfiguration(*this);
+    }
+}
+
+void AUSoundTouchProcessor::setQualityMode(int mode)
+{
+    if (mode >= Fast && mode <= Speech)
+    {
+        qualityMode.store(mode);
+        tunedProgram.store(-1);
+        
+        if (! isModeCombinationSupported(bufferingMode.load(), mode))
+            bufferingMode.store(Normal);
+        
+        reconfigurationWorker->requestReconfiguration(*this);
+    }
+}
+
+// The content engines analyse more input than Minimal or Live buffering holds
+bool AUSoundTouchProcessor::isModeCombinationSupported(int buffering, int quality)
+{
+    return (quality != Monophonic && quality != Speech) || buffering == Normal || buffering == Extra;
+}
+
+// Takes effect on the next block. The latency changes with it, which the
+// worker works out, as the groups and layers may be rebuilt meanwhile; the
+// worker also takes up or lets go of the voices' thread pool.
+void AUSoundTouchProcessor::setHarmonyVoices(int numVoices)
+{
+    harmonizer.setMaxVoices(numVoices);
+    reconfigurationWorker->requestReconfiguration(*this);
+}
+
+void AUSoundTouchProcessor::setHarmonyReferenceNote(int note)
+{
+    harmonizer.setReferenceNote(note);
+}
+
+// Glides to the new pitch like an automated change of the main one
+void AUSoundTouchProcessor::setLayerOffset(int layer, float semitones)
+{
+    outputLayers.setOffset(layer, semitones);
+}
+
+// Worker thread: each group builds its new engine state here and the audio
+// thread swaps it in at the start of its next block
+void AUSoundTouchProcessor::performReconfiguration()
+{
+    int appliedProgram = -1;
+    
+    {
+        const juce::ScopedLock sl(channelGroupLock);
+        
+        // A program carries its own modes, so it replaces a plain mode change.
+        // One built here supersedes one the audio thread has just swapped in.
+        const int swappedIn = takeUpSwappedProgram();
+        appliedProgram = applyPendingProgram();
+        
+        if (appliedProgram < 0)
+            appliedProgram = swappedIn;
+        
+        if (appliedProgram < 0)
+        {
+            const auto configuration = getCurrentEngineConfiguration();
+            
+            for (auto* group : channelGroups)
+                group->configure(configuration);
+            
+            outputLayers.configure(configuration);
+        }
+        
+        refreshStandby();
+        
+        // Harmony voices switch paths without a rebuild (see setHarmonyVoices())
+        harmonizer.refresh();
+        updateReportedLatency();
     }
+    
+    if (appliedProgram >= 0)
+        publishProgramParameters(appliedProgram);
+}
+
+// Picks the engine for what the plugin is being used for. Offline renders get
+// the most accurate one whatever it costs; Minimal buffering means live
+// monitoring, where latency matters more than splice quality, and Live gives up
+// tempo changes to get that latency down to a few milliseconds. Monophonic and
+// Speech are the user's call about the material, so they hold for renders too,
+// but only with the buffering that can cover their latency.
+SoundTouchWrapper::Configuration AUSoundTouchProcessor::getEngineConfiguration (int buffering, int quality) const
+{
+    SoundTouchWrapper::Configuration configuration;
+    configuration.bufferingMode = buffering;
+    configuration.qualityMode = quality;
+    
+    // Presets and the setters never pair the content modes with too little
+    // buffering (see setBufferingMode()), so this only guards
+    const bool canBufferContentMode = isModeCombinationSupported(buffering, quality);
+    
+    if (quality == Monophonic && canBufferContentMode)
+        configuration.engineType = TimeStretchEngine::Type::Monophonic;
+    else if (quality == Speech && canBufferContentMode)
+        configuration.engineType = TimeStretchEngine::Type::Speech;
+    else if (isNonRealtime())
+        configuration.engineType = TimeStretchEngine::Type::HighQuality;
+    else if (buffering == Live)
+        configuration.engineType = TimeStretchEngine::Type::Live;
+    else if (buffering == Minimal)
+        configuration.engineType = TimeStretchEngine::Type::LowLatency;
+    
+    return configuration;
+}
+
+// The current modes, with the tuning of the program that set them while no
+// mode has been changed since
+SoundTouchWrapper::Configuration AUSoundTouchProcessor::getCurrentEngineConfiguration() const
+{
+    const int program = tunedProgram.load();
+    
+    if (program >= 0)
+        return getProgramEngineConfiguration(program);
+    
+    return getEngineConfiguration(bufferingMode.load(), qualityMode.load());
+}
+
+SoundTouchWrapper::Configuration AUSoundTouchProcessor::getProgramEngineConfiguration (int index) const
+{
+    const auto& preset = PresetBank::getFactoryBank()[index];
+    auto configuration = getEngineConfiguration(preset.bufferingMode, preset.qualityMode);
+    configuration.hasTuning = true;
+    configuration.tuning = preset.tuning;
+    return configuration;
+}
+
+// Worker thread, polled: also lets each group move to or from the phase vocoder
+// as the stretch factor crosses its thresholds, and keeps the standbys in step
+// with harmony voices being switched on and off
+void AUSoundTouchProcessor::releaseRetiredState()
+{
+    const juce::ScopedLock sl(channelGroupLock);
+    
+    for (auto* group : channelGroups)
+    {
+        group->releaseRetiredState();
+        group->updateAutomaticEngine();
+    }
+    
+    refreshStandby();
+    
+    outputLayers.releaseRetiredState();
+    harmonizer.refresh();
+    updateReportedLatency();
+    reportedTailSamples.store(getTailLengthSamples());
+}
+
+// The delay to report to the host. Groups and output layers run in parallel
+// and are aligned by the host as one, so the longest one counts.
+int AUSoundTouchProcessor::computeReportedLatency() const
+{
+    if (harmonizer.getMaxVoices() > 0)
+        return harmonizer.getLatencySamples();
+    
+    int latencySamples = outputLayers.getReportedLatencySamples();
+    
+    for (auto* group : channelGroups)
+        latencySamples = juce::jmax(latencySamples, group->getReportedLatencySamples());
+    
+    return latencySamples;
+}
+
+// Worker thread, under channelGroupLock: notes when a swapped-in engine changed
+// the delay. setLatencySamples() runs the host's listeners synchronously, and
+// they may call back into the processor, so the message thread makes the call.
+void AUSoundTouchProcessor::updateReportedLatency()
+{
+    const int latencySamples = computeReportedLatency();
+    
+    if (reportedLatencySamples.exchange(latencySamples) != latencySamples)
+        triggerAsyncUpdate();
+}
+
+// Message thread: passes on what the worker changed to the host
+void AUSoundTouchProcessor::handleAsyncUpdate()
+{
+    const int latencySamples = reportedLatencySamples.load();
+    
+    if (latencySamples != getLatencySamples())
+        setLatencySamples(latencySamples);
+    
+    // The values already in place, which automation may have moved on since
+    if (programParametersChanged.exchange(false))
+        for (const auto& entry : stateParameters)
+            entry.parameter->setValueNotifyingHost(entry.parameter->getValue());
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -179,37 +721,300 @@ bool AUSoundTouchProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any named or discrete layout works (mono, stereo, 5.1, 7.1, 7.1.4, ...) as
+    // long as SoundTouch can carry all of its channels in one stream.
+    const auto& mainOutput = layouts.getMainOutputChannelSet();
+    
+    if (mainOutput.isDisabled() || mainOutput.size() > SoundTouchWrapper::MAX_CHANNELS)
         return false;
 
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
    #endif
+    
+    // Layer buses are the main output at other pitches, so each one is either
+    // off or the main layout
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+    {
+        const auto& layerOutput = layouts.outputBuses.getReference(bus);
+        
+        if (! layerOutput.isDisabled() && layerOutput != mainOutput)
+            return false;
+    }
 
     return true;
   #endif
 }
 #endif
 
-void AUSoundTouchProcessor::processBlock (juce::AudioBuffer<float>& buffer,
-                                          juce::MidiBuffer& midiMessages)
+template <typename SampleType>
+void AUSoundTouchProcessor::processBlockInternal (juce::AudioBuffer<SampleType>& buffer,
+                                                  juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
-
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
+    
+    if (const int standbyRequest = requestedStandbyProgram.exchange(-1); standbyRequest >= 0)
+        switchToStandbyProgram(standbyRequest);
+
+    // While a program change is being published the engines keep their old settings
+    if (! holdParameters.load())
+    {
+        for (auto* group : channelGroups)
+        {
+            group->setPitch(*pitchParameter);
+            group->setTempo(*tempoParameter);
+            group->setRate(*speedParameter);
+        }
+        
+        outputLayers.setRatios(*pitchParameter, *tempoParameter, *speedParameter);
+    }
+    
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    signalScope.captureInput(mainBuffer);
+    
+    // Whichever path is switched in starts from clean state, since it stopped
+    // seeing input when it was switched out
+    const bool harmonizerRunning = harmonizer.getMaxVoices() > 0;
+    
+    if (harmonizerRunning != harmonizerWasRunning)
+    {
+        harmonizerWasRunning = harmonizerRunning;
+        
+        if (harmonizerRunning)
+        {
+            harmonizer.reset();
+        }
+        else
+        {
+            for (auto* group : channelGroups)
+                group->reset();
+            
+            outputLayers.reset();
+        }
+    }
+    
+    if (harmonizerRunning)
+    {
+        harmonizer.processBlock(mainBuffer, midiMessages);
+        signalScope.captureOutput(mainBuffer);
+        return;
+    }
+    
+    if (outputLayers.getNumActiveLayers() > 0)
+        processOutputLayers(buffer, mainBuffer);
+    else if (channelGroups.size() == 1)
+        channelGroups.getUnchecked(0)->processBlock(mainBuffer);
+    else
+        processChannelGroups(mainBuffer);
+    
+    signalScope.captureOutput(mainBuffer);
+}
+
+// A single main engine joins the layers on the shared input pass. Split
+// channel groups keep their own passes, after the layers have read the input.
+template <typename SampleType>
+void AUSoundTouchProcessor::processOutputLayers (juce::AudioBuffer<SampleType>& buffer,
+                                                 juce::AudioBuffer<SampleType>& mainBuffer)
+{
+    std::array<SampleType* const*, OutputLayers::MAX_LAYERS> layerChannels {};
+    
+    for (int layer = 0; layer < OutputLayers::MAX_LAYERS; ++layer)
+    {
+        auto* bus = getBus(false, layer + 1);
+        
+        if (bus != nullptr && bus->isEnabled() && bus->getNumberOfChannels() == mainBuffer.getNumChannels())
+            layerChannels[static_cast<size_t>(layer)] = buffer.getArrayOfWritePointers() + bus->getChannelIndexInProcessBlockBuffer(0);
+    }
+    
+    if (channelGroups.size() == 1)
+    {
+        outputLayers.processBlock(mainBuffer, channelGroups.getUnchecked(0), layerChannels);
+    }
+    else
+    {
+        outputLayers.processBlock(mainBuffer, nullptr, layerChannels);
+        processChannelGroups(mainBuffer);
+    }
+}
+
+// The write pointers are taken here, once: getArrayOfWritePointers() clears
+// the buffer's isClear flag, which tasks on other threads mustn't all write
+template <typename SampleType>
+void AUSoundTouchProcessor::processChannelGroups (juce::AudioBuffer<SampleType>& buffer)
+{
+    // The worker rebuilds groups one after another, so they switch engines
+    // only once the last of them is ready
+    if (std::all_of(channelGroups.begin(), channelGroups.end(),
+                    [] (const SoundTouchWrapper* group) { return group->isReadyToSwap(); }))
+        for (auto* group : channelGroups)
+            group->swapInPendingState();
+    
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    groupTaskNumSamples = buffer.getNumSamples();
+    
+    if constexpr (std::is_same_v<SampleType, float>)
+        groupTaskFloatChannels = channels;
+    else
+        groupTaskDoubleChannels = channels;
+    
+    bool ranOnHostThreads = false;
+    
+   #if AUSOUNDTOUCH_CLAP
+    ranOnHostThreads = clapThreadPool.execute(channelGroups.size());
+   #endif
+    
+    if (! ranOnHostThreads)
+        for (int i = 0; i < channelGroups.size(); ++i)
+            processChannelGroup(channels, groupTaskNumSamples, i);
+    
+    groupTaskFloatChannels = nullptr;
+    groupTaskDoubleChannels = nullptr;
+}
+
+template <typename SampleType>
+void AUSoundTouchProcessor::processChannelGroup (SampleType* const* channels, int numSamples, int groupIndex)
+{
+    auto* group = channelGroups.getUnchecked(groupIndex);
+    
+    // A view onto this group's channels; no allocation for layouts this size
+    juce::AudioBuffer<SampleType> groupBuffer (channels + groupIndex * CHANNELS_PER_GROUP,
+                                               group->getNumChannels(),
+                                               numSamples);
+    group->processBlock(groupBuffer);
+}
+
+// Runs on a host worker thread while processBlock waits in ClapThreadPool::execute()
+void AUSoundTouchProcessor::runChannelGroupTask (int groupIndex)
+{
+    if (! juce::isPositiveAndBelow(groupIndex, channelGroups.size()))
+        return;
+    
+    if (groupTaskFloatChannels != nullptr)
+        processChannelGroup(groupTaskFloatChannels, groupTaskNumSamples, groupIndex);
+    else if (groupTaskDoubleChannels != nullptr)
+        processChannelGroup(groupTaskDoubleChannels, groupTaskNumSamples, groupIndex);
+}
+
+void AUSoundTouchProcessor::processBlock (juce::AudioBuffer<float>& buffer,
+                                          juce::MidiBuffer& midiMessages)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    processBlockInternal (buffer, midiMessages);
+    publishTelemetry (startTicks, buffer.getNumSamples());
+}
+
+// Native 64-bit path: the wrapper narrows to float inside its interleave pass,
+// so hosts with a double mix engine avoid a separate conversion copy.
+void AUSoundTouchProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                          juce::MidiBuffer& midiMessages)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    processBlockInternal (buffer, midiMessages);
+    publishTelemetry (startTicks, buffer.getNumSamples());
+}
 
-    soundTouch.setPitch(*pitchParameter);
-    soundTouch.setTempo(*tempoParameter);
-    soundTouch.setRate(*speedParameter);
+// Audio thread, after every block. Only plain loads and stores of atomics, so
+// the editor can poll them at its own pace.
+void AUSoundTouchProcessor::publishTelemetry (juce::int64 startTicks, int numSamples)
+{
+    // The ratios this block ran at set the tail (see getTailLengthSeconds())
+    reportedTailSamples.store (getTailLengthSamples(), std::memory_order_relaxed);
+    
+    if (numSamples == 0 || getSampleRate() <= 0.0)
+        return;
+    
+    const double elapsedMs = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    const double blockMs = numSamples * 1000.0 / getSampleRate();
+    const auto load = static_cast<float> (elapsedMs / blockMs);
+    
+    // Jumps to a peak at once, then falls back so a single spike stays readable
+    const auto release = static_cast<float> (std::exp (-blockMs / (1000.0 * LOAD_RELEASE_SECONDS)));
+    const float heldLoad = telemetry.dspLoad.load (std::memory_order_relaxed) * release;
+    telemetry.dspLoad.store (juce::jmax (load, heldLoad), std::memory_order_relaxed);
+    
+    // Offline renders may take as long as they like, so only realtime blocks overload
+    if (elapsedMs > blockMs && ! isNonRealtime())
+        realtimeLog->post (RealtimeLog::Event::Overload, logSource, elapsedMs, blockMs);
+    
+    // Published before this block's figures below, so the slot trails the panel by a block
+    blockTimes.add (elapsedMs, blockMs);
+    
+    if (blockTimes.getAudioMs() >= STATS_WINDOW_MS)
+        publishStats();
+    
+    if (harmonizerWasRunning || channelGroups.isEmpty())
+    {
+        telemetry.fifoFrames.store (0, std::memory_order_relaxed);
+        telemetry.fifoTargetFrames.store (0, std::memory_order_relaxed);
+        telemetry.latencySamples.store (harmonizer.getLatencySamples(), std::memory_order_relaxed);
+        return;
+    }
+    
+    juce::int64 underruns = 0;
+    juce::int64 droppedFrames = 0;
+    
+    for (auto* group : channelGroups)
+    {
+        const auto stats = group->getStats();
+        underruns += stats.underruns;
+        droppedFrames += stats.droppedFrames;
+    }
+    
+    auto* mainGroup = channelGroups.getUnchecked (0);
+    telemetry.fifoFrames.store (mainGroup->getStats().fifoFrames, std::memory_order_relaxed);
+    telemetry.fifoTargetFrames.store (mainGroup->getReportedLatencySamples(), std::memory_order_relaxed);
+    telemetry.latencySamples.store (mainGroup->getLatencyInSamples(), std::memory_order_relaxed);
+    telemetry.underruns.store (underruns, std::memory_order_relaxed);
+    telemetry.droppedFrames.store (droppedFrames, std::memory_order_relaxed);
+}
+
+// Audio thread, once per STATS_WINDOW_MS of audio: the window's realtime factor
+// and 99th-percentile block time, with the latest snapshot, go to the shared
+// segment for `ausoundtouch-top`
+void AUSoundTouchProcessor::publishStats()
+{
+    const auto snapshot = getPerformanceSnapshot();
+    
+    StatsSegment::Stats stats;
+    stats.realtimeFactor = blockTimes.getRealtimeFactor();
+    stats.p99BlockMs = blockTimes.getPercentileMs (0.99);
+    stats.latencyMs = snapshot.latencyMs;
+    stats.dspLoad = snapshot.dspLoad;
+    stats.underruns = snapshot.underruns;
+    stats.droppedFrames = snapshot.droppedFrames;
+    stats.qualityMode = qualityMode.load (std::memory_order_relaxed);
+    stats.bufferingMode = bufferingMode.load (std::memory_order_relaxed);
+    
+    statsSlot.publish (stats);
+    blockTimes.reset();
+}
+
+AUSoundTouchProcessor::PerformanceSnapshot AUSoundTouchProcessor::getPerformanceSnapshot() const
+{
+    PerformanceSnapshot snapshot;
+    snapshot.dspLoad = telemetry.dspLoad.load (std::memory_order_relaxed);
+    snapshot.fifoFrames = telemetry.fifoFrames.load (std::memory_order_relaxed);
+    snapshot.fifoTargetFrames = telemetry.fifoTargetFrames.load (std::memory_order_relaxed);
+    snapshot.underruns = telemetry.underruns.load (std::memory_order_relaxed);
+    snapshot.droppedFrames = telemetry.droppedFrames.load (std::memory_order_relaxed);
+    
+    const double sampleRate = getSampleRate();
+    
+    if (sampleRate > 0.0)
+        snapshot.latencyMs = telemetry.latencySamples.load (std::memory_order_relaxed) * 1000.0 / sampleRate;
     
-    soundTouch.processBlock(buffer);
+    return snapshot;
+}
+
+bool AUSoundTouchProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
 }
 
 bool AUSoundTouchProcessor::hasEditor() const
@@ -224,17 +1029,42 @@ juce::AudioProcessorEditor* AUSoundTouchProcessor::createEditor()
 
 void AUSoundTouchProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = parameters.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
+    const auto numEntries = static_cast<juce::uint16> (stateParameters.size() + 5 + OutputLayers::MAX_LAYERS);
+    destData.setSize (STATE_HEADER_SIZE + numEntries * STATE_ENTRY_SIZE);
+    
+    auto* out = static_cast<char*> (destData.getData());
+    
+    writeStateUint32 (out, STATE_MAGIC);
+    writeStateUint16 (out + 4, STATE_VERSION);
+    writeStateUint16 (out + 6, numEntries);
+    out += STATE_HEADER_SIZE;
+    
+    auto writeEntry = [&out] (juce::uint32 key, float value)
+    {
+        writeStateUint32 (out, key);
+        writeStateFloat (out + 4, value);
+        out += STATE_ENTRY_SIZE;
+    };
+    
+    for (const auto& entry : stateParameters)
+        writeEntry (entry.key, entry.value->load());
     
-    // Add buffering mode as an attribute
-    xml->setAttribute("bufferingMode", bufferingMode.load());
+    writeEntry (STATE_BUFFERING_MODE_KEY, static_cast<float> (bufferingMode.load()));
+    writeEntry (STATE_QUALITY_MODE_KEY, static_cast<float> (qualityMode.load()));
+    writeEntry (STATE_PROGRAM_KEY, static_cast<float> (currentProgram.load()));
+    writeEntry (STATE_HARMONY_VOICES_KEY, static_cast<float> (getHarmonyVoices()));
+    writeEntry (STATE_HARMONY_REFERENCE_KEY, static_cast<float> (getHarmonyReferenceNote()));
     
-    copyXmlToBinary (*xml, destData);
+    for (int layer = 0; layer < OutputLayers::MAX_LAYERS; ++layer)
+        writeEntry (STATE_LAYER_OFFSET_KEYS[layer], getLayerOffset (layer));
 }
 
 void AUSoundTouchProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    if (applyBinaryState (data, sizeInBytes))
+        return;
+    
+    // Sessions saved by earlier versions hold the parameter tree as XML
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
@@ -245,9 +1075,105 @@ void AUSoundTouchProcessor::setStateInformation (const void* data, int sizeInByt
         // Restore buffering mode
         const int savedBufferingMode = xmlState->getIntAttribute("bufferingMode", Normal);
         setBufferingMode(savedBufferingMode);
+        
+        // Sessions saved before quality modes existed ran at High
+        setQualityMode(xmlState->getIntAttribute("qualityMode", High));
     }
 }
 
+// Reads the blob in place and applies it through the cached parameter pointers,
+// so loading a session allocates nothing here. Returns false if it isn't ours.
+bool AUSoundTouchProcessor::applyBinaryState (const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < static_cast<int> (STATE_HEADER_SIZE))
+        return false;
+    
+    const auto* in = static_cast<const char*> (data);
+    
+    if (readStateUint32 (in) != STATE_MAGIC)
+        return false;
+    
+    // Every version shares the entry layout; newer ones may only add keys, which
+    // are skipped below, so the version needs no check when reading
+    const int availableEntries = (sizeInBytes - static_cast<int> (STATE_HEADER_SIZE)) / static_cast<int> (STATE_ENTRY_SIZE);
+    const int numEntries = juce::jmin (static_cast<int> (readStateUint16 (in + 6)), availableEntries);
+    in += STATE_HEADER_SIZE;
+    
+    for (int i = 0; i < numEntries; ++i, in += STATE_ENTRY_SIZE)
+    {
+        const auto key = readStateUint32 (in);
+        const float value = readStateFloat (in + 4);
+        
+        if (key == STATE_BUFFERING_MODE_KEY)
+        {
+            setBufferingMode (juce::roundToInt (value));
+            continue;
+        }
+        
+        if (key == STATE_QUALITY_MODE_KEY)
+        {
+            setQualityMode (juce::roundToInt (value));
+            continue;
+        }
+        
+        if (key == STATE_HARMONY_VOICES_KEY)
+        {
+            setHarmonyVoices (juce::roundToInt (value));
+            continue;
+        }
+        
+        if (key == STATE_HARMONY_REFERENCE_KEY)
+        {
+            setHarmonyReferenceNote (juce::roundToInt (value));
+            continue;
+        }
+        
+        if (const auto* layerKey = std::find (std::begin (STATE_LAYER_OFFSET_KEYS), std::end (STATE_LAYER_OFFSET_KEYS), key);
+            layerKey != std::end (STATE_LAYER_OFFSET_KEYS))
+        {
+            setLayerOffset (static_cast<int> (layerKey - std::begin (STATE_LAYER_OFFSET_KEYS)), value);
+            continue;
+        }
+        
+        // Only the selection: the saved parameters already hold any edits made
+        // after the program was chosen
+        if (key == STATE_PROGRAM_KEY)
+        {
+            const int program = juce::roundToInt (value);
+            
+            if (juce::isPositiveAndBelow (program, getNumPrograms()))
+                currentProgram.store (program);
+            
+            continue;
+        }
+        
+        for (const auto& entry : stateParameters)
+            if (entry.key == key)
+                entry.parameter->setValueNotifyingHost (entry.parameter->convertTo0to1 (value));
+    }
+    
+    return true;
+}
+
+#if AUSOUNDTOUCH_CLAP
+bool AUSoundTouchProcessor::supportsExtension (const char* name)
+{
+    return std::strcmp(name, CLAP_EXT_THREAD_POOL) == 0 && clapThreadPool.getPluginExtension() != nullptr;
+}
+
+const void* AUSoundTouchProcessor::getExtension (const char* name)
+{
+    return supportsExtension(name) ? clapThreadPool.getPluginExtension() : nullptr;
+}
+
+void AUSoundTouchProcessor::clapHostAttached (const clap_host_t* host)
+{
+    // prepareToPlay() follows from activate(), so the channel groups it builds
+    // already know whether the host can run them in parallel
+    clapThreadPool.attachHost(host);
+}
+#endif
+
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new AUSoundTouchProcessor();
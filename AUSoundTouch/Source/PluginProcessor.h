@@ -24,8 +24,24 @@
 
 #include <JuceHeader.h>
 #include "SoundTouchWrapper.h"
+#include "ReconfigurationWorker.h"
+#include "Harmonizer.h"
+#include "OutputLayers.h"
+#include "RealtimeLog.h"
+#include "SignalScope.h"
+#include "StatsSegment.h"
+
+#if AUSOUNDTOUCH_CLAP
+ #include <clap-juce-extensions/clap-juce-extensions.h>
+ #include "ClapThreadPool.h"
+#endif
 
 class AUSoundTouchProcessor : public juce::AudioProcessor
+                            , private ReconfigurationWorker::Client
+                            , private juce::AsyncUpdater
+                           #if AUSOUNDTOUCH_CLAP
+                            , public clap_juce_extensions::clap_juce_audio_processor_capabilities
+                           #endif
 {
 public:
     AUSoundTouchProcessor();
@@ -33,12 +49,15 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
 
     #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -68,11 +87,86 @@ public:
     {
         Minimal = 1,
         Normal = 2,
-        Extra = 3
+        Extra = 3,
+        Live = 4   // Pitch only, a few milliseconds, for monitoring while performing
+    };
+    
+    // Quality modes, trading SoundTouch's seek and filter accuracy for CPU
+    enum QualityMode
+    {
+        Fast = 1,
+        Balanced = 2,
+        High = 3,
+        Monophonic = 4,  // Pitch-synchronous engine for a single voice or instrument
+        Speech = 5       // SoundTouch at a reduced rate below 7 kHz, for spoken word
     };
     
+    // Mode changes take effect asynchronously: the engines are rebuilt on the
+    // shared reconfiguration worker and swapped in by the audio thread.
+    // Monophonic and Speech only run with Normal or Extra buffering, so setting
+    // one side of any other pairing moves the other side along with it:
+    // Minimal or Live buffering brings the quality back to High, and Monophonic
+    // or Speech brings the buffering up to Normal.
     void setBufferingMode(int mode);
     int getBufferingMode() const { return bufferingMode.load(); }
+    void setQualityMode(int mode);
+    int getQualityMode() const { return qualityMode.load(); }
+    static bool isModeCombinationSupported(int buffering, int quality);
+    
+    // With voices allowed, held MIDI notes add pitch-shifted copies of the
+    // input in place of the time-stretch engines; 0 turns harmony off
+    void setHarmonyVoices(int numVoices);
+    int getHarmonyVoices() const { return harmonizer.getMaxVoices(); }
+    void setHarmonyReferenceNote(int note);
+    int getHarmonyReferenceNote() const { return harmonizer.getReferenceNote(); }
+    
+    // Auxiliary output buses 1 to OutputLayers::MAX_LAYERS, off until the host
+    // enables them, each carrying the input this many semitones from the main pitch
+    void setLayerOffset(int layer, float semitones);
+    float getLayerOffset(int layer) const { return outputLayers.getOffset(layer); }
+    
+    // What the editor's performance panel shows, as of the last block. The
+    // audio thread publishes it through atomics; readable from any thread.
+    struct PerformanceSnapshot
+    {
+        float dspLoad = 0.0f;           // Block time over the block's duration, peak-held
+        int fifoFrames = 0;             // Main engine's FIFO fill; 0 while harmony runs
+        int fifoTargetFrames = 0;       // The fill the FIFO is primed to
+        double latencyMs = 0.0;         // Audio actually held back: engine input plus FIFO
+        juce::int64 underruns = 0;      // Summed over the channel groups since prepare
+        juce::int64 droppedFrames = 0;
+    };
+    
+    PerformanceSnapshot getPerformanceSnapshot() const;
+    
+    // Latency changes found on the worker reach the host from the message
+    // thread; this hands over one still waiting there at once. Message thread only.
+    void handlePendingLatencyChange() { handleUpdateNowIfNeeded(); }
+    
+    // Input and output decimated for the editor's waveform and spectrum view
+    SignalScope& getSignalScope() { return signalScope; }
+    
+    // How long the DSP load meter takes to fall back by a factor of e after a peak
+    static constexpr double LOAD_RELEASE_SECONDS = 0.5;
+    
+    // Audio per update of this instance's slot in the shared stats segment
+    static constexpr double STATS_WINDOW_MS = 250.0;
+    int getNumActiveLayers() const { return outputLayers.getNumActiveLayers(); }
+    
+    // Wide layouts are split into groups of this many channels when the host
+    // lends us worker threads to run them on; otherwise one group holds them all.
+    static constexpr int CHANNELS_PER_GROUP = 2;
+    int getNumChannelGroups() const { return channelGroups.size(); }
+    
+   #if AUSOUNDTOUCH_CLAP
+    // clap-juce-extensions hooks: advertise clap.thread-pool to the host
+    bool supportsExtension (const char* name) override;
+    const void* getExtension (const char* name) override;
+    
+    // The wrapper calls this from clap_plugin::init(), before activate(); it
+    // binds the host whose thread pool runs the channel groups
+    void clapHostAttached (const clap_host_t* host) override;
+   #endif
 
     static constexpr float MIN_PITCH_SEMITONES = -39.8f;
     static constexpr float MAX_PITCH_SEMITONES = 39.8f;
@@ -87,14 +181,135 @@ public:
     static constexpr float DEFAULT_SPEED_PERCENT = 0.0f;
 
 private:
+    template <typename SampleType>
+    void processBlockInternal (juce::AudioBuffer<SampleType>&, juce::MidiBuffer&);
+    
+    template <typename SampleType>
+    void processChannelGroups (juce::AudioBuffer<SampleType>&);
+    
+    template <typename SampleType>
+    void processOutputLayers (juce::AudioBuffer<SampleType>&, juce::AudioBuffer<SampleType>& mainBuffer);
+    
+    template <typename SampleType>
+    void processChannelGroup (SampleType* const* channels, int numSamples, int groupIndex);
+    
+    void runChannelGroupTask (int groupIndex);
+    void publishTelemetry (juce::int64 startTicks, int numSamples);
+    void publishStats();
+    int getTailLengthSamples() const;
+    bool canRunChannelGroupsInParallel() const;
+    
+    SoundTouchWrapper::Configuration getEngineConfiguration (int buffering, int quality) const;
+    SoundTouchWrapper::Configuration getCurrentEngineConfiguration() const;
+    SoundTouchWrapper::Configuration getProgramEngineConfiguration (int index) const;
+    
+    void performReconfiguration() override;
+    int applyPendingProgram();
+    int takeUpSwappedProgram();
+    void switchToStandbyProgram (int index);
+    void refreshStandby();
+    void publishProgramParameters (int index);
+    void releaseRetiredState() override;
+    int computeReportedLatency() const;
+    void updateReportedLatency();
+    void handleAsyncUpdate() override;
+    
+    bool applyBinaryState (const void* data, int sizeInBytes);
+    
     juce::AudioProcessorValueTreeState parameters;
-    SoundTouchWrapper soundTouch;
+    juce::OwnedArray<SoundTouchWrapper> channelGroups;
+    
+    // Serialises prepareToPlay() against the worker; never taken on the audio thread
+    juce::CriticalSection channelGroupLock;
+    juce::SharedResourcePointer<ReconfigurationWorker> reconfigurationWorker;
+    
+    // Replaces the channel groups while harmony voices are allowed
+    Harmonizer harmonizer;
+    bool harmonizerWasRunning = false;
+    
+    // Engines for the auxiliary output buses, sharing the main path's input pass
+    OutputLayers outputLayers;
+    
+    // Blocks that take longer to process than they last are logged as overloads
+    juce::SharedResourcePointer<RealtimeLog> realtimeLog;
+    const juce::uint32 logSource = RealtimeLog::createSourceId();
+    
+    // Written at the end of every block (see getPerformanceSnapshot())
+    struct Telemetry
+    {
+        std::atomic<float> dspLoad { 0.0f };
+        std::atomic<int> fifoFrames { 0 };
+        std::atomic<int> fifoTargetFrames { 0 };
+        std::atomic<int> latencySamples { 0 };
+        std::atomic<juce::int64> underruns { 0 };
+        std::atomic<juce::int64> droppedFrames { 0 };
+    };
+    
+    Telemetry telemetry;
+    SignalScope signalScope;
+    
+    // This instance's row in `ausoundtouch-top`, updated every STATS_WINDOW_MS of audio
+    juce::SharedResourcePointer<StatsSegment> statsSegment;
+    StatsSegment::Slot statsSlot { statsSegment.getObject(), logSource,
+                                   juce::File::getSpecialLocation (juce::File::hostApplicationPath).getFileNameWithoutExtension() };
+    BlockTimeWindow blockTimes;
+    
+    // The main bus channels, visible to group tasks for the duration of one block
+    float* const* groupTaskFloatChannels = nullptr;
+    double* const* groupTaskDoubleChannels = nullptr;
+    int groupTaskNumSamples = 0;
+    
+   #if AUSOUNDTOUCH_CLAP
+    ClapThreadPool clapThreadPool;
+   #endif
     
     std::atomic<float>* pitchParameter = nullptr;
     std::atomic<float>* tempoParameter = nullptr;
     std::atomic<float>* speedParameter = nullptr;
     
+    // Parameters in the binary state, keyed by fourcc
+    struct StateParameter
+    {
+        juce::uint32 key = 0;
+        juce::RangedAudioParameter* parameter = nullptr;
+        std::atomic<float>* value = nullptr;
+    };
+    
+    std::array<StateParameter, 3> stateParameters;
+    
     std::atomic<int> bufferingMode { Normal };
+    std::atomic<int> qualityMode { High };
+    
+    std::atomic<int> currentProgram { 0 };
+    std::atomic<bool> holdParameters { false };
+    
+    // The latency the host should see, set wherever it is worked out and passed
+    // to setLatencySamples() on the message thread (see handleAsyncUpdate())
+    std::atomic<int> reportedLatencySamples { 0 };
+    
+    // Likewise the tail, refreshed after every block and engine swap
+    std::atomic<int> reportedTailSamples { 0 };
+    
+    // Program whose engines the worker still has to build, or -1
+    std::atomic<int> pendingProgram { -1 };
+    
+    // The program whose tuning the engines run, until a mode change replaces
+    // it, or -1
+    std::atomic<int> tunedProgram { -1 };
+    
+    // The program last switched away from, which the channel groups keep a
+    // standby for; the program the standbys are built for, or -1 while they
+    // aren't; and a switch to it for the audio thread to make at its next
+    // block, which it hands back to the worker once made
+    std::atomic<int> previousProgram { -1 };
+    std::atomic<int> standbyProgram { -1 };
+    std::atomic<int> requestedStandbyProgram { -1 };
+    std::atomic<int> swappedProgram { -1 };
+    bool groupsHaveStandby = false;
+    
+    // Set once the worker has moved the parameters to a program's values, for
+    // the message thread to tell the host
+    std::atomic<bool> programParametersChanged { false };
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AUSoundTouchProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PresetBank.h"
+#include "SoundTouchWrapper.h"
+#include "SoundTouchEngine.h"
+
+const PresetBank& PresetBank::getFactoryBank()
+{
+    static const PresetBank bank;
+    return bank;
+}
+
+PresetBank::PresetBank()
+{
+    add("Default", 0.0f, 0.0f, 0.0f);
+    add("Up 1 Semitone", 1.0f, 0.0f, 0.0f);
+    add("Down 1 Semitone", -1.0f, 0.0f, 0.0f);
+    add("Up 2 Semitones", 2.0f, 0.0f, 0.0f);
+    add("Down 2 Semitones", -2.0f, 0.0f, 0.0f);
+    add("Up 1 Octave", 12.0f, 0.0f, 0.0f);
+    add("Down 1 Octave", -12.0f, 0.0f, 0.0f);
+    add("Practice 75%", 0.0f, -25.0f, 0.0f);
+    add("Practice 50%", 0.0f, -50.0f, 0.0f, 3);
+    add("E-flat Tuning Practice", -1.0f, -25.0f, 0.0f);
+}
+
+void PresetBank::add(const juce::String& name, float pitchSemitones, float tempoPercent, float speedPercent,
+                     int bufferingMode, int qualityMode)
+{
+    Preset preset;
+    preset.name = name;
+    preset.pitchSemitones = pitchSemitones;
+    preset.tempoPercent = tempoPercent;
+    preset.speedPercent = speedPercent;
+    preset.bufferingMode = bufferingMode;
+    preset.qualityMode = qualityMode;
+    
+    preset.nativePitch = SoundTouchWrapper::semitonesToNative(pitchSemitones);
+    preset.nativeTempo = SoundTouchWrapper::percentageToNative(tempoPercent);
+    preset.nativeRate = SoundTouchWrapper::percentageToNative(speedPercent);
+    preset.tuning = getTuning(pitchSemitones, preset.nativeTempo, qualityMode);
+    
+    presets.push_back(preset);
+}
+
+// The quality mode's windows, lengthened as the tempo slows along the slope of
+// SoundTouch's own automatic sequence and seek settings (50 ms and 5 ms less
+// per 1.5 of tempo), so each splice repeats less of the material. Octave
+// shifts put more of the spectrum near the anti-alias filter's edge, so they
+// get its longest filter.
+TimeStretchEngine::Tuning PresetBank::getTuning(float pitchSemitones, float nativeTempo, int qualityMode)
+{
+    auto tuning = SoundTouchEngine::getTuning(TimeStretchEngine::Type::Standard, qualityMode);
+    const float slowdown = 1.0f - nativeTempo;
+    
+    tuning.sequenceMs = juce::jlimit(20, 90, tuning.sequenceMs + juce::roundToInt(slowdown * 100.0f / 3.0f));
+    tuning.seekWindowMs = juce::jlimit(8, 25, tuning.seekWindowMs + juce::roundToInt(slowdown * 10.0f / 3.0f));
+    
+    if (std::abs(pitchSemitones) >= 12.0f)
+        tuning.antiAliasLength = 128;
+    
+    return tuning;
+}
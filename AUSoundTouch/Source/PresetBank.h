@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "TimeStretchEngine.h"
+#include <vector>
+
+// One program: the user-facing parameter values plus the SoundTouch settings
+// worked out from them up front, the native ratios and the WSOLA tuning. The
+// processor builds engines from these on its worker, including a standby for
+// the program it expects next (see AUSoundTouchProcessor::setCurrentProgram()).
+struct Preset
+{
+    juce::String name;
+    float pitchSemitones = 0.0f;
+    float tempoPercent = 0.0f;
+    float speedPercent = 0.0f;
+    int bufferingMode = 2; // AUSoundTouchProcessor::BufferingMode
+    int qualityMode = 3;   // AUSoundTouchProcessor::QualityMode
+    
+    float nativePitch = 1.0f;
+    float nativeTempo = 1.0f;
+    float nativeRate = 1.0f;
+    
+    // For the Standard engine; the other engine types bring their own
+    TimeStretchEngine::Tuning tuning;
+};
+
+// Factory key and tempo presets exposed through the host's program API
+class PresetBank
+{
+public:
+    static const PresetBank& getFactoryBank();
+    
+    int size() const { return static_cast<int>(presets.size()); }
+    const Preset& operator[](int index) const { return presets[static_cast<size_t>(index)]; }
+    
+private:
+    PresetBank();
+    
+    void add(const juce::String& name, float pitchSemitones, float tempoPercent, float speedPercent,
+             int bufferingMode = 2, int qualityMode = 3);
+    
+    static TimeStretchEngine::Tuning getTuning(float pitchSemitones, float nativeTempo, int qualityMode);
+    
+    std::vector<Preset> presets;
+    
+    JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PsolaAnalysis.h"
+#include <algorithm>
+#include <cmath>
+
+void PsolaAnalysis::prepare(double sampleRate, int analysisNumChannels, int maxBlockFrames)
+{
+    numChannels = analysisNumChannels;
+    minPeriod = std::max(2, static_cast<int>(std::floor(sampleRate / MAX_FREQUENCY)));
+    maxPeriod = getMaxPeriod(sampleRate);
+    unvoicedPeriod = std::max(minPeriod, static_cast<int>(std::lround(UNVOICED_GRAIN_SECONDS * sampleRate)));
+    
+    tracker.prepare(sampleRate, MIN_FREQUENCY, MAX_FREQUENCY);
+    
+    // Readers stay within a few periods of the newest input
+    capacity = maxBlockFrames + 8 * maxPeriod;
+    
+    channels.resize(static_cast<size_t>(numChannels));
+    
+    for (auto& channel : channels)
+        channel.resize(static_cast<size_t>(capacity));
+    
+    mono.resize(static_cast<size_t>(capacity));
+    
+    // Snapping can bring two voiced marks as close as three quarters of a period
+    marks.resize(static_cast<size_t>(capacity / std::max(1, minPeriod * 3 / 4) + 4));
+    
+    // One extra entry so the last lookup of a grain can't run off the end
+    hannTable.resize(static_cast<size_t>(HANN_TABLE_SIZE + 1));
+    
+    for (int i = 0; i <= HANN_TABLE_SIZE; ++i)
+        hannTable[static_cast<size_t>(i)] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi
+                                                                 * static_cast<float>(i) / static_cast<float>(HANN_TABLE_SIZE));
+    
+    reset();
+}
+
+void PsolaAnalysis::reset()
+{
+    tracker.reset();
+    
+    // A period of silence ahead of the input gives the first grain its left half
+    numFrames = maxPeriod;
+    
+    for (auto& channel : channels)
+        std::fill(channel.begin(), channel.begin() + numFrames, 0.0f);
+    
+    std::fill(mono.begin(), mono.begin() + numFrames, 0.0f);
+    
+    marks[0] = { maxPeriod, static_cast<float>(unvoicedPeriod), false };
+    numMarks = 1;
+}
+
+int PsolaAnalysis::getMaxPeriod(double sampleRate)
+{
+    return static_cast<int>(std::ceil(sampleRate / MIN_FREQUENCY));
+}
+
+int PsolaAnalysis::getLatency(double sampleRate)
+{
+    const int period = getMaxPeriod(sampleRate);
+    return 3 * period + period / 4 + 1;
+}
+
+int PsolaAnalysis::appendInterleaved(const float* interleaved, int numFramesToAppend)
+{
+    const int framesToCopy = std::min(numFramesToAppend, getFreeFrames());
+    
+    for (int c = 0; c < numChannels; ++c)
+    {
+        float* destination = getWritePointer(c);
+        
+        if (interleaved == nullptr)
+            std::fill_n(destination, framesToCopy, 0.0f);
+        else
+            for (int frame = 0; frame < framesToCopy; ++frame)
+                destination[frame] = interleaved[frame * numChannels + c];
+    }
+    
+    commit(framesToCopy);
+    return framesToCopy;
+}
+
+void PsolaAnalysis::commit(int numFramesWritten)
+{
+    float* monoDestination = mono.data() + numFrames;
+    std::fill_n(monoDestination, numFramesWritten, 0.0f);
+    
+    for (int c = 0; c < numChannels; ++c)
+        juce::FloatVectorOperations::add(monoDestination, getWritePointer(c), numFramesWritten);
+    
+    tracker.push(monoDestination, numFramesWritten);
+    numFrames += numFramesWritten;
+    
+    placeMarks();
+}
+
+int PsolaAnalysis::discard(int firstMark, int keepFrom)
+{
+    firstMark = juce::jlimit(0, numMarks - 1, firstMark);
+    
+    // No grain can reach back further than a period before its mark
+    const int consumed = std::min({ numFrames, keepFrom, marks[static_cast<size_t>(firstMark)].position - maxPeriod });
+    
+    if (consumed <= 0)
+        return 0;
+    
+    for (auto& channel : channels)
+        std::copy(channel.begin() + consumed, channel.begin() + numFrames, channel.begin());
+    
+    std::copy(mono.begin() + consumed, mono.begin() + numFrames, mono.begin());
+    numFrames -= consumed;
+    
+    for (int i = firstMark; i < numMarks; ++i)
+    {
+        auto mark = marks[static_cast<size_t>(i)];
+        mark.position -= consumed;
+        marks[static_cast<size_t>(i - firstMark)] = mark;
+    }
+    
+    numMarks -= firstMark;
+    return consumed;
+}
+
+int PsolaAnalysis::findMarkBefore(double frame) const
+{
+    int index = 0;
+    
+    while (index + 1 < numMarks && marks[static_cast<size_t>(index + 1)].position <= frame)
+        ++index;
+    
+    return index;
+}
+
+// Each mark goes one period after the last; voiced marks move to the largest
+// sample within a quarter period of that, which lands them on the same point
+// of every cycle. The tracker's period is as of the newest input, slightly
+// ahead of the mark, which only matters where the pitch moves quickly.
+void PsolaAnalysis::placeMarks()
+{
+    while (numMarks < static_cast<int>(marks.size()))
+    {
+        const auto& last = marks[static_cast<size_t>(numMarks - 1)];
+        const bool voiced = tracker.isVoiced();
+        const float period = voiced ? juce::jlimit(static_cast<float>(minPeriod), static_cast<float>(maxPeriod), tracker.getPeriod())
+                                    : static_cast<float>(unvoicedPeriod);
+        const int wholePeriod = static_cast<int>(std::lround(period));
+        const int radius = voiced ? wholePeriod / 4 : 0;
+        const int expected = last.position + wholePeriod;
+        
+        // The grain around the mark has to be complete as well
+        if (expected + radius + wholePeriod > numFrames)
+            return;
+        
+        int position = expected;
+        
+        for (int i = expected - radius; i <= expected + radius; ++i)
+            if (mono[static_cast<size_t>(i)] > mono[static_cast<size_t>(position)])
+                position = i;
+        
+        // Keep marks strictly increasing even if the previous one was snapped late
+        position = std::max(position, last.position + minPeriod / 2 + 1);
+        
+        marks[static_cast<size_t>(numMarks++)] = { position, period, voiced };
+    }
+}
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "PitchTracker.h"
+#include <vector>
+
+// The input side of pitch-synchronous overlap-add: planar input history, a
+// mono mix for the pitch tracker, and analysis marks placed one period apart,
+// each snapped to the waveform peak near where it is expected. Synthesis only
+// reads from it, so several PsolaSynthesis voices can share one analysis and
+// render from it concurrently once a block has been appended.
+//
+// prepare() allocates; everything else is safe on the audio thread.
+class PsolaAnalysis
+{
+public:
+    struct Mark
+    {
+        int position = 0;
+        float period = 0.0f;
+        bool voiced = false;
+    };
+    
+    PsolaAnalysis() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames);
+    
+    // Back to a period of silence with a single unvoiced mark at its end
+    void reset();
+    
+    // Appends up to numFrames, as many as fit; nullptr appends silence.
+    // Returns the number of frames taken.
+    int appendInterleaved(const float* interleaved, int numFrames);
+    
+    // For planar sources: write up to getFreeFrames() frames at
+    // getWritePointer(), then commit them to update the tracker and marks
+    float* getWritePointer(int channel) { return channels[static_cast<size_t>(channel)].data() + numFrames; }
+    int getFreeFrames() const { return capacity - numFrames; }
+    void commit(int numFramesWritten);
+    
+    // Drops the marks before firstMark and the input no grain around them can
+    // reach, keeping everything from keepFrom on. Returns how many frames the
+    // input moved back, 0 if nothing could go; mark indices then shift down by
+    // firstMark.
+    int discard(int firstMark, int keepFrom);
+    
+    const float* getChannel(int channel) const { return channels[static_cast<size_t>(channel)].data(); }
+    int getNumChannels() const { return numChannels; }
+    int getNumFrames() const { return numFrames; }
+    int getCapacity() const { return capacity; }
+    
+    const Mark& getMark(int index) const { return marks[static_cast<size_t>(index)]; }
+    int getNumMarks() const { return numMarks; }
+    
+    // The last mark at or before a frame, or the first mark if none is
+    int findMarkBefore(double frame) const;
+    
+    int getMinPeriod() const { return minPeriod; }
+    int getMaxPeriod() const { return maxPeriod; }
+    
+    // From input to final synthesis output: a mark is placed once a period past
+    // its search range has arrived, the next grain needs a mark past the
+    // analysis time, and a grain's output is final once the next grain can't
+    // overlap it
+    int getLatency() const { return 3 * maxPeriod + maxPeriod / 4 + 1; }
+    
+    // The longest period, and so the latency, prepare() settles on at a rate
+    static int getMaxPeriod(double sampleRate);
+    static int getLatency(double sampleRate);
+    
+    // Hann window of HANN_TABLE_SIZE + 1 entries, read at a fixed-point step
+    const float* getHannTable() const { return hannTable.data(); }
+    static constexpr int HANN_TABLE_SIZE = 1024;
+    
+    const PitchTracker& getPitchTracker() const { return tracker; }
+    
+    // Range the tracker searches, which covers sung and spoken voice
+    static constexpr double MIN_FREQUENCY = 60.0;
+    static constexpr double MAX_FREQUENCY = 1000.0;
+    
+    static constexpr double UNVOICED_GRAIN_SECONDS = 0.005;
+    
+private:
+    void placeMarks();
+    
+    int numChannels = 2;
+    int minPeriod = 44;
+    int maxPeriod = 736;
+    int unvoicedPeriod = 220;
+    
+    std::vector<std::vector<float>> channels;
+    std::vector<float> mono;
+    int capacity = 0;
+    int numFrames = 0;
+    
+    std::vector<Mark> marks;
+    int numMarks = 0;
+    
+    PitchTracker tracker;
+    std::vector<float> hannTable;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PsolaAnalysis)
+};
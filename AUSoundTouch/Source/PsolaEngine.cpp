@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PsolaEngine.h"
+#include <algorithm>
+
+void PsolaEngine::prepare(double sampleRate, int engineNumChannels, int maxBlockFrames)
+{
+    numChannels = engineNumChannels;
+    
+    analysis.prepare(sampleRate, numChannels, maxBlockFrames);
+    synthesis.prepare(analysis, 0);
+    
+    setRatios(1.0f, 1.0f, 1.0f);
+    clear();
+}
+
+void PsolaEngine::setRatios(float pitch, float tempo, float rate)
+{
+    // Grain spacing sets the pitch, the mark chosen for each grain the
+    // duration; rate scales both, as with SoundTouch
+    synthesis.setRatios(pitch * rate, tempo * rate);
+}
+
+void PsolaEngine::appendInput(const float* interleaved, int numFrames)
+{
+    if (numFrames > analysis.getFreeFrames())
+    {
+        // No grain can reach back further than the cursor's mark
+        const int firstMark = synthesis.getCursor();
+        const int consumed = analysis.discard(firstMark, analysis.getNumFrames());
+        
+        if (consumed > 0)
+            synthesis.inputDiscarded(consumed, firstMark);
+    }
+    
+    analysis.appendInterleaved(interleaved, numFrames);
+}
+
+void PsolaEngine::putSamples(const float* interleaved, int numFrames)
+{
+    appendInput(interleaved, numFrames);
+}
+
+int PsolaEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    int framesWritten = 0;
+    
+    while (framesWritten < maxFrames)
+    {
+        const int framesToCopy = std::min(maxFrames - framesWritten, synthesis.getNumFinalFrames());
+        
+        if (framesToCopy > 0)
+        {
+            synthesis.readInterleaved(interleaved + framesWritten * numChannels, framesToCopy);
+            framesWritten += framesToCopy;
+            continue;
+        }
+        
+        if (synthesis.synthesizeGrain(analysis))
+            continue;
+        
+        if (synthesis.needsCompacting(0))
+        {
+            synthesis.compact();
+            continue;
+        }
+        
+        if (pendingFlushFrames == 0)
+            break;
+        
+        // Pad a period's worth of silence at a time until the last grain is out
+        const int silentFrames = std::min(pendingFlushFrames, analysis.getMaxPeriod());
+        appendInput(nullptr, silentFrames);
+        pendingFlushFrames -= silentFrames;
+    }
+    
+    return framesWritten;
+}
+
+void PsolaEngine::flush()
+{
+    pendingFlushFrames = getInitialLatency() + analysis.getMaxPeriod();
+}
+
+void PsolaEngine::clear()
+{
+    analysis.reset();
+    synthesis.reset(analysis, analysis.getMaxPeriod());
+    pendingFlushFrames = 0;
+}
+
+int PsolaEngine::getNumUnprocessedFrames() const
+{
+    return std::max(0, analysis.getNumFrames() - static_cast<int>(synthesis.getAnalysisTime()));
+}
+
+double PsolaEngine::getOutputPerInput(float tempo, float rate) const
+{
+    return 1.0 / (static_cast<double>(tempo) * rate);
+}
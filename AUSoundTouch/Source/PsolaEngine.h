@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include "PsolaAnalysis.h"
+#include "PsolaSynthesis.h"
+
+// Pitch-synchronous overlap-add for monophonic material (voice, solo
+// instruments). A YIN tracker gives the period; analysis marks are placed one
+// period apart, each snapped to the waveform peak near where it is expected,
+// so every grain is two periods of signal centred on an epoch. Grains are
+// re-spaced at period/pitch in the output and picked from the analysis mark
+// nearest the stretched time, which changes pitch and duration separately
+// without touching the spectral envelope. Unvoiced input falls back to fixed
+// 5 ms grains. The work is one windowed copy per grain, far cheaper than
+// WSOLA's correlation search, but polyphonic input confuses the tracker.
+//
+// One PsolaAnalysis feeding one PsolaSynthesis; the harmonizer runs several
+// syntheses from the same analysis.
+class PsolaEngine : public TimeStretchEngine
+{
+public:
+    PsolaEngine() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    int getInitialLatency() const override { return analysis.getLatency(); }
+    int getNumUnprocessedFrames() const override;
+    double getOutputPerInput(float tempo, float rate) const override;
+    
+    const PitchTracker& getPitchTracker() const { return analysis.getPitchTracker(); }
+    
+private:
+    void appendInput(const float* interleaved, int numFrames);
+    
+    int numChannels = 2;
+    int pendingFlushFrames = 0;
+    
+    PsolaAnalysis analysis;
+    PsolaSynthesis synthesis;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PsolaEngine)
+};
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "PsolaSynthesis.h"
+#include <algorithm>
+#include <cmath>
+
+void PsolaSynthesis::prepare(const PsolaAnalysis& analysis, int extraFrames)
+{
+    numChannels = analysis.getNumChannels();
+    maxPeriod = analysis.getMaxPeriod();
+    
+    // The next grain starts at most a spacing (capped at two periods) past the
+    // last final frame; the rest is headroom so compacting is rare
+    accumulatorCapacity = extraFrames + 16 * maxPeriod;
+    
+    accumulators.resize(static_cast<size_t>(numChannels));
+    
+    for (auto& accumulator : accumulators)
+        accumulator.resize(static_cast<size_t>(accumulatorCapacity));
+    
+    windowSum.resize(static_cast<size_t>(accumulatorCapacity));
+    
+    setRatios(1.0f, 1.0f);
+    reset(analysis, maxPeriod);
+}
+
+void PsolaSynthesis::reset(const PsolaAnalysis& analysis, double analysisStart)
+{
+    for (auto& accumulator : accumulators)
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    
+    std::fill(windowSum.begin(), windowSum.end(), 0.0f);
+    
+    // The first grain is centred on the first output frame, whose left half is dropped
+    cursor = analysis.findMarkBefore(analysisStart);
+    analysisTime = analysisStart;
+    synthesisTime = maxPeriod;
+    numEmittedFrames = maxPeriod;
+}
+
+void PsolaSynthesis::setRatios(float pitch, float time)
+{
+    pitchRatio = juce::jlimit(0.1f, 10.0f, pitch);
+    timeRatio = juce::jlimit(0.01f, 100.0f, time);
+}
+
+bool PsolaSynthesis::synthesizeGrain(const PsolaAnalysis& analysis)
+{
+    const int numMarks = analysis.getNumMarks();
+    
+    // Wait until a mark at or past the analysis time shows which one is nearest
+    if (analysis.getMark(numMarks - 1).position < analysisTime)
+        return false;
+    
+    while (cursor + 1 < numMarks
+           && std::abs(analysis.getMark(cursor + 1).position - analysisTime)
+                <= std::abs(analysis.getMark(cursor).position - analysisTime))
+        ++cursor;
+    
+    const auto& mark = analysis.getMark(cursor);
+    const int halfGrain = static_cast<int>(std::lround(mark.period));
+    const int centre = static_cast<int>(std::lround(synthesisTime));
+    
+    if (centre + halfGrain > accumulatorCapacity)
+        return false;
+    
+    // Hann window two periods long, centred on the mark
+    const int grainFrames = 2 * halfGrain;
+    const int start = mark.position - halfGrain;
+    const int outputStart = centre - halfGrain;
+    const int step = (PsolaAnalysis::HANN_TABLE_SIZE << 16) / grainFrames;
+    const float* hannTable = analysis.getHannTable();
+    
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const float* source = analysis.getChannel(c) + start;
+        float* destination = accumulators[static_cast<size_t>(c)].data() + outputStart;
+        
+        for (int i = 0, phase = 0; i < grainFrames; ++i, phase += step)
+            destination[i] += source[i] * hannTable[phase >> 16];
+    }
+    
+    for (int i = 0, phase = 0; i < grainFrames; ++i, phase += step)
+        windowSum[static_cast<size_t>(outputStart + i)] += hannTable[phase >> 16];
+    
+    // Voiced grains are re-spaced at the new period; unvoiced ones keep theirs
+    // so noise isn't given a pitch. Very low pitch ratios would leave gaps of
+    // silence between grains, so the spacing is capped.
+    const double spacing = mark.voiced ? std::min(static_cast<double>(mark.period) / pitchRatio, 2.0 * maxPeriod)
+                                       : static_cast<double>(halfGrain);
+    
+    synthesisTime += spacing;
+    analysisTime += spacing * timeRatio;
+    return true;
+}
+
+int PsolaSynthesis::getNumFinalFrames() const
+{
+    // No later grain can reach back before this
+    return std::max(0, static_cast<int>(synthesisTime) - maxPeriod - numEmittedFrames);
+}
+
+// Where pitching up overlaps grains more than the window allows, the sum is
+// divided back down
+void PsolaSynthesis::readInterleaved(float* interleaved, int numFrames)
+{
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        const int index = numEmittedFrames + frame;
+        const float gain = 1.0f / std::max(1.0f, windowSum[static_cast<size_t>(index)]);
+        float* destination = interleaved + frame * numChannels;
+        
+        for (int c = 0; c < numChannels; ++c)
+            destination[c] = accumulators[static_cast<size_t>(c)][static_cast<size_t>(index)] * gain;
+    }
+    
+    numEmittedFrames += numFrames;
+}
+
+void PsolaSynthesis::readPlanar(float* const* planar, int numFrames)
+{
+    const float* sums = windowSum.data() + numEmittedFrames;
+    
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const float* source = accumulators[static_cast<size_t>(c)].data() + numEmittedFrames;
+        float* destination = planar[c];
+        
+        for (int frame = 0; frame < numFrames; ++frame)
+            destination[frame] = source[frame] / std::max(1.0f, sums[frame]);
+    }
+    
+    numEmittedFrames += numFrames;
+}
+
+bool PsolaSynthesis::needsCompacting(int framesToRead) const
+{
+    // Making framesToRead frames final takes grains up to two periods past them
+    return numEmittedFrames > 0
+        && std::max(synthesisTime, static_cast<double>(numEmittedFrames + framesToRead)) + 3 * maxPeriod > accumulatorCapacity;
+}
+
+// Moves the unread part of the accumulator back to the start. Nothing past a
+// period beyond the synthesis time has been written, so only that much moves.
+void PsolaSynthesis::compact()
+{
+    if (numEmittedFrames == 0)
+        return;
+    
+    // A reader that ran ahead of the grains skips the input it missed, so the
+    // next grain lands at or after the read position
+    const double behind = numEmittedFrames + maxPeriod - synthesisTime;
+    
+    if (behind > 0.0)
+    {
+        synthesisTime += behind;
+        analysisTime += behind * timeRatio;
+    }
+    
+    const int usedFrames = std::min(accumulatorCapacity, static_cast<int>(synthesisTime) + maxPeriod + 1);
+    const int framesToMove = std::max(0, usedFrames - numEmittedFrames);
+    const int framesToClear = usedFrames - framesToMove;
+    
+    for (auto& accumulator : accumulators)
+    {
+        std::copy_n(accumulator.begin() + numEmittedFrames, framesToMove, accumulator.begin());
+        std::fill_n(accumulator.begin() + framesToMove, framesToClear, 0.0f);
+    }
+    
+    std::copy_n(windowSum.begin() + numEmittedFrames, framesToMove, windowSum.begin());
+    std::fill_n(windowSum.begin() + framesToMove, framesToClear, 0.0f);
+    
+    synthesisTime -= numEmittedFrames;
+    numEmittedFrames = 0;
+}
+
+void PsolaSynthesis::inputDiscarded(int numFrames, int numMarks)
+{
+    analysisTime -= numFrames;
+    cursor = std::max(0, cursor - numMarks);
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "PsolaAnalysis.h"
+#include <vector>
+
+// The output side of pitch-synchronous overlap-add. Two-period Hann grains
+// centred on analysis marks are re-spaced at period/pitch in an accumulator,
+// each taken from the mark nearest the stretched time, which changes pitch and
+// duration separately without touching the spectral envelope. Unvoiced marks
+// keep their spacing so noise isn't given a pitch.
+//
+// Only reads the analysis, so any number of these can share one; they must be
+// told when it discards input. prepare() allocates, nothing else does.
+class PsolaSynthesis
+{
+public:
+    PsolaSynthesis() = default;
+    
+    // extraFrames is how far past the newest final frame a caller reads
+    void prepare(const PsolaAnalysis& analysis, int extraFrames);
+    
+    // Clears the output and takes the first grain at analysisStart, centred on
+    // the first output frame
+    void reset(const PsolaAnalysis& analysis, double analysisStart);
+    
+    void setRatios(float pitch, float time);
+    
+    // Adds the next grain if the analysis has the mark for it; false otherwise
+    // or when the accumulator needs compacting first
+    bool synthesizeGrain(const PsolaAnalysis& analysis);
+    
+    // Output frames that no later grain can change
+    int getNumFinalFrames() const;
+    
+    // Reads the next frames, final or not, normalised where grains overlap
+    // more than the window allows
+    void readInterleaved(float* interleaved, int numFrames);
+    void readPlanar(float* const* planar, int numFrames);
+    
+    // Frames that can still be read before compact() has to run
+    int getReadableFrames() const { return accumulatorCapacity - numEmittedFrames; }
+    bool needsCompacting(int framesToRead) const;
+    void compact();
+    
+    // After PsolaAnalysis::discard() returned a non-zero frame count
+    void inputDiscarded(int numFrames, int numMarks);
+    
+    int getCursor() const { return cursor; }
+    double getAnalysisTime() const { return analysisTime; }
+    
+private:
+    int numChannels = 2;
+    int maxPeriod = 736;
+    
+    std::vector<std::vector<float>> accumulators;
+    std::vector<float> windowSum;
+    int accumulatorCapacity = 0;
+    int numEmittedFrames = 0;
+    
+    // The next grain goes at synthesisTime in the accumulator, taken from the
+    // mark nearest analysisTime in the input; marks before the cursor are passed
+    double synthesisTime = 0.0;
+    double analysisTime = 0.0;
+    int cursor = 0;
+    
+    float pitchRatio = 1.0f;
+    float timeRatio = 1.0f;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PsolaSynthesis)
+};
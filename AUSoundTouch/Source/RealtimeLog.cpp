@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "RealtimeLog.h"
+#include "TimeStretchEngine.h"
+
+RealtimeLog::RealtimeLog()
+    : juce::Thread("AUSoundTouch Log")
+{
+    for (size_t i = 0; i < cells.size(); ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    
+    startThread(juce::Thread::Priority::low);
+}
+
+RealtimeLog::~RealtimeLog()
+{
+    stopThread(1000);
+    flush();
+}
+
+juce::uint32 RealtimeLog::createSourceId()
+{
+    static std::atomic<juce::uint32> nextId { 1 };
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool RealtimeLog::post(Event event, juce::uint32 source, double value1, double value2, double value3) noexcept
+{
+    size_t position = writePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    
+    while (true)
+    {
+        cell = &cells[position % cells.size()];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        
+        if (sequence == position)
+        {
+            // Free for this position; claim it unless another producer got there first
+            if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (sequence < position)
+        {
+            // Still holds the record from one lap ago: full
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = writePosition.load(std::memory_order_relaxed);
+        }
+    }
+    
+    cell->record.event = event;
+    cell->record.source = source;
+    cell->record.timeMs = juce::Time::getMillisecondCounterHiRes();
+    cell->record.values = { value1, value2, value3 };
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+// Consumer side; call with readLock held
+bool RealtimeLog::pop(Record& record)
+{
+    auto& cell = cells[readPosition % cells.size()];
+    
+    if (cell.sequence.load(std::memory_order_acquire) != readPosition + 1)
+        return false;
+    
+    record = cell.record;
+    cell.sequence.store(readPosition + cells.size(), std::memory_order_release);
+    ++readPosition;
+    return true;
+}
+
+void RealtimeLog::flush()
+{
+    const juce::ScopedLock sl(readLock);
+    Record record;
+    
+    while (pop(record))
+        write(format(record));
+    
+    const auto dropped = numDropped.load(std::memory_order_relaxed);
+    
+    if (dropped != numDroppedReported)
+    {
+        write("AUSoundTouch log: " + juce::String(dropped - numDroppedReported) + " records dropped, queue full");
+        numDroppedReported = dropped;
+    }
+}
+
+void RealtimeLog::setWriter(std::function<void(const juce::String&)> newWriter)
+{
+    const juce::ScopedLock sl(readLock);
+    writer = std::move(newWriter);
+}
+
+void RealtimeLog::write(const juce::String& line)
+{
+    if (writer)
+        writer(line);
+    else
+        juce::Logger::writeToLog(line);
+}
+
+juce::String RealtimeLog::format(const Record& record)
+{
+    const auto& values = record.values;
+    juce::String text;
+    
+    switch (record.event)
+    {
+        case Event::PitchChanged:
+            text << "Set pitch: " << values[0] << " semitones -> native: " << values[1];
+            break;
+            
+        case Event::EngineSwitched:
+            text << "Engine switched automatically: "
+                 << TimeStretchEngine::getTypeName(static_cast<TimeStretchEngine::Type>(values[0]));
+            break;
+            
+        case Event::EngineReconfigured:
+            text << "Engine reconfigured: "
+                 << TimeStretchEngine::getTypeName(static_cast<TimeStretchEngine::Type>(values[0]))
+                 << ", FIFO size: " << static_cast<int>(values[1]);
+            break;
+            
+        case Event::ChunkProcessed:
+            text << "Block " << static_cast<int>(values[0]) << ": Put " << static_cast<int>(values[1])
+                 << " samples, FIFO has " << static_cast<int>(values[2]) << " samples"
+                 << ", " << (values[2] >= values[1] ? "PROCESSED" : "PASSTHROUGH");
+            break;
+            
+        case Event::Underrun:
+            text << "Underrun: FIFO held " << static_cast<int>(values[1]) << " of " << static_cast<int>(values[0])
+                 << " frames, passing input through dry";
+            break;
+            
+        case Event::Overrun:
+            text << "Overrun: FIFO full, dropped " << static_cast<int>(values[0]) << " frames of engine output";
+            break;
+            
+        case Event::Overload:
+            text << "Overload: block took " << juce::String(values[0], 2) << " ms of "
+                 << juce::String(values[1], 2) << " ms";
+            break;
+    }
+    
+    return "[" + juce::String(record.timeMs / 1000.0, 3) + " s] AUSoundTouch #" + juce::String(record.source)
+         + ": " + text;
+}
+
+void RealtimeLog::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(FLUSH_INTERVAL_MS);
+        flush();
+    }
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+
+// Logging that is safe on the audio thread. post() copies a fixed-size record
+// of numbers into a lock-free queue without formatting, allocating or locking;
+// one background thread, shared by every plugin instance in the process, turns
+// queued records into text and writes them through juce::Logger. Release
+// builds post underruns, overruns and overloads; the per-block tracing that
+// used to go through DBG is posted in debug builds only.
+class RealtimeLog : private juce::Thread
+{
+public:
+    enum class Event : juce::uint8
+    {
+        PitchChanged,        // semitones, native ratio
+        EngineSwitched,      // engine type
+        EngineReconfigured,  // engine type, FIFO size in samples
+        ChunkProcessed,      // chunk number, frames put, frames in the FIFO
+        Underrun,            // frames wanted, frames in the FIFO
+        Overrun,             // frames of engine output dropped
+        Overload             // milliseconds taken, milliseconds the block lasts
+    };
+    
+    struct Record
+    {
+        Event event = Event::PitchChanged;
+        juce::uint32 source = 0;
+        double timeMs = 0.0;
+        std::array<double, 3> values {};
+    };
+    
+    RealtimeLog();
+    ~RealtimeLog() override;
+    
+    // Any thread, the audio thread included; never blocks. Returns false if
+    // the queue was full, in which case the record is counted as dropped and
+    // the count is reported with the next batch written.
+    bool post(Event event, juce::uint32 source, double value1 = 0.0, double value2 = 0.0, double value3 = 0.0) noexcept;
+    
+    // A number for each object that posts, so lines from several instances
+    // can be told apart
+    static juce::uint32 createSourceId();
+    
+    // Writes everything queued so far on the calling thread. For tests and
+    // offline rendering; the background thread does this every FLUSH_INTERVAL_MS.
+    void flush();
+    
+    // Where formatted lines go; juce::Logger::writeToLog when empty. For tests.
+    void setWriter(std::function<void(const juce::String&)> newWriter);
+    
+    static juce::String format(const Record& record);
+    
+    juce::int64 getNumDropped() const { return numDropped.load(std::memory_order_relaxed); }
+    
+    static constexpr int CAPACITY = 1024;
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+    
+private:
+    void run() override;
+    bool pop(Record& record);
+    void write(const juce::String& line);
+    
+    // A bounded multi-producer queue: each cell's sequence number says whether
+    // it is free for the producer at that position or holds a record for the
+    // consumer, so producers only contend on the one position counter
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        Record record;
+    };
+    
+    std::array<Cell, CAPACITY> cells;
+    std::atomic<size_t> writePosition { 0 };
+    size_t readPosition = 0;
+    
+    std::atomic<juce::int64> numDropped { 0 };
+    juce::int64 numDroppedReported = 0;
+    
+    // Held while draining, so flush() and the background thread take turns
+    juce::CriticalSection readLock;
+    std::function<void(const juce::String&)> writer;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeLog)
+};
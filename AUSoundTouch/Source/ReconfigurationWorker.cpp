@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "ReconfigurationWorker.h"
+
+ReconfigurationWorker::ReconfigurationWorker()
+    : juce::Thread("AUSoundTouch Reconfiguration")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+ReconfigurationWorker::~ReconfigurationWorker()
+{
+    stopThread(1000);
+}
+
+void ReconfigurationWorker::addClient(Client& client)
+{
+    const juce::ScopedLock sl(clientLock);
+    clients.addIfNotAlreadyThere(&client);
+}
+
+void ReconfigurationWorker::removeClient(Client& client)
+{
+    // Taking the lock also waits out any callback currently running on the client
+    const juce::ScopedLock sl(clientLock);
+    clients.removeFirstMatchingValue(&client);
+    
+    if (client.reconfigurationRequested.exchange(false))
+        --outstandingRequests;
+}
+
+void ReconfigurationWorker::requestReconfiguration(Client& client)
+{
+    requestReconfigurationAtNextPoll(client);
+    notify();
+}
+
+// notify() takes a lock, so this leaves the worker to find the flag on its
+// own, within RELEASE_INTERVAL_MS
+void ReconfigurationWorker::requestReconfigurationAtNextPoll(Client& client)
+{
+    if (! client.reconfigurationRequested.exchange(true))
+        ++outstandingRequests;
+}
+
+bool ReconfigurationWorker::waitUntilIdle(int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+    
+    while (outstandingRequests.load() > 0)
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+        
+        juce::Thread::sleep(1);
+    }
+    
+    return true;
+}
+
+void ReconfigurationWorker::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(RELEASE_INTERVAL_MS);
+        
+        const juce::ScopedLock sl(clientLock);
+        
+        for (auto* client : clients)
+        {
+            // Cleared before the rebuild so a request arriving meanwhile runs again
+            if (client->reconfigurationRequested.exchange(false))
+            {
+                client->performReconfiguration();
+                --outstandingRequests;
+            }
+            
+            client->releaseRetiredState();
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// One background thread, shared by every plugin instance in the process, that
+// performs expensive engine rebuilds (quality, buffering and layout changes)
+// away from the audio thread. Requests can be posted from any thread (from the
+// audio thread only with requestReconfigurationAtNextPoll()); the worker calls
+// back into the client, which builds new state and hands it to the audio
+// thread to swap in. It also periodically frees state the audio
+// thread has swapped out, since that thread must never release memory itself.
+//
+// We use this for every plugin format rather than the LV2 worker extension or a
+// deferred message-thread call: JUCE's LV2 wrapper doesn't expose the former,
+// and headless hosts don't reliably pump a message loop for the latter.
+class ReconfigurationWorker : private juce::Thread
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+        
+        // Worker thread: rebuild whatever state the last request asked for
+        virtual void performReconfiguration() = 0;
+        
+        // Worker thread, every RELEASE_INTERVAL_MS: free anything the audio
+        // thread has retired, plus any other polled upkeep that may allocate
+        virtual void releaseRetiredState() = 0;
+        
+    private:
+        friend class ReconfigurationWorker;
+        std::atomic<bool> reconfigurationRequested { false };
+    };
+    
+    ReconfigurationWorker();
+    ~ReconfigurationWorker() override;
+    
+    void addClient(Client& client);
+    void removeClient(Client& client);
+    
+    // Several requests made before the worker gets to a client are coalesced
+    void requestReconfiguration(Client& client);
+    
+    // Safe on the audio thread: only flags the client, without waking the
+    // worker, which picks the request up at its next poll
+    void requestReconfigurationAtNextPoll(Client& client);
+    
+    // Blocks until every outstanding request has been performed. For tests and
+    // offline rendering; returns false on timeout.
+    bool waitUntilIdle(int timeoutMs);
+    
+    // How often retired state is collected when no requests arrive
+    static constexpr int RELEASE_INTERVAL_MS = 50;
+    
+private:
+    void run() override;
+    
+    juce::CriticalSection clientLock;
+    juce::Array<Client*> clients;
+    std::atomic<int> outstandingRequests { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReconfigurationWorker)
+};
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "ResamplingEngine.h"
+#include <algorithm>
+#include <cmath>
+
+void ResamplingEngine::prepare(double sampleRate, int engineNumChannels, int maxBlockFrames)
+{
+    juce::ignoreUnused(sampleRate);
+    
+    numChannels = engineNumChannels;
+    
+    // One block plus the interpolator's context; receiveSamples() is always
+    // called until it runs dry, so no more than that is ever held
+    capacityFrames = maxBlockFrames + INTERPOLATION_HISTORY + INTERPOLATION_LOOKAHEAD + 2;
+    input.assign(static_cast<size_t>(capacityFrames * numChannels), 0.0f);
+    clear();
+}
+
+void ResamplingEngine::setRatios(float pitch, float tempo, float rate)
+{
+    juce::ignoreUnused(pitch, tempo);
+    step = rate;
+}
+
+void ResamplingEngine::putSamples(const float* interleaved, int numFrames)
+{
+    if (numInputFrames + numFrames > capacityFrames)
+        discardConsumedFrames();
+    
+    const int framesToCopy = std::min(numFrames, capacityFrames - numInputFrames);
+    
+    std::copy_n(interleaved, framesToCopy * numChannels, input.begin() + numInputFrames * numChannels);
+    numInputFrames += framesToCopy;
+}
+
+int ResamplingEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    int framesWritten = 0;
+    
+    while (framesWritten < maxFrames && readPosition + INTERPOLATION_LOOKAHEAD < numInputFrames)
+    {
+        const int index = static_cast<int>(readPosition);
+        const float t = static_cast<float>(readPosition - index);
+        const float* frame = input.data() + index * numChannels;
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float ym1 = frame[channel - numChannels];
+            const float y0 = frame[channel];
+            const float y1 = frame[channel + numChannels];
+            const float y2 = frame[channel + 2 * numChannels];
+            
+            const float c1 = 0.5f * (y1 - ym1);
+            const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+            const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+            
+            *interleaved++ = ((c3 * t + c2) * t + c1) * t + y0;
+        }
+        
+        readPosition += step;
+        ++framesWritten;
+    }
+    
+    return framesWritten;
+}
+
+void ResamplingEngine::flush()
+{
+    // Enough silence for the interpolator to reach the last real frame
+    const float silence[MAX_CHANNELS * INTERPOLATION_LOOKAHEAD] = {};
+    putSamples(silence, INTERPOLATION_LOOKAHEAD);
+}
+
+void ResamplingEngine::clear()
+{
+    // Start with silent history so the first frame can be interpolated
+    std::fill_n(input.begin(), INTERPOLATION_HISTORY * numChannels, 0.0f);
+    numInputFrames = INTERPOLATION_HISTORY;
+    readPosition = INTERPOLATION_HISTORY;
+}
+
+int ResamplingEngine::getNumUnprocessedFrames() const
+{
+    return std::max(0, numInputFrames - static_cast<int>(readPosition));
+}
+
+double ResamplingEngine::getOutputPerInput(float tempo, float rate) const
+{
+    juce::ignoreUnused(tempo);
+    return 1.0 / rate;
+}
+
+// Moves the frames still needed (from one before the read position) to the front
+void ResamplingEngine::discardConsumedFrames()
+{
+    const int firstNeeded = std::min(numInputFrames, static_cast<int>(readPosition) - INTERPOLATION_HISTORY);
+    
+    if (firstNeeded <= 0)
+        return;
+    
+    std::copy(input.begin() + firstNeeded * numChannels,
+              input.begin() + numInputFrames * numChannels,
+              input.begin());
+    
+    numInputFrames -= firstNeeded;
+    readPosition -= firstNeeded;
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include <vector>
+
+// Pure varispeed: plays the input back faster or slower by cubic (Catmull-Rom)
+// interpolation, so pitch and duration change together as on tape. Only the
+// rate ratio applies; pitch and tempo are ignored. There is no anti-alias
+// filter, which keeps it far cheaper than SoundTouch's rate transposer.
+class ResamplingEngine : public TimeStretchEngine
+{
+public:
+    ResamplingEngine() = default;
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    int getInitialLatency() const override { return INTERPOLATION_LOOKAHEAD; }
+    int getNumUnprocessedFrames() const override;
+    double getOutputPerInput(float tempo, float rate) const override;
+    
+private:
+    // The interpolator reads one frame behind and two ahead of the read position
+    static constexpr int INTERPOLATION_HISTORY = 1;
+    static constexpr int INTERPOLATION_LOOKAHEAD = 2;
+    
+    void discardConsumedFrames();
+    
+    int numChannels = 2;
+    int capacityFrames = 0;
+    std::vector<float> input;
+    int numInputFrames = 0;
+    double readPosition = INTERPOLATION_HISTORY;
+    double step = 1.0;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResamplingEngine)
+};
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "SignalScope.h"
+
+SignalScope::SignalScope()
+    : frames(static_cast<size_t>(CAPACITY))
+{
+}
+
+void SignalScope::prepare(int maxBlockSize)
+{
+    blockFrames.resize(static_cast<size_t>(maxBlockSize / DECIMATION + 1));
+    inputAccumulator = {};
+    outputAccumulator = {};
+    capturingBlock = false;
+}
+
+bool SignalScope::Accumulator::add(float sample)
+{
+    if (count == 0 || count == DECIMATION)
+    {
+        count = 0;
+        min = sample;
+        max = sample;
+        sum = 0.0f;
+    }
+    
+    min = std::min(min, sample);
+    max = std::max(max, sample);
+    sum += sample;
+    
+    return ++count == DECIMATION;
+}
+
+template <typename SampleType>
+float SignalScope::mixToMono(const juce::AudioBuffer<SampleType>& buffer, int sample)
+{
+    const int numChannels = buffer.getNumChannels();
+    SampleType sum = 0;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        sum += buffer.getReadPointer(channel)[sample];
+    
+    return static_cast<float>(sum) / static_cast<float>(numChannels);
+}
+
+void SignalScope::captureInput(const juce::AudioBuffer<float>& input)
+{
+    captureInputInternal(input);
+}
+
+void SignalScope::captureInput(const juce::AudioBuffer<double>& input)
+{
+    captureInputInternal(input);
+}
+
+void SignalScope::captureOutput(const juce::AudioBuffer<float>& output)
+{
+    captureOutputInternal(output);
+}
+
+void SignalScope::captureOutput(const juce::AudioBuffer<double>& output)
+{
+    captureOutputInternal(output);
+}
+
+template <typename SampleType>
+void SignalScope::captureInputInternal(const juce::AudioBuffer<SampleType>& input)
+{
+    const int numSamples = input.getNumSamples();
+    capturingBlock = isCapturing() && input.getNumChannels() > 0
+                  && numSamples / DECIMATION + 1 <= static_cast<int>(blockFrames.size());
+    
+    if (! capturingBlock)
+    {
+        // Start afresh when capture resumes, with input and output in step
+        inputAccumulator = {};
+        outputAccumulator = {};
+        return;
+    }
+    
+    int numFrames = 0;
+    
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        if (inputAccumulator.add(mixToMono(input, sample)))
+        {
+            auto& frame = blockFrames[static_cast<size_t>(numFrames++)];
+            frame.inputMin = inputAccumulator.min;
+            frame.inputMax = inputAccumulator.max;
+            frame.inputMean = inputAccumulator.sum / DECIMATION;
+        }
+    }
+}
+
+// The output accumulator was reset along with the input one, so its frames
+// end on the same samples and pair up with blockFrames in order
+template <typename SampleType>
+void SignalScope::captureOutputInternal(const juce::AudioBuffer<SampleType>& output)
+{
+    if (! capturingBlock || output.getNumChannels() == 0)
+        return;
+    
+    int numFrames = 0;
+    
+    for (int sample = 0; sample < output.getNumSamples(); ++sample)
+    {
+        if (outputAccumulator.add(mixToMono(output, sample)))
+        {
+            auto& frame = blockFrames[static_cast<size_t>(numFrames++)];
+            frame.outputMin = outputAccumulator.min;
+            frame.outputMax = outputAccumulator.max;
+            frame.outputMean = outputAccumulator.sum / DECIMATION;
+        }
+    }
+    
+    // A full ring means the view has stopped pulling; drop rather than wait
+    const int numToWrite = std::min(numFrames, fifo.getFreeSpace());
+    
+    if (numToWrite < numFrames)
+        numDropped.fetch_add(numFrames - numToWrite, std::memory_order_relaxed);
+    
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numToWrite, start1, size1, start2, size2);
+    std::copy_n(blockFrames.begin(), size1, frames.begin() + start1);
+    std::copy_n(blockFrames.begin() + size1, size2, frames.begin() + start2);
+    fifo.finishedWrite(size1 + size2);
+}
+
+int SignalScope::pull(Frame* destination, int maxFrames)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxFrames, start1, size1, start2, size2);
+    std::copy_n(frames.begin() + start1, size1, destination);
+    std::copy_n(frames.begin() + start2, size2, destination + size1);
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+// Feeds the editor's waveform and spectrum view. While a view is open, the
+// audio thread mixes each block's input and output to mono, cuts them into
+// frames of DECIMATION samples, and pushes each frame's minimum, maximum and
+// mean into a wait-free single-producer ring. The view pulls from the ring on
+// the message thread, where the FFT and drawing happen. With no view open,
+// capturing costs the audio thread one atomic load per block.
+class SignalScope
+{
+public:
+    struct Frame
+    {
+        float inputMin = 0.0f;
+        float inputMax = 0.0f;
+        float inputMean = 0.0f;   // The box-filtered, decimated signal the spectrum is taken from
+        float outputMin = 0.0f;
+        float outputMax = 0.0f;
+        float outputMean = 0.0f;
+    };
+    
+    static constexpr int DECIMATION = 4;
+    
+    // About 1.4 s at 48 kHz, so a view that misses a few repaints loses nothing
+    static constexpr int CAPACITY = 16384;
+    
+    SignalScope();
+    
+    // Sizes the per-block scratch; not on the audio thread
+    void prepare(int maxBlockSize);
+    
+    // Audio thread, around processing: input before, output after, on the
+    // same number of samples. Blocks longer than the prepared size are skipped.
+    void captureInput(const juce::AudioBuffer<float>& input);
+    void captureInput(const juce::AudioBuffer<double>& input);
+    void captureOutput(const juce::AudioBuffer<float>& output);
+    void captureOutput(const juce::AudioBuffer<double>& output);
+    
+    // Views register while they are showing; capture runs while any is
+    void addViewer() { ++numViewers; }
+    void removeViewer() { --numViewers; }
+    bool isCapturing() const { return numViewers.load(std::memory_order_relaxed) > 0; }
+    
+    // Message thread, from the one open view: copies out up to maxFrames of
+    // the oldest frames waiting. Returns how many were copied.
+    int pull(Frame* destination, int maxFrames);
+    
+    // Frames the ring had no room for, since construction
+    juce::int64 getNumDropped() const { return numDropped.load(std::memory_order_relaxed); }
+    
+private:
+    // One frame in progress, carried over between blocks
+    struct Accumulator
+    {
+        int count = 0;
+        float min = 0.0f;
+        float max = 0.0f;
+        float sum = 0.0f;
+        
+        // Returns true once DECIMATION samples are in, leaving the frame in place
+        bool add(float sample);
+    };
+    
+    template <typename SampleType>
+    void captureInputInternal(const juce::AudioBuffer<SampleType>& input);
+    
+    template <typename SampleType>
+    void captureOutputInternal(const juce::AudioBuffer<SampleType>& output);
+    
+    template <typename SampleType>
+    static float mixToMono(const juce::AudioBuffer<SampleType>& buffer, int sample);
+    
+    juce::AbstractFifo fifo { CAPACITY };
+    std::vector<Frame> frames;
+    
+    // Input frames completed in the current block, waiting for their output
+    std::vector<Frame> blockFrames;
+    Accumulator inputAccumulator;
+    Accumulator outputAccumulator;
+    bool capturingBlock = false;
+    
+    std::atomic<int> numViewers { 0 };
+    std::atomic<juce::int64> numDropped { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SignalScope)
+};
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "SignalScopeView.h"
+
+SignalScopeView::SignalScopeView (AUSoundTouchProcessor& p)
+    : audioProcessor (p),
+      scope (p.getSignalScope()),
+      history (static_cast<size_t> (HISTORY_FRAMES)),
+      pulledFrames (static_cast<size_t> (SignalScope::CAPACITY)),
+      fftData (static_cast<size_t> (2 * FFT_SIZE)),
+      inputDecibels (static_cast<size_t> (FFT_SIZE / 2), MIN_DECIBELS),
+      outputDecibels (static_cast<size_t> (FFT_SIZE / 2), MIN_DECIBELS)
+{
+    setOpaque (true);
+}
+
+SignalScopeView::~SignalScopeView()
+{
+    setViewing (false);
+}
+
+void SignalScopeView::visibilityChanged()
+{
+    setViewing (isVisible());
+}
+
+// Capture runs only while a view exists and is visible, so a closed editor
+// costs the audio thread nothing beyond the check
+void SignalScopeView::setViewing (bool shouldView)
+{
+    if (shouldView == viewing)
+        return;
+    
+    viewing = shouldView;
+    
+    if (viewing)
+    {
+        // Whatever is left from the last time the view was open is stale
+        while (scope.pull (pulledFrames.data(), static_cast<int> (pulledFrames.size())) > 0) {}
+        
+        scope.addViewer();
+        startTimerHz (FRAME_RATE_HZ);
+    }
+    else
+    {
+        stopTimer();
+        scope.removeViewer();
+    }
+}
+
+void SignalScopeView::timerCallback()
+{
+    const int numPulled = scope.pull (pulledFrames.data(), static_cast<int> (pulledFrames.size()));
+    
+    if (numPulled == 0)
+        return;
+    
+    for (int i = 0; i < numPulled; ++i)
+    {
+        history[static_cast<size_t> (historyStart)] = pulledFrames[static_cast<size_t> (i)];
+        historyStart = (historyStart + 1) % HISTORY_FRAMES;
+    }
+    
+    updateSpectra();
+    repaint();
+}
+
+const SignalScope::Frame& SignalScopeView::getHistoryFrame (int index) const
+{
+    return history[static_cast<size_t> ((historyStart + index) % HISTORY_FRAMES)];
+}
+
+void SignalScopeView::updateSpectra()
+{
+    computeSpectrum (&SignalScope::Frame::inputMean, inputDecibels);
+    computeSpectrum (&SignalScope::Frame::outputMean, outputDecibels);
+}
+
+// Of the newest FFT_SIZE decimated samples, windowed, in dB relative to a
+// full-scale sine
+void SignalScopeView::computeSpectrum (float SignalScope::Frame::* mean, std::vector<float>& decibels)
+{
+    const int first = HISTORY_FRAMES - FFT_SIZE;
+    
+    for (int i = 0; i < FFT_SIZE; ++i)
+        fftData[static_cast<size_t> (i)] = getHistoryFrame (first + i).*mean;
+    
+    window.multiplyWithWindowingTable (fftData.data(), static_cast<size_t> (FFT_SIZE));
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+    
+    // A Hann window halves a sine's peak, and the FFT scales it by N/2
+    const float scale = 4.0f / static_cast<float> (FFT_SIZE);
+    
+    for (size_t bin = 0; bin < decibels.size(); ++bin)
+        decibels[bin] = juce::Decibels::gainToDecibels (fftData[bin] * scale, MIN_DECIBELS);
+}
+
+void SignalScopeView::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+    
+    auto bounds = getLocalBounds().toFloat().reduced (2.0f);
+    auto waveformArea = bounds.removeFromLeft (bounds.getWidth() * 0.5f);
+    bounds.removeFromLeft (4.0f);
+    
+    paintWaveform (g, waveformArea);
+    paintSpectra (g, bounds);
+}
+
+// One vertical line per pixel column, from the lowest minimum to the highest
+// maximum of the frames it covers: input behind in grey, output over it
+void SignalScopeView::paintWaveform (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    const int numColumns = juce::jmax (1, static_cast<int> (area.getWidth()));
+    const float centre = area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+    
+    auto drawColumns = [&] (float SignalScope::Frame::* min, float SignalScope::Frame::* max)
+    {
+        for (int column = 0; column < numColumns; ++column)
+        {
+            const int begin = column * HISTORY_FRAMES / numColumns;
+            const int end = juce::jmax (begin + 1, (column + 1) * HISTORY_FRAMES / numColumns);
+            float low = 1.0f;
+            float high = -1.0f;
+            
+            for (int i = begin; i < end; ++i)
+            {
+                const auto& frame = getHistoryFrame (i);
+                low = juce::jmin (low, frame.*min);
+                high = juce::jmax (high, frame.*max);
+            }
+            
+            const float x = area.getX() + static_cast<float> (column) + 0.5f;
+            g.drawVerticalLine (static_cast<int> (x),
+                                centre - juce::jlimit (-1.0f, 1.0f, high) * halfHeight,
+                                centre - juce::jlimit (-1.0f, 1.0f, low) * halfHeight + 1.0f);
+        }
+    };
+    
+    g.setColour (juce::Colours::grey);
+    drawColumns (&SignalScope::Frame::inputMin, &SignalScope::Frame::inputMax);
+    g.setColour (juce::Colours::orange.withAlpha (0.7f));
+    drawColumns (&SignalScope::Frame::outputMin, &SignalScope::Frame::outputMax);
+}
+
+// Log frequency from MIN_FREQUENCY up to the decimated Nyquist frequency,
+// MIN_DECIBELS to 0 dB
+void SignalScopeView::paintSpectra (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    const double sampleRate = audioProcessor.getSampleRate();
+    
+    if (sampleRate <= 0.0)
+        return;
+    
+    const float binHz = static_cast<float> (sampleRate / SignalScope::DECIMATION / FFT_SIZE);
+    const float maxFrequency = binHz * static_cast<float> (FFT_SIZE / 2);
+    const float logRange = std::log (maxFrequency / MIN_FREQUENCY);
+    
+    auto makePath = [&] (const std::vector<float>& decibels)
+    {
+        juce::Path path;
+        
+        for (size_t bin = 1; bin < decibels.size(); ++bin)
+        {
+            const float frequency = binHz * static_cast<float> (bin);
+            
+            if (frequency < MIN_FREQUENCY)
+                continue;
+            
+            const float x = area.getX() + area.getWidth() * std::log (frequency / MIN_FREQUENCY) / logRange;
+            const float y = juce::jmap (decibels[bin], MIN_DECIBELS, 0.0f, area.getBottom(), area.getY());
+            
+            if (path.isEmpty())
+                path.startNewSubPath (x, y);
+            else
+                path.lineTo (x, y);
+        }
+        
+        return path;
+    };
+    
+    g.setColour (juce::Colours::grey);
+    g.strokePath (makePath (inputDecibels), juce::PathStrokeType (1.0f));
+    g.setColour (juce::Colours::orange.withAlpha (0.8f));
+    g.strokePath (makePath (outputDecibels), juce::PathStrokeType (1.0f));
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <vector>
+
+// Input and output overlaid, as a waveform on the left and a spectrum on the
+// right, for checking a shift by eye. Pulls the processor's SignalScope frames
+// at FRAME_RATE_HZ and does the FFT and drawing here on the message thread.
+// Capture is only switched on while this view is showing.
+class SignalScopeView : public juce::Component,
+                        private juce::Timer
+{
+public:
+    explicit SignalScopeView (AUSoundTouchProcessor&);
+    ~SignalScopeView() override;
+    
+    void paint (juce::Graphics&) override;
+    void visibilityChanged() override;
+    
+    static constexpr int FRAME_RATE_HZ = 30;
+    
+    // Frames of history the waveform spans: about 0.7 s at 48 kHz
+    static constexpr int HISTORY_FRAMES = 8192;
+    
+    // 2048 decimated samples: bins about 6 Hz apart at 48 kHz
+    static constexpr int FFT_ORDER = 11;
+    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
+    
+    static constexpr float MIN_FREQUENCY = 50.0f;
+    static constexpr float MIN_DECIBELS = -90.0f;
+    
+private:
+    void timerCallback() override;
+    void setViewing (bool shouldView);
+    void updateSpectra();
+    void computeSpectrum (float SignalScope::Frame::* mean, std::vector<float>& decibels);
+    void paintWaveform (juce::Graphics&, juce::Rectangle<float> area) const;
+    void paintSpectra (juce::Graphics&, juce::Rectangle<float> area) const;
+    
+    // The frame written HISTORY_FRAMES - 1 frames before the newest, plus index
+    const SignalScope::Frame& getHistoryFrame (int index) const;
+    
+    AUSoundTouchProcessor& audioProcessor;
+    SignalScope& scope;
+    bool viewing = false;
+    
+    std::vector<SignalScope::Frame> history;
+    int historyStart = 0;
+    std::vector<SignalScope::Frame> pulledFrames;
+    
+    juce::dsp::FFT fft { FFT_ORDER };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t> (FFT_SIZE), juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> fftData;
+    std::vector<float> inputDecibels;
+    std::vector<float> outputDecibels;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SignalScopeView)
+};
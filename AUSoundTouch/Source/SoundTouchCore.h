@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "CpuLevel.h"
+#include <cmath>
+#include <numbers>
+
+// The per-frame loops of SoundTouchWrapper with the channel count as a
+// template parameter. For the counts hosts use most, the channel loop unrolls
+// and the frame loop vectorises, instead of striding through the interleaved
+// stream by a count only known at run time. NumChannels == 0 is the general
+// version, which takes the count as an argument. The wrapper picks its loops
+// once, in prepare(), through getSoundTouchKernels().
+//
+// Level tells apart the copies SoundTouchVariant.cpp builds for each x86-64
+// level (see CpuLevel.h). Because those are built with newer instruction sets,
+// nothing here may call a shared inline function such as std::min: the linker
+// could keep that copy for everyone. Hence no JUCE in this header either.
+template <int NumChannels, CpuLevel Level = CpuLevel::Baseline>
+struct SoundTouchCore
+{
+    // Interleaves numFrames frames from startSample of every source channel,
+    // narrowing to float on the way
+    template <typename SampleType>
+    static void interleave(const SampleType* const* sources, int startSample, float* destination,
+                           int numFrames, [[maybe_unused]] int numChannels)
+    {
+        if constexpr (NumChannels == 0)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const SampleType* source = sources[channel] + startSample;
+                float* channelDestination = destination + channel;
+                
+                for (int frame = 0; frame < numFrames; ++frame)
+                    channelDestination[frame * numChannels] = static_cast<float>(source[frame]);
+            }
+        }
+        else
+        {
+            const SampleType* channelSources[NumChannels];
+            
+            for (int channel = 0; channel < NumChannels; ++channel)
+                channelSources[channel] = sources[channel] + startSample;
+            
+            for (int frame = 0; frame < numFrames; ++frame)
+                for (int channel = 0; channel < NumChannels; ++channel)
+                    destination[frame * NumChannels + channel] = static_cast<float>(channelSources[channel][frame]);
+        }
+    }
+    
+    // Writes numFrames interleaved frames to every destination channel from startSample
+    template <typename SampleType>
+    static void deinterleave(const float* source, SampleType* const* destinations, int startSample,
+                             int numFrames, [[maybe_unused]] int numChannels)
+    {
+        if constexpr (NumChannels == 0)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                SampleType* destination = destinations[channel] + startSample;
+                const float* channelSource = source + channel;
+                
+                for (int frame = 0; frame < numFrames; ++frame)
+                    destination[frame] = static_cast<SampleType>(channelSource[frame * numChannels]);
+            }
+        }
+        else
+        {
+            SampleType* channelDestinations[NumChannels];
+            
+            for (int channel = 0; channel < NumChannels; ++channel)
+                channelDestinations[channel] = destinations[channel] + startSample;
+            
+            for (int frame = 0; frame < numFrames; ++frame)
+                for (int channel = 0; channel < NumChannels; ++channel)
+                    channelDestinations[channel][frame] = static_cast<SampleType>(source[frame * NumChannels + channel]);
+        }
+    }
+    
+    // Equal-power blend of interleaved incoming frames over the destination,
+    // from frame fadeStart of the chunk (which may be negative, mid-fade) over
+    // fadeFrames frames. The gains are worked out once per frame for all channels.
+    template <typename SampleType>
+    static void crossfade(const float* incoming, SampleType* const* destinations, int startSample,
+                          int numFrames, int fadeStart, int fadeFrames, int numChannels)
+    {
+        const int channels = NumChannels == 0 ? numChannels : NumChannels;
+        
+        for (int frame = fadeStart > 0 ? fadeStart : 0; frame < numFrames; ++frame)
+        {
+            const double position = frame - fadeStart < fadeFrames
+                                  ? static_cast<double>(frame - fadeStart) / fadeFrames : 1.0;
+            const double angle = position * (std::numbers::pi / 2.0);
+            const double outgoingGain = std::cos(angle);
+            const double incomingGain = std::sin(angle);
+            
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                SampleType& destination = destinations[channel][startSample + frame];
+                destination = static_cast<SampleType>(outgoingGain * destination
+                                                      + incomingGain * incoming[frame * channels + channel]);
+            }
+        }
+    }
+};
+
+// One channel count's loops for one sample type, as the wrapper calls them
+template <typename SampleType>
+struct SoundTouchKernels
+{
+    void (*interleave)(const SampleType* const*, int, float*, int, int) = nullptr;
+    void (*deinterleave)(const float*, SampleType* const*, int, int, int) = nullptr;
+    void (*crossfade)(const float*, SampleType* const*, int, int, int, int, int) = nullptr;
+};
+
+// Mono and stereo get their own loops; so do wide layouts split into channel
+// pairs. Measured at 5.1 and 7.1, unrolling won nothing over the general
+// loops for double input, so every other count runs those.
+template <typename SampleType, CpuLevel Level>
+SoundTouchKernels<SampleType> makeSoundTouchKernels(int numChannels)
+{
+    auto kernelsFor = [] (auto core)
+    {
+        using Core = decltype(core);
+        
+        return SoundTouchKernels<SampleType> { &Core::template interleave<SampleType>,
+                                               &Core::template deinterleave<SampleType>,
+                                               &Core::template crossfade<SampleType> };
+    };
+    
+    switch (numChannels)
+    {
+        case 1:  return kernelsFor(SoundTouchCore<1, Level> {});
+        case 2:  return kernelsFor(SoundTouchCore<2, Level> {});
+        default: return kernelsFor(SoundTouchCore<0, Level> {});
+    }
+}
+
+#if AUSOUNDTOUCH_X86_LEVELS
+// Built by SoundTouchVariant.cpp with each level's instruction set
+extern template SoundTouchKernels<float> makeSoundTouchKernels<float, CpuLevel::X86_64_V2>(int);
+extern template SoundTouchKernels<double> makeSoundTouchKernels<double, CpuLevel::X86_64_V2>(int);
+extern template SoundTouchKernels<float> makeSoundTouchKernels<float, CpuLevel::X86_64_V3>(int);
+extern template SoundTouchKernels<double> makeSoundTouchKernels<double, CpuLevel::X86_64_V3>(int);
+extern template SoundTouchKernels<float> makeSoundTouchKernels<float, CpuLevel::X86_64_V4>(int);
+extern template SoundTouchKernels<double> makeSoundTouchKernels<double, CpuLevel::X86_64_V4>(int);
+#endif
+
+// The loops for numChannels at the given level, by default the one this CPU
+// runs; a level that wasn't built falls back to the baseline
+template <typename SampleType>
+SoundTouchKernels<SampleType> getSoundTouchKernels(int numChannels, CpuLevel level = getCpuLevel())
+{
+    switch (level)
+    {
+       #if AUSOUNDTOUCH_X86_LEVELS
+        case CpuLevel::X86_64_V2: return makeSoundTouchKernels<SampleType, CpuLevel::X86_64_V2>(numChannels);
+        case CpuLevel::X86_64_V3: return makeSoundTouchKernels<SampleType, CpuLevel::X86_64_V3>(numChannels);
+        case CpuLevel::X86_64_V4: return makeSoundTouchKernels<SampleType, CpuLevel::X86_64_V4>(numChannels);
+       #endif
+        default: return makeSoundTouchKernels<SampleType, CpuLevel::Baseline>(numChannels);
+    }
+}
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "SoundTouchEngine.h"
+#include <vector>
+
+SoundTouchProcessor::~SoundTouchProcessor() = default;
+
+std::unique_ptr<SoundTouchProcessor> SoundTouchProcessor::create(CpuLevel level)
+{
+    switch (level)
+    {
+       #if AUSOUNDTOUCH_X86_LEVELS
+        case CpuLevel::X86_64_V2: return std::unique_ptr<SoundTouchProcessor>(createSoundTouchProcessor<CpuLevel::X86_64_V2>());
+        case CpuLevel::X86_64_V3: return std::unique_ptr<SoundTouchProcessor>(createSoundTouchProcessor<CpuLevel::X86_64_V3>());
+        case CpuLevel::X86_64_V4: return std::unique_ptr<SoundTouchProcessor>(createSoundTouchProcessor<CpuLevel::X86_64_V4>());
+       #endif
+        default: return std::unique_ptr<SoundTouchProcessor>(createSoundTouchProcessor<CpuLevel::Baseline>());
+    }
+}
+
+SoundTouchEngine::SoundTouchEngine(const Tuning& engineTuning, CpuLevel cpuLevel)
+    : processor(SoundTouchProcessor::create(cpuLevel)),
+      tuning(engineTuning)
+{
+}
+
+SoundTouchEngine::Tuning SoundTouchEngine::getTuning(Type type, int qualityMode)
+{
+    // Standard High is the original configuration; the cheaper quality modes
+    // trade seek accuracy and anti-alias filter length for CPU
+    Tuning result;
+    
+    switch (qualityMode)
+    {
+        case 1: // Fast
+            result.quickSeek = true;
+            result.antiAliasLength = 16;
+            result.seekWindowMs = 10;
+            break;
+            
+        case 2: // Balanced
+            result.quickSeek = true;
+            result.antiAliasLength = 32;
+            break;
+            
+        default: // High, and the content modes where their own engines can't run
+            break;
+    }
+    
+    if (type == Type::LowLatency)
+    {
+        // Shorter windows shrink what SoundTouch holds back before its first
+        // output, at the cost of more audible splicing on low notes
+        result.sequenceMs = 20;
+        result.seekWindowMs = std::min(result.seekWindowMs, 8);
+        result.overlapMs = 4;
+    }
+    else if (type == Type::HighQuality)
+    {
+        // Offline only: CPU and latency don't matter, so search widely and
+        // filter hard regardless of the quality mode
+        result.sequenceMs = 60;
+        result.seekWindowMs = 25;
+        result.overlapMs = 12;
+        result.quickSeek = false;
+        result.antiAliasLength = 128;
+    }
+    
+    return result;
+}
+
+void SoundTouchEngine::prepare(double sampleRate, int numChannels, int maxBlockFrames)
+{
+    processor->setSampleRate(static_cast<int>(sampleRate));
+    processor->setChannels(numChannels);
+    
+    processor->setSetting(SETTING_USE_AA_FILTER, 1);
+    processor->setSetting(SETTING_AA_FILTER_LENGTH, tuning.antiAliasLength);
+    processor->setSetting(SETTING_USE_QUICKSEEK, tuning.quickSeek ? 1 : 0);
+    processor->setSetting(SETTING_SEQUENCE_MS, tuning.sequenceMs);
+    processor->setSetting(SETTING_SEEKWINDOW_MS, tuning.seekWindowMs);
+    processor->setSetting(SETTING_OVERLAP_MS, tuning.overlapMs);
+    
+    // SoundTouch grows its internal pipes on first use. Run silence through it at
+    // the extreme ratios so that growth happens here rather than on the audio
+    // thread later, then discard the result.
+    std::vector<float> silence(static_cast<size_t>(maxBlockFrames * numChannels), 0.0f);
+    std::vector<float> discard(silence.size() * 2);
+    
+    for (const float ratio : { 0.1f, 1.0f, 10.0f })
+    {
+        processor->setTempo(ratio);
+        processor->setRate(1.0f / ratio);
+        
+        for (int block = 0; block < 8; ++block)
+        {
+            processor->putSamples(silence.data(), maxBlockFrames);
+            
+            while (processor->receiveSamples(discard.data(), maxBlockFrames * 2) > 0)
+            {
+            }
+        }
+    }
+    
+    processor->setPitch(currentPitch);
+    processor->setTempo(currentTempo);
+    processor->setRate(currentRate);
+    processor->clear();
+}
+
+void SoundTouchEngine::setRatios(float pitch, float tempo, float rate)
+{
+    // Each setter recalculates SoundTouch's effective rate, so skip unchanged ones
+    if (pitch != currentPitch)
+    {
+        currentPitch = pitch;
+        processor->setPitch(pitch);
+    }
+    
+    if (tempo != currentTempo)
+    {
+        currentTempo = tempo;
+        processor->setTempo(tempo);
+    }
+    
+    if (rate != currentRate)
+    {
+        currentRate = rate;
+        processor->setRate(rate);
+    }
+}
+
+void SoundTouchEngine::putSamples(const float* interleaved, int numFrames)
+{
+    processor->putSamples(interleaved, numFrames);
+}
+
+int SoundTouchEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    return processor->receiveSamples(interleaved, maxFrames);
+}
+
+void SoundTouchEngine::flush()
+{
+    processor->flush();
+}
+
+void SoundTouchEngine::clear()
+{
+    processor->clear();
+}
+
+int SoundTouchEngine::getInitialLatency() const
+{
+    return processor->getSetting(SETTING_INITIAL_LATENCY);
+}
+
+int SoundTouchEngine::getNumUnprocessedFrames() const
+{
+    return processor->getNumUnprocessedFrames();
+}
+
+double SoundTouchEngine::getOutputPerInput(float tempo, float rate) const
+{
+    // Pitch is a rate change undone by a matching tempo change, so only these two
+    // affect the duration (SoundTouch::getInputOutputSampleRatio())
+    return 1.0 / (static_cast<double>(tempo) * rate);
+}
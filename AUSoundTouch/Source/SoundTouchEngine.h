@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include "SoundTouchProcessor.h"
+// Handle both system and fetched SoundTouch includes
+#if __has_include(<soundtouch/SoundTouch.h>)
+    #include <soundtouch/SoundTouch.h>
+#else
+    #include <SoundTouch.h>
+#endif
+
+static_assert(SOUNDTOUCH_MAX_CHANNELS >= TimeStretchEngine::MAX_CHANNELS,
+              "SoundTouch must carry every layout the wrapper accepts in one stream");
+
+// The SoundTouch WSOLA engine. The Standard, LowLatency and HighQuality types
+// are all this class with different window and filter settings. It runs the
+// copy of SoundTouch built for this CPU's x86-64 level unless told otherwise.
+class SoundTouchEngine : public TimeStretchEngine
+{
+public:
+    explicit SoundTouchEngine(const Tuning& tuning, CpuLevel cpuLevel = getCpuLevel());
+    
+    static Tuning getTuning(Type type, int qualityMode);
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    int getInitialLatency() const override;
+    int getNumUnprocessedFrames() const override;
+    double getOutputPerInput(float tempo, float rate) const override;
+    
+private:
+    const std::unique_ptr<SoundTouchProcessor> processor;
+    const Tuning tuning;
+    
+    float currentPitch = 1.0f;
+    float currentTempo = 1.0f;
+    float currentRate = 1.0f;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundTouchEngine)
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "CpuLevel.h"
+#include <memory>
+
+// The calls SoundTouchEngine makes on soundtouch::SoundTouch, behind an
+// interface so the engine can drive the copy of the library built for this
+// CPU's x86-64 level (see CpuLevel.h). Each copy is wrapped by
+// SoundTouchVariant.cpp built for the same level.
+class SoundTouchProcessor
+{
+public:
+    virtual ~SoundTouchProcessor();
+    
+    virtual void setSampleRate(int sampleRate) = 0;
+    virtual void setChannels(int numChannels) = 0;
+    virtual void setSetting(int settingId, int value) = 0;
+    virtual int getSetting(int settingId) const = 0;
+    
+    virtual void setPitch(float pitch) = 0;
+    virtual void setTempo(float tempo) = 0;
+    virtual void setRate(float rate) = 0;
+    
+    virtual void putSamples(const float* interleaved, int numFrames) = 0;
+    virtual int receiveSamples(float* interleaved, int maxFrames) = 0;
+    virtual void flush() = 0;
+    virtual void clear() = 0;
+    virtual int getNumUnprocessedFrames() const = 0;
+    
+    // SoundTouch built for the given level, or the baseline one if that level wasn't built
+    static std::unique_ptr<SoundTouchProcessor> create(CpuLevel level);
+};
+
+// One definition per level, each in SoundTouchVariant.cpp built for it. These
+// return a plain owning pointer so that no unique_ptr code is instantiated
+// with the newer instruction sets.
+template <CpuLevel Level>
+SoundTouchProcessor* createSoundTouchProcessor();
+
+template <> SoundTouchProcessor* createSoundTouchProcessor<CpuLevel::Baseline>();
+
+#if AUSOUNDTOUCH_X86_LEVELS
+template <> SoundTouchProcessor* createSoundTouchProcessor<CpuLevel::X86_64_V2>();
+template <> SoundTouchProcessor* createSoundTouchProcessor<CpuLevel::X86_64_V3>();
+template <> SoundTouchProcessor* createSoundTouchProcessor<CpuLevel::X86_64_V4>();
+#endif
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "SoundTouchProcessor.h"
+#include "SoundTouchCore.h"
+#if __has_include(<soundtouch/SoundTouch.h>)
+    #include <soundtouch/SoundTouch.h>
+#else
+    #include <SoundTouch.h>
+#endif
+
+// Built once with the plugin's other sources, at the baseline, and once per
+// x86-64 level with AUSOUNDTOUCH_CPU_LEVEL and that level's -march, against a
+// copy of SoundTouch whose namespace is renamed to match (see CMakeLists.txt).
+// Code built here for a newer instruction set must not be shared with the
+// rest of the plugin, so this file includes no JUCE and keeps its own classes
+// in an anonymous namespace.
+#ifndef AUSOUNDTOUCH_CPU_LEVEL
+    #define AUSOUNDTOUCH_CPU_LEVEL 1
+#endif
+
+namespace
+{
+    constexpr auto variantLevel = static_cast<CpuLevel>(AUSOUNDTOUCH_CPU_LEVEL);
+    
+    class VariantProcessor final : public SoundTouchProcessor
+    {
+    public:
+        void setSampleRate(int sampleRate) override  { processor.setSampleRate(static_cast<uint>(sampleRate)); }
+        void setChannels(int numChannels) override   { processor.setChannels(static_cast<uint>(numChannels)); }
+        void setSetting(int settingId, int value) override { processor.setSetting(settingId, value); }
+        int getSetting(int settingId) const override { return processor.getSetting(settingId); }
+        
+        void setPitch(float pitch) override { processor.setPitch(pitch); }
+        void setTempo(float tempo) override { processor.setTempo(tempo); }
+        void setRate(float rate) override   { processor.setRate(rate); }
+        
+        void putSamples(const float* interleaved, int numFrames) override
+        {
+            processor.putSamples(interleaved, static_cast<uint>(numFrames));
+        }
+        
+        int receiveSamples(float* interleaved, int maxFrames) override
+        {
+            return static_cast<int>(processor.receiveSamples(interleaved, static_cast<uint>(maxFrames)));
+        }
+        
+        void flush() override { processor.flush(); }
+        void clear() override { processor.clear(); }
+        int getNumUnprocessedFrames() const override { return static_cast<int>(processor.numUnprocessedSamples()); }
+        
+    private:
+        // getSetting() isn't const in SoundTouch, hence mutable
+        mutable soundtouch::SoundTouch processor;
+    };
+}
+
+template <>
+SoundTouchProcessor* createSoundTouchProcessor<variantLevel>()
+{
+    return new VariantProcessor();
+}
+
+#if AUSOUNDTOUCH_CPU_LEVEL > 1
+template SoundTouchKernels<float> makeSoundTouchKernels<float, variantLevel>(int);
+template SoundTouchKernels<double> makeSoundTouchKernels<double, variantLevel>(int);
+#endif
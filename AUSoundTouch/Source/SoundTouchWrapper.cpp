@@ -23,199 +23,722 @@
 #include <cmath>
 
 SoundTouchWrapper::SoundTouchWrapper()
-    : processor(std::make_unique<soundtouch::SoundTouch>())
 {
-    // Configure for best quality
-    processor->setSetting(SETTING_USE_QUICKSEEK, 0); // Disable quickseek for better quality
-    processor->setSetting(SETTING_USE_AA_FILTER, 1); // Enable anti-alias filter
-    
-    // Increase anti-alias filter length for better quality (default is 32)
-    processor->setSetting(SETTING_AA_FILTER_LENGTH, 64); // Higher = better quality but more CPU
-    
-    // Use default processing settings for better quality
-    // These are the SoundTouch defaults that produce high-quality output:
-    processor->setSetting(SETTING_SEQUENCE_MS, 40); // Default is 40ms
-    processor->setSetting(SETTING_SEEKWINDOW_MS, 15); // Default is 15ms  
-    processor->setSetting(SETTING_OVERLAP_MS, 8); // Default is 8ms
-    
-    // Note: We're already using float samples (SOUNDTOUCH_FLOAT_SAMPLES) which is
-    // compiled into the Homebrew version of SoundTouch for best quality
 }
 
-SoundTouchWrapper::~SoundTouchWrapper() = default;
+SoundTouchWrapper::~SoundTouchWrapper()
+{
+    delete pendingState.exchange(nullptr);
+    delete retiredState.exchange(nullptr);
+    delete pendingStandby.exchange(nullptr);
+    delete retiredStandby.exchange(nullptr);
+}
 
 void SoundTouchWrapper::prepare(double sampleRate, int blockSize, int numChannels)
 {
+    jassert(numChannels > 0 && numChannels <= MAX_CHANNELS);
+    
+    // Hosts often re-prepare on a seek with nothing changed; keep the engine
+    if (isPrepared && sampleRate == currentSampleRate
+        && std::max(1, blockSize) == currentBlockSize && numChannels == currentNumChannels)
+    {
+        // The audio thread is stopped, so a rebuild published since can be taken
+        // up outright rather than crossfaded at the next block
+        if (std::unique_ptr<EngineState> next { pendingState.exchange(nullptr) })
+        {
+            adoptOwnRatios(*next);
+            outgoing.reset();
+            engine = std::move(next);
+            updateTailLength();
+            reportedLatencySamples.store(getPrimingFrames(*engine));
+        }
+        
+        reset();
+        return;
+    }
+    
     currentSampleRate = sampleRate;
-    currentBlockSize = blockSize;
+    currentBlockSize = std::max(1, blockSize);
     currentNumChannels = numChannels;
     
-    processor->setSampleRate(static_cast<uint>(sampleRate));
-    processor->setChannels(static_cast<uint>(numChannels));
+    // All per-block scratch space is sized here, once per layout change
+    interleavedBuffer.resize(static_cast<size_t>(currentBlockSize * numChannels));
+    receiveBuffer.resize(static_cast<size_t>(currentBlockSize * numChannels * 2));
+    incomingBuffer.resize(static_cast<size_t>(currentBlockSize * numChannels));
+    floatKernels = getSoundTouchKernels<float>(numChannels);
+    doubleKernels = getSoundTouchKernels<double>(numChannels);
+    
+    // The host has stopped the audio thread, so anything still in flight from an
+    // earlier mode change, including a crossfade or a standby, is stale and can
+    // be dropped here
+    takeUpSwappedStandby();
+    delete pendingState.exchange(nullptr);
+    delete retiredState.exchange(nullptr);
+    delete pendingStandby.exchange(nullptr);
+    delete retiredStandby.exchange(nullptr);
+    standbyCleared.store(false);
+    outgoing.reset();
+    standby.reset();
+    
+    for (auto* ratio : { &pitchRatio, &tempoRatio, &rateRatio })
+        ratio->reset(sampleRate, RATIO_SMOOTHING_SECONDS);
     
-    interleavedBuffer.resize(static_cast<size_t>(blockSize * numChannels * 2));
+    // Offline renders may finish before the first poll, so start on the right engine
+    activeEngineType = chooseEngineType(stretchFactor.load());
+    engine = createEngineState(configuration, activeEngineType);
+    engine->processor->setRatios(pitchRatio.getTargetValue(), tempoRatio.getTargetValue(), rateRatio.getTargetValue());
+    primeOutputFifo(*engine);
+    updateTailLength();
+    reportedLatencySamples.store(getPrimingFrames(*engine));
     
-    // Initialize FIFO buffer based on current buffering mode
-    int fifoSize;
-    switch (bufferingMode)
+    stats.inputFrames = 0;
+    stats.outputFrames = 0;
+    stats.dryFrames = 0;
+    stats.droppedFrames = 0;
+    stats.underruns = 0;
+    stats.crossfades = 0;
+    stats.fifoFrames = 0;
+    tracedChunks = 0;
+    inUnderrun = false;
+    inOverrun = false;
+    
+    isPrepared = true;
+}
+
+void SoundTouchWrapper::reset()
+{
+    if (engine == nullptr)
+        return;
+    
+    // Nothing from before the jump should play, so there is nothing to fade from
+    if (outgoing != nullptr)
+        finishCrossfade();
+    
+    // Jump straight to the latest ratios; there is no old audio to glide from
+    for (auto* ratio : { &pitchRatio, &tempoRatio, &rateRatio })
+        ratio->setCurrentAndTargetValue(ratio->getTargetValue());
+    
+    engine->processor->setRatios(pitchRatio.getTargetValue(), tempoRatio.getTargetValue(), rateRatio.getTargetValue());
+    
+    // Both only rewind read/write positions; all storage stays allocated
+    engine->processor->clear();
+    engine->outputFifo->reset();
+    primeOutputFifo(*engine);
+    
+    if (standby != nullptr)
     {
-        case 1: // Minimal
-            fifoSize = std::max(4096, blockSize * 8);
-            break;
-        case 2: // Normal
-            fifoSize = std::max(16384, blockSize * 32);
-            break;
-        case 3: // Extra
-            fifoSize = std::max(32768, blockSize * 64);
-            break;
-        default:
-            fifoSize = std::max(16384, blockSize * 32);
-            break;
+        standby->processor->clear();
+        standby->outputFifo->reset();
+        primeOutputFifo(*standby);
     }
+}
+
+int SoundTouchWrapper::getPrimingFrames(const EngineState& state) const
+{
+    const int capacityFrames = state.outputFifo->getTotalSize() / currentNumChannels;
     
-    outputFifo = std::make_unique<juce::AbstractFifo>(fifoSize);
-    fifoBuffer.resize(static_cast<size_t>(fifoSize * numChannels));
+    // A constant-latency engine returns every frame past its latency within the
+    // same block, so it needs no slack for uneven output
+    const int slackFrames = state.processor->hasConstantLatency() ? 0 : currentBlockSize;
     
-    processor->clear();
+    return std::min(state.processor->getInitialLatency() + slackFrames, capacityFrames / 2);
+}
+
+void SoundTouchWrapper::updateTailLength()
+{
+    auto& processor = *engine->processor;
+    
+    // The initial latency counts input frames; slower tempos stretch them. Uses
+    // the target ratios so the host sees the tail the new settings will have.
+    const double outputPerInput = processor.getOutputPerInput(tempoRatio.getTargetValue(), rateRatio.getTargetValue());
+    const int heldBackFrames = static_cast<int>(std::ceil(processor.getInitialLatency() * outputPerInput));
+    
+    tailLengthSamples.store(heldBackFrames + getPrimingFrames(*engine));
+}
+
+void SoundTouchWrapper::primeOutputFifo(EngineState& state) const
+{
+    // Start every stream with as much silence as SoundTouch holds back before
+    // its first output (plus a block of slack), so processed audio follows at a
+    // constant latency instead of dry input handing over to delayed output
+    const int primingFrames = getPrimingFrames(state);
+    
+    int start1, size1, start2, size2;
+    state.outputFifo->prepareToWrite(primingFrames * currentNumChannels, start1, size1, start2, size2);
+    std::fill_n(state.fifoBuffer.begin() + start1, size1, 0.0f);
+    std::fill_n(state.fifoBuffer.begin() + start2, size2, 0.0f);
+    state.outputFifo->finishedWrite(size1 + size2);
+}
+
+std::unique_ptr<SoundTouchWrapper::EngineState> SoundTouchWrapper::createEngineState(const Configuration& stateConfiguration,
+                                                                                    TimeStretchEngine::Type type) const
+{
+    auto state = std::make_unique<EngineState>();
+    state->configuration = stateConfiguration;
+    state->engineType = type;
+    
+    state->processor = TimeStretchEngine::create(type, stateConfiguration.qualityMode,
+                                                 stateConfiguration.hasTuning ? &stateConfiguration.tuning : nullptr);
+    state->processor->prepare(currentSampleRate, currentNumChannels, currentBlockSize);
+    
+    // The FIFO holds interleaved samples, so its capacity scales with the channel count
+    const int fifoFrames = getFifoSizeForMode(stateConfiguration.bufferingMode, currentBlockSize);
+    
+    state->outputFifo = std::make_unique<juce::AbstractFifo>(fifoFrames * currentNumChannels);
+    state->fifoBuffer.resize(static_cast<size_t>(fifoFrames * currentNumChannels));
+    
+    return state;
+}
+
+void SoundTouchWrapper::publishEngineState(std::unique_ptr<EngineState> state)
+{
+    // A state the audio thread never picked up is simply superseded
+    delete pendingState.exchange(state.release());
+    releaseRetiredState();
+}
+
+// One crossfade and one retired state at a time; while either is still in
+// progress, the pending state waits
+bool SoundTouchWrapper::canStartSwap() const
+{
+    return outgoing == nullptr && retiredState.load() == nullptr;
+}
+
+bool SoundTouchWrapper::isReadyToSwap() const
+{
+    return canStartSwap() && pendingState.load() != nullptr;
+}
+
+// Audio thread only: takes over a pre-built state without allocating or freeing.
+// The current state keeps running as the outgoing half of a crossfade.
+void SoundTouchWrapper::swapInPendingState()
+{
+    if (! isReadyToSwap())
+        return;
+    
+    std::unique_ptr<EngineState> next { pendingState.exchange(nullptr) };
+    
+    if (next == nullptr)
+        return;
+    
+    adoptOwnRatios(*next);
+    next->processor->setRatios(pitchRatio.getCurrentValue(), tempoRatio.getCurrentValue(), rateRatio.getCurrentValue());
+    primeOutputFifo(*next);
+    
+    // The incoming engine only has priming silence to offer at first, so the
+    // fade starts once that has played out
+    const int warmUp = getPrimingFrames(*next);
+    beginCrossfade(std::move(next), warmUp);
+}
+
+// Audio thread only: not while a newer standby or a pending state waits,
+// either of which would replace the settings swapped to
+bool SoundTouchWrapper::isStandbyReady(int key) const
+{
+    return standby != nullptr && standby->standbyKey == key && canStartSwap()
+        && pendingState.load() == nullptr && pendingStandby.load() == nullptr;
+}
+
+// Audio thread only: the standby has heard the same input all along, so its
+// FIFO is already at its latency and the fade starts with the next chunk
+void SoundTouchWrapper::swapInStandby()
+{
+    if (standby == nullptr || ! canStartSwap())
+        return;
+    
+    adoptOwnRatios(*standby);
+    swappedStandby.store(standby.get());
+    beginCrossfade(std::move(standby), 0);
+}
+
+void SoundTouchWrapper::beginCrossfade(std::unique_ptr<EngineState> next, int warmUp)
+{
+    outgoing = std::move(engine);
+    engine = std::move(next);
+    updateTailLength();
+    reportedLatencySamples.store(getPrimingFrames(*engine));
+    
+    crossfadePosition = 0;
+    warmUpFrames = warmUp;
+    fadeFrames = std::max(1, static_cast<int>(std::lround(CROSSFADE_MS * 0.001 * currentSampleRate)));
+    stats.crossfades.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Audio thread only: a state built for given ratios (see crossfadeTo()) starts
+// at them without smoothing
+void SoundTouchWrapper::adoptOwnRatios(const EngineState& state)
+{
+    if (! state.hasOwnRatios)
+        return;
+    
+    pitchRatio.setCurrentAndTargetValue(state.pitch);
+    tempoRatio.setCurrentAndTargetValue(state.tempo);
+    rateRatio.setCurrentAndTargetValue(state.rate);
+    updateStretchFactor();
+}
+
+void SoundTouchWrapper::prepareStandby(const Configuration& standbyConfiguration,
+                                       float pitch, float tempo, float rate, int key)
+{
+    takeUpSwappedStandby();
+    
+    if (! isPrepared)
+        return;
+    
+    const auto type = chooseEngineType(standbyConfiguration, standbyConfiguration.engineType, getStretchFactor(pitch, tempo));
+    auto state = createEngineState(standbyConfiguration, type);
+    state->hasOwnRatios = true;
+    state->pitch = pitch;
+    state->tempo = tempo;
+    state->rate = rate;
+    state->standbyKey = key;
+    state->processor->setRatios(pitch, tempo, rate);
+    primeOutputFifo(*state);
+    
+    standbyCleared.store(false);
+    delete pendingStandby.exchange(state.release());
+}
+
+void SoundTouchWrapper::clearStandby()
+{
+    takeUpSwappedStandby();
+    delete pendingStandby.exchange(nullptr);
+    standbyCleared.store(true);
+}
+
+// Audio thread only: the standby it replaces goes to the worker to free, so
+// a new one waits while the last is still there
+void SoundTouchWrapper::takeUpPendingStandby()
+{
+    if (retiredStandby.load() != nullptr)
+        return;
+    
+    if (pendingStandby.load() != nullptr)
+    {
+        retiredStandby.store(standby.release());
+        standby.reset(pendingStandby.exchange(nullptr));
+    }
+    else if (standbyCleared.exchange(false))
+    {
+        retiredStandby.store(standby.release());
+    }
+}
+
+// Audio thread only: the standby hears every chunk and plays out as much as
+// the running engine would, into nowhere, so its FIFO holds what it would
+// have by now had it been running all along
+void SoundTouchWrapper::advanceStandby(const float* input, int numSamples)
+{
+    const int numChannels = currentNumChannels;
+    auto& outputFifo = *standby->outputFifo;
+    
+    standby->processor->putSamples(input, numSamples);
+    receiveIntoFifo(*standby);
+    
+    if (outputFifo.getNumReady() / numChannels < numSamples)
+        return;
+    
+    int start1, size1, start2, size2;
+    outputFifo.prepareToRead(numSamples * numChannels, start1, size1, start2, size2);
+    outputFifo.finishedRead(size1 + size2);
+}
+
+// Worker side: after swapInStandby() the standby's settings are the running
+// ones. The state is only ever freed by this thread, after this has run.
+void SoundTouchWrapper::takeUpSwappedStandby()
+{
+    if (const auto* swapped = swappedStandby.exchange(nullptr))
+    {
+        configuration = swapped->configuration;
+        activeEngineType = swapped->engineType;
+    }
+}
+
+// Audio thread only: the retired slot is always free here, since no swap
+// starts while it is occupied and none happens during a crossfade
+void SoundTouchWrapper::finishCrossfade()
+{
+    retiredState.store(outgoing.release());
+}
+
+void SoundTouchWrapper::releaseRetiredState()
+{
+    takeUpSwappedStandby();
+    delete retiredState.exchange(nullptr);
+    delete retiredStandby.exchange(nullptr);
+}
+
+int SoundTouchWrapper::getFifoSizeForMode(int mode, int blockSize)
+{
+    // Sizes are in frames (the stereo capacities the FIFO always had)
+    switch (mode)
+    {
+        case 1: // Minimal - smaller buffer for lower latency
+            return std::max(2048, blockSize * 4);
+            
+        case 2: // Normal - current default
+            return std::max(8192, blockSize * 16);
+            
+        case 3: // Extra - double the normal buffer
+            return std::max(16384, blockSize * 32);
+            
+        case 4: // Live - only the engine's few milliseconds are ever buffered
+            return std::max(1024, blockSize * 4);
+            
+        default:
+            return std::max(8192, blockSize * 16);
+    }
 }
 
 void SoundTouchWrapper::setPitch(float semitones)
 {
     const float nativeValue = semitonesToNative(semitones);
-    processor->setPitch(nativeValue);
-    DBG("Set pitch: " << semitones << " semitones -> native: " << nativeValue);
+    
+    if (nativeValue == pitchRatio.getTargetValue())
+        return;
+    
+    pitchRatio.setTargetValue(nativeValue);
+    updateStretchFactor();
+    
+    if (engine != nullptr)
+        updateTailLength();
+    
+   #if JUCE_DEBUG
+    realtimeLog->post(RealtimeLog::Event::PitchChanged, logSource, semitones, nativeValue);
+   #endif
 }
 
 void SoundTouchWrapper::setTempo(float percentage)
 {
     const float nativeValue = percentageToNative(percentage);
-    processor->setTempo(nativeValue);
+    
+    if (nativeValue == tempoRatio.getTargetValue())
+        return;
+    
+    tempoRatio.setTargetValue(nativeValue);
+    updateStretchFactor();
+    
+    if (engine != nullptr)
+        updateTailLength();
 }
 
 void SoundTouchWrapper::setRate(float percentage)
 {
     const float nativeValue = percentageToNative(percentage);
-    processor->setRate(nativeValue);
+    
+    if (nativeValue == rateRatio.getTargetValue())
+        return;
+    
+    rateRatio.setTargetValue(nativeValue);
+    updateStretchFactor();
+    
+    if (engine != nullptr)
+        updateTailLength();
 }
 
-void SoundTouchWrapper::processBlock(juce::AudioBuffer<float>& buffer)
+float SoundTouchWrapper::getStretchFactor(float pitch, float tempo)
 {
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    // Every engine stretches time by pitch/tempo before resampling
+    const float stretch = pitch / tempo;
+    return std::max(stretch, 1.0f / stretch);
+}
+
+void SoundTouchWrapper::updateStretchFactor()
+{
+    stretchFactor.store(getStretchFactor(pitchRatio.getTargetValue(), tempoRatio.getTargetValue()));
+}
+
+TimeStretchEngine::Type SoundTouchWrapper::chooseEngineType(float stretch) const
+{
+    return chooseEngineType(configuration, activeEngineType, stretch);
+}
+
+TimeStretchEngine::Type SoundTouchWrapper::chooseEngineType(const Configuration& stateConfiguration,
+                                                            TimeStretchEngine::Type current, float stretch)
+{
+    // Low latency and varispeed are explicit choices; only the general-purpose
+    // SoundTouch engines hand over
+    if (stateConfiguration.engineType != TimeStretchEngine::Type::Standard
+        && stateConfiguration.engineType != TimeStretchEngine::Type::HighQuality)
+        return stateConfiguration.engineType;
     
-    if (numChannels != currentNumChannels)
-    {
-        jassertfalse;
-        return;
-    }
+    const float threshold = current == TimeStretchEngine::Type::PhaseVocoder
+                          ? PHASE_VOCODER_RELEASE : PHASE_VOCODER_THRESHOLD;
     
-    // Resize buffers if needed
-    const size_t requiredSize = static_cast<size_t>(numSamples * numChannels);
-    if (interleavedBuffer.size() < requiredSize * 2)
-    {
-        interleavedBuffer.resize(requiredSize * 2);
-    }
+    return stretch >= threshold ? TimeStretchEngine::Type::PhaseVocoder : stateConfiguration.engineType;
+}
+
+bool SoundTouchWrapper::updateAutomaticEngine()
+{
+    takeUpSwappedStandby();
     
-    // Step 1: Interleave and feed input samples to SoundTouch
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        for (int channel = 0; channel < numChannels; ++channel)
-        {
-            interleavedBuffer[static_cast<size_t>(sample * numChannels + channel)] = 
-                buffer.getSample(channel, sample);
-        }
-    }
+    // A pending state may carry its own ratios (see crossfadeTo()); let it land first
+    if (! isPrepared || hasPendingState())
+        return false;
+    
+    const auto type = chooseEngineType(stretchFactor.load());
     
-    processor->putSamples(interleavedBuffer.data(), static_cast<uint>(numSamples));
+    if (type == activeEngineType)
+        return false;
     
-    // Step 2: Receive all available samples from SoundTouch and add to FIFO
-    std::vector<float> tempBuffer(requiredSize * 2); // Temporary buffer for receiving
+    activeEngineType = type;
+    publishEngineState(createEngineState(configuration, activeEngineType));
     
-    while (processor->numSamples() > 0)
+   #if JUCE_DEBUG
+    realtimeLog->post(RealtimeLog::Event::EngineSwitched, logSource, static_cast<double>(activeEngineType));
+   #endif
+    return true;
+}
+
+// Audio thread only. The engine only ever hears the ratios here, at the start
+// of a chunk and after any swap, so an engine being faded out keeps its own.
+void SoundTouchWrapper::applySmoothedRatios(int numSamples)
+{
+    engine->processor->setRatios(pitchRatio.skip(numSamples), tempoRatio.skip(numSamples), rateRatio.skip(numSamples));
+}
+
+// Moves everything the engine has ready into the output FIFO; anything that
+// doesn't fit is dropped. Returns the number of frames dropped.
+int SoundTouchWrapper::receiveIntoFifo(EngineState& state)
+{
+    const int numChannels = currentNumChannels;
+    auto& processor = *state.processor;
+    auto& outputFifo = *state.outputFifo;
+    auto& fifoBuffer = state.fifoBuffer;
+    
+    const int receiveCapacity = static_cast<int>(receiveBuffer.size()) / numChannels;
+    int droppedFrames = 0;
+    
+    while (true)
     {
-        const int received = static_cast<int>(
-            processor->receiveSamples(tempBuffer.data(), static_cast<uint>(numSamples * 2))
-        );
+        const int received = processor.receiveSamples(receiveBuffer.data(), receiveCapacity);
         
         if (received == 0)
-            break;
+            return droppedFrames;
             
         // Add received samples to FIFO
-        const int samplesInFifo = outputFifo->getFreeSpace() / numChannels;
+        const int samplesInFifo = outputFifo.getFreeSpace() / numChannels;
         const int samplesToWrite = std::min(received, samplesInFifo);
         
+        if (samplesToWrite < received)
+            droppedFrames += received - samplesToWrite;
+        
         if (samplesToWrite > 0)
         {
             int start1, size1, start2, size2;
-            outputFifo->prepareToWrite(samplesToWrite * numChannels, start1, size1, start2, size2);
+            outputFifo.prepareToWrite(samplesToWrite * numChannels, start1, size1, start2, size2);
             
             // Copy samples to FIFO buffer
             if (size1 > 0)
             {
-                std::copy(tempBuffer.begin(), 
-                         tempBuffer.begin() + size1, 
+                std::copy(receiveBuffer.begin(), 
+                         receiveBuffer.begin() + size1, 
                          fifoBuffer.begin() + start1);
             }
             if (size2 > 0)
             {
-                std::copy(tempBuffer.begin() + size1,
-                         tempBuffer.begin() + size1 + size2,
+                std::copy(receiveBuffer.begin() + size1,
+                         receiveBuffer.begin() + size1 + size2,
                          fifoBuffer.begin() + start2);
             }
             
-            outputFifo->finishedWrite(samplesToWrite * numChannels);
+            outputFifo.finishedWrite(samplesToWrite * numChannels);
         }
     }
+}
+
+template <typename SampleType>
+void SoundTouchWrapper::processBlockInternal(juce::AudioBuffer<SampleType>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    
+    // Layout changes always go through prepare(), so a mismatch here means the
+    // host skipped it. Leave the dry signal untouched rather than reallocating.
+    if (! isPrepared || buffer.getNumChannels() != currentNumChannels)
+        return;
+    
+    takeUpPendingStandby();
+    
+    if (! holdsPendingState)
+        swapInPendingState();
+    
+    // Hosts may exceed the prepared block size; split instead of growing buffers
+    for (int startSample = 0; startSample < numSamples; startSample += currentBlockSize)
+        processChunk(buffer, startSample, std::min(currentBlockSize, numSamples - startSample));
+}
+
+template <typename SampleType>
+void SoundTouchWrapper::processChunk(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    // Step 1: Interleave and feed input samples to SoundTouch. SoundTouch works
+    // in float, so double input is narrowed here as part of the same pass.
+    getKernels<SampleType>().interleave(buffer.getArrayOfReadPointers(), startSample, interleavedBuffer.data(),
+                                        numSamples, currentNumChannels);
+    
+    processInterleavedChunk(interleavedBuffer.data(), buffer, startSample, numSamples);
+}
+
+template <typename SampleType>
+void SoundTouchWrapper::processInterleavedChunk(const float* input, juce::AudioBuffer<SampleType>& buffer,
+                                                int startSample, int numSamples)
+{
+    const int numChannels = currentNumChannels;
+    
+    applySmoothedRatios(numSamples);
+    engine->processor->putSamples(input, numSamples);
+    
+    // Step 2: Receive all available samples from SoundTouch and add to FIFO.
+    // During a crossfade the outgoing engine hears the same input.
+    int droppedFrames = receiveIntoFifo(*engine);
+    
+    if (outgoing != nullptr)
+    {
+        outgoing->processor->putSamples(input, numSamples);
+        droppedFrames += receiveIntoFifo(*outgoing);
+    }
+    
+    stats.droppedFrames.fetch_add(droppedFrames, std::memory_order_relaxed);
+    
+    if (standby != nullptr)
+        advanceStandby(input, numSamples);
+    
+    const int availableInFifo = engine->outputFifo->getNumReady() / numChannels;
     
     // Step 3: Read samples from FIFO to output buffer
-    // IMPORTANT: Only process if we have enough samples to fill the entire buffer
-    // Otherwise, pass through the dry signal to avoid dropouts
-    const int availableInFifo = outputFifo->getNumReady() / numChannels;
+    bool processed = false;
     
-    if (availableInFifo >= numSamples)
+    if (outgoing == nullptr)
     {
-        // We have enough samples - clear buffer and fill with processed audio
-        buffer.clear();
-        
-        int start1, size1, start2, size2;
-        outputFifo->prepareToRead(numSamples * numChannels, start1, size1, start2, size2);
-        
-        // De-interleave samples from FIFO to output buffer
-        int sampleIndex = 0;
-        
-        // Process first block
-        for (int i = 0; i < size1; i += numChannels)
-        {
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                buffer.setSample(ch, sampleIndex, fifoBuffer[static_cast<size_t>(start1 + i + ch)]);
-            }
-            sampleIndex++;
-        }
-        
-        // Process second block (if wrapped)
-        for (int i = 0; i < size2; i += numChannels)
-        {
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                buffer.setSample(ch, sampleIndex, fifoBuffer[static_cast<size_t>(start2 + i + ch)]);
-            }
-            sampleIndex++;
-        }
+        processed = readFromFifo(*engine, buffer, startSample, numSamples);
+    }
+    else
+    {
+        processed = readFromFifo(*outgoing, buffer, startSample, numSamples);
+        mixIncoming(buffer, startSample, numSamples);
         
-        outputFifo->finishedRead(numSamples * numChannels);
+        if (crossfadePosition >= warmUpFrames + fadeFrames)
+            finishCrossfade();
     }
-    // else: keep the input buffer unchanged (dry signal passes through)
     
-    // Debug output
-    static int blockCount = 0;
-    blockCount++;
-    if (blockCount <= 30)
+    stats.inputFrames.fetch_add(numSamples, std::memory_order_relaxed);
+    (processed ? stats.outputFrames : stats.dryFrames).fetch_add(numSamples, std::memory_order_relaxed);
+    stats.fifoFrames.store(engine->outputFifo->getNumReady() / numChannels, std::memory_order_relaxed);
+    
+    // Logged once per run of short or overfull chunks, not for every chunk in it
+    if (! processed && ! inUnderrun)
     {
-        DBG("Block " << blockCount << ": Put " << numSamples 
-            << " samples, FIFO has " << availableInFifo << " samples"
-            << ", " << (availableInFifo >= numSamples ? "PROCESSED" : "PASSTHROUGH"));
+        stats.underruns.fetch_add(1, std::memory_order_relaxed);
+        realtimeLog->post(RealtimeLog::Event::Underrun, logSource, numSamples, availableInFifo);
     }
+    
+    if (droppedFrames > 0 && ! inOverrun)
+        realtimeLog->post(RealtimeLog::Event::Overrun, logSource, droppedFrames);
+    
+    inUnderrun = ! processed;
+    inOverrun = droppedFrames > 0;
+    
+   #if JUCE_DEBUG
+    if (tracedChunks < TRACED_CHUNKS)
+        realtimeLog->post(RealtimeLog::Event::ChunkProcessed, logSource, ++tracedChunks, numSamples, availableInFifo);
+   #endif
+}
+
+// IMPORTANT: Only reads if the FIFO holds enough samples to fill the entire range.
+// Otherwise the input is left in place, passing the dry signal through to avoid dropouts.
+template <typename SampleType>
+bool SoundTouchWrapper::readFromFifo(EngineState& state, juce::AudioBuffer<SampleType>& buffer,
+                                     int startSample, int numSamples)
+{
+    const int numChannels = currentNumChannels;
+    auto& outputFifo = *state.outputFifo;
+    auto& fifoBuffer = state.fifoBuffer;
+    
+    if (outputFifo.getNumReady() / numChannels < numSamples)
+        return false;
+    
+    int start1, size1, start2, size2;
+    outputFifo.prepareToRead(numSamples * numChannels, start1, size1, start2, size2);
+    
+    // De-interleave samples from FIFO to output buffer, then the wrapped part if any
+    const int framesInFirstBlock = size1 / numChannels;
+    const auto& kernels = getKernels<SampleType>();
+    auto* const* destinations = buffer.getArrayOfWritePointers();
+    
+    kernels.deinterleave(fifoBuffer.data() + start1, destinations, startSample, framesInFirstBlock, numChannels);
+    kernels.deinterleave(fifoBuffer.data() + start2, destinations, startSample + framesInFirstBlock,
+                         numSamples - framesInFirstBlock, numChannels);
+    
+    outputFifo.finishedRead(numSamples * numChannels);
+    return true;
+}
+
+// Blends the incoming engine over the outgoing output already in the buffer,
+// with equal-power gains so the level holds between unrelated settings. The
+// incoming FIFO is drained during warm-up as well, keeping its latency steady.
+// The fade only moves on with chunks the incoming engine could fill, so a run
+// of short ones holds it rather than using it up and cutting over at the end.
+template <typename SampleType>
+void SoundTouchWrapper::mixIncoming(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = currentNumChannels;
+    auto& outputFifo = *engine->outputFifo;
+    const auto& fifoBuffer = engine->fifoBuffer;
+    
+    if (outputFifo.getNumReady() / numChannels < numSamples)
+        return;
+    
+    const int fadeStart = warmUpFrames - crossfadePosition;
+    crossfadePosition += numSamples;
+    
+    int start1, size1, start2, size2;
+    outputFifo.prepareToRead(numSamples * numChannels, start1, size1, start2, size2);
+    std::copy_n(fifoBuffer.begin() + start1, size1, incomingBuffer.begin());
+    std::copy_n(fifoBuffer.begin() + start2, size2, incomingBuffer.begin() + size1);
+    outputFifo.finishedRead(size1 + size2);
+    
+    if (fadeStart >= numSamples)
+        return;
+    
+    getKernels<SampleType>().crossfade(incomingBuffer.data(), buffer.getArrayOfWritePointers(), startSample,
+                                       numSamples, fadeStart, fadeFrames, numChannels);
+}
+
+void SoundTouchWrapper::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    processBlockInternal(buffer);
+}
+
+void SoundTouchWrapper::processBlock(juce::AudioBuffer<double>& buffer)
+{
+    processBlockInternal(buffer);
+}
+
+void SoundTouchWrapper::processInterleaved(const float* input, juce::AudioBuffer<float>& output)
+{
+    if (! isPrepared || output.getNumChannels() != currentNumChannels)
+        return;
+    
+    jassert(output.getNumSamples() <= currentBlockSize);
+    takeUpPendingStandby();
+    
+    if (! holdsPendingState)
+        swapInPendingState();
+    
+    processInterleavedChunk(input, output, 0, output.getNumSamples());
+}
+
+void SoundTouchWrapper::processInterleaved(const float* input, juce::AudioBuffer<double>& output)
+{
+    if (! isPrepared || output.getNumChannels() != currentNumChannels)
+        return;
+    
+    jassert(output.getNumSamples() <= currentBlockSize);
+    takeUpPendingStandby();
+    
+    if (! holdsPendingState)
+        swapInPendingState();
+    
+    processInterleavedChunk(input, output, 0, output.getNumSamples());
 }
 
 int SoundTouchWrapper::getLatencyInSamples() const
@@ -223,8 +746,11 @@ int SoundTouchWrapper::getLatencyInSamples() const
     // Total latency includes:
     // 1. Samples waiting in SoundTouch's input buffer
     // 2. Samples waiting in our output FIFO
-    const int unprocessedSamples = static_cast<int>(processor->numUnprocessedSamples());
-    const int fifoSamples = outputFifo ? (outputFifo->getNumReady() / currentNumChannels) : 0;
+    if (engine == nullptr)
+        return 0;
+    
+    const int unprocessedSamples = engine->processor->getNumUnprocessedFrames();
+    const int fifoSamples = engine->outputFifo->getNumReady() / currentNumChannels;
     
     return unprocessedSamples + fifoSamples;
 }
@@ -239,43 +765,89 @@ float SoundTouchWrapper::percentageToNative(float percentage)
     return 1.0f + (percentage / 100.0f);
 }
 
-void SoundTouchWrapper::setBufferingMode(int mode)
+void SoundTouchWrapper::configure(const Configuration& newConfiguration)
 {
-    if (mode < 1 || mode > 3 || mode == bufferingMode)
+    takeUpSwappedStandby();
+    
+    if (newConfiguration == configuration)
         return;
-        
-    bufferingMode = mode;
     
-    // Re-initialize FIFO buffer with new size based on buffering mode
-    if (currentBlockSize > 0 && currentNumChannels > 0)
+    configuration = newConfiguration;
+    activeEngineType = chooseEngineType(stretchFactor.load());
+    
+    // Build the new engine and resized FIFO here; the audio thread picks them up
+    // at its next block
+    if (isPrepared)
     {
-        int fifoSize;
-        
-        switch (bufferingMode)
-        {
-            case 1: // Minimal - smaller buffer for lower latency
-                fifoSize = std::max(4096, currentBlockSize * 8);
-                break;
-                
-            case 2: // Normal - current default
-                fifoSize = std::max(16384, currentBlockSize * 32);
-                break;
-                
-            case 3: // Extra - double the normal buffer
-                fifoSize = std::max(32768, currentBlockSize * 64);
-                break;
-                
-            default:
-                fifoSize = std::max(16384, currentBlockSize * 32);
-                break;
-        }
-        
-        outputFifo = std::make_unique<juce::AbstractFifo>(fifoSize);
-        fifoBuffer.resize(static_cast<size_t>(fifoSize * currentNumChannels));
+        publishEngineState(createEngineState(configuration, activeEngineType));
         
-        // Clear the processor to ensure clean state
-        processor->clear();
-        
-        DBG("Buffering mode changed to " << mode << ", FIFO size: " << fifoSize);
+       #if JUCE_DEBUG
+        realtimeLog->post(RealtimeLog::Event::EngineReconfigured, logSource, static_cast<double>(activeEngineType),
+                  getFifoSizeForMode(configuration.bufferingMode, currentBlockSize));
+       #endif
+    }
+}
+
+void SoundTouchWrapper::setEngineType(TimeStretchEngine::Type type)
+{
+    auto newConfiguration = configuration;
+    newConfiguration.engineType = type;
+    configure(newConfiguration);
+}
+
+void SoundTouchWrapper::setBufferingMode(int mode)
+{
+    if (mode < 1 || mode > 4)
+        return;
+    
+    auto newConfiguration = configuration;
+    newConfiguration.bufferingMode = mode;
+    configure(newConfiguration);
+}
+
+void SoundTouchWrapper::setQualityMode(int mode)
+{
+    if (mode < 1 || mode > 5)
+        return;
+    
+    auto newConfiguration = configuration;
+    newConfiguration.qualityMode = mode;
+    configure(newConfiguration);
+}
+
+void SoundTouchWrapper::crossfadeTo(const Configuration& newConfiguration, float pitch, float tempo, float rate)
+{
+    takeUpSwappedStandby();
+    configuration = newConfiguration;
+    activeEngineType = chooseEngineType(getStretchFactor(pitch, tempo));
+    
+    // Nothing is running yet, so prepare() simply starts with these
+    if (! isPrepared)
+    {
+        pitchRatio.setCurrentAndTargetValue(pitch);
+        tempoRatio.setCurrentAndTargetValue(tempo);
+        rateRatio.setCurrentAndTargetValue(rate);
+        updateStretchFactor();
+        return;
     }
-}
\ No newline at end of file
+    
+    auto state = createEngineState(configuration, activeEngineType);
+    state->hasOwnRatios = true;
+    state->pitch = pitch;
+    state->tempo = tempo;
+    state->rate = rate;
+    publishEngineState(std::move(state));
+}
+
+SoundTouchWrapper::Stats SoundTouchWrapper::getStats() const
+{
+    Stats result;
+    result.inputFrames = stats.inputFrames.load(std::memory_order_relaxed);
+    result.outputFrames = stats.outputFrames.load(std::memory_order_relaxed);
+    result.dryFrames = stats.dryFrames.load(std::memory_order_relaxed);
+    result.droppedFrames = stats.droppedFrames.load(std::memory_order_relaxed);
+    result.underruns = stats.underruns.load(std::memory_order_relaxed);
+    result.crossfades = stats.crossfades.load(std::memory_order_relaxed);
+    result.fifoFrames = stats.fifoFrames.load(std::memory_order_relaxed);
+    return result;
+}
@@ -22,12 +22,10 @@
 #pragma once
 
 #include <JuceHeader.h>
-// Handle both system and fetched SoundTouch includes
-#if __has_include(<soundtouch/SoundTouch.h>)
-    #include <soundtouch/SoundTouch.h>
-#else
-    #include <SoundTouch.h>
-#endif
+#include "TimeStretchEngine.h"
+#include "SoundTouchCore.h"
+#include "RealtimeLog.h"
+#include <atomic>
 #include <memory>
 
 class SoundTouchWrapper
@@ -36,36 +34,310 @@ public:
     SoundTouchWrapper();
     ~SoundTouchWrapper();
     
+    // Re-preparing with unchanged settings only resets, taking up any pending
+    // rebuild at once; anything else rebuilds
     void prepare(double sampleRate, int blockSize, int numChannels);
     
+    // Rewinds SoundTouch and the output FIFO after a transport jump without
+    // freeing or allocating, then re-primes to the same latency prepare() gives.
+    // A crossfade in progress is cut short in favour of the incoming engine.
+    // Safe to call on the audio thread between blocks.
+    void reset();
+    
+    // Ratio changes glide to the new value over RATIO_SMOOTHING_SECONDS, applied
+    // once per processed chunk, so jumps in automation don't click
     void setPitch(float semitones);
     void setTempo(float percentage);
     void setRate(float percentage);
     
+    static constexpr double RATIO_SMOOTHING_SECONDS = 0.05;
+    
+    // Processes every channel of the buffer in place. The channel count must
+    // match the one passed to prepare(); a mismatched buffer passes through dry.
+    // The double overload converts while interleaving, with no extra copies.
     void processBlock(juce::AudioBuffer<float>& buffer);
+    void processBlock(juce::AudioBuffer<double>& buffer);
+    
+    // For one input fanned out to several wrappers (see OutputLayers): the
+    // caller interleaves and narrows the input once and every wrapper reads that
+    // copy. The output needs the prepared channel count and at most the prepared
+    // block size in frames. Where the FIFO runs short it is left as it is, so
+    // fill it with the dry input first to get processBlock()'s fallback.
+    void processInterleaved(const float* input, juce::AudioBuffer<float>& output);
+    void processInterleaved(const float* input, juce::AudioBuffer<double>& output);
     
     int getLatencyInSamples() const;
     
+    // The delay to report to the host: the silence every stream starts with,
+    // which is the engine's initial latency plus, unless the engine has a
+    // constant latency, a block of slack. Exact for the Live engine; the others
+    // drift around it as they splice. Updated when a new engine is swapped in;
+    // readable from any thread.
+    int getReportedLatencySamples() const { return reportedLatencySamples.load(); }
+    
+    // Output still to come once input stops: the input SoundTouch holds back,
+    // stretched by the current tempo/rate, plus the FIFO's priming. Updated on
+    // the audio thread whenever the ratios change; readable from any thread.
+    int getTailLengthSamples() const { return tailLengthSamples.load(); }
+    
+    int getNumChannels() const { return currentNumChannels; }
+    
     static float semitonesToNative(float semitones);
     static float percentageToNative(float percentage);
     
-    // Buffering mode: 1=Minimal, 2=Normal, 3=Extra
+    // Which engine runs and how it is buffered and tuned.
+    // Buffering mode: 1=Minimal, 2=Normal, 3=Extra, 4=Live (for the Live engine)
+    // Quality mode: 1=Fast, 2=Balanced, 3=High, 4=Monophonic (for the PSOLA engine),
+    // 5=Speech (for the band-split engine)
+    struct Configuration
+    {
+        TimeStretchEngine::Type engineType = TimeStretchEngine::Type::Standard;
+        int bufferingMode = 2;
+        int qualityMode = 3;
+        
+        // A preset's own tuning for the Standard engine, in place of the
+        // quality mode's (see PresetBank)
+        bool hasTuning = false;
+        TimeStretchEngine::Tuning tuning;
+        
+        bool operator== (const Configuration& other) const
+        {
+            return engineType == other.engineType && bufferingMode == other.bufferingMode
+                && qualityMode == other.qualityMode && hasTuning == other.hasTuning
+                && (! hasTuning || tuning == other.tuning);
+        }
+        
+        bool operator!= (const Configuration& other) const { return ! operator== (other); }
+    };
+    
+    // Any change rebuilds the engine and FIFO on the calling thread, which must
+    // never be the audio thread. The new state is handed over lock-free and
+    // taken up at the start of the next processBlock(), where it runs alongside
+    // the old one until its priming has played out and is then crossfaded in.
+    // The old state is freed by the next releaseRetiredState() call after the
+    // crossfade, also off the audio thread.
+    void configure(const Configuration& newConfiguration);
+    const Configuration& getConfiguration() const { return configuration; }
+    
+    // Shorthands for configure() that change a single field
+    void setEngineType(TimeStretchEngine::Type type);
     void setBufferingMode(int mode);
+    void setQualityMode(int mode);
+    TimeStretchEngine::Type getEngineType() const { return configuration.engineType; }
+    int getBufferingMode() const { return configuration.bufferingMode; }
+    int getQualityMode() const { return configuration.qualityMode; }
+    
+    // A configuration and all three native ratios in one rebuild and crossfade,
+    // for switching between complete settings such as presets. Same threading
+    // rules as configure(). The new engine starts at these ratios without
+    // smoothing; ratio changes made while it is pending are replaced by them.
+    void crossfadeTo(const Configuration& newConfiguration, float pitch, float tempo, float rate);
+    
+    // A second engine for settings likely to be switched to next, built with
+    // the same threading as crossfadeTo() and then fed the same input as the
+    // running one, so that swapping it in crossfades at once with nothing to
+    // build or warm up. It costs a second engine's processing for as long as
+    // it is kept. The key tells the owner which settings it holds; preparing
+    // another standby replaces it.
+    void prepareStandby(const Configuration& standbyConfiguration, float pitch, float tempo, float rate, int key);
+    void clearStandby();
+    
+    // Audio thread only: whether the standby for this key is running and a
+    // swap can start now, with no crossfade or pending state in the way
+    bool isStandbyReady(int key) const;
+    void swapInStandby();
+    
+    // Stretching by this factor or more, either way, moves a Standard or
+    // HighQuality configuration over to the phase vocoder, where WSOLA's
+    // repeated splices turn into audible stutter. It moves back once the factor
+    // drops below the release point, so hovering near the threshold doesn't
+    // keep rebuilding.
+    static constexpr float PHASE_VOCODER_THRESHOLD = 4.0f;
+    static constexpr float PHASE_VOCODER_RELEASE = 3.0f;
+    
+    // Polled off the audio thread: rebuilds and crossfades to the engine the
+    // current stretch factor calls for, if that changed. Returns true if it
+    // published a new engine. configure() and crossfadeTo() choose the same way.
+    bool updateAutomaticEngine();
+    
+    // The engine type last built, which may differ from the configured one
+    TimeStretchEngine::Type getActiveEngineType() const { return activeEngineType; }
+    
+    bool hasPendingState() const { return pendingState.load() != nullptr; }
+    bool isCrossfading() const { return outgoing != nullptr; }
+    void releaseRetiredState();
+    
+    // Processing swaps a pending state in by itself. Wrappers that share a
+    // stream (channel groups of one layout) hold that back instead, and the
+    // owner swaps them all on the same block once every one isReadyToSwap(),
+    // so they never run different engines at different latencies.
+    void setHoldsPendingState(bool shouldHold) { holdsPendingState = shouldHold; }
+    
+    // Audio thread only
+    bool isReadyToSwap() const;
+    void swapInPendingState();
+    
+    static constexpr double CROSSFADE_MS = 10.0;
+    
+    // Running totals since prepare(), kept the same way for every engine. Written
+    // on the audio thread and readable from any thread.
+    struct Stats
+    {
+        juce::int64 inputFrames = 0;
+        juce::int64 outputFrames = 0;   // Frames played from the engine
+        juce::int64 dryFrames = 0;      // Frames passed through dry because the FIFO ran short
+        juce::int64 droppedFrames = 0;  // Engine output lost to a full FIFO
+        juce::int64 underruns = 0;      // Runs of dry chunks, counted as each starts
+        juce::int64 crossfades = 0;
+        int fifoFrames = 0;             // FIFO fill after the last chunk
+    };
+    
+    Stats getStats() const;
+    
+    // Engines interleave all channels into a single stream, so any layout up
+    // to this size (mono through 7.1.4 and discrete) runs in one instance.
+    static constexpr int MAX_CHANNELS = TimeStretchEngine::MAX_CHANNELS;
     
 private:
-    std::unique_ptr<soundtouch::SoundTouch> processor;
+    // Everything a mode change has to reallocate, built as one unit so the audio
+    // thread can take it over with a single pointer swap
+    struct EngineState
+    {
+        std::unique_ptr<TimeStretchEngine> processor;
+        std::unique_ptr<juce::AbstractFifo> outputFifo;
+        std::vector<float> fifoBuffer;
+        
+        // What it was built for; never changed afterwards
+        Configuration configuration;
+        TimeStretchEngine::Type engineType = TimeStretchEngine::Type::Standard;
+        int standbyKey = -1;
+        
+        // Ratios to start with instead of the current ones (see crossfadeTo())
+        bool hasOwnRatios = false;
+        float pitch = 1.0f;
+        float tempo = 1.0f;
+        float rate = 1.0f;
+    };
+    
+    std::unique_ptr<EngineState> createEngineState(const Configuration& stateConfiguration,
+                                                   TimeStretchEngine::Type type) const;
+    void publishEngineState(std::unique_ptr<EngineState> state);
+    bool canStartSwap() const;
+    void beginCrossfade(std::unique_ptr<EngineState> next, int warmUp);
+    void adoptOwnRatios(const EngineState& state);
+    void takeUpPendingStandby();
+    void advanceStandby(const float* input, int numSamples);
+    void takeUpSwappedStandby();
+    void primeOutputFifo(EngineState& state) const;
+    int getPrimingFrames(const EngineState& state) const;
+    void updateTailLength();
+    int receiveIntoFifo(EngineState& state);
+    void finishCrossfade();
+    void applySmoothedRatios(int numSamples);
+    void updateStretchFactor();
+    TimeStretchEngine::Type chooseEngineType(float stretch) const;
+    static TimeStretchEngine::Type chooseEngineType(const Configuration& stateConfiguration,
+                                                    TimeStretchEngine::Type current, float stretch);
+    static float getStretchFactor(float pitch, float tempo);
+    
+    template <typename SampleType>
+    void processBlockInternal(juce::AudioBuffer<SampleType>& buffer);
+    
+    template <typename SampleType>
+    void processChunk(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    
+    template <typename SampleType>
+    void processInterleavedChunk(const float* input, juce::AudioBuffer<SampleType>& buffer,
+                                 int startSample, int numSamples);
+    
+    template <typename SampleType>
+    bool readFromFifo(EngineState& state, juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    
+    template <typename SampleType>
+    void mixIncoming(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    static int getFifoSizeForMode(int mode, int blockSize);
+    
+    template <typename SampleType>
+    const SoundTouchKernels<SampleType>& getKernels() const
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatKernels;
+        else
+            return doubleKernels;
+    }
+        
+    // Owned by the audio thread once prepared; replaced only by swapInPendingState()
+    std::unique_ptr<EngineState> engine;
+    std::atomic<EngineState*> pendingState { nullptr };
+    std::atomic<EngineState*> retiredState { nullptr };
+    
+    // The state being faded out after a swap (audio thread only). It keeps
+    // processing the same input until the crossfade ends, then is retired.
+    std::unique_ptr<EngineState> outgoing;
+    
+    // The standby is handed over like a pending state and, once running, owned
+    // by the audio thread, which retires the one it replaces. swappedStandby
+    // tells the worker whose settings are running after swapInStandby(); the
+    // state stays alive until the worker itself frees it.
+    std::unique_ptr<EngineState> standby;
+    std::atomic<EngineState*> pendingStandby { nullptr };
+    std::atomic<EngineState*> retiredStandby { nullptr };
+    std::atomic<const EngineState*> swappedStandby { nullptr };
+    std::atomic<bool> standbyCleared { false };
+    int crossfadePosition = 0;
+    int warmUpFrames = 0;
+    int fadeFrames = 1;
+    bool isPrepared = false;
+    bool holdsPendingState = false;
+    std::atomic<int> tailLengthSamples { 0 };
+    std::atomic<int> reportedLatencySamples { 0 };
+    
+    // Native ratios set from the audio thread; the targets carry over to
+    // swapped-in state
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> pitchRatio { 1.0f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> tempoRatio { 1.0f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> rateRatio { 1.0f };
+    
+    struct AtomicStats
+    {
+        std::atomic<juce::int64> inputFrames { 0 };
+        std::atomic<juce::int64> outputFrames { 0 };
+        std::atomic<juce::int64> dryFrames { 0 };
+        std::atomic<juce::int64> droppedFrames { 0 };
+        std::atomic<juce::int64> underruns { 0 };
+        std::atomic<juce::int64> crossfades { 0 };
+        std::atomic<int> fifoFrames { 0 };
+    };
+    
+    AtomicStats stats;
     
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     int currentNumChannels = 2;
     
+    // Sized for currentBlockSize frames in prepare() so processBlock never allocates
     std::vector<float> interleavedBuffer;
+    std::vector<float> receiveBuffer;
+    std::vector<float> incomingBuffer;
+    
+    // The interleave, de-interleave and crossfade loops for currentNumChannels
+    SoundTouchKernels<float> floatKernels;
+    SoundTouchKernels<double> doubleKernels;
+    
+    Configuration configuration;
+    TimeStretchEngine::Type activeEngineType = TimeStretchEngine::Type::Standard;
     
-    // FIFO buffer for output samples
-    std::unique_ptr<juce::AbstractFifo> outputFifo;
-    std::vector<float> fifoBuffer;
+    // Of the target ratios; set on the audio thread, polled off it
+    std::atomic<float> stretchFactor { 1.0f };
     
-    int bufferingMode = 2; // Default to Normal
+    // Underruns and overruns are logged as they start; debug builds also trace
+    // the first TRACED_CHUNKS chunks after prepare(). Audio thread only.
+    juce::SharedResourcePointer<RealtimeLog> realtimeLog;
+    const juce::uint32 logSource = RealtimeLog::createSourceId();
+    int tracedChunks = 0;
+    bool inUnderrun = false;
+    bool inOverrun = false;
+    static constexpr int TRACED_CHUNKS = 30;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundTouchWrapper)
 };
\ No newline at end of file
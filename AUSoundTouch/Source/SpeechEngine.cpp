@@ -0,0 +1,450 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "SpeechEngine.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Both filters are dot products over contiguous arrays. Summing into
+    // independent lanes lets the compiler vectorise without reassociating a
+    // single float sum, which it won't do under strict IEEE rules.
+    constexpr int dotProductLanes = 8;
+    
+    inline float dotProduct(const float* a, const float* b, int length)
+    {
+        float lanes[dotProductLanes] = {};
+        int i = 0;
+        
+        for (; i + dotProductLanes <= length; i += dotProductLanes)
+            for (int lane = 0; lane < dotProductLanes; ++lane)
+                lanes[lane] += a[i + lane] * b[i + lane];
+        
+        float sum = 0.0f;
+        
+        for (; i < length; ++i)
+            sum += a[i] * b[i];
+        
+        for (const float lane : lanes)
+            sum += lane;
+        
+        return sum;
+    }
+    
+    inline float catmullRom(const float* samples, double position)
+    {
+        const int index = static_cast<int>(position);
+        const float t = static_cast<float>(position - index);
+        const float ym1 = samples[index - 1];
+        const float y0 = samples[index];
+        const float y1 = samples[index + 1];
+        const float y2 = samples[index + 2];
+        
+        const float c1 = 0.5f * (y1 - ym1);
+        const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+        const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+        
+        return ((c3 * t + c2) * t + c1) * t + y0;
+    }
+}
+
+SpeechEngine::SpeechEngine(int engineQualityMode)
+    : qualityMode(engineQualityMode)
+{
+}
+
+void SpeechEngine::prepare(double sampleRate, int engineNumChannels, int maxBlockFrames)
+{
+    numChannels = engineNumChannels;
+    maxBlockSize = maxBlockFrames;
+    decimation = std::max(1, static_cast<int>(sampleRate / LOW_BAND_RATE));
+    
+    // Blackman-windowed sinc: about 74 dB down past the transition band, so
+    // decimating folds back very little
+    filterDelay = TAPS_PER_PHASE * decimation;
+    filterLength = 2 * filterDelay + 1;
+    lowPass.resize(static_cast<size_t>(filterLength));
+    
+    const double cutoff = CROSSOVER * 0.5 / decimation;
+    double sum = 0.0;
+    
+    for (int i = 0; i < filterLength; ++i)
+    {
+        const double x = static_cast<double>(i - filterDelay);
+        const double sinc = x == 0.0 ? 2.0 * cutoff
+                                     : std::sin(juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+        const double phase = juce::MathConstants<double>::twoPi * i / (filterLength - 1);
+        const double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        lowPass[static_cast<size_t>(i)] = static_cast<float>(sinc * window);
+        sum += sinc * window;
+    }
+    
+    for (auto& tap : lowPass)
+        tap = static_cast<float>(tap / sum);
+    
+    // Polyphase interpolator: phase p of each decimated frame is the filter's
+    // every decimation-th tap from p, ordered oldest sample first and scaled
+    // up for the zeros that upsampling stuffs in between
+    interpolatorLength = (filterLength + decimation - 1) / decimation;
+    interpolatorPhases.assign(static_cast<size_t>(decimation * interpolatorLength), 0.0f);
+    
+    for (int phase = 0; phase < decimation; ++phase)
+        for (int i = 0; i < interpolatorLength; ++i)
+        {
+            const int tap = phase + (interpolatorLength - 1 - i) * decimation;
+            
+            if (tap < filterLength)
+                interpolatorPhases[static_cast<size_t>(phase * interpolatorLength + i)]
+                    = static_cast<float>(decimation) * lowPass[static_cast<size_t>(tap)];
+        }
+    
+    const int lowBlockFrames = maxBlockFrames / decimation + 2;
+    lowBand = TimeStretchEngine::create(Type::Standard, qualityMode);
+    lowBand->prepare(sampleRate / decimation, numChannels, lowBlockFrames);
+    lowInput.resize(static_cast<size_t>(lowBlockFrames * numChannels));
+    lowReceived.resize(static_cast<size_t>(LOW_CHUNK_FRAMES * numChannels));
+    
+    // Periodic Hann at half overlap sums to one
+    grainFrames = std::max(32, static_cast<int>(std::lround(GRAIN_SECONDS * sampleRate)));
+    grainWindow.resize(static_cast<size_t>(2 * grainFrames));
+    
+    for (int i = 0; i < 2 * grainFrames; ++i)
+        grainWindow[static_cast<size_t>(i)] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi
+                                                                   * static_cast<float>(i) / static_cast<float>(grainFrames));
+    
+    // One side of a Blackman-windowed sinc, in zero crossings
+    sincTable.resize(static_cast<size_t>(SINC_ZERO_CROSSINGS * SINC_RESOLUTION + 2));
+    
+    for (size_t i = 0; i < sincTable.size(); ++i)
+    {
+        const double x = static_cast<double>(i) / SINC_RESOLUTION;
+        const double sinc = i == 0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const double phase = juce::MathConstants<double>::pi * (1.0 + std::min(1.0, x / SINC_ZERO_CROSSINGS));
+        const double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        sincTable[i] = static_cast<float>(sinc * window);
+    }
+    
+    // The frames kept either side of a read: the sinc reaches furthest at the
+    // highest step that still leaves some of the high band below Nyquist
+    const double maxAudibleStep = decimation / CROSSOVER;
+    highMargin = static_cast<int>(std::ceil(SINC_ZERO_CROSSINGS * maxAudibleStep / SINC_CUTOFF)) + 2;
+    
+    // The high band runs ahead of SoundTouch by up to its latency, and a grain
+    // read at the highest pitch spans ten grains of input
+    highInputCapacity = 2 * maxBlockFrames + 2 * decimation * lowBand->getInitialLatency() + 24 * grainFrames
+                      + 2 * highMargin;
+    
+    // Either band is topped up only while it is the one with nothing ready
+    outputCapacity = decimation * LOW_CHUNK_FRAMES + 2 * grainFrames + filterDelay;
+    
+    channels.resize(static_cast<size_t>(numChannels));
+    
+    for (auto& channel : channels)
+    {
+        channel.filterHistory.resize(static_cast<size_t>(2 * filterLength));
+        channel.lowHistory.resize(static_cast<size_t>(2 * interpolatorLength));
+        channel.highInput.resize(static_cast<size_t>(highInputCapacity));
+        channel.highAccumulator.resize(static_cast<size_t>(2 * grainFrames));
+        channel.lowOutput.resize(static_cast<size_t>(outputCapacity));
+        channel.highOutput.resize(static_cast<size_t>(outputCapacity));
+    }
+    
+    setRatios(1.0f, 1.0f, 1.0f);
+    clear();
+}
+
+void SpeechEngine::setRatios(float pitch, float tempo, float rate)
+{
+    lowBand->setRatios(pitch, tempo, rate);
+    
+    // Each high-band grain is read at the pitch ratio, and the next one starts
+    // a stretched hop further on
+    readStep = static_cast<double>(pitch) * rate;
+    analysisHop = static_cast<double>(grainFrames) * tempo * rate;
+    
+    // The band starts at the crossover, a fraction of the full-rate Nyquist
+    // frequency, and stepping through it multiplies every frequency
+    highBandAudible = readStep * CROSSOVER / decimation < 1.0;
+    sincScale = readStep > 1.0 ? SINC_CUTOFF / static_cast<float>(readStep) : 1.0f;
+    sincHalfSpan = std::min(highMargin - 1, static_cast<int>(std::ceil(SINC_ZERO_CROSSINGS / sincScale)));
+}
+
+void SpeechEngine::makeRoomForHighInput(int numFrames)
+{
+    if (numHighInputFrames + numFrames <= highInputCapacity)
+        return;
+    
+    // The readers look back up to highMargin frames from the next grain
+    const int consumed = std::min(numHighInputFrames, static_cast<int>(highReadPosition) - highMargin);
+    
+    if (consumed <= 0)
+        return;
+    
+    for (auto& channel : channels)
+        std::copy(channel.highInput.begin() + consumed, channel.highInput.begin() + numHighInputFrames,
+                  channel.highInput.begin());
+    
+    numHighInputFrames -= consumed;
+    highReadPosition -= consumed;
+}
+
+// Runs the crossover: the low-pass output is decimated into SoundTouch, and
+// the input less the low-pass (the centre tap is the input delayed to match)
+// becomes the high band. A null pointer splits silence.
+void SpeechEngine::splitInput(const float* interleaved, int numFrames)
+{
+    makeRoomForHighInput(numFrames);
+    
+    const int highFrames = std::min(numFrames, highInputCapacity - numHighInputFrames);
+    int numLowFrames = 0;
+    
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        filterPosition = filterPosition + 1 == filterLength ? 0 : filterPosition + 1;
+        const bool keepLow = decimationPhase == 0;
+        
+        for (int c = 0; c < numChannels; ++c)
+        {
+            auto& channel = channels[static_cast<size_t>(c)];
+            const float sample = interleaved == nullptr ? 0.0f : interleaved[frame * numChannels + c];
+            
+            channel.filterHistory[static_cast<size_t>(filterPosition)] = sample;
+            channel.filterHistory[static_cast<size_t>(filterPosition + filterLength)] = sample;
+            
+            const float* window = channel.filterHistory.data() + filterPosition + 1;
+            const float low = dotProduct(lowPass.data(), window, filterLength);
+            
+            if (frame < highFrames)
+                channel.highInput[static_cast<size_t>(numHighInputFrames + frame)] = window[filterDelay] - low;
+            
+            if (keepLow)
+                lowInput[static_cast<size_t>(numLowFrames * numChannels + c)] = low;
+        }
+        
+        numLowFrames += keepLow ? 1 : 0;
+        decimationPhase = decimationPhase + 1 == decimation ? 0 : decimationPhase + 1;
+    }
+    
+    numHighInputFrames += highFrames;
+    lowBand->putSamples(lowInput.data(), numLowFrames);
+}
+
+void SpeechEngine::putSamples(const float* interleaved, int numFrames)
+{
+    splitInput(interleaved, numFrames);
+}
+
+// Takes a chunk of stretched low band from SoundTouch and interpolates it back
+// up to the full rate
+bool SpeechEngine::receiveLowBand()
+{
+    const int maxFrames = std::min(LOW_CHUNK_FRAMES, (outputCapacity - numLowOutputFrames) / decimation);
+    const int received = maxFrames > 0 ? lowBand->receiveSamples(lowReceived.data(), maxFrames) : 0;
+    
+    for (int frame = 0; frame < received; ++frame)
+    {
+        lowPosition = lowPosition + 1 == interpolatorLength ? 0 : lowPosition + 1;
+        
+        for (int c = 0; c < numChannels; ++c)
+        {
+            auto& channel = channels[static_cast<size_t>(c)];
+            const float sample = lowReceived[static_cast<size_t>(frame * numChannels + c)];
+            
+            channel.lowHistory[static_cast<size_t>(lowPosition)] = sample;
+            channel.lowHistory[static_cast<size_t>(lowPosition + interpolatorLength)] = sample;
+            
+            const float* window = channel.lowHistory.data() + lowPosition + 1;
+            float* destination = channel.lowOutput.data() + numLowOutputFrames + frame * decimation;
+            
+            for (int phase = 0; phase < decimation; ++phase)
+                destination[phase] = dotProduct(interpolatorPhases.data() + phase * interpolatorLength,
+                                                window, interpolatorLength);
+        }
+    }
+    
+    numLowOutputFrames += received * decimation;
+    return received > 0;
+}
+
+// The high band at a fractional position, low-passed to the stepped Nyquist
+// frequency: the sinc is stretched by 1/sincScale, and scaled down to match
+float SpeechEngine::readBandLimited(const float* samples, double position) const
+{
+    const int index = static_cast<int>(position);
+    const float fraction = static_cast<float>(position - index);
+    float sum = 0.0f;
+    
+    for (int offset = 1 - sincHalfSpan; offset <= sincHalfSpan; ++offset)
+    {
+        const float x = std::abs(static_cast<float>(offset) - fraction) * sincScale * SINC_RESOLUTION;
+        const int tableIndex = static_cast<int>(x);
+        
+        if (tableIndex >= SINC_ZERO_CROSSINGS * SINC_RESOLUTION)
+            continue;
+        
+        const float t = x - static_cast<float>(tableIndex);
+        const float weight = sincTable[static_cast<size_t>(tableIndex)]
+                           + t * (sincTable[static_cast<size_t>(tableIndex + 1)] - sincTable[static_cast<size_t>(tableIndex)]);
+        sum += weight * samples[index + offset];
+    }
+    
+    return sum * sincScale;
+}
+
+// Adds one Hann grain of the high band, read at the pitch ratio, and moves a
+// hop of finished output across
+bool SpeechEngine::synthesizeHighHop()
+{
+    const int grainSpan = 2 * grainFrames;
+    const double lookahead = readStep > 1.0 ? sincHalfSpan + 1.0 : 2.0;
+    
+    if (highReadPosition + readStep * (grainSpan - 1) + lookahead >= numHighInputFrames
+        || numHighOutputFrames + grainFrames > outputCapacity)
+        return false;
+    
+    for (auto& channel : channels)
+    {
+        float* accumulator = channel.highAccumulator.data();
+        const float* input = channel.highInput.data();
+        
+        if (! highBandAudible)
+        {
+            // Nothing of the band would stay below Nyquist
+        }
+        else if (readStep <= 1.0)
+        {
+            for (int i = 0; i < grainSpan; ++i)
+                accumulator[i] += grainWindow[static_cast<size_t>(i)] * catmullRom(input, highReadPosition + readStep * i);
+        }
+        else
+        {
+            for (int i = 0; i < grainSpan; ++i)
+                accumulator[i] += grainWindow[static_cast<size_t>(i)] * readBandLimited(input, highReadPosition + readStep * i);
+        }
+        
+        std::copy_n(accumulator, grainFrames, channel.highOutput.begin() + numHighOutputFrames);
+        std::copy(accumulator + grainFrames, accumulator + grainSpan, accumulator);
+        std::fill(accumulator + grainFrames, accumulator + grainSpan, 0.0f);
+    }
+    
+    numHighOutputFrames += grainFrames;
+    highReadPosition += analysisHop;
+    return true;
+}
+
+int SpeechEngine::receiveSamples(float* interleaved, int maxFrames)
+{
+    int framesWritten = 0;
+    
+    while (framesWritten < maxFrames)
+    {
+        const int framesToMix = std::min(maxFrames - framesWritten, std::min(numLowOutputFrames, numHighOutputFrames));
+        
+        if (framesToMix > 0)
+        {
+            for (int c = 0; c < numChannels; ++c)
+            {
+                auto& channel = channels[static_cast<size_t>(c)];
+                float* destination = interleaved + framesWritten * numChannels + c;
+                
+                for (int frame = 0; frame < framesToMix; ++frame)
+                    destination[frame * numChannels] = channel.lowOutput[static_cast<size_t>(frame)]
+                                                     + channel.highOutput[static_cast<size_t>(frame)];
+                
+                std::copy(channel.lowOutput.begin() + framesToMix, channel.lowOutput.begin() + numLowOutputFrames,
+                          channel.lowOutput.begin());
+                std::copy(channel.highOutput.begin() + framesToMix, channel.highOutput.begin() + numHighOutputFrames,
+                          channel.highOutput.begin());
+            }
+            
+            numLowOutputFrames -= framesToMix;
+            numHighOutputFrames -= framesToMix;
+            framesWritten += framesToMix;
+            continue;
+        }
+        
+        if (numLowOutputFrames == 0 && receiveLowBand())
+            continue;
+        
+        if (numHighOutputFrames == 0 && synthesizeHighHop())
+            continue;
+        
+        if (pendingFlushFrames == 0)
+            break;
+        
+        // Split silence a block at a time until both bands have let everything out
+        const int silentFrames = std::min(pendingFlushFrames, maxBlockSize);
+        splitInput(nullptr, silentFrames);
+        pendingFlushFrames -= silentFrames;
+    }
+    
+    return framesWritten;
+}
+
+void SpeechEngine::flush()
+{
+    pendingFlushFrames = getInitialLatency() + maxBlockSize;
+}
+
+void SpeechEngine::clear()
+{
+    lowBand->clear();
+    
+    for (auto& channel : channels)
+    {
+        std::fill(channel.filterHistory.begin(), channel.filterHistory.end(), 0.0f);
+        std::fill(channel.lowHistory.begin(), channel.lowHistory.end(), 0.0f);
+        std::fill(channel.highAccumulator.begin(), channel.highAccumulator.end(), 0.0f);
+        
+        // The low band comes back through the interpolator's delay as well,
+        // which the high band makes up here
+        std::fill_n(channel.highOutput.begin(), filterDelay, 0.0f);
+        
+        // Silence ahead of the input for the readers to look back into
+        std::fill_n(channel.highInput.begin(), highMargin, 0.0f);
+    }
+    
+    filterPosition = 0;
+    lowPosition = 0;
+    decimationPhase = 0;
+    numHighInputFrames = highMargin;
+    highReadPosition = highMargin;
+    numLowOutputFrames = 0;
+    numHighOutputFrames = filterDelay;
+    pendingFlushFrames = 0;
+}
+
+// Both filters' delays, plus whichever band holds back more
+int SpeechEngine::getInitialLatency() const
+{
+    return 2 * filterDelay + decimation + std::max(decimation * lowBand->getInitialLatency(), 3 * grainFrames + highMargin);
+}
+
+int SpeechEngine::getNumUnprocessedFrames() const
+{
+    return decimation * lowBand->getNumUnprocessedFrames();
+}
+
+double SpeechEngine::getOutputPerInput(float tempo, float rate) const
+{
+    return 1.0 / (static_cast<double>(tempo) * rate);
+}
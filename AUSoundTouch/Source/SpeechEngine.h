@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "TimeStretchEngine.h"
+#include <memory>
+#include <vector>
+
+// Reduced-rate processing for speech, where little happens above 7 kHz. A
+// linear-phase low-pass splits each channel: the low band is decimated to
+// about 16 kHz and stretched there by SoundTouch, whose cost scales with the
+// sample rate, then interpolated back up with the same filter. The high band
+// is what the low-pass removed, and goes through plain overlap-add of Hann
+// grains, each read at the pitch ratio: fricatives and breath have no pitch
+// to splice around, so the grains need no search. When pitch and tempo are
+// equal (only Speed moves), consecutive grains read the same positions and
+// the high band reduces to a resampler.
+//
+// Grains are read by cubic interpolation at or below unity step. Reading
+// faster would fold whatever lands past Nyquist back into the band, so there
+// they are read through a windowed sinc whose cutoff drops with the step, and
+// once the whole high band would land past Nyquist it is left out.
+class SpeechEngine : public TimeStretchEngine
+{
+public:
+    explicit SpeechEngine(int qualityMode);
+    
+    void prepare(double sampleRate, int numChannels, int maxBlockFrames) override;
+    void setRatios(float pitch, float tempo, float rate) override;
+    void putSamples(const float* interleaved, int numFrames) override;
+    int receiveSamples(float* interleaved, int maxFrames) override;
+    void flush() override;
+    void clear() override;
+    
+    int getInitialLatency() const override;
+    int getNumUnprocessedFrames() const override;
+    double getOutputPerInput(float tempo, float rate) const override;
+    
+    int getDecimation() const { return decimation; }
+    
+    // The low band is decimated to at least this rate
+    static constexpr double LOW_BAND_RATE = 16000.0;
+    
+    // Crossover, as a fraction of the decimated Nyquist frequency; the rest
+    // is the filter's transition band
+    static constexpr double CROSSOVER = 0.8;
+    
+private:
+    // Filter taps per decimation step, either side of the centre tap
+    static constexpr int TAPS_PER_PHASE = 16;
+    
+    // Low-band frames taken from SoundTouch per step of receiveSamples()
+    static constexpr int LOW_CHUNK_FRAMES = 128;
+    
+    static constexpr double GRAIN_SECONDS = 0.004;
+    
+    // The band-limited reader's kernel: zero crossings either side, table
+    // points per zero crossing, and the cutoff as a fraction of the stepped
+    // Nyquist frequency
+    static constexpr int SINC_ZERO_CROSSINGS = 12;
+    static constexpr int SINC_RESOLUTION = 32;
+    static constexpr float SINC_CUTOFF = 0.8f;
+    
+    struct Channel
+    {
+        std::vector<float> filterHistory;   // Mirrored, so the filter window is contiguous
+        std::vector<float> lowHistory;      // Mirrored, for the interpolator
+        std::vector<float> highInput;
+        std::vector<float> highAccumulator;
+        std::vector<float> lowOutput;
+        std::vector<float> highOutput;
+    };
+    
+    void splitInput(const float* interleaved, int numFrames);
+    bool receiveLowBand();
+    bool synthesizeHighHop();
+    float readBandLimited(const float* samples, double position) const;
+    void makeRoomForHighInput(int numFrames);
+    
+    int qualityMode = 3;
+    int numChannels = 2;
+    int maxBlockSize = 512;
+    int decimation = 3;
+    int filterLength = 97;
+    int filterDelay = 48;
+    int interpolatorLength = 33;
+    int grainFrames = 192;
+    
+    std::vector<float> lowPass;
+    std::vector<float> interpolatorPhases;   // decimation rows of interpolatorLength
+    std::vector<Channel> channels;
+    int filterPosition = 0;
+    int lowPosition = 0;
+    int decimationPhase = 0;
+    
+    std::unique_ptr<TimeStretchEngine> lowBand;
+    std::vector<float> lowInput;
+    std::vector<float> lowReceived;
+    
+    std::vector<float> grainWindow;
+    std::vector<float> sincTable;
+    int highMargin = 1;
+    int highInputCapacity = 0;
+    int numHighInputFrames = 0;
+    double highReadPosition = 1.0;
+    double analysisHop = 0.0;
+    double readStep = 1.0;
+    float sincScale = 1.0f;       // Zero crossings per input frame at the current step
+    int sincHalfSpan = 1;
+    bool highBandAudible = true;
+    
+    int outputCapacity = 0;
+    int numLowOutputFrames = 0;
+    int numHighOutputFrames = 0;
+    int pendingFlushFrames = 0;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpeechEngine)
+};
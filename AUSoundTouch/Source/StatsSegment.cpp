@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "StatsSegment.h"
+#include <cstring>
+
+#if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+ #define AUSOUNDTOUCH_STATS_SEGMENT 1
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#else
+ #define AUSOUNDTOUCH_STATS_SEGMENT 0
+#endif
+
+StatsSegment::StatsSegment(const juce::String& name, bool create)
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    const int descriptor = shm_open(name.toRawUTF8(), create ? (O_RDWR | O_CREAT) : O_RDWR, 0600);
+    
+    if (descriptor < 0)
+        return;
+    
+    // New segments come back empty; growing one that another process sized
+    // already is a no-op. Either way it reads as zeros until written.
+    struct stat status {};
+    const bool sized = fstat(descriptor, &status) == 0
+                    && (status.st_size >= static_cast<off_t>(sizeof(Table))
+                        || (create && ftruncate(descriptor, static_cast<off_t>(sizeof(Table))) == 0));
+    
+    if (sized)
+    {
+        void* address = mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        
+        if (address != MAP_FAILED)
+            table = static_cast<Table*>(address);
+    }
+    
+    close(descriptor);
+   #else
+    juce::ignoreUnused(name, create);
+   #endif
+}
+
+StatsSegment::~StatsSegment()
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    if (table != nullptr)
+        munmap(table, sizeof(Table));
+   #endif
+}
+
+void StatsSegment::remove(const juce::String& name)
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    shm_unlink(name.toRawUTF8());
+   #else
+    juce::ignoreUnused(name);
+   #endif
+}
+
+int StatsSegment::getCurrentProcessId()
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    return static_cast<int>(getpid());
+   #else
+    return 0;
+   #endif
+}
+
+bool StatsSegment::isProcessAlive(int processId)
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    return processId > 0 && (kill(processId, 0) == 0 || errno == EPERM);
+   #else
+    juce::ignoreUnused(processId);
+    return false;
+   #endif
+}
+
+// Takes the first free slot, or failing that one left claimed, or part way
+// through being claimed, by a process that has since died. Returns -1 if the
+// table is full or closed.
+int StatsSegment::claim(juce::uint32 instanceId, const juce::String& processName)
+{
+   #if AUSOUNDTOUCH_STATS_SEGMENT
+    if (table == nullptr)
+        return -1;
+    
+    const int processId = getCurrentProcessId();
+    
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int index = 0; index < MAX_SLOTS; ++index)
+        {
+            auto& slot = table->slots[static_cast<size_t>(index)];
+            auto owner = slot.owner.load(std::memory_order_relaxed);
+            
+            const bool available = pass == 0 ? getState(owner) == slotFree
+                                             : getState(owner) != slotFree && ! isProcessAlive(getProcessId(owner));
+            
+            if (! available || ! slot.owner.compare_exchange_strong(owner, makeOwner(slotClaiming, processId),
+                                                                    std::memory_order_acquire))
+                continue;
+            
+            // Readers skip claiming slots, and the sequence catches any that
+            // started reading before the claim. A dead owner may have left it
+            // odd, so round it up rather than flip it.
+            const auto sequence = slot.sequence.load(std::memory_order_relaxed) | 1u;
+            slot.sequence.store(sequence, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            
+            slot.instanceId.store(instanceId, std::memory_order_relaxed);
+            writeProcessName(slot, processName);
+            slot.lastUpdateMs.store(0, std::memory_order_relaxed);
+            slot.realtimeFactor.store(0.0, std::memory_order_relaxed);
+            slot.p99BlockMs.store(0.0, std::memory_order_relaxed);
+            slot.latencyMs.store(0.0, std::memory_order_relaxed);
+            slot.dspLoad.store(0.0f, std::memory_order_relaxed);
+            slot.underruns.store(0, std::memory_order_relaxed);
+            slot.droppedFrames.store(0, std::memory_order_relaxed);
+            slot.qualityMode.store(0, std::memory_order_relaxed);
+            slot.bufferingMode.store(0, std::memory_order_relaxed);
+            
+            slot.sequence.store(sequence + 1, std::memory_order_release);
+            slot.owner.store(makeOwner(slotClaimed, processId), std::memory_order_release);
+            return index;
+        }
+    }
+   #else
+    juce::ignoreUnused(instanceId, processName);
+   #endif
+    
+    return -1;
+}
+
+void StatsSegment::release(int index)
+{
+    table->slots[static_cast<size_t>(index)].owner.store(makeOwner(slotFree, 0), std::memory_order_release);
+}
+
+void StatsSegment::writeProcessName(SlotData& slot, const juce::String& processName)
+{
+    std::array<char, MAX_PROCESS_NAME> bytes {};
+    processName.copyToUTF8(bytes.data(), bytes.size() - 1);
+    
+    for (size_t word = 0; word < slot.processName.size(); ++word)
+    {
+        juce::uint64 value = 0;
+        std::memcpy(&value, bytes.data() + word * sizeof(value), sizeof(value));
+        slot.processName[word].store(value, std::memory_order_relaxed);
+    }
+}
+
+juce::String StatsSegment::readProcessName(const SlotData& slot)
+{
+    std::array<char, MAX_PROCESS_NAME + 1> bytes {};
+    
+    for (size_t word = 0; word < slot.processName.size(); ++word)
+    {
+        const juce::uint64 value = slot.processName[word].load(std::memory_order_relaxed);
+        std::memcpy(bytes.data() + word * sizeof(value), &value, sizeof(value));
+    }
+    
+    return juce::String::fromUTF8(bytes.data());
+}
+
+std::vector<StatsSegment::Instance> StatsSegment::readInstances() const
+{
+    std::vector<Instance> instances;
+    
+    if (table == nullptr)
+        return instances;
+    
+    for (int index = 0; index < MAX_SLOTS; ++index)
+    {
+        const auto& slot = table->slots[static_cast<size_t>(index)];
+        
+        const auto owner = slot.owner.load(std::memory_order_acquire);
+        
+        if (getState(owner) != slotClaimed)
+            continue;
+        
+        // A writer publishes a few times a second, so a torn read is rare and
+        // the next try almost always succeeds; give up on the slot after a few
+        constexpr int maxAttempts = 8;
+        
+        for (int attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            
+            if ((before & 1) != 0)
+                continue;
+            
+            Instance instance;
+            instance.slot = index;
+            instance.processId = getProcessId(owner);
+            instance.instanceId = slot.instanceId.load(std::memory_order_relaxed);
+            instance.processName = readProcessName(slot);
+            instance.lastUpdateMs = slot.lastUpdateMs.load(std::memory_order_relaxed);
+            instance.stats.realtimeFactor = slot.realtimeFactor.load(std::memory_order_relaxed);
+            instance.stats.p99BlockMs = slot.p99BlockMs.load(std::memory_order_relaxed);
+            instance.stats.latencyMs = slot.latencyMs.load(std::memory_order_relaxed);
+            instance.stats.dspLoad = slot.dspLoad.load(std::memory_order_relaxed);
+            instance.stats.underruns = slot.underruns.load(std::memory_order_relaxed);
+            instance.stats.droppedFrames = slot.droppedFrames.load(std::memory_order_relaxed);
+            instance.stats.qualityMode = slot.qualityMode.load(std::memory_order_relaxed);
+            instance.stats.bufferingMode = slot.bufferingMode.load(std::memory_order_relaxed);
+            
+            std::atomic_thread_fence(std::memory_order_acquire);
+            
+            if (slot.sequence.load(std::memory_order_relaxed) != before)
+                continue;
+            
+            if (slot.owner.load(std::memory_order_relaxed) == owner && isProcessAlive(instance.processId))
+                instances.push_back(std::move(instance));
+            
+            break;
+        }
+    }
+    
+    return instances;
+}
+
+StatsSegment::Slot::Slot(StatsSegment& owner, juce::uint32 instanceId, const juce::String& processName)
+    : segment(owner),
+      index(owner.claim(instanceId, processName))
+{
+}
+
+StatsSegment::Slot::~Slot()
+{
+    if (index >= 0)
+        segment.release(index);
+}
+
+void StatsSegment::Slot::publish(const Stats& stats) noexcept
+{
+    if (index < 0)
+        return;
+    
+    auto& slot = segment.table->slots[static_cast<size_t>(index)];
+    
+    // Only this slot's owner writes to it, so a plain increment suffices
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    slot.lastUpdateMs.store(juce::Time::currentTimeMillis(), std::memory_order_relaxed);
+    slot.realtimeFactor.store(stats.realtimeFactor, std::memory_order_relaxed);
+    slot.p99BlockMs.store(stats.p99BlockMs, std::memory_order_relaxed);
+    slot.latencyMs.store(stats.latencyMs, std::memory_order_relaxed);
+    slot.dspLoad.store(stats.dspLoad, std::memory_order_relaxed);
+    slot.underruns.store(stats.underruns, std::memory_order_relaxed);
+    slot.droppedFrames.store(stats.droppedFrames, std::memory_order_relaxed);
+    slot.qualityMode.store(stats.qualityMode, std::memory_order_relaxed);
+    slot.bufferingMode.store(stats.bufferingMode, std::memory_order_relaxed);
+    
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void BlockTimeWindow::add(double elapsedMs, double blockMs) noexcept
+{
+    const int bin = elapsedMs > MIN_MS
+                  ? static_cast<int>(std::log2(elapsedMs / MIN_MS) * BINS_PER_OCTAVE)
+                  : 0;
+    ++counts[static_cast<size_t>(juce::jlimit(0, NUM_BINS - 1, bin))];
+    ++numBlocks;
+    audioMs += blockMs;
+    processMs += elapsedMs;
+}
+
+void BlockTimeWindow::reset() noexcept
+{
+    counts.fill(0);
+    numBlocks = 0;
+    audioMs = 0.0;
+    processMs = 0.0;
+}
+
+double BlockTimeWindow::getRealtimeFactor() const
+{
+    return processMs > 0.0 ? audioMs / processMs : 0.0;
+}
+
+double BlockTimeWindow::getPercentileMs(double fraction) const
+{
+    if (numBlocks == 0)
+        return 0.0;
+    
+    const auto wanted = static_cast<juce::uint32>(std::ceil(fraction * numBlocks));
+    juce::uint32 seen = 0;
+    int bin = 0;
+    
+    for (; bin < NUM_BINS - 1; ++bin)
+    {
+        seen += counts[static_cast<size_t>(bin)];
+        
+        if (seen >= wanted)
+            break;
+    }
+    
+    return MIN_MS * std::exp2(static_cast<double>(bin + 1) / BINS_PER_OCTAVE);
+}
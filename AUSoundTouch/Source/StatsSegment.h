@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// A POSIX shared-memory table of every plugin instance's headline figures,
+// for watching hosts in production with `ausoundtouch-top` rather than a
+// debugger. Each processor claims a slot when it is created and frees it when
+// it is destroyed. The audio thread fills the slot with relaxed atomic stores
+// bracketed by a sequence count; readers retry on a torn read instead of
+// locking, so nothing a reader does can hold up a writer.
+//
+// A zero-filled segment is a valid empty table, so whichever process opens it
+// first needs no initialisation step. The layout version is part of the name.
+// The segment is never unlinked: another process may be using it. On
+// platforms without POSIX shared memory the segment stays closed and slots
+// do nothing.
+//
+// The segment is created 0600, so only the creating user's processes can
+// open it. Everything that opens it does so read-write, ausoundtouch-top
+// included, so 0644 would buy nothing, and a table other users could write
+// would let them forge or wipe the figures of hosts they don't own.
+class StatsSegment
+{
+public:
+    static constexpr const char* DEFAULT_NAME = "/ausoundtouch-stats-2";
+    static constexpr int MAX_SLOTS = 256;
+    static constexpr int MAX_PROCESS_NAME = 64;
+    
+    // What a slot publishes
+    struct Stats
+    {
+        double realtimeFactor = 0.0;    // Audio duration over processing time (xRT)
+        double p99BlockMs = 0.0;        // 99th percentile of the time spent in processBlock()
+        double latencyMs = 0.0;         // Audio actually held back
+        float dspLoad = 0.0f;           // Peak-held block time over block duration
+        juce::int64 underruns = 0;
+        juce::int64 droppedFrames = 0;
+        int qualityMode = 0;            // AUSoundTouchProcessor::QualityMode
+        int bufferingMode = 0;          // AUSoundTouchProcessor::BufferingMode
+    };
+    
+    // One live instance, as read back
+    struct Instance
+    {
+        int slot = 0;
+        int processId = 0;
+        juce::uint32 instanceId = 0;
+        juce::String processName;
+        juce::int64 lastUpdateMs = 0;   // juce::Time::currentTimeMillis() at the last publish; 0 if never
+        Stats stats;
+    };
+    
+    // One instance's registration in the table, claimed and freed on the
+    // message thread and published to from the audio thread
+    class Slot
+    {
+    public:
+        Slot(StatsSegment& segment, juce::uint32 instanceId, const juce::String& processName);
+        ~Slot();
+        
+        bool isRegistered() const { return index >= 0; }
+        
+        // Audio thread; never blocks or allocates
+        void publish(const Stats& stats) noexcept;
+        
+    private:
+        StatsSegment& segment;
+        int index = -1;
+        
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Slot)
+    };
+    
+    // Opens the named segment, creating it if asked to and it doesn't exist
+    explicit StatsSegment(const juce::String& name = DEFAULT_NAME, bool create = true);
+    ~StatsSegment();
+    
+    bool isOpen() const { return table != nullptr; }
+    
+    // Claimed slots whose process is still running, in slot order. Readers
+    // may run at any rate in any process without affecting the writers.
+    std::vector<Instance> readInstances() const;
+    
+    // Deletes the segment's name, for tests; processes that have it mapped keep it
+    static void remove(const juce::String& name);
+    
+    // For picking out this process's instances from readInstances(); 0 where
+    // the segment isn't supported
+    static int getCurrentProcessId();
+    
+private:
+    enum SlotState : juce::uint32
+    {
+        slotFree = 0,
+        slotClaiming = 1,
+        slotClaimed = 2
+    };
+    
+    // Everything is an atomic so that concurrent access from several processes
+    // is well defined; the sequence count makes a reader's copy consistent
+    struct SlotData
+    {
+        std::atomic<juce::uint64> owner;        // See makeOwner()
+        std::atomic<juce::uint32> sequence;     // Odd while a writer is part way through
+        std::atomic<juce::uint32> instanceId;
+        std::array<std::atomic<juce::uint64>, MAX_PROCESS_NAME / 8> processName;  // UTF-8, zero padded
+        std::atomic<juce::int64> lastUpdateMs;
+        std::atomic<double> realtimeFactor;
+        std::atomic<double> p99BlockMs;
+        std::atomic<double> latencyMs;
+        std::atomic<float> dspLoad;
+        std::atomic<juce::int64> underruns;
+        std::atomic<juce::int64> droppedFrames;
+        std::atomic<juce::int32> qualityMode;
+        std::atomic<juce::int32> bufferingMode;
+    };
+    
+    struct Table
+    {
+        std::array<SlotData, MAX_SLOTS> slots;
+    };
+    
+    static_assert(std::atomic<juce::uint64>::is_always_lock_free && std::atomic<double>::is_always_lock_free,
+                  "Atomics shared between processes must not hide a lock");
+    
+    // A slot's state and the ID of the process that holds it, in one word so
+    // that claiming a slot records its claimant in the same step. A process
+    // that dies part way through a claim can then be told apart from one
+    // still making it.
+    static constexpr juce::uint64 makeOwner(SlotState state, int processId)
+    {
+        return (static_cast<juce::uint64>(static_cast<juce::uint32>(processId)) << 32) | state;
+    }
+    
+    static constexpr SlotState getState(juce::uint64 owner) { return static_cast<SlotState>(owner & 0xffffffffu); }
+    static constexpr int getProcessId(juce::uint64 owner) { return static_cast<int>(static_cast<juce::uint32>(owner >> 32)); }
+    
+    int claim(juce::uint32 instanceId, const juce::String& processName);
+    void release(int index);
+    
+    static void writeProcessName(SlotData& slot, const juce::String& processName);
+    static juce::String readProcessName(const SlotData& slot);
+    static bool isProcessAlive(int processId);
+    
+    Table* table = nullptr;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StatsSegment)
+};
+
+// Audio thread: block times over a window of audio, for the realtime factor and
+// 99th-percentile block time a slot publishes. Times are binned on a log scale
+// at BINS_PER_OCTAVE, so percentiles are good to about 9%.
+class BlockTimeWindow
+{
+public:
+    void add(double elapsedMs, double blockMs) noexcept;
+    void reset() noexcept;
+    
+    double getAudioMs() const { return audioMs; }
+    double getRealtimeFactor() const;
+    
+    // The upper edge of the bin holding the given fraction of blocks
+    double getPercentileMs(double fraction) const;
+    
+    static constexpr int BINS_PER_OCTAVE = 8;
+    static constexpr int NUM_BINS = 20 * BINS_PER_OCTAVE;   // 1 us up to about 1 s
+    static constexpr double MIN_MS = 0.001;
+    
+private:
+    std::array<juce::uint32, NUM_BINS> counts {};
+    juce::uint32 numBlocks = 0;
+    double audioMs = 0.0;
+    double processMs = 0.0;
+};
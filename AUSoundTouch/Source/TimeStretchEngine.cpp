@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "TimeStretchEngine.h"
+#include "SoundTouchEngine.h"
+#include "ResamplingEngine.h"
+#include "PhaseVocoderEngine.h"
+#include "GranularEngine.h"
+#include "PsolaEngine.h"
+#include "SpeechEngine.h"
+
+std::unique_ptr<TimeStretchEngine> TimeStretchEngine::create(Type type, int qualityMode, const Tuning* standardTuning)
+{
+    if (type == Type::Resampling)
+        return std::make_unique<ResamplingEngine>();
+    
+    if (type == Type::PhaseVocoder)
+        return std::make_unique<PhaseVocoderEngine>();
+    
+    if (type == Type::Live)
+        return std::make_unique<GranularEngine>();
+    
+    if (type == Type::Monophonic)
+        return std::make_unique<PsolaEngine>();
+    
+    if (type == Type::Speech)
+        return std::make_unique<SpeechEngine>(qualityMode);
+    
+    if (type == Type::Standard && standardTuning != nullptr)
+        return std::make_unique<SoundTouchEngine>(*standardTuning);
+    
+    return std::make_unique<SoundTouchEngine>(SoundTouchEngine::getTuning(type, qualityMode));
+}
+
+const char* TimeStretchEngine::getTypeName(Type type)
+{
+    switch (type)
+    {
+        case Type::Resampling:   return "Resampling";
+        case Type::LowLatency:   return "Low latency";
+        case Type::HighQuality:  return "High quality";
+        case Type::PhaseVocoder: return "Phase vocoder";
+        case Type::Live:         return "Live";
+        case Type::Monophonic:   return "Monophonic";
+        case Type::Speech:       return "Speech";
+        default:                 return "Standard";
+    }
+}
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+// A time-stretch/pitch-shift backend working on interleaved float frames. The
+// output FIFO, parameter smoothing, crossfades and stats live in
+// SoundTouchWrapper and are shared by every engine; an engine only turns
+// input frames into output frames.
+//
+// The constructor and prepare() may allocate and run off the audio thread.
+// Everything else is called on the audio thread and must not allocate.
+class TimeStretchEngine
+{
+public:
+    enum class Type
+    {
+        Standard = 1, // SoundTouch tuned by the quality mode
+        Resampling,   // Varispeed: only the rate applies, pitch follows it
+        LowLatency,   // SoundTouch with short windows, for live monitoring
+        HighQuality,  // SoundTouch with long windows and filters, for offline rendering
+        PhaseVocoder, // FFT phase vocoder, for stretches beyond what WSOLA handles cleanly
+        Live,         // Granular pitch shift at a few milliseconds' latency, for performers
+        Monophonic,   // Pitch-synchronous overlap-add driven by a pitch tracker, for solo voice
+        Speech        // SoundTouch on a decimated low band plus a cheap high band, for spoken word
+    };
+    
+    static constexpr int NUM_TYPES = 8;
+    static constexpr int MAX_CHANNELS = 16;
+    
+    // SoundTouch's WSOLA window and filter settings, for the types that run it
+    struct Tuning
+    {
+        int sequenceMs = 40;
+        int seekWindowMs = 15;
+        int overlapMs = 8;
+        bool quickSeek = false;
+        int antiAliasLength = 64;
+        
+        bool operator== (const Tuning& other) const
+        {
+            return sequenceMs == other.sequenceMs && seekWindowMs == other.seekWindowMs
+                && overlapMs == other.overlapMs && quickSeek == other.quickSeek
+                && antiAliasLength == other.antiAliasLength;
+        }
+        
+        bool operator!= (const Tuning& other) const { return ! operator== (other); }
+    };
+    
+    virtual ~TimeStretchEngine() = default;
+    
+    // A Standard engine runs standardTuning if given, in place of the quality
+    // mode's; the other types ignore it
+    static std::unique_ptr<TimeStretchEngine> create(Type type, int qualityMode, const Tuning* standardTuning = nullptr);
+    static const char* getTypeName(Type type);
+    
+    virtual void prepare(double sampleRate, int numChannels, int maxBlockFrames) = 0;
+    
+    // Native ratios (1.0 = unchanged)
+    virtual void setRatios(float pitch, float tempo, float rate) = 0;
+    
+    // At most maxBlockFrames per call, each followed by receiveSamples() until
+    // it returns 0
+    virtual void putSamples(const float* interleaved, int numFrames) = 0;
+    
+    // Returns the number of frames written, 0 once nothing is ready
+    virtual int receiveSamples(float* interleaved, int maxFrames) = 0;
+    
+    // Processes whatever input is held back, padding with silence as needed
+    virtual void flush() = 0;
+    
+    // Drops all buffered input and output, keeping storage allocated
+    virtual void clear() = 0;
+    
+    // Input frames held back before the first output appears
+    virtual int getInitialLatency() const = 0;
+    virtual int getNumUnprocessedFrames() const = 0;
+    
+    // True if every input frame past the initial latency is returned by the
+    // receiveSamples() calls that follow its putSamples(), so the output never
+    // needs more than the initial latency of buffering
+    virtual bool hasConstantLatency() const { return false; }
+    
+    // Output frames produced per input frame at the given ratios
+    virtual double getOutputPerInput(float tempo, float rate) const = 0;
+};
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "VoiceWorkerPool.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr juce::uint64 taskIndexMask = 0xffff;
+    constexpr int taskCountShift = 16;
+    constexpr int batchNumberShift = 32;
+    
+    // Eases off the core while spinning, so a pool thread sharing it runs sooner
+    inline void pauseWhileSpinning()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (JUCE_CLANG || JUCE_GCC)
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+}
+
+class VoiceWorkerPool::Worker : public juce::Thread
+{
+public:
+    explicit Worker(VoiceWorkerPool& poolToServe)
+        : juce::Thread("AUSoundTouch Voices"), pool(poolToServe)
+    {
+    }
+    
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            pool.wakeups.acquire();
+            
+            while (pool.runNextTask())
+            {
+            }
+        }
+    }
+    
+private:
+    VoiceWorkerPool& pool;
+};
+
+VoiceWorkerPool::VoiceWorkerPool()
+{
+    // Leave a core for the host's own audio thread
+    const int numThreads = juce::jmin(MAX_THREADS, juce::SystemStats::getNumCpus() - 2);
+    
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this));
+        worker->startRealtimeThread(juce::Thread::RealtimeOptions {});
+    }
+}
+
+VoiceWorkerPool::~VoiceWorkerPool()
+{
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+    
+    // One wakeup per thread; each leaves its loop on the first one it takes
+    wakeups.release(workers.size());
+    
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+}
+
+bool VoiceWorkerPool::execute(Batch& batch, int numTasks, double maxWaitMs)
+{
+    if (numTasks <= 0)
+    {
+        batch.runPosterTask();
+        return true;
+    }
+    
+    if (workers.isEmpty() || numTasks == 1 || busy.exchange(true, std::memory_order_acquire))
+    {
+        runAlone(batch, numTasks);
+        return true;
+    }
+    
+    currentBatch.store(&batch, std::memory_order_relaxed);
+    completedTasks.store(0, std::memory_order_relaxed);
+    
+    ++batchNumber;
+    claims.store((static_cast<juce::uint64>(batchNumber) << batchNumberShift)
+                     | (static_cast<juce::uint64>(numTasks) << taskCountShift),
+                 std::memory_order_release);
+    
+    // The poster takes one task itself, so one worker fewer than tasks is enough
+    wakeups.release(juce::jmin(workers.size(), numTasks - 1));
+    batch.runPosterTask();
+    
+    // Whatever no pool thread has started yet runs here
+    while (runNextTask())
+    {
+    }
+    
+    const auto deadline = juce::Time::getHighResolutionTicks()
+                        + juce::Time::secondsToHighResolutionTicks(maxWaitMs * 0.001);
+    
+    while (completedTasks.load(std::memory_order_acquire) < numTasks)
+    {
+        if (juce::Time::getHighResolutionTicks() < deadline)
+        {
+            pauseWhileSpinning();
+            continue;
+        }
+        
+        // Hand the pool over to the late task, unless it finished just now
+        stalledBatch.store(&batch, std::memory_order_seq_cst);
+        
+        if (completedTasks.load(std::memory_order_seq_cst) < numTasks)
+            return false;
+        
+        if (stalledBatch.exchange(nullptr, std::memory_order_acq_rel) == nullptr)
+            return true;  // The pool thread finished it and freed the pool
+        
+        break;
+    }
+    
+    busy.store(false, std::memory_order_release);
+    return true;
+}
+
+void VoiceWorkerPool::runAlone(Batch& batch, int numTasks)
+{
+    batch.runPosterTask();
+    
+    for (int i = 0; i < numTasks; ++i)
+        batch.runTask(i);
+}
+
+bool VoiceWorkerPool::runNextTask()
+{
+    auto current = claims.load(std::memory_order_acquire);
+    
+    for (;;)
+    {
+        const auto taskIndex = current & taskIndexMask;
+        const auto numTasks = (current >> taskCountShift) & taskIndexMask;
+        
+        if (taskIndex >= numTasks)
+            return false;
+        
+        if (claims.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel))
+        {
+            // The batch can't finish, or be replaced, before this task is counted
+            currentBatch.load(std::memory_order_relaxed)->runTask(static_cast<int>(taskIndex));
+            
+            // The last task of a batch its poster gave up on frees the pool
+            if (completedTasks.fetch_add(1, std::memory_order_seq_cst) + 1 == static_cast<int>(numTasks)
+                && stalledBatch.exchange(nullptr, std::memory_order_acq_rel) != nullptr)
+                busy.store(false, std::memory_order_release);
+            
+            return true;
+        }
+    }
+}
+
+VoiceWorkerPool::Handle::~Handle()
+{
+    while (isStalled())
+        juce::Thread::sleep(1);
+}
+
+void VoiceWorkerPool::Handle::acquire()
+{
+    if (reference != nullptr)
+        return;
+    
+    reference = std::make_unique<juce::SharedResourcePointer<VoiceWorkerPool>>();
+    pool.store(&reference->getObject(), std::memory_order_release);
+}
+
+// Takes the pool back from the audio thread first, so it can't be borrowed
+// while it is let go
+void VoiceWorkerPool::Handle::release()
+{
+    if (reference == nullptr)
+        return;
+    
+    auto* claimed = pool.exchange(nullptr, std::memory_order_acquire);
+    
+    if (claimed == nullptr)
+        return;
+    
+    if (claimed->isStalled(batch))
+    {
+        pool.store(claimed, std::memory_order_release);
+        return;
+    }
+    
+    reference.reset();
+}
+
+void VoiceWorkerPool::Handle::restore(VoiceWorkerPool* claimed)
+{
+    if (claimed != nullptr)
+        pool.store(claimed, std::memory_order_release);
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <semaphore>
+
+// A few threads, shared by every plugin instance in the process, that run a
+// batch of tasks alongside the audio thread that posts it. The poster works
+// through the batch too, taking every task no pool thread has started, and
+// then waits out any task still running, so a batch never takes longer than
+// running it alone would. One batch runs at a time; an instance that finds
+// the pool busy runs its whole batch itself.
+//
+// Pool threads are woken through a semaphore, so posting takes no lock. A
+// pool thread descheduled in the middle of a task would hold the poster up
+// indefinitely, so the wait is bounded: past the deadline the poster gives
+// the batch up to that thread and goes on without it.
+//
+// Harmony voices run on it in every plugin format; the CLAP host pool, where
+// there is one, stays with the channel groups. Each user holds it through a
+// Handle, and only while it has tasks for it, so the threads only start once
+// some instance has voices or layers to run.
+class VoiceWorkerPool
+{
+public:
+    class Handle;
+    
+    class Batch
+    {
+    public:
+        virtual ~Batch() = default;
+        
+        // Any pool thread or the poster; each index runs exactly once
+        virtual void runTask(int taskIndex) = 0;
+        
+        // The poster only, once per execute() and alongside the tasks: work
+        // that must stay on the audio thread even if the batch is given up
+        virtual void runPosterTask() {}
+    };
+    
+    VoiceWorkerPool();
+    ~VoiceWorkerPool();
+    
+    // Audio thread: runs tasks [0, numTasks) and returns true once all are
+    // done. Returns false if a pool thread was still inside one of them
+    // maxWaitMs after the poster ran out of tasks to take; that task finishes
+    // on its own, and until isStalled() turns false everything it touches
+    // still belongs to it.
+    bool execute(Batch& batch, int numTasks, double maxWaitMs);
+    
+    // Runs the batch on the calling thread alone, as execute() does when the
+    // pool is busy
+    static void runAlone(Batch& batch, int numTasks);
+    
+    // True while a batch given up by execute() still has a task running
+    bool isStalled(const Batch& batch) const { return stalledBatch.load(std::memory_order_acquire) == &batch; }
+    
+    // The wait for a chunk of this many frames: enough for a pool thread that
+    // started late, but leaving most of the chunk's duration to the rest of
+    // the callback
+    static double getMaxWaitMs(int numFrames, double sampleRate) { return MAX_WAIT_FRACTION * 1000.0 * numFrames / sampleRate; }
+    static constexpr double MAX_WAIT_FRACTION = 0.25;
+    
+    int getNumThreads() const { return workers.size(); }
+    
+    // Beyond this the posting thread spends more time waking workers than
+    // the voices save
+    static constexpr int MAX_THREADS = 3;
+    
+private:
+    class Worker;
+    
+    bool runNextTask();
+    
+    juce::OwnedArray<Worker> workers;
+    std::counting_semaphore<> wakeups { 0 };
+    std::atomic<bool> busy { false };
+    
+    // Batch number, task count and next task index packed together, so a
+    // thread that wakes late can't claim a task of the wrong batch
+    std::atomic<juce::uint64> claims { 0 };
+    std::atomic<Batch*> currentBatch { nullptr };
+    std::atomic<int> completedTasks { 0 };
+    juce::uint32 batchNumber = 0;
+    
+    // Set by a poster that gave up waiting; whichever thread then finishes the
+    // batch's last task clears it and frees the pool
+    std::atomic<Batch*> stalledBatch { nullptr };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceWorkerPool)
+};
+
+// One batch owner's hold on the shared pool. acquire() and release() run on
+// the owner's non-audio threads, one at a time; the audio thread borrows the
+// pool for a block with claim() and gives it back with restore(), so the pool
+// can't go away under it. Between the two, release() leaves the pool where it
+// is and the next call tries again, as it does while the owner's batch is
+// stalled on it.
+//
+// Declared last in the owner, so that on destruction it waits out a stalled
+// task before the state the task works on goes.
+class VoiceWorkerPool::Handle
+{
+public:
+    explicit Handle(const Batch& batchToRun) : batch(batchToRun) {}
+    ~Handle();
+    
+    void acquire();
+    void release();
+    
+    // Off the audio thread: whether a task of the batch still runs on the pool
+    bool isStalled() const { return reference != nullptr && reference->getObject().isStalled(batch); }
+    
+    // Audio thread: nullptr while no pool is held or release() is checking it;
+    // the batch then runs alone
+    VoiceWorkerPool* claim() { return pool.exchange(nullptr, std::memory_order_acquire); }
+    void restore(VoiceWorkerPool* claimed);
+    
+private:
+    const Batch& batch;
+    std::unique_ptr<juce::SharedResourcePointer<VoiceWorkerPool>> reference;
+    std::atomic<VoiceWorkerPool*> pool { nullptr };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Handle)
+};
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+// Self-registering benchmark, mirroring juce::UnitTest: declare a static
+// instance in any benchmark source file and Main.cpp will find and run it.
+class Benchmark
+{
+public:
+    explicit Benchmark(const juce::String& benchmarkName) : name(benchmarkName)
+    {
+        getAllBenchmarks().add(this);
+    }
+    
+    virtual ~Benchmark()
+    {
+        getAllBenchmarks().removeFirstMatchingValue(this);
+    }
+    
+    const juce::String& getName() const { return name; }
+    
+    virtual void run() = 0;
+    
+    static juce::Array<Benchmark*>& getAllBenchmarks()
+    {
+        static juce::Array<Benchmark*> benchmarks;
+        return benchmarks;
+    }
+    
+    static int& getNumFailedChecks()
+    {
+        static int numFailed = 0;
+        return numFailed;
+    }
+    
+protected:
+    // Prints one aligned result row
+    void logResult(const juce::String& label, double value, const juce::String& unit) const
+    {
+        std::cout << "  " << label.paddedRight(' ', 40) << juce::String(value, 3).paddedLeft(' ', 12)
+                  << " " << unit << std::endl;
+    }
+    
+    // A quality bound the benchmark holds the result to; Main exits non-zero if
+    // any run fell outside one
+    void checkResult(const juce::String& label, double value, double limit) const
+    {
+        if (value <= limit)
+            return;
+        
+        std::cout << "  FAILED: " << label << " " << juce::String(value, 3)
+                  << " exceeds " << juce::String(limit, 3) << std::endl;
+        ++getNumFailedChecks();
+    }
+    
+    static double timeSeconds(const std::function<void()>& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    // Deterministic sine per channel, offset in frequency so channels differ
+    static void fillSine(juce::AudioBuffer<float>& buffer, float frequency, double sampleRate, juce::int64 startSample)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            const double channelFrequency = frequency * (1.0 + 0.25 * channel);
+            auto* data = buffer.getWritePointer(channel);
+            
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            {
+                const double phase = 2.0 * juce::MathConstants<double>::pi * channelFrequency
+                                   * static_cast<double>(startSample + sample) / sampleRate;
+                data[sample] = 0.5f * static_cast<float>(std::sin(phase));
+            }
+        }
+    }
+    
+private:
+    juce::String name;
+    
+    JUCE_DECLARE_NON_COPYABLE (Benchmark)
+};
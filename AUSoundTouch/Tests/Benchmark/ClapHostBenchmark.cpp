@@ -0,0 +1,446 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+    Headless benchmark that loads the built CLAP through a minimal local host.
+    The host implements clap.thread-pool with its own workers, so the plugin's
+    channel groups run on host threads. Each run is repeated without the
+    thread pool to show what it buys. With --verify it instead checks that the
+    groups really ran on the host's workers, and exits non-zero if not.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include <clap/clap.h>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+//==============================================================================
+// The host side of clap.thread-pool: request_exec() wakes the workers, joins in
+// itself unless told not to, and returns once every task has run.
+class HostWorkerPool
+{
+public:
+    HostWorkerPool(int numWorkers, bool callerJoinsIn)
+        : callerRunsTasks(callerJoinsIn)
+    {
+        for (int i = 0; i < numWorkers; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+    
+    ~HostWorkerPool()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            shouldExit = true;
+        }
+        
+        wakeUp.notify_all();
+        
+        for (auto& worker : workers)
+            worker.join();
+    }
+    
+    void run(const clap_plugin_t* plugin, const clap_plugin_thread_pool_t* extension, uint32_t numTasks)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            currentPlugin = plugin;
+            currentExtension = extension;
+            taskCount.store(numTasks);
+            nextTask.store(0);
+            completedTasks.store(0);
+            ++generation;
+        }
+        
+        wakeUp.notify_all();
+        
+        if (callerRunsTasks)
+            runTasks(false);
+        
+        while (completedTasks.load(std::memory_order_acquire) < numTasks)
+            std::this_thread::yield();
+    }
+    
+    uint64_t getTasksRunOnWorkers() const { return tasksOnWorkers.load(std::memory_order_relaxed); }
+    
+private:
+    void workerLoop()
+    {
+        uint64_t seenGeneration = 0;
+        
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [&] { return shouldExit || generation != seenGeneration; });
+                
+                if (shouldExit)
+                    return;
+                
+                seenGeneration = generation;
+            }
+            
+            runTasks(true);
+        }
+    }
+    
+    void runTasks(bool onWorker)
+    {
+        for (uint32_t task = nextTask.fetch_add(1); task < taskCount.load(); task = nextTask.fetch_add(1))
+        {
+            currentExtension->exec(currentPlugin, task);
+            
+            if (onWorker)
+                tasksOnWorkers.fetch_add(1, std::memory_order_relaxed);
+            
+            completedTasks.fetch_add(1, std::memory_order_release);
+        }
+    }
+    
+    const bool callerRunsTasks;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    uint64_t generation = 0;
+    bool shouldExit = false;
+    
+    const clap_plugin_t* currentPlugin = nullptr;
+    const clap_plugin_thread_pool_t* currentExtension = nullptr;
+    std::atomic<uint32_t> taskCount { 0 };
+    std::atomic<uint32_t> nextTask { 0 };
+    std::atomic<uint32_t> completedTasks { 0 };
+    std::atomic<uint64_t> tasksOnWorkers { 0 };
+};
+
+//==============================================================================
+class MinimalClapHost
+{
+public:
+    MinimalClapHost(bool offerThreadPool, int numWorkers, bool callerJoinsIn)
+        : threadPoolOffered(offerThreadPool), workerPool(offerThreadPool ? numWorkers : 0, callerJoinsIn)
+    {
+        host.clap_version = CLAP_VERSION;
+        host.host_data = this;
+        host.name = "AUSoundTouch CLAP benchmark host";
+        host.vendor = "AUSoundTouch";
+        host.url = "https://github.com/allquixotic/ausoundtouch";
+        host.version = "1.0.0";
+        host.get_extension = getExtension;
+        host.request_restart = [](const clap_host_t*) {};
+        host.request_process = [](const clap_host_t*) {};
+        host.request_callback = [](const clap_host_t*) {};
+        
+        hostThreadPool.request_exec = requestExec;
+    }
+    
+    const clap_host_t* getHost() const { return &host; }
+    
+    void setPlugin(const clap_plugin_t* pluginToUse)
+    {
+        plugin = pluginToUse;
+        pluginThreadPool = static_cast<const clap_plugin_thread_pool_t*>(
+            plugin->get_extension(plugin, CLAP_EXT_THREAD_POOL));
+    }
+    
+    bool isThreadPoolInUse() const { return threadPoolOffered && pluginThreadPool != nullptr; }
+    uint64_t getExecRequests() const { return execRequests; }
+    uint64_t getTasksRunOnWorkers() const { return workerPool.getTasksRunOnWorkers(); }
+    
+private:
+    static MinimalClapHost& fromHost(const clap_host_t* h)
+    {
+        return *static_cast<MinimalClapHost*>(h->host_data);
+    }
+    
+    static const void* CLAP_ABI getExtension(const clap_host_t* h, const char* extensionId)
+    {
+        auto& self = fromHost(h);
+        
+        if (self.threadPoolOffered && std::strcmp(extensionId, CLAP_EXT_THREAD_POOL) == 0)
+            return &self.hostThreadPool;
+        
+        return nullptr;
+    }
+    
+    static bool CLAP_ABI requestExec(const clap_host_t* h, uint32_t numTasks)
+    {
+        auto& self = fromHost(h);
+        
+        if (self.pluginThreadPool == nullptr)
+            return false;
+        
+        ++self.execRequests;
+        self.workerPool.run(self.plugin, self.pluginThreadPool, numTasks);
+        return true;
+    }
+    
+    clap_host_t host {};
+    clap_host_thread_pool_t hostThreadPool {};
+    const bool threadPoolOffered;
+    HostWorkerPool workerPool;
+    
+    const clap_plugin_t* plugin = nullptr;
+    const clap_plugin_thread_pool_t* pluginThreadPool = nullptr;
+    uint64_t execRequests = 0;
+};
+
+//==============================================================================
+struct BenchmarkResult
+{
+    bool succeeded = false;
+    int numChannels = 0;
+    double seconds = 0.0;
+    uint64_t execRequests = 0;
+    uint64_t tasksOnWorkers = 0;
+};
+
+static BenchmarkResult runPlugin(const clap_plugin_entry_t* entry, bool offerThreadPool, int numWorkers,
+                                 int requestedChannels, double sampleRate, int blockSize, double durationSeconds,
+                                 bool callerJoinsIn = true)
+{
+    BenchmarkResult result;
+    MinimalClapHost minimalHost(offerThreadPool, numWorkers, callerJoinsIn);
+    
+    const auto* factory = static_cast<const clap_plugin_factory_t*>(entry->get_factory(CLAP_PLUGIN_FACTORY_ID));
+    
+    if (factory == nullptr || factory->get_plugin_count(factory) == 0)
+    {
+        std::cerr << "No plugins in CLAP factory" << std::endl;
+        return result;
+    }
+    
+    const auto* descriptor = factory->get_plugin_descriptor(factory, 0);
+    const auto* plugin = factory->create_plugin(factory, minimalHost.getHost(), descriptor->id);
+    
+    if (plugin == nullptr || ! plugin->init(plugin))
+    {
+        std::cerr << "Failed to create " << descriptor->id << std::endl;
+        return result;
+    }
+    
+    minimalHost.setPlugin(plugin);
+    
+    // Ask for the wider layout if the plugin lets hosts configure its ports
+    int numChannels = 2;
+    
+    if (const auto* configurable = static_cast<const clap_plugin_configurable_audio_ports_t*>(
+            plugin->get_extension(plugin, CLAP_EXT_CONFIGURABLE_AUDIO_PORTS)))
+    {
+        const clap_audio_port_configuration_request_t requests[] = {
+            { true, 0, static_cast<uint32_t>(requestedChannels), nullptr, nullptr },
+            { false, 0, static_cast<uint32_t>(requestedChannels), nullptr, nullptr }
+        };
+        
+        if (configurable->apply_configuration(plugin, requests, 2))
+            numChannels = requestedChannels;
+    }
+    
+    if (numChannels != requestedChannels)
+        std::cout << "  Plugin kept its default layout; running " << numChannels << " channels" << std::endl;
+    
+    plugin->activate(plugin, sampleRate, 1, static_cast<uint32_t>(blockSize));
+    plugin->start_processing(plugin);
+    
+    juce::AudioBuffer<float> inputs(numChannels, blockSize);
+    juce::AudioBuffer<float> outputs(numChannels, blockSize);
+    
+    clap_audio_buffer_t inputBuffer {};
+    inputBuffer.data32 = const_cast<float**>(inputs.getArrayOfWritePointers());
+    inputBuffer.channel_count = static_cast<uint32_t>(numChannels);
+    
+    clap_audio_buffer_t outputBuffer {};
+    outputBuffer.data32 = const_cast<float**>(outputs.getArrayOfWritePointers());
+    outputBuffer.channel_count = static_cast<uint32_t>(numChannels);
+    
+    clap_input_events_t inEvents {};
+    inEvents.size = [](const clap_input_events_t*) -> uint32_t { return 0; };
+    inEvents.get = [](const clap_input_events_t*, uint32_t) -> const clap_event_header_t* { return nullptr; };
+    
+    clap_output_events_t outEvents {};
+    outEvents.try_push = [](const clap_output_events_t*, const clap_event_header_t*) { return true; };
+    
+    clap_process_t process {};
+    process.frames_count = static_cast<uint32_t>(blockSize);
+    process.audio_inputs = &inputBuffer;
+    process.audio_inputs_count = 1;
+    process.audio_outputs = &outputBuffer;
+    process.audio_outputs_count = 1;
+    process.in_events = &inEvents;
+    process.out_events = &outEvents;
+    
+    const int numBlocks = static_cast<int>(sampleRate * durationSeconds) / blockSize;
+    double total = 0.0;
+    
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = inputs.getWritePointer(channel);
+            
+            for (int sample = 0; sample < blockSize; ++sample)
+                data[sample] = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 220.0f * (1.0f + 0.25f * channel)
+                                               * static_cast<float>(block * blockSize + sample) / static_cast<float>(sampleRate));
+        }
+        
+        process.steady_time = static_cast<int64_t>(block) * blockSize;
+        
+        const auto start = std::chrono::steady_clock::now();
+        plugin->process(plugin, &process);
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    if (offerThreadPool && ! minimalHost.isThreadPoolInUse())
+        std::cout << "  Plugin did not expose " << CLAP_EXT_THREAD_POOL << std::endl;
+    
+    plugin->stop_processing(plugin);
+    plugin->deactivate(plugin);
+    plugin->destroy(plugin);
+    
+    result.succeeded = true;
+    result.numChannels = numChannels;
+    result.seconds = total;
+    result.execRequests = minimalHost.getExecRequests();
+    result.tasksOnWorkers = minimalHost.getTasksRunOnWorkers();
+    return result;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::String pluginPath;
+    int requestedChannels = 12;
+    int numWorkers = juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+    double durationSeconds = 20.0;
+    bool verify = false;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        
+        if (arg == "--channels" && i + 1 < argc)
+            requestedChannels = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--workers" && i + 1 < argc)
+            numWorkers = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--seconds" && i + 1 < argc)
+            durationSeconds = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--verify")
+            verify = true;
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: " << argv[0] << " [options] plugin.clap\n"
+                      << "Options:\n"
+                      << "  --channels N   Layout to request (default 12, i.e. 7.1.4)\n"
+                      << "  --workers N    Host worker threads (default: CPUs - 1)\n"
+                      << "  --seconds S    Audio to process per run (default 20)\n"
+                      << "  --verify       Check that channel groups run on host workers, then exit\n";
+            return 0;
+        }
+        else
+            pluginPath = arg;
+    }
+    
+    if (pluginPath.isEmpty())
+    {
+        std::cerr << "No plugin path given" << std::endl;
+        return 1;
+    }
+    
+    // A .clap is a bundle directory on macOS and a plain shared object elsewhere
+    juce::File pluginFile(pluginPath);
+   #if JUCE_MAC
+    const auto binary = pluginFile.getChildFile("Contents/MacOS").findChildFiles(juce::File::findFiles, false).getFirst();
+   #else
+    const auto binary = pluginFile;
+   #endif
+    
+    juce::DynamicLibrary library;
+    
+    if (! library.open(binary.getFullPathName()))
+    {
+        std::cerr << "Failed to open " << binary.getFullPathName() << std::endl;
+        return 1;
+    }
+    
+    const auto* entry = static_cast<const clap_plugin_entry_t*>(library.getFunction("clap_entry"));
+    
+    if (entry == nullptr || ! entry->init(pluginFile.getFullPathName().toRawUTF8()))
+    {
+        std::cerr << "No usable clap_entry in " << pluginPath << std::endl;
+        return 1;
+    }
+    
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    
+    if (verify)
+    {
+        // The calling thread stays out of the pool, so every task that runs
+        // at all has to run on a host worker
+        const auto pooled = runPlugin(entry, true, juce::jmax(1, numWorkers), requestedChannels,
+                                      sampleRate, blockSize, 1.0, false);
+        entry->deinit();
+        
+        const uint64_t numBlocks = static_cast<uint64_t>(sampleRate) / static_cast<uint64_t>(blockSize);
+        const uint64_t numGroups = static_cast<uint64_t>((pooled.numChannels + 1) / 2);
+        
+        std::cout << "Blocks: " << numBlocks << ", exec requests: " << pooled.execRequests
+                  << ", tasks on host workers: " << pooled.tasksOnWorkers << std::endl;
+        
+        if (! pooled.succeeded || pooled.numChannels <= 2)
+        {
+            std::cerr << "FAIL: the plugin has to accept a layout wider than stereo" << std::endl;
+            return 1;
+        }
+        
+        if (pooled.execRequests != numBlocks || pooled.tasksOnWorkers != numBlocks * numGroups)
+        {
+            std::cerr << "FAIL: channel groups did not run on the host thread pool" << std::endl;
+            return 1;
+        }
+        
+        std::cout << "PASS: " << numGroups << " channel groups per block ran on host workers" << std::endl;
+        return 0;
+    }
+    
+    std::cout << "=== CLAP host benchmark ===" << std::endl;
+    std::cout << "Plugin: " << pluginPath << ", host workers: " << numWorkers << std::endl;
+    
+    const auto serial = runPlugin(entry, false, 0, requestedChannels, sampleRate, blockSize, durationSeconds);
+    const auto pooled = runPlugin(entry, true, numWorkers, requestedChannels, sampleRate, blockSize, durationSeconds);
+    
+    entry->deinit();
+    
+    if (! serial.succeeded || ! pooled.succeeded)
+        return 1;
+    
+    auto logResult = [](const juce::String& label, double value, const juce::String& unit)
+    {
+        std::cout << "  " << label.paddedRight(' ', 40) << juce::String(value, 3).paddedLeft(' ', 12)
+                  << " " << unit << std::endl;
+    };
+    
+    std::cout << pooled.numChannels << " channels" << std::endl;
+    logResult("Without host thread pool", durationSeconds / serial.seconds, "xRT");
+    logResult("With host thread pool", durationSeconds / pooled.seconds, "xRT");
+    logResult("Speedup", serial.seconds / pooled.seconds, "x");
+    
+    return 0;
+}
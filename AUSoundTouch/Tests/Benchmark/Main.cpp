@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+
+// Usage: AUSoundTouchBenchmark [--list] [name filter...]
+// Runs every registered benchmark whose name contains one of the filters, and
+// exits non-zero if any of them failed a quality check.
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::StringArray filters;
+    bool listOnly = false;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        
+        if (arg == "--list")
+            listOnly = true;
+        else
+            filters.add(arg);
+    }
+    
+    for (auto* benchmark : Benchmark::getAllBenchmarks())
+    {
+        bool selected = filters.isEmpty();
+        
+        for (const auto& filter : filters)
+            selected = selected || benchmark->getName().containsIgnoreCase(filter);
+        
+        if (!selected)
+            continue;
+        
+        std::cout << "=== " << benchmark->getName() << " ===" << std::endl;
+        
+        if (!listOnly)
+        {
+            benchmark->run();
+            std::cout << std::endl;
+        }
+    }
+    
+    return Benchmark::getNumFailedChecks() > 0 ? 1 : 0;
+}
@@ -0,0 +1,350 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+    Offline renderer: loads the built VST3 through JUCE's host, the way a DAW
+    bounce would, and renders every clip of the vocal corpus (see
+    VocalCorpus.h) at a set of typical settings, non-realtime. Reports the
+    speed of each render as a multiple of real time (xRT), and can write the
+    results out as WAV files. `make pgo` uses it to train the plugin itself.
+    As a batch worker it can export its progress in OpenMetrics format (see
+    RenderMetrics.h).
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "VocalCorpus.h"
+#include "RenderMetrics.h"
+#include "StatsSegment.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+//==============================================================================
+namespace
+{
+    struct RenderSetting
+    {
+        const char* name;
+        const char* pitch;
+        const char* tempo;
+        const char* speed;
+        int bufferingMode;
+        int qualityMode;
+    };
+    
+    // Normal buffering throughout; the default quality renders with the
+    // High quality SoundTouch engine, as it does for any offline bounce
+    constexpr RenderSetting renderSettings[] = {
+        { "Pitch +3",             "3",  "0",   "0",  2, 3 },
+        { "Pitch -5, tempo -10%", "-5", "-10", "0",  2, 3 },
+        { "Tempo -25%",           "0",  "-25", "0",  2, 3 },
+        { "Speed +25%",           "0",  "0",   "25", 2, 3 },
+        { "Monophonic, pitch +7", "7",  "0",   "0",  2, 4 },
+        { "Speech, tempo +50%",   "0",  "50",  "0",  2, 5 },
+    };
+    
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    
+    // The VST3 host stores the plugin's own state base64-encoded in an
+    // IComponent element, in the plugin's binary format (magic, version,
+    // count, then {fourcc, float} entries); rewrite the mode entries in place
+    bool setModesInHostedState(juce::MemoryBlock& hostState, int bufferingMode, int qualityMode)
+    {
+        auto hostXml = juce::AudioProcessor::getXmlFromBinary(hostState.getData(), static_cast<int>(hostState.getSize()));
+        
+        if (hostXml == nullptr)
+            return false;
+        
+        auto* component = hostXml->getChildByName("IComponent");
+        
+        if (component == nullptr)
+            return false;
+        
+        juce::MemoryBlock pluginState;
+        
+        if (! pluginState.fromBase64Encoding(component->getAllSubText()) || pluginState.getSize() < 8)
+            return false;
+        
+        auto* bytes = static_cast<char*>(pluginState.getData());
+        const int numEntries = juce::jmin(static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6)),
+                                          static_cast<int>(pluginState.getSize() - 8) / 8);
+        int modesFound = 0;
+        
+        for (int i = 0; i < numEntries; ++i)
+        {
+            char* entry = bytes + 8 + i * 8;
+            const auto key = juce::ByteOrder::littleEndianInt(entry);
+            float value;
+            
+            if (key == juce::ByteOrder::bigEndianInt("bufm"))
+                value = static_cast<float>(bufferingMode);
+            else if (key == juce::ByteOrder::bigEndianInt("qual"))
+                value = static_cast<float>(qualityMode);
+            else
+                continue;
+            
+            juce::uint32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits = juce::ByteOrder::swapIfBigEndian(bits);
+            std::memcpy(entry + 4, &bits, sizeof(bits));
+            ++modesFound;
+        }
+        
+        if (modesFound != 2)
+            return false;
+        
+        component->deleteAllTextElements();
+        component->addTextElement(pluginState.toBase64Encoding());
+        
+        hostState.reset();
+        juce::AudioProcessor::copyXmlToBinary(*hostXml, hostState);
+        return true;
+    }
+    
+    void setParameter(juce::AudioPluginInstance& plugin, const juce::String& name, const juce::String& text)
+    {
+        for (auto* parameter : plugin.getParameters())
+            if (parameter->getName(32) == name)
+                parameter->setValueNotifyingHost(parameter->getValueForText(text));
+    }
+    
+    // Renders the clip, in stereo, and then the tail; returns the seconds
+    // spent inside processBlock
+    double render(juce::AudioPluginInstance& plugin, const VocalClip& clip, juce::AudioBuffer<float>& output)
+    {
+        const int inputSamples = static_cast<int>(clip.samples.size());
+        const int tailSamples = static_cast<int>(plugin.getTailLengthSeconds() * clip.sampleRate);
+        output.setSize(numChannels, inputSamples + tailSamples);
+        output.clear();
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            output.copyFrom(channel, 0, clip.samples.data(), inputSamples);
+        
+        juce::MidiBuffer midi;
+        double seconds = 0.0;
+        
+        for (int start = 0; start < output.getNumSamples(); start += blockSize)
+        {
+            const int numSamples = juce::jmin(blockSize, output.getNumSamples() - start);
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), numChannels, start, numSamples);
+            
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            plugin.processBlock(block, midi);
+            seconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        }
+        
+        return seconds;
+    }
+    
+    // The hosted plugin's figures as of its last publish, found by process,
+    // since only one instance is alive at a time
+    StatsSegment::Stats getHostedStats()
+    {
+        const StatsSegment segment(StatsSegment::DEFAULT_NAME, false);
+        
+        for (const auto& instance : segment.readInstances())
+            if (instance.processId == StatsSegment::getCurrentProcessId())
+                return instance.stats;
+        
+        return {};
+    }
+    
+    double secondsSince(double startMs)
+    {
+        return (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    }
+    
+    bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        
+        if (stream == nullptr)
+            return false;
+        
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), sampleRate,
+                                                                               static_cast<unsigned int>(numChannels),
+                                                                               24, {}, 0));
+        
+        if (writer == nullptr)
+            return false;
+        
+        stream.release();
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+}
+
+//==============================================================================
+// Usage: AUSoundTouchOfflineRender <path to AUSoundTouch.vst3> [--output <directory>]
+//            [--metrics <file>] [--metrics-socket <path>]
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <path to AUSoundTouch.vst3> [--output <directory>]"
+                  << " [--metrics <file>] [--metrics-socket <path>]" << std::endl;
+        return 1;
+    }
+    
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const double runStartMs = juce::Time::getMillisecondCounterHiRes();
+    
+    const juce::String pluginPath(argv[1]);
+    juce::File outputDirectory;
+    MetricsExporter metricsExporter;
+    
+    for (int i = 2; i + 1 < argc; ++i)
+    {
+        const juce::String option(argv[i]);
+        const auto path = juce::File::getCurrentWorkingDirectory().getChildFile(argv[i + 1]);
+        
+        if (option == "--output")
+            outputDirectory = path;
+        else if (option == "--metrics")
+            metricsExporter.setFile(path);
+        else if (option == "--metrics-socket" && ! metricsExporter.listenOnSocket(path.getFullPathName()))
+        {
+            std::cerr << "Can't listen on " << path.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    
+    if (outputDirectory != juce::File() && ! outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+    
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+    
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+    
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+        if (formatManager.getFormat(i)->getName() == "VST3")
+            formatManager.getFormat(i)->findAllTypesForFile(descriptions, pluginPath);
+    
+    if (descriptions.isEmpty())
+    {
+        std::cerr << "No VST3 plugin found at: " << pluginPath << std::endl;
+        return 1;
+    }
+    
+    RenderMetrics metrics;
+    
+    auto publishMetrics = [&]
+    {
+        metrics.elapsedSeconds = secondsSince(runStartMs);
+        metricsExporter.publish(metrics);
+    };
+    
+    const double decodeStartMs = juce::Time::getMillisecondCounterHiRes();
+    const auto corpus = loadVocalCorpus();
+    metrics.decodeSeconds = secondsSince(decodeStartMs);
+    metrics.rendersQueued = static_cast<juce::int64>(corpus.size() * std::size(renderSettings));
+    publishMetrics();
+    
+    double totalAudioSeconds = 0.0;
+    double totalRenderSeconds = 0.0;
+    
+    std::cout << "=== AUSoundTouch Offline Render ===" << std::endl;
+    
+    for (const auto& clip : corpus)
+    {
+        std::cout << clip.name << " (" << juce::String(clip.samples.size() / clip.sampleRate, 1) << " s)" << std::endl;
+        
+        for (const auto& setting : renderSettings)
+        {
+            // A fresh instance per render, as a bounce of a new track would get
+            juce::String errorMessage;
+            auto plugin = formatManager.createPluginInstance(*descriptions[0], clip.sampleRate, blockSize, errorMessage);
+            
+            if (plugin == nullptr)
+            {
+                std::cerr << "Failed to instantiate plugin: " << errorMessage << std::endl;
+                return 1;
+            }
+            
+            juce::MemoryBlock state;
+            plugin->getStateInformation(state);
+            
+            if (! setModesInHostedState(state, setting.bufferingMode, setting.qualityMode))
+            {
+                std::cerr << "Could not rewrite the hosted state for " << setting.name << std::endl;
+                return 1;
+            }
+            
+            plugin->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+            setParameter(*plugin, "Pitch", setting.pitch);
+            setParameter(*plugin, "Tempo", setting.tempo);
+            setParameter(*plugin, "Speed", setting.speed);
+            
+            plugin->setNonRealtime(true);
+            plugin->prepareToPlay(clip.sampleRate, blockSize);
+            
+            juce::AudioBuffer<float> output;
+            const double seconds = render(*plugin, clip, output);
+            const double audioSeconds = output.getNumSamples() / clip.sampleRate;
+            const auto hostedStats = getHostedStats();
+            
+            plugin->releaseResources();
+            
+            std::cout << "  " << juce::String(setting.name).paddedRight(' ', 40)
+                      << juce::String(audioSeconds / seconds, 1).paddedLeft(' ', 12) << " xRT" << std::endl;
+            
+            totalAudioSeconds += audioSeconds;
+            totalRenderSeconds += seconds;
+            
+            if (outputDirectory != juce::File())
+            {
+                const auto file = outputDirectory.getChildFile(juce::File::createLegalFileName(
+                    juce::File(clip.name).getFileNameWithoutExtension() + " - " + setting.name + ".wav"));
+                
+                const double encodeStartMs = juce::Time::getMillisecondCounterHiRes();
+                
+                if (! writeWav(file, output, clip.sampleRate))
+                    std::cerr << "Could not write " << file.getFullPathName() << std::endl;
+                
+                metrics.encodeSeconds += secondsSince(encodeStartMs);
+            }
+            
+            metrics.rendersCompleted += 1;
+            metrics.rendersQueued -= 1;
+            metrics.framesRendered += output.getNumSamples();
+            metrics.stretchSeconds += seconds;
+            metrics.underruns += hostedStats.underruns;
+            metrics.droppedFrames += hostedStats.droppedFrames;
+            metrics.p99BlockSeconds = hostedStats.p99BlockMs / 1000.0;
+            metrics.latencySeconds = hostedStats.latencyMs / 1000.0;
+            publishMetrics();
+        }
+        
+        metrics.filesProcessed += 1;
+        publishMetrics();
+    }
+    
+    // `make pgo` compares this line between builds
+    std::cout << "Total: " << juce::String(totalAudioSeconds, 1) << " s of audio in "
+              << juce::String(totalRenderSeconds, 2) << " s, "
+              << juce::String(totalAudioSeconds / totalRenderSeconds, 1) << " xRT" << std::endl;
+    
+    return 0;
+}
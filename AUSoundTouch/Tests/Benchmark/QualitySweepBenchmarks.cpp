@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "TimeStretchEngine.h"
+#include <vector>
+
+// Output quality against cost as the stretch grows. A two-tone chord is slowed
+// down by each factor; the tone-to-residue ratio is the energy near the two
+// partials over everything else (splice stutter, phasiness smearing, aliasing),
+// so higher is cleaner. The phase vocoder should pull ahead of SoundTouch from
+// about 4x, where WSOLA starts repeating whole sequences, at a similar cost per
+// output frame.
+//
+// Pitching up at the original tempo stretches just as far, so the second sweep
+// shifts the chord plus a high partial up by each interval. Once the partial
+// lands past Nyquist it has to vanish rather than fold back into the band.
+class QualitySweepBenchmark : public Benchmark
+{
+public:
+    QualitySweepBenchmark() : Benchmark("Engine quality sweep") {}
+    
+    void run() override
+    {
+        const double stretches[] = { 1.0, 2.0, 4.0, 6.0, 8.0 };
+        const float pitchUpSemitones[] = { 12.0f, 24.0f, 36.0f };
+        
+        const TimeStretchEngine::Type types[] = {
+            TimeStretchEngine::Type::Standard,
+            TimeStretchEngine::Type::HighQuality,
+            TimeStretchEngine::Type::PhaseVocoder
+        };
+        
+        for (const double stretch : stretches)
+        {
+            std::cout << "Stretch " << stretch << "x" << std::endl;
+            
+            for (const auto type : types)
+            {
+                const auto result = render(type, 1.0f, stretch);
+                const juce::String typeName(TimeStretchEngine::getTypeName(type));
+                
+                logResult(typeName + " tone-to-residue", result.toneToResidueDb, "dB");
+                logResult(typeName + " cost per output frame", result.nanosecondsPerOutputFrame, "ns");
+            }
+        }
+        
+        for (const float semitones : pitchUpSemitones)
+        {
+            std::cout << "Pitch +" << semitones << " st" << std::endl;
+            
+            for (const auto type : types)
+            {
+                const auto result = render(type, std::pow(2.0f, semitones / 12.0f), 1.0);
+                const juce::String typeName(TimeStretchEngine::getTypeName(type));
+                
+                logResult(typeName + " tone-to-residue", result.toneToResidueDb, "dB");
+                logResult(typeName + " cost per output frame", result.nanosecondsPerOutputFrame, "ns");
+            }
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr double inputSeconds = 4.0;
+    
+    // A major third: close enough that a smeared spectrum shows between them.
+    // The chord is played at the original pitch; pitched up, the high partial
+    // joins it, and passes Nyquist from two octaves up.
+    static constexpr float toneFrequencies[] = { 440.0f, 554.37f };
+    static constexpr float highPartialFrequency = 7000.0f;
+    
+    struct Result
+    {
+        double toneToResidueDb = 0.0;
+        double nanosecondsPerOutputFrame = 0.0;
+    };
+    
+    static Result render(TimeStretchEngine::Type type, float pitch, double stretch)
+    {
+        auto engine = TimeStretchEngine::create(type, 3);
+        engine->prepare(sampleRate, 1, blockSize);
+        engine->setRatios(pitch, static_cast<float>(1.0 / stretch), 1.0f);
+        
+        const bool withHighPartial = pitch > 1.0f;
+        
+        const int numBlocks = static_cast<int>(sampleRate * inputSeconds) / blockSize;
+        
+        // Sized up front so receiving straight into it is all that gets timed
+        std::vector<float> output(static_cast<size_t>(numBlocks * blockSize * stretch) + 16384);
+        std::vector<float> input(static_cast<size_t>(blockSize));
+        int received = 0;
+        double seconds = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                const double time = static_cast<double>(block * blockSize + sample) / sampleRate;
+                double value = 0.0;
+                
+                for (const float frequency : toneFrequencies)
+                    value += 0.25 * std::sin(2.0 * juce::MathConstants<double>::pi * frequency * time);
+                
+                if (withHighPartial)
+                    value += 0.25 * std::sin(2.0 * juce::MathConstants<double>::pi * highPartialFrequency * time);
+                
+                input[static_cast<size_t>(sample)] = static_cast<float>(value);
+            }
+            
+            seconds += timeSeconds([&]
+            {
+                engine->putSamples(input.data(), blockSize);
+                
+                while (const int frames = engine->receiveSamples(output.data() + received,
+                                                                 static_cast<int>(output.size()) - received))
+                    received += frames;
+            });
+        }
+        
+        output.resize(static_cast<size_t>(received));
+        
+        Result result;
+        result.toneToResidueDb = measureToneToResidue(output, pitch, withHighPartial);
+        result.nanosecondsPerOutputFrame = 1.0e9 * seconds / std::max(1, received);
+        return result;
+    }
+    
+    // Hann-windowed spectra of successive frames, skipping the first one while
+    // the engine fades in. Tones are expected at the input partials times the
+    // pitch ratio, wherever that is still below Nyquist.
+    static double measureToneToResidue(const std::vector<float>& signal, float pitch, bool withHighPartial)
+    {
+        constexpr int fftOrder = 13;
+        constexpr int fftSize = 1 << fftOrder;
+        constexpr int toneHalfWidthBins = 4;
+        
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> frame(static_cast<size_t>(fftSize * 2));
+        double tone = 0.0;
+        double residue = 0.0;
+        
+        for (size_t start = fftSize; start + fftSize <= signal.size(); start += fftSize)
+        {
+            for (int i = 0; i < fftSize; ++i)
+            {
+                const double window = 0.5 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * i / fftSize);
+                frame[static_cast<size_t>(i)] = static_cast<float>(signal[start + static_cast<size_t>(i)] * window);
+            }
+            
+            std::fill(frame.begin() + fftSize, frame.end(), 0.0f);
+            fft.performFrequencyOnlyForwardTransform(frame.data(), true);
+            
+            for (int bin = 1; bin <= fftSize / 2; ++bin)
+            {
+                const double power = static_cast<double>(frame[static_cast<size_t>(bin)]) * frame[static_cast<size_t>(bin)];
+                bool isTone = false;
+                
+                for (const float frequency : toneFrequencies)
+                    isTone = isTone || std::abs(bin - frequency * pitch * fftSize / sampleRate) <= toneHalfWidthBins;
+                
+                if (withHighPartial)
+                    isTone = isTone || std::abs(bin - highPartialFrequency * pitch * fftSize / sampleRate) <= toneHalfWidthBins;
+                
+                (isTone ? tone : residue) += power;
+            }
+        }
+        
+        return 10.0 * std::log10(tone / std::max(residue, 1.0e-20));
+    }
+};
+
+static QualitySweepBenchmark qualitySweepBenchmark;
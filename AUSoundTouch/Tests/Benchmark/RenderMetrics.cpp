@@ -0,0 +1,248 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "RenderMetrics.h"
+#include <cstring>
+#include <iostream>
+
+#if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+ #define AUSOUNDTOUCH_UNIX_SOCKETS 1
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#else
+ #define AUSOUNDTOUCH_UNIX_SOCKETS 0
+#endif
+
+namespace
+{
+    void addFamily(juce::String& text, const char* name, const char* type, const char* help)
+    {
+        text << "# TYPE " << name << " " << type << "\n"
+             << "# HELP " << name << " " << help << "\n";
+    }
+    
+    void addSample(juce::String& text, const juce::String& name, double value)
+    {
+        text << name << " " << juce::String(value, 6) << "\n";
+    }
+    
+    void addSample(juce::String& text, const juce::String& name, juce::int64 value)
+    {
+        text << name << " " << juce::String(value) << "\n";
+    }
+}
+
+juce::String RenderMetrics::toOpenMetrics() const
+{
+    juce::String result;
+    
+    addFamily(result, "ausoundtouch_render_files", "counter", "Corpus files rendered at every setting.");
+    addSample(result, "ausoundtouch_render_files_total", filesProcessed);
+    
+    addFamily(result, "ausoundtouch_render_renders", "counter", "Renders completed, one per file and setting.");
+    addSample(result, "ausoundtouch_render_renders_total", rendersCompleted);
+    
+    addFamily(result, "ausoundtouch_render_queue_depth", "gauge", "Renders still to do in this run.");
+    addSample(result, "ausoundtouch_render_queue_depth", rendersQueued);
+    
+    addFamily(result, "ausoundtouch_render_frames", "counter", "Frames rendered, tails included.");
+    addSample(result, "ausoundtouch_render_frames_total", framesRendered);
+    
+    addFamily(result, "ausoundtouch_render_frames_per_second", "gauge", "Frames rendered per second of wall time since the run started.");
+    addSample(result, "ausoundtouch_render_frames_per_second", elapsedSeconds > 0.0 ? framesRendered / elapsedSeconds : 0.0);
+    
+    addFamily(result, "ausoundtouch_render_stage_seconds", "counter", "Wall time spent in each stage.");
+    result << "# UNIT ausoundtouch_render_stage_seconds seconds\n";
+    addSample(result, "ausoundtouch_render_stage_seconds_total{stage=\"decode\"}", decodeSeconds);
+    addSample(result, "ausoundtouch_render_stage_seconds_total{stage=\"stretch\"}", stretchSeconds);
+    addSample(result, "ausoundtouch_render_stage_seconds_total{stage=\"encode\"}", encodeSeconds);
+    
+    // One worker renders everything, so this is how busy that worker is
+    addFamily(result, "ausoundtouch_render_worker_utilisation", "gauge", "Share of wall time spent in processBlock.");
+    addSample(result, "ausoundtouch_render_worker_utilisation", elapsedSeconds > 0.0 ? stretchSeconds / elapsedSeconds : 0.0);
+    
+    addFamily(result, "ausoundtouch_plugin_underruns", "counter", "FIFO underruns in the hosted plugin, summed over renders.");
+    addSample(result, "ausoundtouch_plugin_underruns_total", underruns);
+    
+    addFamily(result, "ausoundtouch_plugin_dropped_frames", "counter", "Frames the hosted plugin dropped, summed over renders.");
+    addSample(result, "ausoundtouch_plugin_dropped_frames_total", droppedFrames);
+    
+    addFamily(result, "ausoundtouch_plugin_p99_block_seconds", "gauge", "99th-percentile processBlock time in the latest render.");
+    result << "# UNIT ausoundtouch_plugin_p99_block_seconds seconds\n";
+    addSample(result, "ausoundtouch_plugin_p99_block_seconds", p99BlockSeconds);
+    
+    addFamily(result, "ausoundtouch_plugin_latency_seconds", "gauge", "Audio held back by the hosted plugin in the latest render.");
+    result << "# UNIT ausoundtouch_plugin_latency_seconds seconds\n";
+    addSample(result, "ausoundtouch_plugin_latency_seconds", latencySeconds);
+    
+    result << "# EOF\n";
+    return result;
+}
+
+MetricsExporter::MetricsExporter()
+    : juce::Thread("AUSoundTouch Metrics")
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stopThread(1000);
+    
+   #if AUSOUNDTOUCH_UNIX_SOCKETS
+    if (listener >= 0)
+    {
+        close(listener);
+        unlink(socketPath.toRawUTF8());
+    }
+   #endif
+}
+
+bool MetricsExporter::listenOnSocket(const juce::String& path)
+{
+   #if AUSOUNDTOUCH_UNIX_SOCKETS
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    
+    if (listener >= 0 || path.getNumBytesAsUTF8() >= sizeof(address.sun_path))
+        return false;
+    
+    path.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+    unlink(address.sun_path);
+    
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    
+    if (listener < 0)
+        return false;
+    
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0)
+    {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    
+    socketPath = path;
+    startThread(juce::Thread::Priority::low);
+    return true;
+   #else
+    juce::ignoreUnused(path);
+    return false;
+   #endif
+}
+
+void MetricsExporter::publish(const RenderMetrics& metrics)
+{
+    const auto newText = metrics.toOpenMetrics();
+    
+    {
+        const juce::ScopedLock sl(textLock);
+        text = newText;
+    }
+    
+    if (metricsFile == juce::File())
+        return;
+    
+    // Written beside the target and renamed over it
+    juce::TemporaryFile temporary(metricsFile);
+    
+    if (! temporary.getFile().replaceWithText(newText, false, false, "\n") || ! temporary.overwriteTargetFileWithTemporary())
+        std::cerr << "Could not write " << metricsFile.getFullPathName() << std::endl;
+}
+
+void MetricsExporter::run()
+{
+   #if AUSOUNDTOUCH_UNIX_SOCKETS
+    while (! threadShouldExit())
+    {
+        // Wake regularly to check for shutdown
+        pollfd waiting { listener, POLLIN, 0 };
+        
+        if (poll(&waiting, 1, 100) <= 0)
+            continue;
+        
+        const int connection = accept(listener, nullptr, nullptr);
+        
+        if (connection >= 0)
+        {
+            serve(connection);
+            close(connection);
+        }
+    }
+   #endif
+}
+
+void MetricsExporter::serve(int connection)
+{
+   #if AUSOUNDTOUCH_UNIX_SOCKETS
+    // HTTP clients speak first; bare readers such as `socat` or `nc -U` don't,
+    // so give them a moment and then send the text plain
+    char request[1024];
+    ssize_t requestSize = 0;
+    pollfd waiting { connection, POLLIN, 0 };
+    
+    if (poll(&waiting, 1, 200) > 0)
+        requestSize = recv(connection, request, sizeof(request), 0);
+    
+    juce::String body;
+    
+    {
+        const juce::ScopedLock sl(textLock);
+        body = text;
+    }
+    
+    juce::String response;
+    
+    if (requestSize >= 4 && std::memcmp(request, "GET ", 4) == 0)
+        response << "HTTP/1.1 200 OK\r\n"
+                 << "Content-Type: " << CONTENT_TYPE << "\r\n"
+                 << "Content-Length: " << static_cast<int>(body.getNumBytesAsUTF8()) << "\r\n"
+                 << "Connection: close\r\n\r\n";
+    
+    response << body;
+    
+    // A client that hangs up early must not take the renderer down with SIGPIPE
+   #ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+   #else
+    const int flags = 0;
+    const int noSigPipe = 1;
+    setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+   #endif
+    
+    const char* data = response.toRawUTF8();
+    size_t remaining = response.getNumBytesAsUTF8();
+    
+    while (remaining > 0)
+    {
+        const ssize_t sent = send(connection, data, remaining, flags);
+        
+        if (sent <= 0)
+            break;
+        
+        data += sent;
+        remaining -= static_cast<size_t>(sent);
+    }
+   #else
+    juce::ignoreUnused(connection);
+   #endif
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+
+// What the offline renderer exports for a batch worker's scraper, so its
+// throughput can be tracked without parsing the console output
+struct RenderMetrics
+{
+    juce::int64 filesProcessed = 0;      // Corpus files rendered at every setting
+    juce::int64 rendersCompleted = 0;    // One per file and setting
+    juce::int64 rendersQueued = 0;       // Still to do in this run
+    juce::int64 framesRendered = 0;
+    
+    // Wall time per stage: loading the corpus, processBlock(), writing WAV files
+    double decodeSeconds = 0.0;
+    double stretchSeconds = 0.0;
+    double encodeSeconds = 0.0;
+    double elapsedSeconds = 0.0;         // Since the run started
+    
+    // From the hosted plugin's slot in the stats segment (see StatsSegment.h):
+    // summed over renders, and as of the latest render
+    juce::int64 underruns = 0;
+    juce::int64 droppedFrames = 0;
+    double p99BlockSeconds = 0.0;
+    double latencySeconds = 0.0;
+    
+    // OpenMetrics text exposition, ending in "# EOF"
+    juce::String toOpenMetrics() const;
+};
+
+// Makes the latest RenderMetrics available as a file, replaced whole on each
+// publish so a reader never sees half of one, and/or on a Unix domain socket
+// served by a background thread for as long as the exporter lives. A client
+// that opens with an HTTP request (curl --unix-socket) gets an HTTP response;
+// any other gets the bare text.
+class MetricsExporter : private juce::Thread
+{
+public:
+    MetricsExporter();
+    ~MetricsExporter() override;
+    
+    void setFile(const juce::File& file) { metricsFile = file; }
+    
+    // Removes anything already at the path first. Returns false where Unix
+    // domain sockets aren't available or the socket can't be bound.
+    bool listenOnSocket(const juce::String& path);
+    
+    void publish(const RenderMetrics& metrics);
+    
+    static constexpr const char* CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    
+private:
+    void run() override;
+    void serve(int connection);
+    
+    juce::File metricsFile;
+    juce::String socketPath;
+    int listener = -1;
+    
+    juce::CriticalSection textLock;
+    juce::String text;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetricsExporter)
+};
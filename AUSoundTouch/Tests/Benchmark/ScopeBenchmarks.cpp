@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+#include <vector>
+
+// What the editor's waveform and spectrum view costs the audio thread: the
+// processor's block time with no view open, against the same run with one
+// open. Draining the ring, as the view's timer would, is left out of the
+// timed region since it happens on the message thread.
+class SignalScopeBenchmark : public Benchmark
+{
+public:
+    SignalScopeBenchmark() : Benchmark("Signal scope overhead") {}
+    
+    void run() override
+    {
+        // Alternate so both runs see the same thermal and cache conditions
+        double closedSeconds = 0.0;
+        double openSeconds = 0.0;
+        
+        for (int pass = 0; pass < numPasses; ++pass)
+        {
+            closedSeconds += processSeconds(false);
+            openSeconds += processSeconds(true);
+        }
+        
+        const double numBlocks = static_cast<double>(numPasses) * blocksPerPass;
+        
+        logResult("Block time, view closed", 1.0e6 * closedSeconds / numBlocks, "us");
+        logResult("Block time, view open", 1.0e6 * openSeconds / numBlocks, "us");
+        logResult("Overhead of an open view", 100.0 * (openSeconds - closedSeconds) / closedSeconds, "%");
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numPasses = 4;
+    static constexpr int blocksPerPass = 2000;
+    
+    static double processSeconds(bool viewOpen)
+    {
+        AUSoundTouchProcessor processor;
+        
+        if (auto* pitch = processor.getParameters().getParameter("pitch"))
+            pitch->setValueNotifyingHost(pitch->convertTo0to1(3.0f));
+        
+        processor.prepareToPlay(sampleRate, blockSize);
+        
+        auto& scope = processor.getSignalScope();
+        std::vector<SignalScope::Frame> frames(static_cast<size_t>(SignalScope::CAPACITY));
+        
+        if (viewOpen)
+            scope.addViewer();
+        
+        juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), blockSize);
+        juce::MidiBuffer midi;
+        double total = 0.0;
+        
+        for (int block = 0; block < blocksPerPass; ++block)
+        {
+            fillSine(buffer, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            total += timeSeconds([&] { processor.processBlock(buffer, midi); });
+            scope.pull(frames.data(), static_cast<int>(frames.size()));
+        }
+        
+        if (viewOpen)
+            scope.removeViewer();
+        
+        processor.releaseResources();
+        return total;
+    }
+};
+
+static SignalScopeBenchmark signalScopeBenchmark;
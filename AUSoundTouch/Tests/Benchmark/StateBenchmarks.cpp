@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+// Session load cost: 1000 save/restore round-trips through the binary state,
+// against restoring the same settings from the legacy XML form.
+class StateRoundTripBenchmark : public Benchmark
+{
+public:
+    StateRoundTripBenchmark() : Benchmark("Processor state round-trip") {}
+    
+    void run() override
+    {
+        AUSoundTouchProcessor source;
+        AUSoundTouchProcessor destination;
+        
+        if (auto* pitch = source.getParameters().getParameter("pitch"))
+            pitch->setValueNotifyingHost(pitch->convertTo0to1(-5.0f));
+        
+        juce::MemoryBlock binaryState;
+        source.getStateInformation(binaryState);
+        
+        auto xml = source.getParameters().copyState().createXml();
+        xml->setAttribute("bufferingMode", source.getBufferingMode());
+        xml->setAttribute("qualityMode", source.getQualityMode());
+        
+        juce::MemoryBlock legacyState;
+        juce::AudioProcessor::copyXmlToBinary(*xml, legacyState);
+        
+        juce::MemoryBlock scratch;
+        
+        const double saveSeconds = timeSeconds([&]
+        {
+            for (int i = 0; i < numRoundTrips; ++i)
+                source.getStateInformation(scratch);
+        });
+        
+        const double binaryLoadSeconds = timeSeconds([&]
+        {
+            for (int i = 0; i < numRoundTrips; ++i)
+                destination.setStateInformation(binaryState.getData(), static_cast<int>(binaryState.getSize()));
+        });
+        
+        const double legacyLoadSeconds = timeSeconds([&]
+        {
+            for (int i = 0; i < numRoundTrips; ++i)
+                destination.setStateInformation(legacyState.getData(), static_cast<int>(legacyState.getSize()));
+        });
+        
+        logResult("Binary state size", static_cast<double>(binaryState.getSize()), "bytes");
+        logResult("Legacy XML state size", static_cast<double>(legacyState.getSize()), "bytes");
+        logResult("Binary save", 1.0e6 * saveSeconds / numRoundTrips, "us");
+        logResult("Binary load", 1.0e6 * binaryLoadSeconds / numRoundTrips, "us");
+        logResult("Legacy XML load", 1.0e6 * legacyLoadSeconds / numRoundTrips, "us");
+        logResult("Round-trip (save + load)", 1.0e6 * (saveSeconds + binaryLoadSeconds) / numRoundTrips, "us");
+    }
+    
+private:
+    static constexpr int numRoundTrips = 1000;
+};
+
+static StateRoundTripBenchmark stateRoundTripBenchmark;
@@ -0,0 +1,398 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "TimeStretchEngine.h"
+#include "SpeechEngine.h"
+#include "Harmonizer.h"
+#include "VocalCorpus.h"
+#include <vector>
+
+// CPU per input sample on solo voice, SoundTouch against the pitch-synchronous
+// Monophonic engine, at the shifts a vocal tuning or harmony part would use.
+// The corpus is a synthetic phrase (a glottal source gliding over an octave
+// with vibrato, shaped by vowel formants, with unvoiced fricatives between
+// syllables). Point AUSOUNDTOUCH_VOCAL_CORPUS at a directory of WAV files to
+// run on real recordings instead; each file is mixed down to mono.
+class VocalBenchmark : public Benchmark
+{
+public:
+    VocalBenchmark() : Benchmark("Vocal engine cost") {}
+    
+    void run() override
+    {
+        const auto corpus = loadVocalCorpus();
+        const float semitones[] = { -5.0f, 3.0f, 7.0f };
+        
+        const TimeStretchEngine::Type types[] = {
+            TimeStretchEngine::Type::Standard,
+            TimeStretchEngine::Type::HighQuality,
+            TimeStretchEngine::Type::Monophonic
+        };
+        
+        for (const auto& clip : corpus)
+        {
+            std::cout << clip.name << " (" << juce::String(clip.samples.size() / clip.sampleRate, 1) << " s)" << std::endl;
+            
+            for (const float shift : semitones)
+            {
+                const float pitch = std::pow(2.0f, shift / 12.0f);
+                
+                for (const auto type : types)
+                {
+                    const double seconds = render(type, clip, pitch);
+                    const auto numSamples = static_cast<double>(clip.samples.size());
+                    const juce::String label = juce::String(TimeStretchEngine::getTypeName(type))
+                                             + (shift > 0.0f ? " +" : " ") + juce::String(juce::roundToInt(shift)) + " st";
+                    
+                    logResult(label + " per sample", 1.0e9 * seconds / numSamples, "ns");
+                    logResult(label + " realtime factor", numSamples / clip.sampleRate / seconds, "x");
+                }
+            }
+        }
+    }
+    
+private:
+    static constexpr int blockSize = 256;
+    
+    // Seconds spent in the engine, at unity tempo
+    static double render(TimeStretchEngine::Type type, const VocalClip& clip, float pitch)
+    {
+        auto engine = TimeStretchEngine::create(type, 3);
+        engine->prepare(clip.sampleRate, 1, blockSize);
+        engine->setRatios(pitch, 1.0f, 1.0f);
+        
+        std::vector<float> output(static_cast<size_t>(blockSize * 16));
+        const int numSamples = static_cast<int>(clip.samples.size());
+        int received = 0;
+        
+        const double seconds = timeSeconds([&]
+        {
+            for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+            {
+                engine->putSamples(clip.samples.data() + start, blockSize);
+                
+                while (const int frames = engine->receiveSamples(output.data(), blockSize * 16))
+                    received += frames;
+            }
+        });
+        
+        // Only the latency should be missing
+        jassert(received >= numSamples - blockSize - 2 * engine->getInitialLatency());
+        juce::ignoreUnused(received);
+        return seconds;
+    }
+};
+
+static VocalBenchmark vocalBenchmark;
+
+// The Speech engine against full-rate SoundTouch on the same material: the
+// CPU saving, and how far the long-term spectrum of its output strays from the
+// full-rate output below and above the crossover. A few dB above it is the
+// expected price of the cheap high band; below it the two should agree, and
+// both bounds are checked. Pitching up also checks the band between the
+// crossover and Nyquist holds no more energy than the full-rate output, where
+// aliases from an unfiltered high band would show.
+class SpeechBenchmark : public Benchmark
+{
+public:
+    SpeechBenchmark() : Benchmark("Speech band split") {}
+    
+    void run() override
+    {
+        struct Setting
+        {
+            const char* name;
+            float pitch, tempo, rate;
+        };
+        
+        const Setting settings[] = {
+            { "tempo 80%", 1.0f, 0.8f, 1.0f },
+            { "tempo 125%", 1.0f, 1.25f, 1.0f },
+            { "pitch -3 st", 0.8409f, 1.0f, 1.0f },
+            { "pitch +4 st", 1.2599f, 1.0f, 1.0f },
+            { "pitch +12 st", 2.0f, 1.0f, 1.0f },
+            { "speed 125%", 1.0f, 1.0f, 1.25f }
+        };
+        
+        double fullRateSeconds = 0.0;
+        double speechSeconds = 0.0;
+        
+        for (const auto& clip : loadVocalCorpus())
+        {
+            std::cout << clip.name << " (" << juce::String(clip.samples.size() / clip.sampleRate, 1) << " s)" << std::endl;
+            
+            for (const auto& setting : settings)
+            {
+                const auto fullRate = render(TimeStretchEngine::Type::Standard, clip, setting.pitch, setting.tempo, setting.rate);
+                const auto speech = render(TimeStretchEngine::Type::Speech, clip, setting.pitch, setting.tempo, setting.rate);
+                const double crossover = SpeechEngine::CROSSOVER * SpeechEngine::LOW_BAND_RATE * 0.5;
+                const juce::String label(setting.name);
+                
+                logResult(label + " full rate", 1.0e9 * fullRate.seconds / clip.samples.size(), "ns/sample");
+                logResult(label + " speech", 1.0e9 * speech.seconds / clip.samples.size(), "ns/sample");
+                logResult(label + " speedup", fullRate.seconds / speech.seconds, "x");
+                fullRateSeconds += fullRate.seconds;
+                speechSeconds += speech.seconds;
+                
+                const double distanceBelow = getSpectralDistance(fullRate.output, speech.output, clip.sampleRate, 50.0, crossover);
+                const double distanceAbove = getSpectralDistance(fullRate.output, speech.output, clip.sampleRate,
+                                                                 crossover, clip.sampleRate / 2);
+                logResult(label + " spectral distance below crossover", distanceBelow, "dB");
+                logResult(label + " spectral distance above crossover", distanceAbove, "dB");
+                checkResult(label + " spectral distance below crossover", distanceBelow, MAX_DISTANCE_BELOW_DB);
+                checkResult(label + " spectral distance above crossover", distanceAbove, MAX_DISTANCE_ABOVE_DB);
+                
+                if (setting.pitch * setting.rate > 1.0f)
+                {
+                    const double excess = getBandEnergy(speech.output, clip.sampleRate, crossover, clip.sampleRate / 2)
+                                        - getBandEnergy(fullRate.output, clip.sampleRate, crossover, clip.sampleRate / 2);
+                    logResult(label + " excess energy above crossover", excess, "dB");
+                    checkResult(label + " excess energy above crossover", excess, MAX_EXCESS_ABOVE_DB);
+                }
+            }
+        }
+        
+        logResult("Overall speedup", fullRateSeconds / std::max(speechSeconds, 1.0e-9), "x");
+    }
+    
+private:
+    static constexpr int blockSize = 256;
+    static constexpr int fftOrder = 11;
+    
+    // Quality bounds, in dB
+    static constexpr double MAX_DISTANCE_BELOW_DB = 6.0;
+    static constexpr double MAX_DISTANCE_ABOVE_DB = 12.0;
+    static constexpr double MAX_EXCESS_ABOVE_DB = 3.0;
+    
+    struct Result
+    {
+        double seconds = 0.0;
+        std::vector<float> output;
+    };
+    
+    static Result render(TimeStretchEngine::Type type, const VocalClip& clip, float pitch, float tempo, float rate)
+    {
+        auto engine = TimeStretchEngine::create(type, 3);
+        engine->prepare(clip.sampleRate, 1, blockSize);
+        engine->setRatios(pitch, tempo, rate);
+        
+        const int numSamples = static_cast<int>(clip.samples.size());
+        
+        // Sized up front so receiving straight into it is all that gets timed
+        Result result;
+        result.output.resize(static_cast<size_t>(numSamples * engine->getOutputPerInput(tempo, rate)) + 16384);
+        int received = 0;
+        
+        result.seconds = timeSeconds([&]
+        {
+            for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+            {
+                engine->putSamples(clip.samples.data() + start, blockSize);
+                
+                while (const int frames = engine->receiveSamples(result.output.data() + received,
+                                                                 static_cast<int>(result.output.size()) - received))
+                    received += frames;
+            }
+        });
+        
+        result.output.resize(static_cast<size_t>(received));
+        return result;
+    }
+    
+    // Average power spectrum over Hann-windowed frames
+    static std::vector<double> getLongTermSpectrum(const std::vector<float>& signal)
+    {
+        constexpr int fftSize = 1 << fftOrder;
+        
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> frame(static_cast<size_t>(fftSize * 2));
+        std::vector<double> spectrum(static_cast<size_t>(fftSize / 2 + 1), 0.0);
+        
+        for (size_t start = 0; start + fftSize <= signal.size(); start += fftSize / 2)
+        {
+            for (int i = 0; i < fftSize; ++i)
+            {
+                const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / fftSize);
+                frame[static_cast<size_t>(i)] = static_cast<float>(signal[start + static_cast<size_t>(i)] * window);
+            }
+            
+            std::fill(frame.begin() + fftSize, frame.end(), 0.0f);
+            fft.performFrequencyOnlyForwardTransform(frame.data(), true);
+            
+            for (size_t bin = 0; bin < spectrum.size(); ++bin)
+                spectrum[bin] += static_cast<double>(frame[bin]) * frame[bin];
+        }
+        
+        return spectrum;
+    }
+    
+    // Mean power per output frame over a band, in dB
+    static double getBandEnergy(const std::vector<float>& signal, double sampleRate,
+                                double lowFrequency, double highFrequency)
+    {
+        const auto spectrum = getLongTermSpectrum(signal);
+        const double binWidth = sampleRate / (1 << fftOrder);
+        double energy = 0.0;
+        
+        for (size_t bin = 1; bin < spectrum.size(); ++bin)
+        {
+            const double frequency = static_cast<double>(bin) * binWidth;
+            
+            if (frequency >= lowFrequency && frequency < highFrequency)
+                energy += spectrum[bin];
+        }
+        
+        return 10.0 * std::log10(energy / std::max<size_t>(1, signal.size()) + 1.0e-20);
+    }
+    
+    // RMS difference in dB between the two long-term spectra over a band
+    static double getSpectralDistance(const std::vector<float>& reference, const std::vector<float>& test,
+                                      double sampleRate, double lowFrequency, double highFrequency)
+    {
+        const auto referenceSpectrum = getLongTermSpectrum(reference);
+        const auto testSpectrum = getLongTermSpectrum(test);
+        
+        // Outputs of slightly different length: compare levels, not totals
+        const double scale = static_cast<double>(reference.size()) / std::max<size_t>(1, test.size());
+        const double binWidth = sampleRate / (1 << fftOrder);
+        double sum = 0.0;
+        int numBins = 0;
+        
+        for (size_t bin = 1; bin < referenceSpectrum.size(); ++bin)
+        {
+            const double frequency = static_cast<double>(bin) * binWidth;
+            
+            if (frequency < lowFrequency || frequency >= highFrequency)
+                continue;
+            
+            const double difference = 10.0 * std::log10((referenceSpectrum[bin] + 1.0e-12)
+                                                         / (testSpectrum[bin] * scale + 1.0e-12));
+            sum += difference * difference;
+            ++numBins;
+        }
+        
+        return std::sqrt(sum / std::max(1, numBins));
+    }
+};
+
+static SpeechBenchmark speechBenchmark;
+
+// Harmony parts from one input: the Harmonizer with N held notes, whose voices
+// share one analysis and run on the voice pool, against N Monophonic engines
+// each analysing the input for itself, which is what N plugin instances on
+// copies of the track would cost. The marginal figure is what each voice adds
+// over the dry path and the shared analysis.
+class HarmonyBenchmark : public Benchmark
+{
+public:
+    HarmonyBenchmark() : Benchmark("Harmony voices") {}
+    
+    void run() override
+    {
+        const int voiceCounts[] = { 1, 2, 4, 8 };
+        
+        for (const auto& clip : loadVocalCorpus())
+        {
+            std::cout << clip.name << " (" << juce::String(clip.samples.size() / clip.sampleRate, 1) << " s), "
+                      << juce::SharedResourcePointer<VoiceWorkerPool>()->getNumThreads() << " pool threads" << std::endl;
+            
+            const auto numSamples = static_cast<double>(clip.samples.size());
+            const double analysisOnly = renderHarmonizer(clip, 0);
+            logResult("Shared analysis, no voices", 1.0e9 * analysisOnly / numSamples, "ns/sample");
+            
+            for (const int numVoices : voiceCounts)
+            {
+                const double shared = renderHarmonizer(clip, numVoices);
+                const double separate = renderSeparateEngines(clip, numVoices);
+                const juce::String label = juce::String(numVoices) + (numVoices == 1 ? " voice" : " voices");
+                
+                logResult(label + " harmonizer", 1.0e9 * shared / numSamples, "ns/sample");
+                logResult(label + " marginal per voice", 1.0e9 * (shared - analysisOnly) / numVoices / numSamples, "ns/sample");
+                logResult(label + " as separate engines", 1.0e9 * separate / numSamples, "ns/sample");
+            }
+        }
+    }
+    
+private:
+    static constexpr int blockSize = 256;
+    
+    // Thirds, fifths and octaves either side of the reference
+    static constexpr int intervals[Harmonizer::MAX_VOICES] = { 4, 7, -5, 12, -8, -12, 16, 19 };
+    
+    static double renderHarmonizer(const VocalClip& clip, int numVoices)
+    {
+        Harmonizer harmonizer;
+        harmonizer.setMaxVoices(juce::jmax(1, numVoices));
+        harmonizer.prepare(clip.sampleRate, 1, blockSize);
+        
+        juce::MidiBuffer notes;
+        
+        for (int voice = 0; voice < numVoices; ++voice)
+            notes.addEvent(juce::MidiMessage::noteOn(1, Harmonizer::DEFAULT_REFERENCE_NOTE + intervals[voice], 1.0f), 0);
+        
+        const juce::MidiBuffer noMidi;
+        juce::AudioBuffer<float> buffer(1, blockSize);
+        const int numSamples = static_cast<int>(clip.samples.size());
+        
+        return timeSeconds([&]
+        {
+            for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+            {
+                buffer.copyFrom(0, 0, clip.samples.data() + start, blockSize);
+                harmonizer.processBlock(buffer, start == 0 ? notes : noMidi);
+            }
+        });
+    }
+    
+    static double renderSeparateEngines(const VocalClip& clip, int numVoices)
+    {
+        std::vector<std::unique_ptr<TimeStretchEngine>> engines;
+        
+        for (int voice = 0; voice < numVoices; ++voice)
+        {
+            engines.push_back(TimeStretchEngine::create(TimeStretchEngine::Type::Monophonic, 3));
+            engines.back()->prepare(clip.sampleRate, 1, blockSize);
+            engines.back()->setRatios(std::pow(2.0f, static_cast<float>(intervals[voice]) / 12.0f), 1.0f, 1.0f);
+        }
+        
+        std::vector<float> output(static_cast<size_t>(blockSize * 16));
+        const int numSamples = static_cast<int>(clip.samples.size());
+        
+        return timeSeconds([&]
+        {
+            for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+            {
+                for (auto& engine : engines)
+                {
+                    engine->putSamples(clip.samples.data() + start, blockSize);
+                    
+                    while (engine->receiveSamples(output.data(), blockSize * 16) > 0)
+                    {
+                    }
+                }
+            }
+        });
+    }
+};
+
+static HarmonyBenchmark harmonyBenchmark;
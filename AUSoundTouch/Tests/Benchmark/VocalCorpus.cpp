@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include "VocalCorpus.h"
+
+namespace
+{
+    constexpr double syntheticSampleRate = 48000.0;
+    
+    // Eight seconds of "singing": 250 ms syllables, one in four a fricative
+    VocalClip makeSyntheticPhrase()
+    {
+        constexpr double twoPi = juce::MathConstants<double>::twoPi;
+        constexpr double seconds = 8.0;
+        constexpr double syllableSeconds = 0.25;
+        
+        // First three formants of /a/, /i/ and /u/
+        constexpr double formants[3][3] = { { 730.0, 1090.0, 2440.0 },
+                                             { 270.0, 2290.0, 3010.0 },
+                                             { 300.0,  870.0, 2240.0 } };
+        
+        VocalClip clip;
+        clip.name = "Synthetic vocal phrase";
+        clip.samples.resize(static_cast<size_t>(seconds * syntheticSampleRate));
+        
+        juce::Random random(1234);
+        double phase = 0.0;
+        double resonatorState[3][2] = {};
+        float previousNoise = 0.0f;
+        
+        for (size_t i = 0; i < clip.samples.size(); ++i)
+        {
+            const double time = static_cast<double>(i) / syntheticSampleRate;
+            const int syllable = static_cast<int>(time / syllableSeconds);
+            
+            if (syllable % 4 == 3)
+            {
+                // Fricative: differenced noise, brighter than the vowels
+                const float noise = random.nextFloat() - 0.5f;
+                clip.samples[i] = 0.3f * (noise - previousNoise);
+                previousNoise = noise;
+                continue;
+            }
+            
+            // Glide over an octave and back, with 5.5 Hz vibrato of about a third of a semitone
+            const double glide = 0.5 - 0.5 * std::cos(twoPi * time / seconds);
+            const double f0 = 110.0 * std::pow(2.0, glide) * (1.0 + 0.02 * std::sin(twoPi * 5.5 * time));
+            phase += f0 / syntheticSampleRate;
+            phase -= std::floor(phase);
+            
+            // Band-limited glottal source: harmonics up to 10 kHz, rolling off at 6 dB/octave
+            double source = 0.0;
+            
+            for (int harmonic = 1; harmonic * f0 < 10000.0; ++harmonic)
+                source += std::sin(twoPi * harmonic * phase) / harmonic;
+            
+            // Parallel two-pole resonators, one per formant
+            const auto& vowel = formants[syllable % 3];
+            double voiced = 0.0;
+            
+            for (int f = 0; f < 3; ++f)
+            {
+                const double radius = std::exp(-juce::MathConstants<double>::pi * 80.0 / syntheticSampleRate);
+                const double coefficient = 2.0 * radius * std::cos(twoPi * vowel[f] / syntheticSampleRate);
+                const double output = (1.0 - radius) * source + coefficient * resonatorState[f][0]
+                                    - radius * radius * resonatorState[f][1];
+                resonatorState[f][1] = resonatorState[f][0];
+                resonatorState[f][0] = output;
+                voiced += output;
+            }
+            
+            clip.samples[i] = static_cast<float>(0.1 * voiced);
+        }
+        
+        return clip;
+    }
+}
+
+std::vector<VocalClip> loadVocalCorpus()
+{
+    std::vector<VocalClip> corpus;
+    const auto directory = juce::SystemStats::getEnvironmentVariable("AUSOUNDTOUCH_VOCAL_CORPUS", {});
+    
+    if (directory.isNotEmpty())
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        
+        for (const auto& file : juce::File(directory).findChildFiles(juce::File::findFiles, false, "*.wav"))
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+            
+            if (reader == nullptr || reader->lengthInSamples <= 0)
+                continue;
+            
+            const int numSamples = static_cast<int>(reader->lengthInSamples);
+            const int numChannels = static_cast<int>(reader->numChannels);
+            juce::AudioBuffer<float> buffer(numChannels, numSamples);
+            reader->read(&buffer, 0, numSamples, 0, true, true);
+            
+            VocalClip clip;
+            clip.name = file.getFileName();
+            clip.sampleRate = reader->sampleRate;
+            clip.samples.assign(static_cast<size_t>(numSamples), 0.0f);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(clip.samples.data(), buffer.getReadPointer(channel),
+                                                             1.0f / static_cast<float>(numChannels), numSamples);
+            
+            corpus.push_back(std::move(clip));
+        }
+    }
+    
+    if (corpus.empty())
+        corpus.push_back(makeSyntheticPhrase());
+    
+    return corpus;
+}
@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// One mono recording of a voice, for the benchmarks and the offline renderer
+struct VocalClip
+{
+    juce::String name;
+    double sampleRate = 48000.0;
+    std::vector<float> samples;
+};
+
+// The WAV files in AUSOUNDTOUCH_VOCAL_CORPUS, each mixed down to mono, or a
+// synthetic sung phrase when that isn't set or holds none: a glottal source
+// gliding over an octave with vibrato, shaped by vowel formants, with
+// unvoiced fricatives between syllables
+std::vector<VocalClip> loadVocalCorpus();
@@ -0,0 +1,605 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "SoundTouchWrapper.h"
+#include "OutputLayers.h"
+#include "SoundTouchCore.h"
+#include "SoundTouchEngine.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+// Every wrapper benchmark runs once per engine
+static constexpr TimeStretchEngine::Type benchmarkEngineTypes[] = {
+    TimeStretchEngine::Type::Standard,
+    TimeStretchEngine::Type::Resampling,
+    TimeStretchEngine::Type::LowLatency,
+    TimeStretchEngine::Type::HighQuality,
+    TimeStretchEngine::Type::PhaseVocoder,
+    TimeStretchEngine::Type::Live
+};
+
+// Three semitones up; the resampling engine can only get there as varispeed.
+// Call before prepare() so no rebuild is left pending.
+static void setUpBenchmarkEngine(SoundTouchWrapper& wrapper, TimeStretchEngine::Type type)
+{
+    wrapper.setEngineType(type);
+    
+    if (type == TimeStretchEngine::Type::Resampling)
+        wrapper.setRate(100.0f * (SoundTouchWrapper::semitonesToNative(3.0f) - 1.0f));
+    else
+        wrapper.setPitch(3.0f);
+}
+
+// Processing cost per channel for each supported layout, relative to stereo.
+// A layout scales well when its per-channel cost stays close to 1.0x.
+class ChannelScalingBenchmark : public Benchmark
+{
+public:
+    ChannelScalingBenchmark() : Benchmark("Wrapper channel scaling") {}
+    
+    void run() override
+    {
+        const std::pair<const char*, int> layouts[] = {
+            { "Mono", 1 },
+            { "Stereo", 2 },
+            { "5.1", 6 },
+            { "7.1", 8 },
+            { "7.1.4", 12 }
+        };
+        
+        for (const auto type : benchmarkEngineTypes)
+        {
+            double stereoCostPerChannel = 0.0;
+            
+            for (const auto& [layoutName, numChannels] : layouts)
+            {
+                const double seconds = processSeconds(type, numChannels);
+                const double costPerChannel = seconds / numChannels;
+                
+                if (numChannels == 2)
+                    stereoCostPerChannel = costPerChannel;
+                
+                const double frames = sampleRate * durationSeconds;
+                
+                std::cout << TimeStretchEngine::getTypeName(type) << ", " << layoutName << std::endl;
+                logResult("Realtime factor", durationSeconds / seconds, "xRT");
+                logResult("Cost per frame per channel", 1.0e9 * costPerChannel / frames, "ns");
+                
+                if (stereoCostPerChannel > 0.0)
+                    logResult("Per-channel cost vs stereo", costPerChannel / stereoCostPerChannel, "x");
+            }
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr double durationSeconds = 20.0;
+    
+    // Time spent inside processBlock only; signal generation is excluded
+    double processSeconds(TimeStretchEngine::Type type, int numChannels) const
+    {
+        SoundTouchWrapper wrapper;
+        setUpBenchmarkEngine(wrapper, type);
+        wrapper.prepare(sampleRate, blockSize, numChannels);
+        
+        juce::AudioBuffer<float> source(numChannels, blockSize);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        
+        const int numBlocks = static_cast<int>(sampleRate * durationSeconds) / blockSize;
+        double total = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine(source, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            buffer.makeCopyOf(source, true);
+            total += timeSeconds([&] { wrapper.processBlock(buffer); });
+        }
+        
+        return total;
+    }
+};
+
+static ChannelScalingBenchmark channelScalingBenchmark;
+
+// The double path narrows inside the interleave pass, so it should cost about
+// the same as the float path rather than adding a conversion copy each way.
+class DoublePrecisionBenchmark : public Benchmark
+{
+public:
+    DoublePrecisionBenchmark() : Benchmark("Wrapper double precision") {}
+    
+    void run() override
+    {
+        for (const auto type : benchmarkEngineTypes)
+        {
+            const double floatSeconds = processSeconds<float>(type);
+            const double doubleSeconds = processSeconds<double>(type);
+            
+            std::cout << TimeStretchEngine::getTypeName(type) << std::endl;
+            logResult("Float path", durationSeconds / floatSeconds, "xRT");
+            logResult("Double path", durationSeconds / doubleSeconds, "xRT");
+            logResult("Double cost vs float", doubleSeconds / floatSeconds, "x");
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numChannels = 2;
+    static constexpr double durationSeconds = 20.0;
+    
+    template <typename SampleType>
+    double processSeconds(TimeStretchEngine::Type type) const
+    {
+        SoundTouchWrapper wrapper;
+        setUpBenchmarkEngine(wrapper, type);
+        wrapper.prepare(sampleRate, blockSize, numChannels);
+        
+        juce::AudioBuffer<float> source(numChannels, blockSize);
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        
+        const int numBlocks = static_cast<int>(sampleRate * durationSeconds) / blockSize;
+        double total = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine(source, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            buffer.makeCopyOf(source, true);
+            total += timeSeconds([&] { wrapper.processBlock(buffer); });
+        }
+        
+        return total;
+    }
+};
+
+static DoublePrecisionBenchmark doublePrecisionBenchmark;
+
+// The interleave and de-interleave loops every block runs, specialised for the
+// channel count against the general loops, per frame. Only the counts with
+// their own loops are listed; every other count runs the general ones.
+class ChannelKernelBenchmark : public Benchmark
+{
+public:
+    ChannelKernelBenchmark() : Benchmark("Wrapper channel kernels") {}
+    
+    void run() override
+    {
+        for (const auto& [layoutName, numChannels] : { std::pair<const char*, int> { "Mono", 1 }, { "Stereo", 2 } })
+        {
+            std::cout << layoutName << std::endl;
+            report<float>("Float", numChannels);
+            report<double>("Double", numChannels);
+        }
+    }
+    
+private:
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 100000;
+    
+    template <typename SampleType>
+    void report(const juce::String& label, int numChannels) const
+    {
+        const double generalSeconds = processSeconds(getSoundTouchKernels<SampleType>(0), numChannels);
+        const double specialisedSeconds = processSeconds(getSoundTouchKernels<SampleType>(numChannels), numChannels);
+        const double frames = static_cast<double>(numBlocks) * blockSize;
+        
+        logResult(label + ", general loops", 1.0e9 * generalSeconds / frames, "ns/frame");
+        logResult(label + ", specialised loops", 1.0e9 * specialisedSeconds / frames, "ns/frame");
+        logResult(label + ", speedup", generalSeconds / specialisedSeconds, "x");
+    }
+    
+    // One interleave into SoundTouch's layout and one de-interleave back per block
+    template <typename SampleType>
+    static double processSeconds(const SoundTouchKernels<SampleType>& kernels, int numChannels)
+    {
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        std::vector<float> interleaved(static_cast<size_t>(numChannels * blockSize));
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int sample = 0; sample < blockSize; ++sample)
+                buffer.setSample(channel, sample, static_cast<SampleType>(0.001 * (sample + channel)));
+        
+        return timeSeconds([&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                kernels.interleave(buffer.getArrayOfReadPointers(), 0, interleaved.data(), blockSize, numChannels);
+                kernels.deinterleave(interleaved.data(), buffer.getArrayOfWritePointers(), 0, blockSize, numChannels);
+            }
+        });
+    }
+};
+
+static ChannelKernelBenchmark channelKernelBenchmark;
+
+// The same SoundTouch engine and wrapper loops built for each x86-64 level
+// this CPU runs, against the baseline build. Force a level for the whole
+// plugin with AUSOUNDTOUCH_CPU_LEVEL=1..4.
+class CpuLevelBenchmark : public Benchmark
+{
+public:
+    CpuLevelBenchmark() : Benchmark("Wrapper CPU levels") {}
+    
+    void run() override
+    {
+        std::cout << "Detected " << getCpuLevelName(detectCpuLevel())
+                  << ", plugin runs " << getCpuLevelName(getCpuLevel()) << std::endl;
+        
+        for (const auto type : { TimeStretchEngine::Type::Standard, TimeStretchEngine::Type::HighQuality })
+        {
+            std::cout << TimeStretchEngine::getTypeName(type) << std::endl;
+            
+            const auto tuning = SoundTouchEngine::getTuning(type, 3);
+            const double baselineSeconds = engineSeconds(tuning, CpuLevel::Baseline);
+            report(CpuLevel::Baseline, baselineSeconds, baselineSeconds, numBlocks);
+            
+            for (const auto level : { CpuLevel::X86_64_V2, CpuLevel::X86_64_V3, CpuLevel::X86_64_V4 })
+                if (isCpuLevelAvailable(level))
+                    report(level, engineSeconds(tuning, level), baselineSeconds, numBlocks);
+        }
+        
+        std::cout << "Stereo loops, float" << std::endl;
+        const double baselineSeconds = kernelSeconds(CpuLevel::Baseline);
+        report(CpuLevel::Baseline, baselineSeconds, baselineSeconds, numKernelBlocks);
+        
+        for (const auto level : { CpuLevel::X86_64_V2, CpuLevel::X86_64_V3, CpuLevel::X86_64_V4 })
+            if (isCpuLevelAvailable(level))
+                report(level, kernelSeconds(level), baselineSeconds, numKernelBlocks);
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numChannels = 2;
+    static constexpr int numBlocks = 2000;
+    static constexpr int numKernelBlocks = 100000;
+    
+    void report(CpuLevel level, double seconds, double baselineSeconds, int blocks) const
+    {
+        const juce::String name(getCpuLevelName(level));
+        logResult(name, 1.0e9 * seconds / (static_cast<double>(blocks) * blockSize), "ns/frame");
+        
+        if (level != CpuLevel::Baseline)
+            logResult(name + " speedup", baselineSeconds / seconds, "x");
+    }
+    
+    // Three semitones up, so both the stretch and the rate transposer run
+    static double engineSeconds(const SoundTouchEngine::Tuning& tuning, CpuLevel level)
+    {
+        SoundTouchEngine engine(tuning, level);
+        engine.prepare(sampleRate, numChannels, blockSize);
+        engine.setRatios(SoundTouchWrapper::semitonesToNative(3.0f), 1.0f, 1.0f);
+        
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        std::vector<float> interleaved(static_cast<size_t>(numChannels * blockSize));
+        std::vector<float> output(interleaved.size() * 4);
+        double seconds = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine(buffer, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                    interleaved[static_cast<size_t>(sample * numChannels + channel)] = buffer.getSample(channel, sample);
+            
+            seconds += timeSeconds([&]
+            {
+                engine.putSamples(interleaved.data(), blockSize);
+                
+                while (engine.receiveSamples(output.data(), blockSize * 4) > 0)
+                {
+                }
+            });
+        }
+        
+        return seconds;
+    }
+    
+    // An interleave into SoundTouch's layout and a de-interleave back per block
+    static double kernelSeconds(CpuLevel level)
+    {
+        const auto kernels = getSoundTouchKernels<float>(numChannels, level);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        std::vector<float> interleaved(static_cast<size_t>(numChannels * blockSize));
+        fillSine(buffer, 220.0f, sampleRate, 0);
+        
+        const double seconds = timeSeconds([&]
+        {
+            for (int block = 0; block < numKernelBlocks; ++block)
+            {
+                kernels.interleave(buffer.getArrayOfReadPointers(), 0, interleaved.data(), blockSize, numChannels);
+                kernels.deinterleave(interleaved.data(), buffer.getArrayOfWritePointers(), 0, blockSize, numChannels);
+            }
+        });
+        
+        return seconds;
+    }
+};
+
+static CpuLevelBenchmark cpuLevelBenchmark;
+
+// Transport jumps: cost of reset() against a full rebuild, and seek-to-audio,
+// i.e. how long after the seek the first processed sample is heard.
+class SeekRecoveryBenchmark : public Benchmark
+{
+public:
+    SeekRecoveryBenchmark() : Benchmark("Wrapper seek recovery") {}
+    
+    void run() override
+    {
+        for (const auto type : benchmarkEngineTypes)
+        {
+            std::cout << TimeStretchEngine::getTypeName(type) << std::endl;
+            runEngine(type);
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numChannels = 2;
+    static constexpr int numSeeks = 200;
+    
+    void runEngine(TimeStretchEngine::Type type)
+    {
+        SoundTouchWrapper wrapper;
+        setUpBenchmarkEngine(wrapper, type);
+        wrapper.prepare(sampleRate, blockSize, numChannels);
+        
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        
+        double resetSeconds = 0.0;
+        double rebuildSeconds = 0.0;
+        double seekToAudioSamples = 0.0;
+        
+        for (int seek = 0; seek < numSeeks; ++seek)
+        {
+            // Play a while so there is stale audio to discard
+            for (int block = 0; block < 32; ++block)
+            {
+                fillSine(buffer, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+                wrapper.processBlock(buffer);
+            }
+            
+            resetSeconds += timeSeconds([&] { wrapper.reset(); });
+            seekToAudioSamples += firstAudibleSample(wrapper, buffer);
+            
+            // A different block size forces the rebuild a host re-prepare used to cost
+            rebuildSeconds += timeSeconds([&] { wrapper.prepare(sampleRate, blockSize + 1 + (seek % 2), numChannels); });
+        }
+        
+        logResult("reset()", 1.0e6 * resetSeconds / numSeeks, "us");
+        logResult("Full rebuild via prepare()", 1.0e6 * rebuildSeconds / numSeeks, "us");
+        logResult("Seek to audio", 1000.0 * seekToAudioSamples / numSeeks / sampleRate, "ms");
+    }
+    
+    static int firstAudibleSample(SoundTouchWrapper& wrapper, juce::AudioBuffer<float>& buffer)
+    {
+        for (int block = 0; block < 64; ++block)
+        {
+            fillSine(buffer, 220.0f, sampleRate, static_cast<juce::int64>(block) * buffer.getNumSamples());
+            wrapper.processBlock(buffer);
+            
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                if (std::abs(buffer.getSample(0, sample)) > 1.0e-4f)
+                    return block * buffer.getNumSamples() + sample;
+        }
+        
+        return 64 * buffer.getNumSamples();
+    }
+};
+
+static SeekRecoveryBenchmark seekRecoveryBenchmark;
+
+// Per-block cost at a 32-frame host buffer, where a spike in any single block
+// is a dropout. An engine suits live use when its worst block stays close to
+// its mean.
+class SmallBlockBenchmark : public Benchmark
+{
+public:
+    SmallBlockBenchmark() : Benchmark("Wrapper small-block cost") {}
+    
+    void run() override
+    {
+        for (const auto type : benchmarkEngineTypes)
+        {
+            SoundTouchWrapper::Configuration configuration;
+            configuration.engineType = type;
+            configuration.bufferingMode = type == TimeStretchEngine::Type::Live ? 4 : 1;
+            
+            SoundTouchWrapper wrapper;
+            wrapper.configure(configuration);
+            setUpBenchmarkEngine(wrapper, type);
+            wrapper.prepare(sampleRate, blockSize, numChannels);
+            
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            std::vector<double> blockSeconds(static_cast<size_t>(numBlocks));
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                fillSine(buffer, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+                blockSeconds[static_cast<size_t>(block)] = timeSeconds([&] { wrapper.processBlock(buffer); });
+            }
+            
+            const double meanSeconds = std::accumulate(blockSeconds.begin(), blockSeconds.end(), 0.0) / numBlocks;
+            std::sort(blockSeconds.begin(), blockSeconds.end());
+            
+            std::cout << TimeStretchEngine::getTypeName(type) << std::endl;
+            logResult("Reported latency", 1000.0 * wrapper.getReportedLatencySamples() / sampleRate, "ms");
+            logResult("Mean block", 1.0e6 * meanSeconds, "us");
+            logResult("99.9th percentile block", 1.0e6 * blockSeconds[static_cast<size_t>(numBlocks * 999 / 1000)], "us");
+            logResult("Worst block vs mean", blockSeconds.back() / meanSeconds, "x");
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 32;
+    static constexpr int numChannels = 2;
+    static constexpr int numBlocks = 30000;
+};
+
+static SmallBlockBenchmark smallBlockBenchmark;
+
+// Output layers against as many separate wrappers, as separate plugin instances
+// would run them. Layers share one interleave and conversion pass with the main
+// engine and run alongside it on the voice pool, so their marginal cost should
+// be the stretch alone. Double precision, where the shared pass saves the most.
+class OutputLayersBenchmark : public Benchmark
+{
+public:
+    OutputLayersBenchmark() : Benchmark("Wrapper output layers") {}
+    
+    void run() override
+    {
+        for (const auto type : { TimeStretchEngine::Type::Standard, TimeStretchEngine::Type::LowLatency })
+        {
+            std::cout << TimeStretchEngine::getTypeName(type) << std::endl;
+            
+            const double mainSeconds = processLayersSeconds(type, 0);
+            logResult("Main output only", 1.0e9 * mainSeconds / numFrames, "ns/frame");
+            
+            for (int numLayers = 1; numLayers <= OutputLayers::MAX_LAYERS; ++numLayers)
+            {
+                const double layersSeconds = processLayersSeconds(type, numLayers);
+                const double separateSeconds = processSeparateSeconds(type, numLayers);
+                const juce::String label = juce::String(numLayers) + (numLayers == 1 ? " layer" : " layers");
+                
+                logResult(label + ", shared input", 1.0e9 * layersSeconds / numFrames, "ns/frame");
+                logResult(label + ", separate wrappers", 1.0e9 * separateSeconds / numFrames, "ns/frame");
+                logResult(label + ", marginal cost per layer",
+                          1.0e9 * (layersSeconds - mainSeconds) / (numLayers * numFrames), "ns/frame");
+            }
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numChannels = 2;
+    static constexpr double durationSeconds = 10.0;
+    static constexpr int numBlocks = static_cast<int>(sampleRate * durationSeconds) / blockSize;
+    static constexpr double numFrames = static_cast<double>(numBlocks) * blockSize;
+    
+    // Layers at an octave, a fifth and an octave below the main engine's +3
+    static constexpr float layerOffsets[] = { 12.0f, 7.0f, -12.0f };
+    
+    static SoundTouchWrapper::Configuration getConfiguration(TimeStretchEngine::Type type)
+    {
+        SoundTouchWrapper::Configuration configuration;
+        configuration.engineType = type;
+        configuration.bufferingMode = type == TimeStretchEngine::Type::LowLatency ? 1 : 2;
+        return configuration;
+    }
+    
+    double processLayersSeconds(TimeStretchEngine::Type type, int numLayers) const
+    {
+        SoundTouchWrapper mainEngine;
+        OutputLayers layers;
+        mainEngine.configure(getConfiguration(type));
+        layers.configure(getConfiguration(type));
+        setUpBenchmarkEngine(mainEngine, type);
+        
+        std::array<bool, OutputLayers::MAX_LAYERS> enabledLayers {};
+        
+        for (int layer = 0; layer < numLayers; ++layer)
+        {
+            enabledLayers[static_cast<size_t>(layer)] = true;
+            layers.setOffset(layer, layerOffsets[layer]);
+        }
+        
+        layers.setRatios(3.0f, 0.0f, 0.0f);
+        mainEngine.prepare(sampleRate, blockSize, numChannels);
+        layers.prepare(sampleRate, blockSize, numChannels, enabledLayers);
+        
+        juce::AudioBuffer<float> source(numChannels, blockSize);
+        juce::AudioBuffer<double> buffer(numChannels * (1 + OutputLayers::MAX_LAYERS), blockSize);
+        juce::AudioBuffer<double> mainBuffer(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+        
+        std::array<double* const*, OutputLayers::MAX_LAYERS> layerChannels {};
+        
+        for (int layer = 0; layer < numLayers; ++layer)
+            layerChannels[static_cast<size_t>(layer)] = buffer.getArrayOfWritePointers() + numChannels * (layer + 1);
+        
+        double total = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine(source, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                    mainBuffer.setSample(channel, sample, source.getSample(channel, sample));
+            
+            total += timeSeconds([&] { layers.processBlock(mainBuffer, &mainEngine, layerChannels); });
+        }
+        
+        return total;
+    }
+    
+    double processSeparateSeconds(TimeStretchEngine::Type type, int numLayers) const
+    {
+        juce::OwnedArray<SoundTouchWrapper> wrappers;
+        
+        for (int i = 0; i <= numLayers; ++i)
+        {
+            auto* wrapper = wrappers.add(new SoundTouchWrapper());
+            wrapper->configure(getConfiguration(type));
+            setUpBenchmarkEngine(*wrapper, type);
+            
+            if (i > 0)
+                wrapper->setPitch(3.0f + layerOffsets[i - 1]);
+            
+            wrapper->prepare(sampleRate, blockSize, numChannels);
+        }
+        
+        juce::AudioBuffer<float> source(numChannels, blockSize);
+        juce::OwnedArray<juce::AudioBuffer<double>> buffers;
+        
+        for (int i = 0; i <= numLayers; ++i)
+            buffers.add(new juce::AudioBuffer<double>(numChannels, blockSize));
+        
+        double total = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine(source, 220.0f, sampleRate, static_cast<juce::int64>(block) * blockSize);
+            
+            for (auto* buffer : buffers)
+                buffer->makeCopyOf(source, true);
+            
+            total += timeSeconds([&]
+            {
+                for (int i = 0; i <= numLayers; ++i)
+                    wrappers.getUnchecked(i)->processBlock(*buffers.getUnchecked(i));
+            });
+        }
+        
+        return total;
+    }
+};
+
+static OutputLayersBenchmark outputLayersBenchmark;
@@ -20,22 +20,29 @@
     Functional test that loads AUSoundTouch plugin, generates a test signal,
     processes it through the plugin with pitch shifting, and validates the output
     using FFT analysis. Optionally plays the result for manual verification.
+    With --grid it instead sweeps the built-in processor over pitch, tempo,
+    speed, sample rate and buffering mode on a thread pool.
 
   ==============================================================================
 */
 
 #include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <vector>
 #include <cmath>
 #include <iomanip>
 
 //==============================================================================
+// Not thread-safe: the FFT works in place, so the grid gives each case its own
 class SignalAnalyzer
 {
 public:
-    SignalAnalyzer(int fftSize = 4096) : fftOrder(std::log2(fftSize)), fft(fftOrder)
+    SignalAnalyzer(int fftSize = 4096) : fftOrder(static_cast<int>(std::log2(fftSize))), fft(fftOrder)
     {
         fftData.resize(fftSize * 2, 0.0f);
         window.resize(fftSize);
@@ -57,62 +64,30 @@ public:
         // Use the middle part of the signal for better results
         const int startSample = std::max(0, numSamples / 2 - fftSize / 2);
         
-        // Clear FFT data first
-        std::fill(fftData.begin(), fftData.end(), 0.0f);
+        // Window in one vector pass; the upper half is the transform's scratch
+        juce::FloatVectorOperations::multiply(fftData.data(), audioData + startSample, window.data(), fftSize);
+        juce::FloatVectorOperations::clear(fftData.data() + fftSize, fftSize);
         
-        // Copy and window the data from middle of signal
-        for (int i = 0; i < fftSize; ++i)
-        {
-            if (startSample + i < numSamples)
-            {
-                fftData[i * 2] = audioData[startSample + i] * window[i];     // Real part
-                fftData[i * 2 + 1] = 0.0f;                                   // Imaginary part
-            }
-        }
-        
-        // Use the normal forward transform, not frequency-only
-        fft.performRealOnlyForwardTransform(fftData.data(), true);
+        // Leaves the magnitude of each bin in the first half
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
         
-        // Find peak magnitude - for real FFT, data is packed differently
-        int peakBin = 0;
-        float peakMagnitude = 0.0f;
-        
-        // For real FFT, calculate magnitude from real and imaginary parts
-        for (int i = 1; i < fftSize / 2; ++i)
-        {
-            float real = fftData[i * 2];
-            float imag = fftData[i * 2 + 1];
-            float magnitude = std::sqrt(real * real + imag * imag);
-            
-            if (magnitude > peakMagnitude)
-            {
-                peakMagnitude = magnitude;
-                peakBin = i;
-            }
-        }
+        const auto peak = std::max_element(fftData.begin() + 1, fftData.begin() + fftSize / 2);
+        const int peakBin = static_cast<int>(std::distance(fftData.begin(), peak));
         
-        if (peakBin == 0)
+        if (*peak <= 0.0f)
             return 0.0f;
         
         // Convert bin to frequency
         float binFreq = (float)peakBin * (float)sampleRate / (float)fftSize;
         
-        // Apply parabolic interpolation for better accuracy
-        if (peakBin > 0 && peakBin < fftSize / 2 - 1)
+        // Parabolic interpolation on log magnitudes, which fits the Hann
+        // window's main lobe closely
+        if (peakBin < fftSize / 2 - 1)
         {
-            float real1 = fftData[(peakBin - 1) * 2];
-            float imag1 = fftData[(peakBin - 1) * 2 + 1];
-            float y1 = std::sqrt(real1 * real1 + imag1 * imag1);
+            const float y1 = std::log(fftData[peakBin - 1] + 1.0e-12f);
+            const float y2 = std::log(fftData[peakBin] + 1.0e-12f);
+            const float y3 = std::log(fftData[peakBin + 1] + 1.0e-12f);
             
-            float real2 = fftData[peakBin * 2];
-            float imag2 = fftData[peakBin * 2 + 1];
-            float y2 = std::sqrt(real2 * real2 + imag2 * imag2);
-            
-            float real3 = fftData[(peakBin + 1) * 2];
-            float imag3 = fftData[(peakBin + 1) * 2 + 1];
-            float y3 = std::sqrt(real3 * real3 + imag3 * imag3);
-            
-            // Parabolic interpolation
             if (2.0f * y2 - y1 - y3 != 0.0f)
             {
                 float d = (y3 - y1) / (2.0f * (2.0f * y2 - y1 - y3));
@@ -125,12 +100,21 @@ public:
     
     float calculateRMS(const float* audioData, int numSamples)
     {
-        float sum = 0.0f;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            sum += audioData[i] * audioData[i];
-        }
-        return std::sqrt(sum / numSamples);
+        // Independent partial sums, so the compiler can keep them in one
+        // vector register without reassociating a single sum
+        constexpr int numLanes = 8;
+        std::array<float, numLanes> sums {};
+        int i = 0;
+        
+        for (; i + numLanes <= numSamples; i += numLanes)
+            for (int lane = 0; lane < numLanes; ++lane)
+                sums[lane] += audioData[i + lane] * audioData[i + lane];
+        
+        for (; i < numSamples; ++i)
+            sums[0] += audioData[i] * audioData[i];
+        
+        const double sum = std::accumulate(sums.begin(), sums.end(), 0.0);
+        return static_cast<float>(std::sqrt(sum / numSamples));
     }
     
     bool hasDropouts(const float* audioData, int numSamples, float threshold = 0.01f)
@@ -148,6 +132,13 @@ public:
         return false;
     }
     
+    // NaN or infinity anywhere fails the comparisons with themselves
+    static bool isFinite(const float* audioData, int numSamples)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(audioData, numSamples);
+        return std::isfinite(range.getStart()) && std::isfinite(range.getEnd());
+    }
+    
 private:
     int fftOrder;
     juce::dsp::FFT fft;
@@ -349,11 +340,246 @@ private:
     int playbackPosition = 0;
 };
 
+//==============================================================================
+// In-process sweep: AUSoundTouchProcessor is compiled into this binary, so no
+// plugin has to be installed. Each case gets its own processor and analyzer,
+// and the cases are spread over a thread pool.
+namespace ValidationGrid
+{
+    struct Case
+    {
+        double sampleRate;
+        int bufferingMode;
+        float pitch;
+        float tempo;
+        float speed;
+    };
+    
+    struct Result
+    {
+        float expectedFrequency = 0.0f;
+        float measuredFrequency = 0.0f;
+        float centsError = 0.0f;
+        float rmsRatio = 0.0f;
+        double realtimeFactor = 0.0;
+        juce::int64 underruns = 0;
+        bool finite = false;
+        bool frequencyChecked = false;
+        bool passed = false;
+    };
+    
+    constexpr double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    constexpr int bufferingModes[] = { AUSoundTouchProcessor::Minimal, AUSoundTouchProcessor::Normal,
+                                       AUSoundTouchProcessor::Extra, AUSoundTouchProcessor::Live };
+    constexpr float pitches[] = { -12.0f, -5.0f, 0.0f, 3.0f, 12.0f };
+    constexpr float tempos[] = { -25.0f, 0.0f, 25.0f };
+    constexpr float speeds[] = { -20.0f, 0.0f, 20.0f };
+    
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr double durationSeconds = 3.0;
+    constexpr float testFrequency = 440.0f;
+    constexpr float maxCentsError = 20.0f;
+    
+    // Constructing the processor registers with process-wide singletons (the
+    // stats segment, the realtime log, the reconfiguration worker), so only
+    // the DSP runs in parallel
+    juce::CriticalSection lifecycleLock;
+    
+    std::vector<Case> makeCases()
+    {
+        std::vector<Case> cases;
+        
+        for (auto sampleRate : sampleRates)
+            for (auto bufferingMode : bufferingModes)
+                for (auto pitch : pitches)
+                    for (auto tempo : tempos)
+                        for (auto speed : speeds)
+                            cases.push_back({ sampleRate, bufferingMode, pitch, tempo, speed });
+        
+        return cases;
+    }
+    
+    const char* getBufferingName(int mode)
+    {
+        switch (mode)
+        {
+            case AUSoundTouchProcessor::Minimal: return "Minimal";
+            case AUSoundTouchProcessor::Normal:  return "Normal";
+            case AUSoundTouchProcessor::Extra:   return "Extra";
+            case AUSoundTouchProcessor::Live:    return "Live";
+            default:                             return "?";
+        }
+    }
+    
+    Result runCase(const Case& testCase)
+    {
+        const int totalSamples = static_cast<int>(testCase.sampleRate * durationSeconds);
+        std::unique_ptr<AUSoundTouchProcessor> processor;
+        
+        {
+            const juce::ScopedLock lock(lifecycleLock);
+            processor = std::make_unique<AUSoundTouchProcessor>();
+            
+            auto& params = processor->getParameters();
+            
+            for (const auto& [id, value] : { std::pair<const char*, float> { "pitch", testCase.pitch },
+                                             std::pair<const char*, float> { "tempo", testCase.tempo },
+                                             std::pair<const char*, float> { "speed", testCase.speed } })
+            {
+                auto* param = params.getParameter(id);
+                param->setValueNotifyingHost(param->convertTo0to1(value));
+            }
+            
+            processor->setBufferingMode(testCase.bufferingMode);
+            processor->prepareToPlay(testCase.sampleRate, blockSize);
+        }
+        
+        juce::AudioBuffer<float> block(numChannels, blockSize);
+        juce::AudioBuffer<float> output(numChannels, totalSamples);
+        juce::MidiBuffer midi;
+        double phase = 0.0;
+        const double phaseIncrement = juce::MathConstants<double>::twoPi * testFrequency / testCase.sampleRate;
+        double processingSeconds = 0.0;
+        
+        for (int position = 0; position < totalSamples; position += blockSize)
+        {
+            const int numSamples = std::min(blockSize, totalSamples - position);
+            block.setSize(numChannels, numSamples, false, false, true);
+            
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float sample = 0.5f * static_cast<float>(std::sin(phase));
+                phase += phaseIncrement;
+                
+                for (int ch = 0; ch < numChannels; ++ch)
+                    block.setSample(ch, i, sample);
+            }
+            
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(block, midi);
+            processingSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                output.copyFrom(ch, position, block, ch, 0, numSamples);
+        }
+        
+        Result result;
+        result.underruns = processor->getPerformanceSnapshot().underruns;
+        result.realtimeFactor = processingSeconds > 0.0 ? durationSeconds / processingSeconds : 0.0;
+        
+        {
+            const juce::ScopedLock lock(lifecycleLock);
+            processor->releaseResources();
+            processor.reset();
+        }
+        
+        // Live ignores tempo and speed; otherwise speed moves the pitch too
+        const bool live = testCase.bufferingMode == AUSoundTouchProcessor::Live;
+        const float speedRatio = live ? 1.0f : 1.0f + testCase.speed / 100.0f;
+        const float tempoRatio = live ? 1.0f : 1.0f + testCase.tempo / 100.0f;
+        result.expectedFrequency = testFrequency * std::pow(2.0f, testCase.pitch / 12.0f) * speedRatio;
+        
+        // Consuming input faster than it arrives underruns, and the engine then
+        // passes the input through dry, so only the frequency is reported
+        result.frequencyChecked = tempoRatio * speedRatio <= 1.0f;
+        
+        SignalAnalyzer analyzer(8192);
+        const float* left = output.getReadPointer(0);
+        result.finite = SignalAnalyzer::isFinite(left, totalSamples)
+                        && SignalAnalyzer::isFinite(output.getReadPointer(1), totalSamples);
+        
+        // Skip the first half, which covers the engine's latency at every mode
+        const int settled = totalSamples / 2;
+        const float inputRMS = 0.5f / std::sqrt(2.0f);
+        result.rmsRatio = analyzer.calculateRMS(left + settled, totalSamples - settled) / inputRMS;
+        result.measuredFrequency = analyzer.findDominantFrequency(left, totalSamples, testCase.sampleRate);
+        
+        if (result.measuredFrequency > 0.0f)
+            result.centsError = 1200.0f * std::log2(result.measuredFrequency / result.expectedFrequency);
+        
+        result.passed = result.finite
+                        && result.rmsRatio > 0.25f && result.rmsRatio < 4.0f
+                        && (! result.frequencyChecked || std::abs(result.centsError) <= maxCentsError);
+        
+        return result;
+    }
+    
+    int run(int numThreads)
+    {
+        const auto cases = makeCases();
+        std::vector<Result> results(cases.size());
+        
+        std::cout << "=== AUSoundTouch Pitch/Tempo Validation Grid ===" << std::endl;
+        std::cout << cases.size() << " cases, " << durationSeconds << " s of " << testFrequency
+                  << " Hz each, on " << numThreads << " threads" << std::endl << std::endl;
+        
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        
+        {
+            juce::ThreadPool pool(numThreads);
+            
+            for (size_t i = 0; i < cases.size(); ++i)
+                pool.addJob([&cases, &results, i] { results[i] = runCase(cases[i]); });
+            
+            while (pool.getNumJobs() > 0)
+                juce::Thread::sleep(10);
+        }
+        
+        const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        
+        std::cout << std::setw(6) << "Rate" << std::setw(9) << "Buffer" << std::setw(7) << "Pitch"
+                  << std::setw(7) << "Tempo" << std::setw(7) << "Speed" << std::setw(10) << "Expected"
+                  << std::setw(10) << "Measured" << std::setw(8) << "Cents" << std::setw(7) << "xRT"
+                  << std::setw(6) << "Under" << "  Result" << std::endl;
+        
+        int failures = 0;
+        
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            const auto& testCase = cases[i];
+            const auto& result = results[i];
+            
+            if (! result.passed)
+                ++failures;
+            
+            const char* verdict = ! result.passed ? "FAIL"
+                                : result.frequencyChecked ? "PASS"
+                                : "PASS (dry on underrun, frequency not checked)";
+            
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(6) << testCase.sampleRate / 1000.0 << std::setw(9) << getBufferingName(testCase.bufferingMode)
+                      << std::setw(7) << testCase.pitch << std::setw(7) << testCase.tempo << std::setw(7) << testCase.speed
+                      << std::setw(10) << result.expectedFrequency << std::setw(10) << result.measuredFrequency
+                      << std::setw(8) << result.centsError << std::setw(7) << result.realtimeFactor
+                      << std::setw(6) << result.underruns << "  " << verdict;
+            
+            if (! result.finite)
+                std::cout << " - non-finite output";
+            else if (result.rmsRatio <= 0.25f || result.rmsRatio >= 4.0f)
+                std::cout << " - RMS ratio " << result.rmsRatio;
+            
+            std::cout << std::endl;
+        }
+        
+        const double audioSeconds = durationSeconds * static_cast<double>(cases.size());
+        
+        std::cout << std::endl << "=== Summary ===" << std::endl;
+        std::cout << cases.size() - static_cast<size_t>(failures) << " passed, " << failures << " failed" << std::endl;
+        std::cout << std::setprecision(2) << "Grid wall time: " << wallSeconds << " s ("
+                  << audioSeconds / wallSeconds << "x realtime across all threads)" << std::endl;
+        
+        return failures == 0 ? 0 : 1;
+    }
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
     // Parse command line arguments
     bool playAudio = false;
+    bool runGrid = false;
+    int numThreads = juce::SystemStats::getNumCpus();
     juce::String pluginPath;
     
     for (int i = 1; i < argc; ++i)
@@ -361,12 +587,19 @@ int main(int argc, char* argv[])
         juce::String arg(argv[i]);
         if (arg == "--play" || arg == "-p")
             playAudio = true;
+        else if (arg == "--grid" || arg == "-g")
+            runGrid = true;
+        else if (arg == "--threads" && i + 1 < argc)
+            numThreads = std::max(1, juce::String(argv[++i]).getIntValue());
         else if (arg == "--help" || arg == "-h")
         {
             std::cout << "Usage: " << argv[0] << " [options] [plugin_path]\n"
                       << "Options:\n"
-                      << "  -p, --play    Play the processed audio through speakers\n"
-                      << "  -h, --help    Show this help message\n"
+                      << "  -p, --play       Play the processed audio through speakers\n"
+                      << "  -g, --grid       Sweep pitch, tempo, speed, sample rate and buffering\n"
+                      << "                   mode on the built-in processor instead of a plugin\n"
+                      << "  --threads N      Threads for --grid (default: one per CPU)\n"
+                      << "  -h, --help       Show this help message\n"
                       << "\nIf plugin_path is not specified, will look for AUSoundTouch.component\n"
                       << "in ~/Library/Audio/Plug-Ins/Components/\n";
             return 0;
@@ -380,6 +613,9 @@ int main(int argc, char* argv[])
     // Initialize JUCE
     juce::ScopedJuceInitialiser_GUI juce;
     
+    if (runGrid)
+        return ValidationGrid::run(numThreads);
+    
     // Default plugin path if not specified
     if (pluginPath.isEmpty())
     {
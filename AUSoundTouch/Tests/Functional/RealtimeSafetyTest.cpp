@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+    Headless realtime-safety check for the built VST3. Loads the plugin through
+    JUCE's VST3 host, counts every heap allocation and free made on the thread
+    that calls processBlock, and changes the buffering and quality modes
+    mid-stream so the worker-built engine swap is covered too. The executable
+    exports its operator new/delete, so the plugin's allocations land here.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+//==============================================================================
+namespace
+{
+    thread_local bool monitoringAudioThread = false;
+    std::atomic<int> audioThreadAllocations { 0 };
+    std::atomic<int> audioThreadFrees { 0 };
+
+    void* countedAllocate(std::size_t size)
+    {
+        if (monitoringAudioThread)
+            ++audioThreadAllocations;
+
+        if (void* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+
+        throw std::bad_alloc();
+    }
+
+    void countedFree(void* ptr) noexcept
+    {
+        if (monitoringAudioThread && ptr != nullptr)
+            ++audioThreadFrees;
+
+        std::free(ptr);
+    }
+
+    struct ScopedAudioThreadMonitor
+    {
+        ScopedAudioThreadMonitor()  { monitoringAudioThread = true; }
+        ~ScopedAudioThreadMonitor() { monitoringAudioThread = false; }
+    };
+}
+
+void* operator new(std::size_t size)                                  { return countedAllocate(size); }
+void* operator new[](std::size_t size)                                { return countedAllocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept  { try { return countedAllocate(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return countedAllocate(size); } catch (...) { return nullptr; } }
+void operator delete(void* ptr) noexcept                              { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept                            { countedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept                 { countedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept               { countedFree(ptr); }
+
+//==============================================================================
+// The VST3 host stores the plugin's own state base64-encoded in an IComponent
+// element. That state is the plugin's binary format (magic, version, count, then
+// {fourcc, float} entries); rewrite the mode entries in place.
+static bool setModesInHostedState(juce::MemoryBlock& hostState, int bufferingMode, int qualityMode)
+{
+    auto hostXml = juce::AudioProcessor::getXmlFromBinary(hostState.getData(), static_cast<int>(hostState.getSize()));
+
+    if (hostXml == nullptr)
+        return false;
+
+    auto* component = hostXml->getChildByName("IComponent");
+
+    if (component == nullptr)
+        return false;
+
+    juce::MemoryBlock pluginState;
+
+    if (! pluginState.fromBase64Encoding(component->getAllSubText()) || pluginState.getSize() < 8)
+        return false;
+
+    auto* bytes = static_cast<char*>(pluginState.getData());
+    const int numEntries = juce::jmin(static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6)),
+                                      static_cast<int>(pluginState.getSize() - 8) / 8);
+    int modesFound = 0;
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        char* entry = bytes + 8 + i * 8;
+        const auto key = juce::ByteOrder::littleEndianInt(entry);
+        float value;
+
+        if (key == juce::ByteOrder::bigEndianInt("bufm"))
+            value = static_cast<float>(bufferingMode);
+        else if (key == juce::ByteOrder::bigEndianInt("qual"))
+            value = static_cast<float>(qualityMode);
+        else
+            continue;
+
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = juce::ByteOrder::swapIfBigEndian(bits);
+        std::memcpy(entry + 4, &bits, sizeof(bits));
+        ++modesFound;
+    }
+
+    if (modesFound != 2)
+        return false;
+
+    component->deleteAllTextElements();
+    component->addTextElement(pluginState.toBase64Encoding());
+
+    hostState.reset();
+    juce::AudioProcessor::copyXmlToBinary(*hostXml, hostState);
+    return true;
+}
+
+static void fillSine(juce::AudioBuffer<float>& buffer, int64_t startSample, double sampleRate)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* data = buffer.getWritePointer(channel);
+
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            data[sample] = 0.5f * static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * 440.0
+                                                              * static_cast<double>(startSample + sample) / sampleRate));
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <path to AUSoundTouch.vst3>" << std::endl;
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::String pluginPath(argv[1]);
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int warmUpBlocks = 64;
+    const int monitoredBlocks = 600;
+
+    std::cout << "=== AUSoundTouch Realtime Safety Test ===" << std::endl;
+    std::cout << "Plugin path: " << pluginPath << std::endl;
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+        if (formatManager.getFormat(i)->getName() == "VST3")
+            formatManager.getFormat(i)->findAllTypesForFile(descriptions, pluginPath);
+
+    if (descriptions.isEmpty())
+    {
+        std::cerr << "No VST3 plugin found at: " << pluginPath << std::endl;
+        return 1;
+    }
+
+    juce::String errorMessage;
+    auto plugin = formatManager.createPluginInstance(*descriptions[0], sampleRate, blockSize, errorMessage);
+
+    if (plugin == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << errorMessage << std::endl;
+        return 1;
+    }
+
+    plugin->setNonRealtime(false);
+    plugin->prepareToPlay(sampleRate, blockSize);
+
+    for (auto* parameter : plugin->getParameters())
+        if (parameter->getName(32) == "Pitch")
+            parameter->setValueNotifyingHost(parameter->getValueForText("3"));
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    int64_t position = 0;
+
+    // First blocks may legitimately size host-side buffers
+    for (int block = 0; block < warmUpBlocks; ++block, position += blockSize)
+    {
+        fillSine(buffer, position, sampleRate);
+        plugin->processBlock(buffer, midi);
+    }
+
+    juce::MemoryBlock originalState;
+    plugin->getStateInformation(originalState);
+
+    const struct { int block; int bufferingMode; int qualityMode; } changes[] = {
+        { 100, 1, 1 },  // Minimal, Fast
+        { 250, 3, 2 },  // Extra, Balanced
+        { 350, 2, 4 },  // Normal, Monophonic
+        { 400, 3, 5 },  // Extra, Speech
+        { 450, 2, 3 },  // back to the defaults
+    };
+
+    bool stateChangesApplied = true;
+    double worstBlockMs = 0.0;
+
+    for (int block = 0; block < monitoredBlocks; ++block, position += blockSize)
+    {
+        for (const auto& change : changes)
+        {
+            if (change.block != block)
+                continue;
+
+            // Host/UI side: this is where the plugin may allocate
+            juce::MemoryBlock state(originalState);
+
+            if (setModesInHostedState(state, change.bufferingMode, change.qualityMode))
+                plugin->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+            else
+                stateChangesApplied = false;
+        }
+
+        fillSine(buffer, position, sampleRate);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        {
+            ScopedAudioThreadMonitor monitor;
+            plugin->processBlock(buffer, midi);
+        }
+        worstBlockMs = juce::jmax(worstBlockMs, 1000.0 * juce::Time::highResolutionTicksToSeconds(
+                                                             juce::Time::getHighResolutionTicks() - startTicks));
+
+        // Pace like a real device so the worker rebuilds while blocks keep coming
+        juce::Thread::sleep(1);
+    }
+
+    const float outputLevel = buffer.getMagnitude(0, 0, blockSize);
+
+    plugin->releaseResources();
+    plugin.reset();
+
+    const double budgetMs = 1000.0 * blockSize / sampleRate;
+
+    std::cout << "Audio-thread allocations: " << audioThreadAllocations.load() << std::endl;
+    std::cout << "Audio-thread frees:       " << audioThreadFrees.load() << std::endl;
+    std::cout << "Worst block time:         " << worstBlockMs << " ms (budget " << budgetMs << " ms)" << std::endl;
+
+    // Without the mode changes the engine swaps go unexercised, which is most
+    // of what this test is for
+    if (! stateChangesApplied)
+        std::cout << "Could not rewrite the hosted state; mode changes were not exercised" << std::endl;
+
+    const bool passed = stateChangesApplied
+                     && audioThreadAllocations.load() == 0
+                     && audioThreadFrees.load() == 0
+                     && outputLevel > 0.0f;
+
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -33,10 +33,11 @@ public:
         {
             AUSoundTouchProcessor processor;
             expectEquals(processor.getName(), juce::String("AUSoundTouch"));
-            expect(!processor.acceptsMidi());
+            expect(processor.acceptsMidi()); // Notes drive the harmony voices
             expect(!processor.producesMidi());
             expect(!processor.isMidiEffect());
             expect(processor.hasEditor()); // Processor does have an editor
+            expect(processor.supportsDoublePrecisionProcessing());
         }
         
         beginTest("Bus Configuration");
@@ -46,6 +47,108 @@ public:
             
             expect(layout.getMainInputChannelSet() == juce::AudioChannelSet::stereo());
             expect(layout.getMainOutputChannelSet() == juce::AudioChannelSet::stereo());
+            
+            // Layer buses are there for hosts to enable, but start off
+            expectEquals(layout.outputBuses.size(), 1 + OutputLayers::MAX_LAYERS);
+            
+            for (int bus = 1; bus < layout.outputBuses.size(); ++bus)
+                expect(layout.getChannelSet(false, bus).isDisabled());
+        }
+        
+        beginTest("Multichannel Layouts");
+        {
+            AUSoundTouchProcessor processor;
+            
+            const juce::AudioChannelSet supportedSets[] = {
+                juce::AudioChannelSet::mono(),
+                juce::AudioChannelSet::stereo(),
+                juce::AudioChannelSet::create5point1(),
+                juce::AudioChannelSet::create7point1(),
+                juce::AudioChannelSet::create7point1point4(),
+                juce::AudioChannelSet::discreteChannels(10)
+            };
+            
+            // Layouts are checked with every bus, so start from the default one
+            auto withMainBuses = [&processor](const juce::AudioChannelSet& input, const juce::AudioChannelSet& output)
+            {
+                auto layout = processor.getBusesLayout();
+                layout.getChannelSet(true, 0) = input;
+                layout.getChannelSet(false, 0) = output;
+                return layout;
+            };
+            
+            for (const auto& channelSet : supportedSets)
+                expect(processor.checkBusesLayoutSupported(withMainBuses(channelSet, channelSet)), channelSet.getDescription());
+            
+            expect(!processor.checkBusesLayoutSupported(withMainBuses(juce::AudioChannelSet::stereo(),
+                                                                      juce::AudioChannelSet::create5point1())));
+            
+            const auto tooWide = juce::AudioChannelSet::discreteChannels(SoundTouchWrapper::MAX_CHANNELS + 1);
+            expect(!processor.checkBusesLayoutSupported(withMainBuses(tooWide, tooWide)));
+        }
+        
+        beginTest("7.1.4 Processing");
+        {
+            AUSoundTouchProcessor processor;
+            const auto channelSet = juce::AudioChannelSet::create7point1point4();
+            
+            auto layout = processor.getBusesLayout();
+            layout.getChannelSet(true, 0) = channelSet;
+            layout.getChannelSet(false, 0) = channelSet;
+            expect(processor.setBusesLayout(layout));
+            
+            if (auto* pitchParam = processor.getParameters().getParameter("pitch"))
+                pitchParam->setValueNotifyingHost(pitchParam->convertTo0to1(12.0f));
+            
+            processor.prepareToPlay(48000.0, 256);
+            
+            // Without host worker threads all twelve channels share one engine
+            expectEquals(processor.getNumChannelGroups(), 1);
+            
+            const int numChannels = channelSet.size();
+            const int numBlocks = 96;
+            const int measuredBlocks = 16;
+            juce::AudioBuffer<float> buffer(numChannels, 256);
+            juce::AudioBuffer<float> measured(numChannels, measuredBlocks * 256);
+            juce::MidiBuffer midiBuffer;
+            
+            auto getFrequency = [] (int channel) { return 300.0f + 110.0f * static_cast<float>(channel); };
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    for (int sample = 0; sample < 256; ++sample)
+                    {
+                        const float phase = 2.0f * juce::MathConstants<float>::pi * getFrequency(channel)
+                                          * static_cast<float>(block * 256 + sample) / 48000.0f;
+                        buffer.setSample(channel, sample, 0.5f * std::sin(phase));
+                    }
+                }
+                
+                processor.processBlock(buffer, midiBuffer);
+                
+                if (block >= numBlocks - measuredBlocks)
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        measured.copyFrom(channel, (block - numBlocks + measuredBlocks) * 256, buffer, channel, 0, 256);
+            }
+            
+            // Once primed, every channel carries its own tone an octave up, and
+            // none of the others: dry passthrough or mixed channels both fail
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const float* samples = measured.getReadPointer(channel);
+                const int numSamples = measured.getNumSamples();
+                
+                expectGreaterThan(getToneLevel(samples, numSamples, 2.0f * getFrequency(channel), 48000.0), 0.25f);
+                expectLessThan(getToneLevel(samples, numSamples, getFrequency(channel), 48000.0), 0.05f);
+                
+                for (int other = 0; other < numChannels; ++other)
+                    if (other != channel)
+                        expectLessThan(getToneLevel(samples, numSamples, 2.0f * getFrequency(other), 48000.0), 0.05f);
+            }
+            
+            processor.releaseResources();
         }
         
         beginTest("Parameter Creation");
@@ -150,6 +253,438 @@ public:
             expectWithinAbsoluteError(speed2, speed1, 0.01f);
         }
         
+        beginTest("Buffering and Quality Mode Persistence");
+        {
+            AUSoundTouchProcessor processor1;
+            processor1.setBufferingMode(AUSoundTouchProcessor::Extra);
+            processor1.setQualityMode(AUSoundTouchProcessor::Fast);
+            
+            juce::MemoryBlock stateData;
+            processor1.getStateInformation(stateData);
+            
+            AUSoundTouchProcessor processor2;
+            expectEquals(processor2.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::High));
+            
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            expectEquals(processor2.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Extra));
+            expectEquals(processor2.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Fast));
+        }
+        
+        beginTest("Content Modes Need Buffering");
+        {
+            // The mode pair always names the engine that runs: a content mode
+            // brings the buffering up, and short buffering drops the content mode
+            AUSoundTouchProcessor processor;
+            
+            processor.setBufferingMode(AUSoundTouchProcessor::Live);
+            processor.setQualityMode(AUSoundTouchProcessor::Speech);
+            expectEquals(processor.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Normal));
+            expectEquals(processor.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Speech));
+            
+            processor.setBufferingMode(AUSoundTouchProcessor::Minimal);
+            expectEquals(processor.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Minimal));
+            expectEquals(processor.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::High));
+            
+            processor.setQualityMode(AUSoundTouchProcessor::Fast);
+            processor.setBufferingMode(AUSoundTouchProcessor::Extra);
+            processor.setQualityMode(AUSoundTouchProcessor::Monophonic);
+            expectEquals(processor.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Extra));
+            
+            for (int buffering = AUSoundTouchProcessor::Minimal; buffering <= AUSoundTouchProcessor::Live; ++buffering)
+                for (int quality = AUSoundTouchProcessor::Fast; quality <= AUSoundTouchProcessor::Speech; ++quality)
+                {
+                    processor.setBufferingMode(buffering);
+                    processor.setQualityMode(quality);
+                    expect(AUSoundTouchProcessor::isModeCombinationSupported(processor.getBufferingMode(),
+                                                                             processor.getQualityMode()));
+                }
+        }
+        
+        beginTest("Content Quality Modes");
+        {
+            AUSoundTouchProcessor processor1;
+            processor1.setQualityMode(AUSoundTouchProcessor::Monophonic);
+            expectEquals(processor1.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Monophonic));
+            
+            processor1.setQualityMode(AUSoundTouchProcessor::Speech);
+            expectEquals(processor1.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Speech));
+            
+            // Out of range is ignored
+            processor1.setQualityMode(AUSoundTouchProcessor::Speech + 1);
+            expectEquals(processor1.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Speech));
+            
+            juce::MemoryBlock stateData;
+            processor1.getStateInformation(stateData);
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            expectEquals(processor2.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::Speech));
+        }
+        
+        beginTest("Harmony Settings");
+        {
+            AUSoundTouchProcessor processor1;
+            expectEquals(processor1.getHarmonyVoices(), 0);
+            expectEquals(processor1.getHarmonyReferenceNote(), Harmonizer::DEFAULT_REFERENCE_NOTE);
+            
+            processor1.prepareToPlay(48000.0, 256);
+            const int engineLatency = processor1.getLatencySamples();
+            
+            // Voices are capped, and harmony reports PSOLA's latency instead of
+            // the engines' once the worker has seen the change
+            juce::SharedResourcePointer<ReconfigurationWorker> worker;
+            processor1.setHarmonyVoices(Harmonizer::MAX_VOICES + 4);
+            expect(worker->waitUntilIdle(2000));
+            processor1.handlePendingLatencyChange();
+            expectEquals(processor1.getHarmonyVoices(), Harmonizer::MAX_VOICES);
+            expectGreaterThan(processor1.getLatencySamples(), 0);
+            expect(processor1.getLatencySamples() != engineLatency);
+            
+            processor1.setHarmonyVoices(3);
+            processor1.setHarmonyReferenceNote(64);
+            
+            juce::MemoryBlock stateData;
+            processor1.getStateInformation(stateData);
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            expectEquals(processor2.getHarmonyVoices(), 3);
+            expectEquals(processor2.getHarmonyReferenceNote(), 64);
+            
+            processor1.setHarmonyVoices(0);
+            expect(worker->waitUntilIdle(2000));
+            processor1.handlePendingLatencyChange();
+            expectEquals(processor1.getLatencySamples(), engineLatency);
+            processor1.releaseResources();
+        }
+        
+        beginTest("Harmony Voices Follow MIDI Notes");
+        {
+            AUSoundTouchProcessor processor;
+            processor.setHarmonyVoices(4);
+            processor.prepareToPlay(48000.0, 256);
+            
+            juce::AudioBuffer<float> buffer(2, 256);
+            juce::MidiBuffer midi;
+            juce::MidiBuffer noMidi;
+            midi.addEvent(juce::MidiMessage::noteOn(1, 67, 1.0f), 0);
+            midi.addEvent(juce::MidiMessage::noteOn(1, 55, 1.0f), 0);
+            
+            for (int block = 0; block < 200; ++block)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int sample = 0; sample < 256; ++sample)
+                        buffer.setSample(channel, sample, 0.3f * std::sin(juce::MathConstants<float>::twoPi * 220.0f
+                                                                         * static_cast<float>(block * 256 + sample) / 48000.0f));
+                
+                processor.processBlock(buffer, block == 0 ? midi : noMidi);
+            }
+            
+            // A fifth above and an octave below, both under the dry signal
+            expectGreaterThan(buffer.getMagnitude(0, 0, 256), 0.4f);
+            
+            processor.releaseResources();
+        }
+        
+        beginTest("Output Layers");
+        {
+            AUSoundTouchProcessor processor;
+            auto layout = processor.getBusesLayout();
+            
+            // A layer carries the main layout or nothing
+            layout.getChannelSet(false, 1) = juce::AudioChannelSet::mono();
+            expect(!processor.checkBusesLayoutSupported(layout));
+            
+            layout.getChannelSet(false, 1) = juce::AudioChannelSet::stereo();
+            expect(processor.setBusesLayout(layout));
+            
+            processor.setLayerOffset(0, 12.0f);
+            processor.setLayerOffset(1, OutputLayers::MAX_OFFSET_SEMITONES + 5.0f);
+            expectEquals(processor.getLayerOffset(1), OutputLayers::MAX_OFFSET_SEMITONES);
+            processor.setLayerOffset(1, 0.0f);
+            
+            processor.prepareToPlay(48000.0, 256);
+            expectEquals(processor.getNumActiveLayers(), 1);
+            
+            // Main output in channels 0-1, Layer 1 in 2-3
+            juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), 256);
+            expectEquals(buffer.getNumChannels(), 4);
+            juce::MidiBuffer midiBuffer;
+            
+            int mainCrossings = 0;
+            int layerCrossings = 0;
+            float previousMain = 0.0f;
+            float previousLayer = 0.0f;
+            
+            for (int block = 0; block < 120; ++block)
+            {
+                buffer.clear();
+                
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int sample = 0; sample < 256; ++sample)
+                        buffer.setSample(channel, sample, 0.3f * std::sin(juce::MathConstants<float>::twoPi * 220.0f
+                                                                         * static_cast<float>(block * 256 + sample) / 48000.0f));
+                
+                processor.processBlock(buffer, midiBuffer);
+                
+                if (block < 80)
+                    continue;
+                
+                for (int sample = 0; sample < 256; ++sample)
+                {
+                    const float mainSample = buffer.getSample(0, sample);
+                    const float layerSample = buffer.getSample(2, sample);
+                    mainCrossings += (mainSample >= 0.0f) != (previousMain >= 0.0f) ? 1 : 0;
+                    layerCrossings += (layerSample >= 0.0f) != (previousLayer >= 0.0f) ? 1 : 0;
+                    previousMain = mainSample;
+                    previousLayer = layerSample;
+                }
+            }
+            
+            // The layer sounds an octave above the unshifted main output
+            expectGreaterThan(buffer.getMagnitude(2, 0, 256), 0.1f);
+            expectGreaterThan(mainCrossings, 0);
+            expectWithinAbsoluteError(static_cast<float>(layerCrossings) / static_cast<float>(mainCrossings), 2.0f, 0.2f);
+            
+            // Offsets are saved with the session
+            juce::MemoryBlock stateData;
+            processor.getStateInformation(stateData);
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            expectEquals(processor2.getLayerOffset(0), 12.0f);
+            expectEquals(processor2.getLayerOffset(1), 0.0f);
+            
+            processor.releaseResources();
+        }
+        
+        beginTest("Live Buffering Reports Its Latency");
+        {
+            AUSoundTouchProcessor processor;
+            processor.prepareToPlay(48000.0, 32);
+            const int normalLatency = processor.getLatencySamples();
+            expectGreaterThan(normalLatency, 0);
+            
+            processor.setBufferingMode(AUSoundTouchProcessor::Live);
+            processor.prepareToPlay(48000.0, 32);
+            
+            // Within the 5 ms monitoring budget
+            const int liveLatency = processor.getLatencySamples();
+            expectGreaterThan(liveLatency, 0);
+            expectLessOrEqual(liveLatency, 240);
+            expectLessThan(liveLatency, normalLatency);
+            
+            processor.releaseResources();
+        }
+        
+        beginTest("Binary State Format");
+        {
+            AUSoundTouchProcessor processor1;
+            if (auto* pitchParam = processor1.getParameters().getParameter("pitch"))
+                pitchParam->setValueNotifyingHost(pitchParam->convertTo0to1(-7.0f));
+            
+            juce::MemoryBlock stateData;
+            processor1.getStateInformation(stateData);
+            
+            // Header plus eleven {key, value} entries
+            expectEquals(static_cast<int>(stateData.getSize()), 8 + 8 * 11);
+            
+            // Entries with keys this version doesn't know are skipped
+            const juce::uint32 unknownEntry[] = { juce::ByteOrder::swapIfBigEndian(0x7a7a7a7au),
+                                                  juce::ByteOrder::swapIfBigEndian(0x3f800000u) };
+            stateData.append(unknownEntry, sizeof(unknownEntry));
+            const auto extendedCount = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint16>(12));
+            stateData.copyFrom(&extendedCount, 6, sizeof(extendedCount));
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            
+            auto* pitch2 = processor2.getParameters().getParameter("pitch");
+            expectWithinAbsoluteError(pitch2->convertFrom0to1(pitch2->getValue()), -7.0f, 0.01f);
+        }
+        
+        beginTest("Legacy XML State");
+        {
+            // Sessions saved before the binary format stored the parameter tree as XML
+            AUSoundTouchProcessor processor1;
+            auto xml = processor1.getParameters().copyState().createXml();
+            
+            for (auto* child : xml->getChildIterator())
+                if (child->getStringAttribute("id") == "tempo")
+                    child->setAttribute("value", 25.0);
+            
+            xml->setAttribute("bufferingMode", static_cast<int>(AUSoundTouchProcessor::Minimal));
+            
+            juce::MemoryBlock legacyState;
+            juce::AudioProcessor::copyXmlToBinary(*xml, legacyState);
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(legacyState.getData(), static_cast<int>(legacyState.getSize()));
+            
+            auto* tempo2 = processor2.getParameters().getParameter("tempo");
+            expectWithinAbsoluteError(tempo2->convertFrom0to1(tempo2->getValue()), 25.0f, 0.01f);
+            expectEquals(processor2.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Minimal));
+            expectEquals(processor2.getQualityMode(), static_cast<int>(AUSoundTouchProcessor::High));
+        }
+        
+        beginTest("Reconfiguration While Processing");
+        {
+            // Mode changes are rebuilt on the worker and swapped in between blocks,
+            // so audio keeps flowing across them
+            AUSoundTouchProcessor processor;
+            processor.prepareToPlay(44100.0, 512);
+            
+            auto& apvts = processor.getParameters();
+            if (auto* pitchParam = apvts.getParameter("pitch"))
+                pitchParam->setValueNotifyingHost(pitchParam->convertTo0to1(3.0f));
+            
+            juce::SharedResourcePointer<ReconfigurationWorker> worker;
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::MidiBuffer midiBuffer;
+            
+            for (int block = 0; block < 48; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                      * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                if (block == 8)
+                    processor.setQualityMode(AUSoundTouchProcessor::Balanced);
+                else if (block == 16)
+                    processor.setBufferingMode(AUSoundTouchProcessor::Minimal);
+                
+                if (block == 8 || block == 16)
+                    expect(worker->waitUntilIdle(2000));
+                
+                processor.processBlock(buffer, midiBuffer);
+            }
+            
+            expectGreaterThan(buffer.getMagnitude(0, 0, 512), 0.0f);
+            processor.releaseResources();
+        }
+        
+        beginTest("Program Switching");
+        {
+            AUSoundTouchProcessor processor;
+            expectGreaterThan(processor.getNumPrograms(), 1);
+            expectEquals(processor.getProgramName(0), juce::String("Default"));
+            
+            processor.prepareToPlay(44100.0, 512);
+            
+            // "Practice 50%" also switches to Extra buffering
+            int practiceProgram = -1;
+            for (int i = 0; i < processor.getNumPrograms(); ++i)
+                if (processor.getProgramName(i) == "Practice 50%")
+                    practiceProgram = i;
+            
+            expect(practiceProgram > 0);
+            
+            juce::SharedResourcePointer<ReconfigurationWorker> worker;
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::MidiBuffer midiBuffer;
+            
+            for (int block = 0; block < 32; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                      * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                // The engines are built on the worker, as for a mode change
+                if (block == 8)
+                {
+                    processor.setCurrentProgram(practiceProgram);
+                    expectEquals(processor.getCurrentProgram(), practiceProgram);
+                    expect(worker->waitUntilIdle(2000));
+                }
+                
+                processor.processBlock(buffer, midiBuffer);
+                
+                // The old program plays until the new one has warmed up, so no block drops out
+                if (block >= 8)
+                    expectGreaterThan(buffer.getMagnitude(0, 0, 512), 0.0f);
+            }
+            
+            expectEquals(processor.getCurrentProgram(), practiceProgram);
+            expectEquals(processor.getBufferingMode(), static_cast<int>(AUSoundTouchProcessor::Extra));
+            
+            auto* tempo = processor.getParameters().getParameter("tempo");
+            expectWithinAbsoluteError(tempo->convertFrom0to1(tempo->getValue()), -50.0f, 0.01f);
+            
+            // The selection is saved with the session
+            juce::MemoryBlock stateData;
+            processor.getStateInformation(stateData);
+            
+            AUSoundTouchProcessor processor2;
+            processor2.setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+            expectEquals(processor2.getCurrentProgram(), practiceProgram);
+            
+            processor.releaseResources();
+        }
+        
+        beginTest("Switching Back Uses the Standby");
+        {
+            AUSoundTouchProcessor processor;
+            processor.prepareToPlay(44100.0, 512);
+            
+            int octaveProgram = -1;
+            for (int i = 0; i < processor.getNumPrograms(); ++i)
+                if (processor.getProgramName(i) == "Up 1 Octave")
+                    octaveProgram = i;
+            
+            expect(octaveProgram > 0);
+            
+            juce::SharedResourcePointer<ReconfigurationWorker> worker;
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::MidiBuffer midiBuffer;
+            int block = 0;
+            
+            auto processSineBlocks = [&] (int numBlocks)
+            {
+                for (int end = block + numBlocks; block < end; ++block)
+                {
+                    for (int sample = 0; sample < 512; ++sample)
+                    {
+                        const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                          * static_cast<float>(block * 512 + sample) / 44100.0f);
+                        buffer.setSample(0, sample, value);
+                        buffer.setSample(1, sample, value);
+                    }
+                    
+                    processor.processBlock(buffer, midiBuffer);
+                }
+            };
+            
+            // The first change is built on the worker, which then builds the
+            // standby for the program left behind
+            processSineBlocks(8);
+            processor.setCurrentProgram(octaveProgram);
+            expect(worker->waitUntilIdle(2000));
+            processSineBlocks(24);
+            expectGreaterThan(getToneLevel(buffer.getReadPointer(0), 512, 880.0f, 44100.0), 0.2f);
+            
+            // Let the worker free the engine the crossfade retired
+            juce::Thread::sleep(3 * ReconfigurationWorker::RELEASE_INTERVAL_MS);
+            
+            // Switching back waits for neither the worker nor a warm-up
+            processor.setCurrentProgram(0);
+            processSineBlocks(2);
+            expectGreaterThan(getToneLevel(buffer.getReadPointer(0), 512, 440.0f, 44100.0), 0.2f);
+            expectLessThan(getToneLevel(buffer.getReadPointer(0), 512, 880.0f, 44100.0), 0.05f);
+            
+            expect(worker->waitUntilIdle(2000));
+            auto* pitch = processor.getParameters().getParameter("pitch");
+            expectWithinAbsoluteError(pitch->convertFrom0to1(pitch->getValue()), 0.0f, 0.01f);
+            processor.releaseResources();
+        }
+        
         beginTest("Audio Processing");
         {
             AUSoundTouchProcessor processor;
@@ -157,12 +692,12 @@ public:
             
             juce::MidiBuffer midiBuffer;
             
-            // Process several blocks to account for SoundTouch's internal buffering
+            // Process enough blocks to get past the priming silence (SoundTouch's initial latency)
             bool hasOutput = false;
             const float testFrequency = 440.0f;
             const float sampleRate = 44100.0f;
             
-            for (int block = 0; block < 4 && !hasOutput; ++block)
+            for (int block = 0; block < 8 && !hasOutput; ++block)
             {
                 juce::AudioBuffer<float> buffer(2, 512);
                 
@@ -186,6 +721,209 @@ public:
             
             processor.releaseResources();
         }
+        
+        beginTest("Performance Snapshot Follows the Stream");
+        {
+            AUSoundTouchProcessor processor;
+            processor.prepareToPlay(44100.0, 512);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::MidiBuffer midiBuffer;
+            
+            for (int block = 0; block < 20; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                      * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                processor.processBlock(buffer, midiBuffer);
+            }
+            
+            const auto snapshot = processor.getPerformanceSnapshot();
+            expectGreaterThan(snapshot.dspLoad, 0.0f);
+            expectGreaterThan(snapshot.fifoTargetFrames, 0);
+            expectGreaterThan(snapshot.fifoFrames, 0);
+            expectGreaterThan(snapshot.latencyMs, 0.0);
+            
+            processor.releaseResources();
+        }
+        
+        beginTest("Offline Bounce Tail");
+        {
+            // Everything buffered when the input ends must come out within the
+            // reported tail, or bounces lose their last few hundred milliseconds.
+            // Nothing flushes it: the silence rendered for the tail pushes it out.
+            AUSoundTouchProcessor processor;
+            processor.setNonRealtime(true);
+            processor.prepareToPlay(44100.0, 512);
+            
+            auto& apvts = processor.getParameters();
+            if (auto* pitchParam = apvts.getParameter("pitch"))
+                pitchParam->setValueNotifyingHost(pitchParam->convertTo0to1(3.0f));
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::MidiBuffer midiBuffer;
+            const int audioBlocks = 20;
+            
+            for (int block = 0; block < audioBlocks; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                      * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                processor.processBlock(buffer, midiBuffer);
+            }
+            
+            const int tailSamples = juce::roundToInt(processor.getTailLengthSeconds() * 44100.0);
+            expectGreaterThan(tailSamples, 0);
+            
+            int lastAudibleTailSample = -1;
+            
+            for (int tailPosition = 0; tailPosition < tailSamples + 4 * 512; tailPosition += 512)
+            {
+                buffer.clear();
+                processor.processBlock(buffer, midiBuffer);
+                
+                for (int sample = 0; sample < 512; ++sample)
+                    if (std::abs(buffer.getSample(0, sample)) > 1.0e-4f)
+                        lastAudibleTailSample = tailPosition + sample;
+            }
+            
+            // The tone carries on for about the latency after the input stops
+            expectGreaterThan(lastAudibleTailSample, processor.getLatencySamples() / 2);
+            expectLessThan(lastAudibleTailSample, tailSamples);
+        }
+
+        beginTest("Offline Bounce Across a Short Gap");
+        {
+            // Silence inside the input is no different offline, so the bounce
+            // must line up with the same render done in realtime. Speech runs
+            // the same engine either way, unlike the default High quality.
+            juce::SharedResourcePointer<ReconfigurationWorker> worker;
+            const int blockSize = 441;
+            const int toneBlocks = 20;
+            const int gapBlocks = 10;   // 100 ms
+            const int numBlocks = 2 * toneBlocks + gapBlocks + 8;
+
+            auto render = [&] (bool nonRealtime, int& tailSamples)
+            {
+                AUSoundTouchProcessor processor;
+                processor.setNonRealtime(nonRealtime);
+                processor.setQualityMode(AUSoundTouchProcessor::Speech);
+                expect(worker->waitUntilIdle(2000));
+
+                if (auto* tempoParam = processor.getParameters().getParameter("tempo"))
+                    tempoParam->setValueNotifyingHost(tempoParam->convertTo0to1(-25.0f));
+
+                processor.prepareToPlay(44100.0, blockSize);
+
+                juce::AudioBuffer<float> rendered(2, numBlocks * blockSize);
+                juce::AudioBuffer<float> buffer(2, blockSize);
+                juce::MidiBuffer midiBuffer;
+
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    const bool inGap = block >= toneBlocks && block < toneBlocks + gapBlocks;
+                    const bool inTone = block < 2 * toneBlocks + gapBlocks;
+
+                    for (int sample = 0; sample < blockSize; ++sample)
+                    {
+                        const float value = inTone && ! inGap
+                                          ? 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                            * static_cast<float>(block * blockSize + sample) / 44100.0f)
+                                          : 0.0f;
+                        buffer.setSample(0, sample, value);
+                        buffer.setSample(1, sample, value);
+                    }
+
+                    processor.processBlock(buffer, midiBuffer);
+
+                    for (int channel = 0; channel < 2; ++channel)
+                        rendered.copyFrom(channel, block * blockSize, buffer, channel, 0, blockSize);
+                }
+
+                tailSamples = juce::roundToInt(processor.getTailLengthSeconds() * 44100.0);
+                processor.releaseResources();
+                return rendered;
+            };
+
+            int offlineTail = 0, realtimeTail = 0;
+            const auto offline = render(true, offlineTail);
+            const auto realtime = render(false, realtimeTail);
+
+            expectEquals(offlineTail, realtimeTail);
+            expectGreaterThan(offlineTail, gapBlocks * blockSize);
+
+            float maxDifference = 0.0f;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int sample = 0; sample < offline.getNumSamples(); ++sample)
+                    maxDifference = juce::jmax(maxDifference, std::abs(offline.getSample(channel, sample)
+                                                                       - realtime.getSample(channel, sample)));
+
+            expectLessThan(maxDifference, 1.0e-6f);
+            expectGreaterThan(offline.getMagnitude(0, (toneBlocks + gapBlocks) * blockSize, toneBlocks * blockSize), 0.1f);
+        }
+
+        beginTest("Double Precision Audio Processing");
+        {
+            AUSoundTouchProcessor processor;
+            processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+            processor.prepareToPlay(44100.0, 512);
+            
+            juce::MidiBuffer midiBuffer;
+            bool hasOutput = false;
+            
+            for (int block = 0; block < 8 && !hasOutput; ++block)
+            {
+                juce::AudioBuffer<double> buffer(2, 512);
+                
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const double value = std::sin(2.0 * juce::MathConstants<double>::pi * 440.0
+                                                * static_cast<double>(block * 512 + sample) / 44100.0);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                processor.processBlock(buffer, midiBuffer);
+                
+                if (buffer.getMagnitude(0, 0, 512) > 0.0)
+                    hasOutput = true;
+            }
+            
+            expect(hasOutput);
+            
+            processor.releaseResources();
+        }
+    }
+    
+private:
+    // Amplitude of the tone at frequency, through a Hann window over numSamples
+    static float getToneLevel(const float* samples, int numSamples, float frequency, double sampleRate)
+    {
+        double re = 0.0;
+        double im = 0.0;
+        double windowSum = 0.0;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / numSamples);
+            const double phase = juce::MathConstants<double>::twoPi * frequency * i / sampleRate;
+            re += window * samples[i] * std::cos(phase);
+            im -= window * samples[i] * std::sin(phase);
+            windowSum += window;
+        }
+        
+        return static_cast<float>(2.0 * std::sqrt(re * re + im * im) / windowSum);
     }
 };
 
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "Harmonizer.h"
+#include "PitchTracker.h"
+#include <vector>
+
+class HarmonizerTests : public juce::UnitTest
+{
+public:
+    HarmonizerTests() : UnitTest("Harmonizer Tests") {}
+    
+    void runTest() override
+    {
+        beginTest("Dry Signal Is Delayed by the Latency");
+        {
+            Harmonizer harmonizer;
+            harmonizer.setMaxVoices(2);
+            harmonizer.prepare(sampleRate, 1, blockSize);
+            
+            const int latency = harmonizer.getLatencySamples();
+            expectGreaterThan(latency, 0);
+            
+            const auto input = makeSawtooth(32 * blockSize, 150.0);
+            const auto output = process(harmonizer, input, {});
+            
+            bool matches = true;
+            
+            for (size_t i = 0; i < output.size(); ++i)
+                matches = matches && output[i] == (i >= static_cast<size_t>(latency) ? input[i - static_cast<size_t>(latency)] : 0.0f);
+            
+            expect(matches);
+        }
+        
+        beginTest("A Held Note Adds a Shifted Voice");
+        {
+            Harmonizer harmonizer;
+            harmonizer.setMaxVoices(2);
+            harmonizer.setReferenceNote(60);
+            harmonizer.prepare(sampleRate, 1, blockSize);
+            
+            const int latency = harmonizer.getLatencySamples();
+            const auto input = makeSawtooth(160 * blockSize, 150.0);
+            const auto output = process(harmonizer, input, { { 0, juce::MidiMessage::noteOn(1, 72, 1.0f) } });
+            
+            expectEquals(harmonizer.getNumActiveVoices(), 1);
+            
+            // What is left once the delayed dry signal is taken out is an octave up
+            std::vector<float> voice(output.size() / 2);
+            
+            for (size_t i = 0; i < voice.size(); ++i)
+            {
+                const size_t frame = output.size() / 2 + i;
+                voice[i] = output[frame] - input[frame - static_cast<size_t>(latency)];
+            }
+            
+            PitchTracker tracker;
+            tracker.prepare(sampleRate, 60.0, 1000.0);
+            tracker.push(voice.data(), static_cast<int>(voice.size()));
+            
+            expect(tracker.isVoiced());
+            expectWithinAbsoluteError(tracker.getPeriod(), static_cast<float>(sampleRate / 300.0), 2.0f);
+        }
+        
+        beginTest("Voices Are Capped and Released");
+        {
+            Harmonizer harmonizer;
+            harmonizer.setMaxVoices(2);
+            harmonizer.prepare(sampleRate, 1, blockSize);
+            
+            const auto input = makeSawtooth(32 * blockSize, 150.0);
+            process(harmonizer, input, { { 0, juce::MidiMessage::noteOn(1, 64, 0.8f) },
+                                         { 0, juce::MidiMessage::noteOn(1, 67, 0.8f) },
+                                         { 4, juce::MidiMessage::noteOn(1, 71, 0.8f) } });
+            
+            // The third note took over the oldest voice
+            expectEquals(harmonizer.getNumActiveVoices(), 2);
+            
+            // 32 blocks outlast the release
+            process(harmonizer, input, { { 0, juce::MidiMessage::allNotesOff(1) } });
+            expectEquals(harmonizer.getNumActiveVoices(), 0);
+        }
+    }
+    
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+    
+    struct Event
+    {
+        int block = 0;
+        juce::MidiMessage message;
+    };
+    
+    static std::vector<float> process(Harmonizer& harmonizer, const std::vector<float>& input, const std::vector<Event>& events)
+    {
+        std::vector<float> output(input.size());
+        juce::AudioBuffer<float> buffer(1, blockSize);
+        
+        for (int block = 0; block * blockSize < static_cast<int>(input.size()); ++block)
+        {
+            juce::MidiBuffer midi;
+            
+            for (const auto& event : events)
+                if (event.block == block)
+                    midi.addEvent(event.message, 0);
+            
+            const size_t start = static_cast<size_t>(block * blockSize);
+            std::copy_n(input.begin() + static_cast<std::ptrdiff_t>(start), blockSize, buffer.getWritePointer(0));
+            harmonizer.processBlock(buffer, midi);
+            std::copy_n(buffer.getReadPointer(0), blockSize, output.begin() + static_cast<std::ptrdiff_t>(start));
+        }
+        
+        return output;
+    }
+    
+    static std::vector<float> makeSawtooth(int numFrames, double frequency)
+    {
+        std::vector<float> samples(static_cast<size_t>(numFrames));
+        
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            const double phase = frame * frequency / sampleRate;
+            samples[static_cast<size_t>(frame)] = 0.4f * (static_cast<float>(phase - std::floor(phase)) - 0.5f);
+        }
+        
+        return samples;
+    }
+};
+
+static HarmonizerTests harmonizerTests;
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "PitchTracker.h"
+#include <vector>
+
+class PitchTrackerTests : public juce::UnitTest
+{
+public:
+    PitchTrackerTests() : UnitTest("Pitch Tracker Tests") {}
+    
+    void runTest() override
+    {
+        beginTest("Finds the Period of a Tone");
+        {
+            PitchTracker tracker;
+            tracker.prepare(44100.0, 60.0, 1000.0);
+            
+            const auto tone = makeSine(44100, 220.0, 44100.0);
+            tracker.push(tone.data(), static_cast<int>(tone.size()));
+            
+            expect(tracker.isVoiced());
+            expectWithinAbsoluteError(tracker.getPeriod(), 44100.0f / 220.0f, 0.5f);
+            expectLessThan(tracker.getAperiodicity(), PitchTracker::VOICING_THRESHOLD);
+        }
+        
+        beginTest("Follows a Change of Pitch");
+        {
+            // Fed in small blocks, as the engine does
+            PitchTracker tracker;
+            tracker.prepare(48000.0, 60.0, 1000.0);
+            
+            const auto low = makeSine(48000, 110.0, 48000.0);
+            const auto high = makeSine(9600, 880.0, 48000.0);
+            
+            for (int start = 0; start < 48000; start += 64)
+                tracker.push(low.data() + start, 64);
+            
+            expectWithinAbsoluteError(tracker.getPeriod(), 48000.0f / 110.0f, 1.0f);
+            
+            for (int start = 0; start < 9600; start += 64)
+                tracker.push(high.data() + start, 64);
+            
+            expectWithinAbsoluteError(tracker.getPeriod(), 48000.0f / 880.0f, 0.5f);
+        }
+        
+        beginTest("A Rich Tone Isn't Taken an Octave Up");
+        {
+            PitchTracker tracker;
+            tracker.prepare(48000.0, 60.0, 1000.0);
+            
+            std::vector<float> sawtooth(48000);
+            
+            for (size_t i = 0; i < sawtooth.size(); ++i)
+            {
+                const double phase = static_cast<double>(i) * 100.0 / 48000.0;
+                sawtooth[i] = static_cast<float>(phase - std::floor(phase)) - 0.5f;
+            }
+            
+            tracker.push(sawtooth.data(), static_cast<int>(sawtooth.size()));
+            expectWithinAbsoluteError(tracker.getPeriod(), 480.0f, 2.0f);
+        }
+        
+        beginTest("Silence and Noise Are Unvoiced");
+        {
+            PitchTracker tracker;
+            tracker.prepare(44100.0, 60.0, 1000.0);
+            
+            juce::Random random(42);
+            std::vector<float> noise(44100);
+            
+            for (auto& sample : noise)
+                sample = random.nextFloat() - 0.5f;
+            
+            tracker.push(noise.data(), static_cast<int>(noise.size()));
+            expect(! tracker.isVoiced());
+            expectEquals(tracker.getPeriod(), 0.0f);
+            
+            const auto tone = makeSine(44100, 220.0, 44100.0);
+            tracker.push(tone.data(), static_cast<int>(tone.size()));
+            expect(tracker.isVoiced());
+            
+            const std::vector<float> silence(4410, 0.0f);
+            tracker.push(silence.data(), static_cast<int>(silence.size()));
+            expect(! tracker.isVoiced());
+            
+            // reset() forgets the history
+            tracker.push(tone.data(), static_cast<int>(tone.size()));
+            tracker.reset();
+            expect(! tracker.isVoiced());
+        }
+    }
+    
+private:
+    static std::vector<float> makeSine(int numFrames, double frequency, double sampleRate)
+    {
+        std::vector<float> samples(static_cast<size_t>(numFrames));
+        
+        for (int frame = 0; frame < numFrames; ++frame)
+            samples[static_cast<size_t>(frame)] = 0.5f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi
+                                                                                  * frequency * frame / sampleRate));
+        
+        return samples;
+    }
+};
+
+static PitchTrackerTests pitchTrackerTests;
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "RealtimeLog.h"
+#include <thread>
+#include <vector>
+
+class RealtimeLogTests : public juce::UnitTest
+{
+public:
+    RealtimeLogTests() : UnitTest("Realtime Log Tests") {}
+    
+    void runTest() override
+    {
+        beginTest("Records Are Written in the Order Posted");
+        {
+            RealtimeLog log;
+            juce::StringArray lines;
+            log.setWriter([&lines](const juce::String& line) { lines.add(line); });
+            
+            expect(log.post(RealtimeLog::Event::Underrun, 7, 512, 100));
+            expect(log.post(RealtimeLog::Event::Overrun, 7, 64));
+            expect(log.post(RealtimeLog::Event::Overload, 8, 12.5, 10.67));
+            log.flush();
+            
+            expectEquals(lines.size(), 3);
+            expect(lines[0].contains("AUSoundTouch #7: Underrun: FIFO held 100 of 512 frames"));
+            expect(lines[1].contains("AUSoundTouch #7: Overrun: FIFO full, dropped 64 frames"));
+            expect(lines[2].contains("AUSoundTouch #8: Overload: block took 12.50 ms of 10.67 ms"));
+            expectEquals(log.getNumDropped(), static_cast<juce::int64>(0));
+        }
+        
+        beginTest("A Full Queue Drops Records and Reports How Many");
+        {
+            RealtimeLog log;
+            juce::StringArray lines;
+            constexpr int extraRecords = 5;
+            
+            // The writer runs with the queue's reader locked, so nothing drains
+            // while it fills the queue, whichever thread flushes first
+            log.setWriter([&](const juce::String& line)
+            {
+                if (lines.isEmpty())
+                    for (int i = 0; i < RealtimeLog::CAPACITY + extraRecords; ++i)
+                        log.post(RealtimeLog::Event::Overrun, 1, i);
+                
+                lines.add(line);
+            });
+            
+            log.post(RealtimeLog::Event::Overrun, 1, 0);
+            log.flush();
+            
+            expectEquals(log.getNumDropped(), static_cast<juce::int64>(extraRecords));
+            expectEquals(lines.size(), 1 + RealtimeLog::CAPACITY + 1);
+            expect(lines[lines.size() - 1].contains(juce::String(extraRecords) + " records dropped"));
+        }
+        
+        beginTest("Producers on Several Threads Lose Nothing");
+        {
+            RealtimeLog log;
+            juce::StringArray lines;
+            log.setWriter([&lines](const juce::String& line) { lines.add(line); });
+            
+            constexpr int numThreads = 4;
+            constexpr int recordsPerThread = 200;
+            std::vector<std::thread> threads;
+            
+            for (int t = 0; t < numThreads; ++t)
+                threads.emplace_back([&log, t]
+                {
+                    for (int i = 0; i < recordsPerThread; ++i)
+                        log.post(RealtimeLog::Event::Overrun, static_cast<juce::uint32>(t + 1), i);
+                });
+            
+            for (auto& thread : threads)
+                thread.join();
+            
+            log.flush();
+            
+            expectEquals(lines.size(), numThreads * recordsPerThread);
+            
+            // Each thread's records arrive complete and in its own order
+            std::vector<int> nextValue(numThreads, 0);
+            bool inOrder = true;
+            
+            for (const auto& line : lines)
+            {
+                const int source = line.fromFirstOccurrenceOf("#", false, false).getIntValue();
+                const int value = line.fromFirstOccurrenceOf("dropped ", false, false).getIntValue();
+                
+                if (! juce::isPositiveAndBelow(source - 1, numThreads))
+                {
+                    inOrder = false;
+                    continue;
+                }
+                
+                inOrder = inOrder && value == nextValue[static_cast<size_t>(source - 1)]++;
+            }
+            
+            expect(inOrder);
+            
+            for (int count : nextValue)
+                expectEquals(count, recordsPerThread);
+        }
+    }
+};
+
+static RealtimeLogTests realtimeLogTests;
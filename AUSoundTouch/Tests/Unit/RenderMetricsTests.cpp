@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "RenderMetrics.h"
+
+#if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+class RenderMetricsTests : public juce::UnitTest
+{
+public:
+    RenderMetricsTests() : UnitTest("Render Metrics Tests") {}
+
+    void runTest() override
+    {
+        RenderMetrics metrics;
+        metrics.filesProcessed = 3;
+        metrics.rendersCompleted = 12;
+        metrics.rendersQueued = 4;
+        metrics.framesRendered = 441000;
+        metrics.decodeSeconds = 0.5;
+        metrics.stretchSeconds = 2.0;
+        metrics.encodeSeconds = 0.25;
+        metrics.elapsedSeconds = 4.0;
+        metrics.underruns = 2;
+        metrics.p99BlockSeconds = 0.001;
+        metrics.latencySeconds = 0.05;
+
+        const auto text = metrics.toOpenMetrics();
+
+        beginTest("OpenMetrics Exposition");
+        {
+            // Ends in exactly one "# EOF" line
+            expect(text.endsWith("\n# EOF\n"));
+            expectEquals(text.indexOf("# EOF"), text.lastIndexOf("# EOF"));
+
+            auto lines = juce::StringArray::fromLines(text.trimEnd());
+            juce::StringArray families;
+
+            for (int i = 0; i < lines.size() - 1;)
+            {
+                // Every family opens with TYPE then HELP, and UNIT if any after
+                // those, all naming the same family, which appears only once
+                const auto typeLine = juce::StringArray::fromTokens(lines[i], " ", "");
+                expectEquals(typeLine[1], juce::String("TYPE"), lines[i]);
+
+                const auto name = typeLine[2];
+                const auto type = typeLine[3];
+                expect(! families.contains(name), name);
+                families.add(name);
+
+                expect(lines[++i].startsWith("# HELP " + name + " "), lines[i]);
+
+                if (lines[++i].startsWith("# UNIT "))
+                {
+                    const auto unit = lines[i].fromLastOccurrenceOf(" ", false, false);
+                    expect(lines[i] == "# UNIT " + name + " " + unit, lines[i]);
+                    expect(name.endsWith("_" + unit), name);
+                    ++i;
+                }
+
+                // Counter samples carry _total, gauge samples the bare name
+                int numSamples = 0;
+
+                for (; i < lines.size() - 1 && ! lines[i].startsWith("#"); ++i, ++numSamples)
+                {
+                    const auto sampleName = lines[i].upToFirstOccurrenceOf(" ", false, false)
+                                                    .upToFirstOccurrenceOf("{", false, false);
+
+                    if (type == "counter")
+                        expectEquals(sampleName, name + "_total");
+                    else
+                        expectEquals(sampleName, name);
+
+                    expect(lines[i].fromLastOccurrenceOf(" ", false, false).containsOnly("0123456789.-"), lines[i]);
+                }
+
+                expectGreaterThan(numSamples, 0, name);
+            }
+
+            expect(families.contains("ausoundtouch_render_frames"));
+            expect(text.contains("ausoundtouch_render_frames_total 441000\n"));
+            expect(text.contains("ausoundtouch_render_stage_seconds_total{stage=\"stretch\"} 2.0"));
+        }
+
+        beginTest("File Export");
+        {
+            juce::TemporaryFile file(".txt");
+            MetricsExporter exporter;
+            exporter.setFile(file.getFile());
+            exporter.publish(metrics);
+
+            expectEquals(file.getFile().loadFileAsString(), text);
+        }
+
+       #if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+        beginTest("Socket Round Trip");
+        {
+            const juce::String path = "/tmp/ausoundtouch-metrics-test-"
+                                    + juce::String(juce::Random::getSystemRandom().nextInt(1000000)) + ".sock";
+            MetricsExporter exporter;
+            expect(exporter.listenOnSocket(path));
+            exporter.publish(metrics);
+
+            // An HTTP client gets a response with the text as its body
+            const auto response = fetch(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+            expect(response.startsWith("HTTP/1.1 200 OK\r\n"));
+            expect(response.contains("Content-Type: " + juce::String(MetricsExporter::CONTENT_TYPE) + "\r\n"));
+            expect(response.contains("Content-Length: " + juce::String(static_cast<int>(text.getNumBytesAsUTF8())) + "\r\n"));
+            expectEquals(response.fromFirstOccurrenceOf("\r\n\r\n", false, false), text);
+
+            // Any other client gets the bare text
+            expectEquals(fetch(path, {}), text);
+        }
+       #endif
+    }
+
+private:
+   #if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+    // Connects, sends the request if any, and reads until the server hangs up
+    static juce::String fetch(const juce::String& path, const juce::String& request)
+    {
+        const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (connection < 0)
+            return {};
+
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        path.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+        juce::MemoryOutputStream received;
+
+        if (connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            if (request.isNotEmpty())
+                send(connection, request.toRawUTF8(), request.getNumBytesAsUTF8(), 0);
+
+            char chunk[4096];
+            ssize_t size = 0;
+
+            while ((size = recv(connection, chunk, sizeof(chunk), 0)) > 0)
+                received.write(chunk, static_cast<size_t>(size));
+        }
+
+        close(connection);
+        return received.toUTF8();
+    }
+   #endif
+};
+
+static RenderMetricsTests renderMetricsTests;
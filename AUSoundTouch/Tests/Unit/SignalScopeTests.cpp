@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "SignalScope.h"
+#include <vector>
+
+class SignalScopeTests : public juce::UnitTest
+{
+public:
+    SignalScopeTests() : UnitTest("Signal Scope Tests") {}
+    
+    void runTest() override
+    {
+        beginTest("Nothing Is Captured Without a Viewer");
+        {
+            SignalScope scope;
+            scope.prepare(blockSize);
+            
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            fillRamp(buffer, 0);
+            scope.captureInput(buffer);
+            scope.captureOutput(buffer);
+            
+            expect(! scope.isCapturing());
+            expectEquals(scope.pull(frames.data(), static_cast<int>(frames.size())), 0);
+        }
+        
+        beginTest("Frames Pair Input With Output Across Blocks");
+        {
+            SignalScope scope;
+            scope.prepare(blockSize);
+            scope.addViewer();
+            
+            // An odd block size leaves frames straddling block boundaries
+            constexpr int oddBlockSize = 37;
+            constexpr int numBlocks = 12;
+            juce::AudioBuffer<float> input(2, oddBlockSize);
+            juce::AudioBuffer<float> output(2, oddBlockSize);
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                fillRamp(input, block * oddBlockSize);
+                scope.captureInput(input);
+                
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int sample = 0; sample < oddBlockSize; ++sample)
+                        output.setSample(channel, sample, -input.getSample(channel, sample));
+                
+                scope.captureOutput(output);
+            }
+            
+            const int numFrames = scope.pull(frames.data(), static_cast<int>(frames.size()));
+            expectEquals(numFrames, numBlocks * oddBlockSize / SignalScope::DECIMATION);
+            
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const auto& frame = frames[static_cast<size_t>(i)];
+                const float firstSample = rampValue(i * SignalScope::DECIMATION);
+                const float lastSample = rampValue((i + 1) * SignalScope::DECIMATION - 1);
+                
+                expectWithinAbsoluteError(frame.inputMin, firstSample, 1.0e-6f);
+                expectWithinAbsoluteError(frame.inputMax, lastSample, 1.0e-6f);
+                expectWithinAbsoluteError(frame.inputMean, 0.5f * (firstSample + lastSample), 1.0e-5f);
+                expectWithinAbsoluteError(frame.outputMin, -lastSample, 1.0e-6f);
+                expectWithinAbsoluteError(frame.outputMax, -firstSample, 1.0e-6f);
+                expectWithinAbsoluteError(frame.outputMean, -frame.inputMean, 1.0e-5f);
+            }
+        }
+        
+        beginTest("A Full Ring Drops Frames Instead of Blocking");
+        {
+            SignalScope scope;
+            scope.prepare(blockSize);
+            scope.addViewer();
+            
+            juce::AudioBuffer<float> buffer(1, blockSize);
+            const int framesPerBlock = blockSize / SignalScope::DECIMATION;
+            const int numBlocks = SignalScope::CAPACITY / framesPerBlock + 4;
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                fillRamp(buffer, block * blockSize);
+                scope.captureInput(buffer);
+                scope.captureOutput(buffer);
+            }
+            
+            const int numFrames = scope.pull(frames.data(), static_cast<int>(frames.size()));
+            expectLessThan(numFrames, SignalScope::CAPACITY);
+            expectEquals(numFrames + static_cast<int>(scope.getNumDropped()), numBlocks * framesPerBlock);
+            
+            // The oldest frames are the ones kept
+            expectWithinAbsoluteError(frames[0].inputMin, rampValue(0), 1.0e-6f);
+        }
+        
+        beginTest("Capture Stops When the Last Viewer Leaves");
+        {
+            SignalScope scope;
+            scope.prepare(blockSize);
+            scope.addViewer();
+            scope.addViewer();
+            
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            fillRamp(buffer, 0);
+            
+            scope.removeViewer();
+            expect(scope.isCapturing());
+            scope.removeViewer();
+            expect(! scope.isCapturing());
+            
+            scope.captureInput(buffer);
+            scope.captureOutput(buffer);
+            expectEquals(scope.pull(frames.data(), static_cast<int>(frames.size())), 0);
+        }
+    }
+    
+private:
+    static constexpr int blockSize = 256;
+    
+    std::vector<SignalScope::Frame> frames = std::vector<SignalScope::Frame>(static_cast<size_t>(SignalScope::CAPACITY));
+    
+    // A slow rising ramp, so each frame's minimum is its first sample and its
+    // maximum its last
+    static float rampValue(int sample)
+    {
+        return -1.0f + 1.0e-4f * static_cast<float>(sample % 20000);
+    }
+    
+    static void fillRamp(juce::AudioBuffer<float>& buffer, int startSample)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                buffer.setSample(channel, sample, rampValue(startSample + sample));
+    }
+};
+
+static SignalScopeTests signalScopeTests;
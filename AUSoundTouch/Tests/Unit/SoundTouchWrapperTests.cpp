@@ -21,6 +21,8 @@
 */
 #include <JuceHeader.h>
 #include "SoundTouchWrapper.h"
+#include <algorithm>
+#include <vector>
 
 class SoundTouchWrapperTests : public juce::UnitTest
 {
@@ -65,12 +67,12 @@ public:
             SoundTouchWrapper wrapper;
             wrapper.prepare(44100.0, 512, 2);
             
-            // Process several blocks to account for SoundTouch's internal buffering
+            // Process enough blocks to get past the priming silence (SoundTouch's initial latency)
             bool hasOutput = false;
             const float testFrequency = 440.0f;
             const float sampleRate = 44100.0f;
             
-            for (int block = 0; block < 4 && !hasOutput; ++block)
+            for (int block = 0; block < 8 && !hasOutput; ++block)
             {
                 juce::AudioBuffer<float> buffer(2, 512);
                 
@@ -93,6 +95,518 @@ public:
             expect(hasOutput);
         }
         
+        beginTest("Multichannel Processing");
+        {
+            // 5.1: one SoundTouch instance carries all six channels, each
+            // shifted an octave on its own, with none leaking into another
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(48000.0, 512, 6);
+            wrapper.setPitch(12.0f);
+            expectEquals(wrapper.getNumChannels(), 6);
+            
+            auto getFrequency = [] (int channel) { return 300.0f + 110.0f * static_cast<float>(channel); };
+            
+            const int numBlocks = 40;
+            const int measuredBlocks = 8;
+            juce::AudioBuffer<float> buffer(6, 512);
+            juce::AudioBuffer<float> measured(6, measuredBlocks * 512);
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < 6; ++channel)
+                {
+                    for (int sample = 0; sample < 512; ++sample)
+                    {
+                        const float phase = 2.0f * juce::MathConstants<float>::pi * getFrequency(channel)
+                                          * static_cast<float>(block * 512 + sample) / 48000.0f;
+                        buffer.setSample(channel, sample, 0.5f * std::sin(phase));
+                    }
+                }
+                
+                wrapper.processBlock(buffer);
+                
+                if (block >= numBlocks - measuredBlocks)
+                    for (int channel = 0; channel < 6; ++channel)
+                        measured.copyFrom(channel, (block - numBlocks + measuredBlocks) * 512, buffer, channel, 0, 512);
+            }
+            
+            for (int channel = 0; channel < 6; ++channel)
+            {
+                const float* samples = measured.getReadPointer(channel);
+                const int numSamples = measured.getNumSamples();
+                
+                expectGreaterThan(getToneLevel(samples, numSamples, 2.0f * getFrequency(channel), 48000.0), 0.25f);
+                expectLessThan(getToneLevel(samples, numSamples, getFrequency(channel), 48000.0), 0.05f);
+                
+                for (int other = 0; other < 6; ++other)
+                    if (other != channel)
+                        expectLessThan(getToneLevel(samples, numSamples, 2.0f * getFrequency(other), 48000.0), 0.05f);
+            }
+        }
+        
+        beginTest("Oversized Host Block");
+        {
+            // Blocks larger than prepared are split rather than reallocating
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 256, 2);
+            
+            juce::AudioBuffer<float> buffer(2, 1024);
+            
+            for (int block = 0; block < 8; ++block)
+            {
+                for (int sample = 0; sample < 1024; ++sample)
+                {
+                    const float value = std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                               * static_cast<float>(block * 1024 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                wrapper.processBlock(buffer);
+            }
+            
+            expectGreaterThan(buffer.getMagnitude(0, 0, 1024), 0.0f);
+        }
+        
+        beginTest("Double Precision Matches Float");
+        {
+            // Both paths feed SoundTouch the same float stream, so output must agree
+            SoundTouchWrapper floatWrapper;
+            SoundTouchWrapper doubleWrapper;
+            floatWrapper.prepare(44100.0, 512, 2);
+            doubleWrapper.prepare(44100.0, 512, 2);
+            floatWrapper.setPitch(5.0f);
+            doubleWrapper.setPitch(5.0f);
+            
+            juce::AudioBuffer<float> floatBuffer(2, 512);
+            juce::AudioBuffer<double> doubleBuffer(2, 512);
+            double maxDifference = 0.0;
+            
+            for (int block = 0; block < 16; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = std::sin(2.0f * juce::MathConstants<float>::pi * 330.0f
+                                               * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    
+                    for (int channel = 0; channel < 2; ++channel)
+                    {
+                        floatBuffer.setSample(channel, sample, value);
+                        doubleBuffer.setSample(channel, sample, static_cast<double>(value));
+                    }
+                }
+                
+                floatWrapper.processBlock(floatBuffer);
+                doubleWrapper.processBlock(doubleBuffer);
+                
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int sample = 0; sample < 512; ++sample)
+                        maxDifference = std::max(maxDifference,
+                                                 std::abs(doubleBuffer.getSample(channel, sample)
+                                                          - static_cast<double>(floatBuffer.getSample(channel, sample))));
+            }
+            
+            expectLessThan(maxDifference, 1.0e-6);
+            expectGreaterThan(doubleBuffer.getMagnitude(0, 0, 512), 0.0);
+        }
+        
+        beginTest("Mode Change Swaps Pre-built State");
+        {
+            // Mode changes build state on the calling thread; the audio thread
+            // only swaps it in and hands the old state back
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 512, 2);
+            wrapper.setPitch(3.0f);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            
+            auto fillSine = [&buffer](int block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                               * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+            };
+            
+            for (int block = 0; block < 8; ++block)
+            {
+                fillSine(block);
+                wrapper.processBlock(buffer);
+            }
+            
+            wrapper.setBufferingMode(1);
+            wrapper.setQualityMode(1);
+            expect(wrapper.hasPendingState());
+            expectEquals(wrapper.getBufferingMode(), 1);
+            expectEquals(wrapper.getQualityMode(), 1);
+            
+            fillSine(8);
+            wrapper.processBlock(buffer);
+            expect(! wrapper.hasPendingState());
+            
+            wrapper.releaseRetiredState();
+            
+            for (int block = 9; block < 24; ++block)
+            {
+                fillSine(block);
+                wrapper.processBlock(buffer);
+            }
+            
+            expectGreaterThan(buffer.getMagnitude(0, 0, 512), 0.0f);
+        }
+        
+        beginTest("Mode Change Crossfades Without a Gap");
+        {
+            // The incoming engine warms up behind the outgoing one and fades in,
+            // so no block after the change falls back to priming silence
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 256, 2);
+            wrapper.setPitch(-2.0f);
+            
+            juce::AudioBuffer<float> buffer(2, 256);
+            
+            auto processSine = [&buffer, &wrapper](int block)
+            {
+                for (int sample = 0; sample < 256; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 220.0f
+                                                      * static_cast<float>(block * 256 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                wrapper.processBlock(buffer);
+            };
+            
+            for (int block = 0; block < 32; ++block)
+                processSine(block);
+            
+            SoundTouchWrapper::Configuration configuration;
+            configuration.bufferingMode = 3;
+            configuration.qualityMode = 1;
+            wrapper.crossfadeTo(configuration, SoundTouchWrapper::semitonesToNative(5.0f), 1.0f, 1.0f);
+            expectEquals(wrapper.getBufferingMode(), 3);
+            expectEquals(wrapper.getQualityMode(), 1);
+            
+            processSine(32);
+            expect(wrapper.isCrossfading());
+            
+            int block = 33;
+            
+            for (; block < 96 && wrapper.isCrossfading(); ++block)
+            {
+                processSine(block);
+                expectGreaterThan(buffer.getMagnitude(0, 0, 256), 0.1f);
+            }
+            
+            expect(! wrapper.isCrossfading());
+            
+            // The outgoing engine is handed back for release once the fade is over
+            wrapper.releaseRetiredState();
+            wrapper.setQualityMode(2);
+            processSine(block);
+            expect(wrapper.isCrossfading());
+        }
+        
+        beginTest("Held Pending State Waits for the Owner");
+        {
+            // Wrappers sharing a stream leave the swap to whoever runs them
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 512, 2);
+            wrapper.setHoldsPendingState(true);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            buffer.clear();
+            
+            wrapper.setQualityMode(1);
+            expect(wrapper.isReadyToSwap());
+            
+            wrapper.processBlock(buffer);
+            expect(wrapper.hasPendingState());
+            expect(! wrapper.isCrossfading());
+            
+            wrapper.swapInPendingState();
+            expect(! wrapper.hasPendingState());
+            expect(wrapper.isCrossfading());
+            
+            // A second state waits for the crossfade to end and the first to be released
+            wrapper.setQualityMode(2);
+            expect(! wrapper.isReadyToSwap());
+        }
+        
+        beginTest("Standby Swaps In Warm");
+        {
+            // A standby an octave up hears the input all along, so switching to
+            // it is heard within a block instead of after its priming
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 512, 2);
+            wrapper.prepareStandby(wrapper.getConfiguration(), 2.0f, 1.0f, 1.0f, 7);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            
+            auto processSineBlock = [&wrapper, &buffer] (int block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                      * static_cast<float>(block * 512 + sample) / 44100.0f);
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                wrapper.processBlock(buffer);
+            };
+            
+            for (int block = 0; block < 32; ++block)
+                processSineBlock(block);
+            
+            expect(wrapper.isStandbyReady(7));
+            expect(! wrapper.isStandbyReady(8));
+            
+            wrapper.swapInStandby();
+            expect(wrapper.isCrossfading());
+            expect(! wrapper.isStandbyReady(7));
+            
+            // The fade is shorter than a block, so the second is all octave
+            processSineBlock(32);
+            expect(! wrapper.isCrossfading());
+            
+            processSineBlock(33);
+            expectGreaterThan(getToneLevel(buffer.getReadPointer(0), 512, 880.0f, 44100.0), 0.2f);
+            expectLessThan(getToneLevel(buffer.getReadPointer(0), 512, 440.0f, 44100.0), 0.05f);
+            expectEquals(wrapper.getStats().dryFrames, static_cast<juce::int64>(0));
+        }
+        
+        beginTest("Reset After Seek");
+        {
+            // A reset must drop pre-seek audio and come back at the same latency
+            // as a fresh prepare(), reusing the existing engine
+            SoundTouchWrapper wrapper;
+            wrapper.setPitch(3.0f);
+            wrapper.prepare(44100.0, 512, 2);
+            
+            auto firstAudibleSample = [&wrapper]
+            {
+                juce::AudioBuffer<float> buffer(2, 512);
+                
+                for (int block = 0; block < 16; ++block)
+                {
+                    for (int sample = 0; sample < 512; ++sample)
+                    {
+                        const float value = std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                   * static_cast<float>(block * 512 + sample) / 44100.0f);
+                        buffer.setSample(0, sample, value);
+                        buffer.setSample(1, sample, value);
+                    }
+                    
+                    wrapper.processBlock(buffer);
+                    
+                    for (int sample = 0; sample < 512; ++sample)
+                        if (std::abs(buffer.getSample(0, sample)) > 1.0e-4f)
+                            return block * 512 + sample;
+                }
+                
+                return -1;
+            };
+            
+            const int latencyAfterPrepare = firstAudibleSample();
+            expectGreaterThan(latencyAfterPrepare, 0);
+            
+            wrapper.reset();
+            expectEquals(firstAudibleSample(), latencyAfterPrepare);
+            
+            // Re-preparing with the same settings takes the same path
+            wrapper.prepare(44100.0, 512, 2);
+            expectEquals(firstAudibleSample(), latencyAfterPrepare);
+        }
+        
+        beginTest("Tail Length Tracks Tempo");
+        {
+            SoundTouchWrapper wrapper;
+            expectEquals(wrapper.getTailLengthSamples(), 0);
+            
+            wrapper.prepare(44100.0, 512, 2);
+            const int normalTail = wrapper.getTailLengthSamples();
+            expectGreaterThan(normalTail, 0);
+            
+            // Half speed stretches the held-back input over twice the output
+            wrapper.setTempo(-50.0f);
+            expectGreaterThan(wrapper.getTailLengthSamples(), normalTail);
+            
+            wrapper.setTempo(100.0f);
+            expectLessThan(wrapper.getTailLengthSamples(), normalTail);
+        }
+        
+        beginTest("Every Engine Processes");
+        {
+            for (int typeIndex = 1; typeIndex <= TimeStretchEngine::NUM_TYPES; ++typeIndex)
+            {
+                const auto type = static_cast<TimeStretchEngine::Type>(typeIndex);
+                
+                SoundTouchWrapper wrapper;
+                wrapper.setEngineType(type);
+                wrapper.prepare(44100.0, 512, 2);
+                expect(wrapper.getEngineType() == type);
+                expectGreaterThan(wrapper.getLatencyInSamples(), 0);
+                
+                juce::AudioBuffer<float> buffer(2, 512);
+                
+                for (int block = 0; block < 16; ++block)
+                {
+                    for (int sample = 0; sample < 512; ++sample)
+                    {
+                        const float value = std::sin(2.0f * juce::MathConstants<float>::pi * 440.0f
+                                                   * static_cast<float>(block * 512 + sample) / 44100.0f);
+                        buffer.setSample(0, sample, value);
+                        buffer.setSample(1, sample, value);
+                    }
+                    
+                    wrapper.processBlock(buffer);
+                }
+                
+                expectGreaterThan(buffer.getMagnitude(0, 0, 512), 0.0f);
+                
+                // Every engine reports through the same stats
+                const auto stats = wrapper.getStats();
+                expectEquals(stats.inputFrames, static_cast<juce::int64>(16 * 512));
+                expectEquals(stats.outputFrames + stats.dryFrames, stats.inputFrames);
+                expectGreaterThan(stats.outputFrames, static_cast<juce::int64>(0));
+            }
+        }
+        
+        beginTest("Extreme Stretch Selects the Phase Vocoder");
+        {
+            SoundTouchWrapper wrapper;
+            wrapper.prepare(44100.0, 512, 2);
+            expect(wrapper.getActiveEngineType() == TimeStretchEngine::Type::Standard);
+            expect(! wrapper.updateAutomaticEngine());
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            
+            auto processBlocks = [&](int numBlocks)
+            {
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    for (int channel = 0; channel < 2; ++channel)
+                        for (int sample = 0; sample < 512; ++sample)
+                            buffer.setSample(channel, sample, std::sin(0.06f * static_cast<float>(block * 512 + sample)));
+                    
+                    wrapper.processBlock(buffer);
+                }
+            };
+            
+            // A fifth of the tempo is a 5x stretch
+            wrapper.setTempo(-80.0f);
+            expect(wrapper.updateAutomaticEngine());
+            expect(wrapper.getActiveEngineType() == TimeStretchEngine::Type::PhaseVocoder);
+            expect(wrapper.getEngineType() == TimeStretchEngine::Type::Standard);
+            
+            processBlocks(32);
+            expectEquals(wrapper.getStats().crossfades, static_cast<juce::int64>(1));
+            expect(! wrapper.isCrossfading());
+            expectGreaterThan(buffer.getMagnitude(0, 0, 512), 0.1f);
+            
+            // 3.3x is inside the hysteresis band, 2x is below it
+            wrapper.setTempo(-70.0f);
+            expect(! wrapper.updateAutomaticEngine());
+            wrapper.setTempo(-50.0f);
+            expect(wrapper.updateAutomaticEngine());
+            expect(wrapper.getActiveEngineType() == TimeStretchEngine::Type::Standard);
+            
+            // Pitch shifts stretch too, before resampling back
+            wrapper.setTempo(0.0f);
+            wrapper.setPitch(-30.0f);
+            processBlocks(32);
+            expect(wrapper.updateAutomaticEngine());
+            expect(wrapper.getActiveEngineType() == TimeStretchEngine::Type::PhaseVocoder);
+            
+            // Explicit low-latency and varispeed choices are left alone
+            wrapper.setEngineType(TimeStretchEngine::Type::LowLatency);
+            expect(wrapper.getActiveEngineType() == TimeStretchEngine::Type::LowLatency);
+            processBlocks(32);
+            expect(! wrapper.updateAutomaticEngine());
+        }
+        
+        beginTest("Live Mode Latency Is Exact");
+        {
+            SoundTouchWrapper::Configuration configuration;
+            configuration.engineType = TimeStretchEngine::Type::Live;
+            configuration.bufferingMode = 4;
+            
+            SoundTouchWrapper wrapper;
+            wrapper.configure(configuration);
+            wrapper.prepare(48000.0, 32, 1);
+            
+            const int latency = wrapper.getReportedLatencySamples();
+            expectGreaterThan(latency, 0);
+            expectLessOrEqual(latency, 240);
+            
+            // At unity pitch an impulse comes out exactly the reported latency later
+            juce::AudioBuffer<float> buffer(1, 32);
+            std::vector<float> output;
+            
+            for (int block = 0; block < 16; ++block)
+            {
+                buffer.clear();
+                
+                if (block == 0)
+                    buffer.setSample(0, 0, 1.0f);
+                
+                wrapper.processBlock(buffer);
+                output.insert(output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + 32);
+            }
+            
+            const auto peak = std::max_element(output.begin(), output.end(),
+                                               [](float a, float b) { return std::abs(a) < std::abs(b); });
+            expectEquals(static_cast<int>(peak - output.begin()), latency);
+            expectWithinAbsoluteError(*peak, 1.0f, 1.0e-5f);
+            
+            // Shifted, every block still comes from the engine, never dry
+            wrapper.setPitch(7.0f);
+            
+            for (int block = 0; block < 200; ++block)
+            {
+                for (int sample = 0; sample < 32; ++sample)
+                    buffer.setSample(0, sample, std::sin(0.05f * static_cast<float>(block * 32 + sample)));
+                
+                wrapper.processBlock(buffer);
+            }
+            
+            expectEquals(wrapper.getStats().dryFrames, static_cast<juce::int64>(0));
+            expectEquals(wrapper.getReportedLatencySamples(), latency);
+        }
+        
+        beginTest("Underruns Are Counted Once per Run");
+        {
+            // Ten times faster, the engine returns a tenth of each block, so the
+            // FIFO only fills a block's worth every ten or so and runs dry between
+            SoundTouchWrapper wrapper;
+            wrapper.setTempo(900.0f);
+            wrapper.prepare(44100.0, 512, 2);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            
+            for (int block = 0; block < 100; ++block)
+            {
+                for (int sample = 0; sample < 512; ++sample)
+                {
+                    const float value = std::sin(0.05f * static_cast<float>(block * 512 + sample));
+                    buffer.setSample(0, sample, value);
+                    buffer.setSample(1, sample, value);
+                }
+                
+                wrapper.processBlock(buffer);
+            }
+            
+            const auto stats = wrapper.getStats();
+            const auto dryChunks = stats.dryFrames / 512;
+            expectGreaterThan(stats.underruns, static_cast<juce::int64>(0));
+            expectLessThan(stats.underruns, dryChunks);
+        }
+        
         beginTest("Latency Reporting");
         {
             SoundTouchWrapper wrapper;
@@ -110,6 +624,94 @@ public:
             const int afterProcessLatency = wrapper.getLatencyInSamples();
             expectGreaterOrEqual(afterProcessLatency, 0);
         }
+        
+        beginTest("Channel-Specialised Loops Match the General Ones");
+        {
+            expectKernelsMatch<float>(1);
+            expectKernelsMatch<float>(2);
+            expectKernelsMatch<double>(1);
+            expectKernelsMatch<double>(2);
+        }
+        
+        beginTest("Every CPU Level's Loops Match the Baseline");
+        {
+            // Only the crossfade may differ, by rounding, where the newer
+            // instruction sets fuse its multiply and add
+            for (int levelIndex = static_cast<int>(CpuLevel::X86_64_V2); levelIndex <= static_cast<int>(CpuLevel::X86_64_V4); ++levelIndex)
+            {
+                const auto level = static_cast<CpuLevel>(levelIndex);
+                
+                if (! isCpuLevelAvailable(level))
+                    continue;
+                
+                for (int numChannels = 1; numChannels <= 3; ++numChannels)
+                {
+                    expectKernelsMatch<float>(numChannels, level, 1.0e-6);
+                    expectKernelsMatch<double>(numChannels, level, 1.0e-12);
+                }
+            }
+            
+            expect(static_cast<int>(getCpuLevel()) <= static_cast<int>(detectCpuLevel()));
+            expect(isCpuLevelAvailable(getCpuLevel()));
+        }
+    }
+    
+private:
+    // Amplitude of the tone at frequency, through a Hann window over numSamples
+    static float getToneLevel(const float* samples, int numSamples, float frequency, double sampleRate)
+    {
+        double re = 0.0;
+        double im = 0.0;
+        double windowSum = 0.0;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / numSamples);
+            const double phase = juce::MathConstants<double>::twoPi * frequency * i / sampleRate;
+            re += window * samples[i] * std::cos(phase);
+            im -= window * samples[i] * std::sin(phase);
+            windowSum += window;
+        }
+        
+        return static_cast<float>(2.0 * std::sqrt(re * re + im * im) / windowSum);
+    }
+    
+    // Runs one chunk with an odd start and length through the baseline's
+    // general loops and the given level's loops for numChannels, including a
+    // crossfade that starts part-way in
+    template <typename SampleType>
+    void expectKernelsMatch(int numChannels, CpuLevel level = CpuLevel::Baseline, double tolerance = 0.0)
+    {
+        const int numFrames = 301;
+        const int startSample = 7;
+        
+        const auto general = getSoundTouchKernels<SampleType>(0, CpuLevel::Baseline);
+        const auto specialised = getSoundTouchKernels<SampleType>(numChannels, level);
+        
+        juce::AudioBuffer<SampleType> source(numChannels, startSample + numFrames);
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int sample = 0; sample < source.getNumSamples(); ++sample)
+                source.setSample(channel, sample, static_cast<SampleType>(std::sin(0.01 * sample * (channel + 1))));
+        
+        std::vector<float> generalInterleaved(static_cast<size_t>(numChannels * numFrames));
+        std::vector<float> specialisedInterleaved(generalInterleaved.size());
+        general.interleave(source.getArrayOfReadPointers(), startSample, generalInterleaved.data(), numFrames, numChannels);
+        specialised.interleave(source.getArrayOfReadPointers(), startSample, specialisedInterleaved.data(), numFrames, numChannels);
+        expect(generalInterleaved == specialisedInterleaved);
+        
+        juce::AudioBuffer<SampleType> generalOutput(source);
+        juce::AudioBuffer<SampleType> specialisedOutput(source);
+        general.deinterleave(generalInterleaved.data(), generalOutput.getArrayOfWritePointers(), startSample, numFrames / 2, numChannels);
+        specialised.deinterleave(specialisedInterleaved.data(), specialisedOutput.getArrayOfWritePointers(), startSample, numFrames / 2, numChannels);
+        
+        general.crossfade(generalInterleaved.data(), generalOutput.getArrayOfWritePointers(), startSample, numFrames, 40, 200, numChannels);
+        specialised.crossfade(specialisedInterleaved.data(), specialisedOutput.getArrayOfWritePointers(), startSample, numFrames, 40, 200, numChannels);
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int sample = 0; sample < source.getNumSamples(); ++sample)
+                expectWithinAbsoluteError(specialisedOutput.getSample(channel, sample), generalOutput.getSample(channel, sample),
+                                          static_cast<SampleType>(tolerance));
     }
 };
 
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "StatsSegment.h"
+#include <thread>
+
+#if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+ #include <new>
+ #include <sys/wait.h>
+ #include <unistd.h>
+#endif
+
+class StatsSegmentTests : public juce::UnitTest
+{
+public:
+    StatsSegmentTests() : UnitTest("Stats Segment Tests") {}
+    
+    void runTest() override
+    {
+       #if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+        // A segment of the test's own, so running plugins are left alone
+        const juce::String name = "/ausoundtouch-stats-test-" + juce::String(juce::Random::getSystemRandom().nextInt(1000000));
+        StatsSegment::remove(name);
+        
+        beginTest("Slots Are Listed While Registered");
+        {
+            StatsSegment writer(name);
+            StatsSegment reader(name, false);
+            expect(writer.isOpen());
+            expect(reader.isOpen());
+            
+            {
+                StatsSegment::Slot first(writer, 11, "First Host");
+                StatsSegment::Slot second(writer, 12, "Second Host");
+                expect(first.isRegistered());
+                expect(second.isRegistered());
+                
+                StatsSegment::Stats stats;
+                stats.realtimeFactor = 42.5;
+                stats.p99BlockMs = 1.25;
+                stats.latencyMs = 30.0;
+                stats.underruns = 3;
+                stats.qualityMode = 4;
+                stats.bufferingMode = 2;
+                second.publish(stats);
+                
+                const auto instances = reader.readInstances();
+                expectEquals(static_cast<int>(instances.size()), 2);
+                
+                if (instances.size() == 2)
+                {
+                    expectEquals(static_cast<int>(instances[0].instanceId), 11);
+                    expectEquals(instances[0].processName, juce::String("First Host"));
+                    expectEquals(instances[0].lastUpdateMs, static_cast<juce::int64>(0));
+                    
+                    const auto& published = instances[1];
+                    expectEquals(published.processName, juce::String("Second Host"));
+                    expectEquals(published.stats.realtimeFactor, 42.5);
+                    expectEquals(published.stats.p99BlockMs, 1.25);
+                    expectEquals(published.stats.latencyMs, 30.0);
+                    expectEquals(published.stats.underruns, static_cast<juce::int64>(3));
+                    expectEquals(published.stats.qualityMode, 4);
+                    expectEquals(published.stats.bufferingMode, 2);
+                    expectGreaterThan(published.lastUpdateMs, static_cast<juce::int64>(0));
+                }
+            }
+            
+            expect(reader.readInstances().empty());
+        }
+        
+        beginTest("Readers Never See a Torn Update");
+        {
+            StatsSegment writer(name);
+            StatsSegment reader(name, false);
+            StatsSegment::Slot slot(writer, 21, "Writer");
+            std::atomic<bool> done { false };
+            
+            // Every field carries the same number, so a mixed copy shows up
+            std::thread audioThread([&]
+            {
+                for (int i = 1; ! done.load(); ++i)
+                {
+                    StatsSegment::Stats stats;
+                    stats.realtimeFactor = i;
+                    stats.p99BlockMs = i;
+                    stats.latencyMs = i;
+                    stats.underruns = i;
+                    stats.droppedFrames = i;
+                    stats.qualityMode = i;
+                    slot.publish(stats);
+                }
+            });
+            
+            int numTorn = 0;
+            
+            for (int read = 0; read < 20000; ++read)
+            {
+                for (const auto& instance : reader.readInstances())
+                {
+                    const auto& stats = instance.stats;
+                    
+                    if (stats.p99BlockMs != stats.realtimeFactor || stats.latencyMs != stats.realtimeFactor
+                        || static_cast<double>(stats.underruns) != stats.realtimeFactor
+                        || static_cast<double>(stats.droppedFrames) != stats.realtimeFactor
+                        || static_cast<double>(stats.qualityMode) != stats.realtimeFactor)
+                        ++numTorn;
+                }
+            }
+            
+            done = true;
+            audioThread.join();
+            expectEquals(numTorn, 0);
+        }
+        
+        beginTest("A Full Table Leaves Further Instances Unregistered");
+        {
+            StatsSegment segment(name);
+            std::vector<std::unique_ptr<StatsSegment::Slot>> slots;
+            
+            for (int i = 0; i < StatsSegment::MAX_SLOTS; ++i)
+                slots.push_back(std::make_unique<StatsSegment::Slot>(segment, static_cast<juce::uint32>(i), "Host"));
+            
+            StatsSegment::Slot extra(segment, 999, "Host");
+            expect(! extra.isRegistered());
+            extra.publish({});
+            
+            expectEquals(static_cast<int>(segment.readInstances().size()), StatsSegment::MAX_SLOTS);
+        }
+        
+        beginTest("Slots of a Dead Process Are Reclaimed");
+        {
+            StatsSegment segment(name);
+            const juce::String processName("Crashed Host");
+            
+            // The child fills the table and exits without releasing anything,
+            // as a crashed host would; it only claims, so it never allocates
+            const auto child = fork();
+            
+            if (child == 0)
+            {
+                alignas(StatsSegment::Slot) unsigned char storage[sizeof(StatsSegment::Slot)];
+                
+                for (int i = 0; i < StatsSegment::MAX_SLOTS; ++i)
+                    new (storage) StatsSegment::Slot(segment, static_cast<juce::uint32>(i), processName);
+                
+                _exit(0);
+            }
+            
+            expectGreaterThan(static_cast<int>(child), 0);
+            int status = 0;
+            waitpid(child, &status, 0);
+            expect(segment.readInstances().empty());
+            
+            std::vector<std::unique_ptr<StatsSegment::Slot>> slots;
+            
+            for (int i = 0; i < StatsSegment::MAX_SLOTS; ++i)
+            {
+                slots.push_back(std::make_unique<StatsSegment::Slot>(segment, static_cast<juce::uint32>(i), "Host"));
+                expect(slots.back()->isRegistered());
+            }
+            
+            expectEquals(static_cast<int>(segment.readInstances().size()), StatsSegment::MAX_SLOTS);
+        }
+        
+        StatsSegment::remove(name);
+       #endif
+        
+        beginTest("Block Time Percentiles");
+        {
+            BlockTimeWindow window;
+            expectEquals(window.getPercentileMs(0.99), 0.0);
+            
+            // 990 fast blocks and 10 slow ones: the 99th percentile is still fast
+            for (int i = 0; i < 990; ++i)
+                window.add(1.0, 10.0);
+            
+            for (int i = 0; i < 10; ++i)
+                window.add(8.0, 10.0);
+            
+            expectWithinAbsoluteError(window.getPercentileMs(0.99), 1.0, 0.1);
+            expectWithinAbsoluteError(window.getPercentileMs(1.0), 8.0, 0.8);
+            expectWithinAbsoluteError(window.getRealtimeFactor(), 10000.0 / 1070.0, 1.0e-9);
+            expectEquals(window.getAudioMs(), 10000.0);
+            
+            window.reset();
+            expectEquals(window.getAudioMs(), 0.0);
+            expectEquals(window.getPercentileMs(0.99), 0.0);
+        }
+    }
+};
+
+static StatsSegmentTests statsSegmentTests;
@@ -0,0 +1,474 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "TimeStretchEngine.h"
+#include "SoundTouchEngine.h"
+#include <algorithm>
+#include <vector>
+
+class TimeStretchEngineTests : public juce::UnitTest
+{
+public:
+    TimeStretchEngineTests() : UnitTest("Time Stretch Engine Tests") {}
+    
+    void runTest() override
+    {
+        beginTest("Every Engine Type Produces Output");
+        {
+            for (int typeIndex = 1; typeIndex <= TimeStretchEngine::NUM_TYPES; ++typeIndex)
+            {
+                const auto type = static_cast<TimeStretchEngine::Type>(typeIndex);
+                auto engine = TimeStretchEngine::create(type, 3);
+                engine->prepare(44100.0, 2, 512);
+                engine->setRatios(1.0f, 1.0f, 1.0f);
+                
+                std::vector<float> output(2 * 16384);
+                int received = 0;
+                
+                for (int block = 0; block < 16; ++block)
+                {
+                    const auto input = makeSine(2, 512, 440.0f, block * 512);
+                    engine->putSamples(input.data(), 512);
+                    
+                    while (const int frames = engine->receiveSamples(output.data() + received * 2, 16384 - received))
+                        received += frames;
+                }
+                
+                expectGreaterThan(received, 0);
+                expectGreaterThan(engine->getInitialLatency(), 0);
+                
+                // clear() drops everything held back
+                engine->clear();
+                expectEquals(engine->receiveSamples(output.data(), 16384), 0);
+            }
+        }
+        
+        beginTest("Low Latency Holds Back Less");
+        {
+            auto standard = TimeStretchEngine::create(TimeStretchEngine::Type::Standard, 3);
+            auto lowLatency = TimeStretchEngine::create(TimeStretchEngine::Type::LowLatency, 3);
+            standard->prepare(44100.0, 2, 512);
+            lowLatency->prepare(44100.0, 2, 512);
+            
+            expectLessThan(lowLatency->getInitialLatency(), standard->getInitialLatency());
+        }
+        
+        beginTest("Resampling Is Varispeed");
+        {
+            // Double rate halves the duration and doubles the frequency, as on tape
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Resampling, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(1.5f, 0.5f, 2.0f);
+            
+            std::vector<float> output(4096);
+            int received = 0;
+            
+            for (int block = 0; block < 8; ++block)
+            {
+                const auto input = makeSine(1, 512, 441.0f, block * 512);
+                engine->putSamples(input.data(), 512);
+                
+                while (const int frames = engine->receiveSamples(output.data() + received, 4096 - received))
+                    received += frames;
+            }
+            
+            expectWithinAbsoluteError(received, 2048, 4);
+            expectWithinAbsoluteError(engine->getOutputPerInput(0.5f, 2.0f), 0.5, 1.0e-9);
+            
+            int zeroCrossings = 0;
+            
+            for (int sample = 1; sample < received; ++sample)
+                if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                    ++zeroCrossings;
+            
+            // 4096 input frames at 441 Hz hold about 82 crossings
+            expectWithinAbsoluteError(zeroCrossings, 82, 3);
+        }
+        
+        beginTest("Phase Vocoder Stretches Without Changing Pitch");
+        {
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::PhaseVocoder, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(1.0f, 0.25f, 1.0f);
+            
+            std::vector<float> output(40000);
+            int received = 0;
+            
+            for (int block = 0; block < 16; ++block)
+            {
+                const auto input = makeSine(1, 512, 441.0f, block * 512);
+                engine->putSamples(input.data(), 512);
+                
+                while (const int frames = engine->receiveSamples(output.data() + received, 40000 - received))
+                    received += frames;
+            }
+            
+            // 8192 frames stretch to 32768, less what is still held back
+            expectGreaterThan(received, 32768 - 2 * engine->getInitialLatency());
+            expectLessOrEqual(received, 32768);
+            
+            // Past the fade-in, the tone keeps its frequency and level
+            const int settled = 8192;
+            int zeroCrossings = 0;
+            float peak = 0.0f;
+            
+            for (int sample = settled; sample < received; ++sample)
+            {
+                if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                    ++zeroCrossings;
+                
+                peak = std::max(peak, std::abs(output[static_cast<size_t>(sample)]));
+            }
+            
+            const int expectedCrossings = (received - settled) * 2 * 441 / 44100;
+            expectWithinAbsoluteError(zeroCrossings, expectedCrossings, 3);
+            expectWithinAbsoluteError(peak, 1.0f, 0.05f);
+            
+            // flush() lets the rest out
+            engine->flush();
+            
+            while (const int frames = engine->receiveSamples(output.data(), 40000))
+                received += frames;
+            
+            expectGreaterOrEqual(received, 32768);
+        }
+        
+        beginTest("Phase Vocoder Pitches Up Without Aliasing");
+        {
+            // Two octaves up, a tone below an eighth of the sample rate comes
+            // through at its level, and one above it is cut rather than folded back
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::PhaseVocoder, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(4.0f, 1.0f, 1.0f);
+            expectWithinAbsoluteError(getRms(runMono(*engine, 2000.0f, 44100)), std::sqrt(0.5), 0.1);
+            
+            engine->clear();
+            expectLessThan(getRms(runMono(*engine, 7000.0f, 44100)), 0.01);
+        }
+        
+        beginTest("Live Engine Is a Fixed Delay");
+        {
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Live, 3);
+            engine->prepare(44100.0, 2, 32);
+            engine->setRatios(1.0f, 0.5f, 2.0f);
+            
+            const int latency = engine->getInitialLatency();
+            expectLessOrEqual(latency, static_cast<int>(0.005 * 44100.0));
+            expect(engine->hasConstantLatency());
+            expectWithinAbsoluteError(engine->getOutputPerInput(0.5f, 2.0f), 1.0, 1.0e-9);
+            
+            // Tempo and rate are ignored: at unity pitch the output is the input,
+            // once the latency has been held back, and each block is returned whole
+            std::vector<float> output(64);
+            int received = 0;
+            int mismatches = 0;
+            
+            for (int block = 0; block < 64; ++block)
+            {
+                const auto input = makeSine(2, 32, 441.0f, block * 32);
+                engine->putSamples(input.data(), 32);
+                
+                const int frames = engine->receiveSamples(output.data(), 32);
+                expectEquals(engine->receiveSamples(output.data(), 32), 0);
+                expectEquals(frames, juce::jlimit(0, 32, (block + 1) * 32 - latency));
+                
+                const auto expected = makeSine(2, frames, 441.0f, received);
+                
+                for (int i = 0; i < frames * 2; ++i)
+                    if (std::abs(output[static_cast<size_t>(i)] - expected[static_cast<size_t>(i)]) > 1.0e-5f)
+                        ++mismatches;
+                
+                received += frames;
+            }
+            
+            expectEquals(mismatches, 0);
+        }
+        
+        beginTest("Live Engine Shifts Pitch");
+        {
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Live, 3);
+            engine->prepare(44100.0, 1, 32);
+            engine->setRatios(2.0f, 1.0f, 1.0f);
+            
+            std::vector<float> output(32);
+            int zeroCrossings = 0;
+            float previous = 0.0f;
+            int counted = 0;
+            
+            for (int block = 0; block < 1400; ++block)
+            {
+                const auto input = makeSine(1, 32, 441.0f, block * 32);
+                engine->putSamples(input.data(), 32);
+                const int frames = engine->receiveSamples(output.data(), 32);
+                
+                // Count over the last second, well past the first grains
+                for (int i = 0; i < frames; ++i)
+                {
+                    if (block >= 1400 - 44100 / 32)
+                    {
+                        if ((previous < 0.0f) != (output[static_cast<size_t>(i)] < 0.0f))
+                            ++zeroCrossings;
+                        
+                        ++counted;
+                    }
+                    
+                    previous = output[static_cast<size_t>(i)];
+                }
+            }
+            
+            // An octave up: 882 Hz, two crossings a cycle
+            const int expectedCrossings = counted * 2 * 882 / 44100;
+            expectWithinAbsoluteError(zeroCrossings, expectedCrossings, expectedCrossings / 50);
+        }
+        
+        beginTest("Monophonic Engine Shifts Pitch");
+        {
+            // Up a fourth, and down a fourth: the grains are re-spaced at the new period
+            for (const float pitch : { 1.33484f, 0.74915f })
+            {
+                auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Monophonic, 3);
+                engine->prepare(44100.0, 1, 512);
+                engine->setRatios(pitch, 1.0f, 1.0f);
+                
+                const auto output = runMono(*engine, 220.0f, 88200);
+                const int received = static_cast<int>(output.size());
+                expectGreaterOrEqual(received, 88200 - engine->getInitialLatency());
+                
+                // Count over the second half, well past the tracker's first estimate
+                int zeroCrossings = 0;
+                
+                for (int sample = received / 2 + 1; sample < received; ++sample)
+                    if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                        ++zeroCrossings;
+                
+                const int expectedCrossings = juce::roundToInt((received - received / 2) * 2.0f * 220.0f * pitch / 44100.0f);
+                expectWithinAbsoluteError(zeroCrossings, expectedCrossings, expectedCrossings / 100 + 1);
+            }
+        }
+        
+        beginTest("Monophonic Engine Stretches Time");
+        {
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Monophonic, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(1.0f, 0.5f, 1.0f);
+            expectWithinAbsoluteError(engine->getOutputPerInput(0.5f, 1.0f), 2.0, 1.0e-9);
+            
+            // A second of input becomes two, less what is still held back
+            auto output = runMono(*engine, 220.0f, 44100);
+            const int received = static_cast<int>(output.size());
+            expectGreaterThan(received, 88200 - 2 * engine->getInitialLatency());
+            expectLessOrEqual(received, 88200);
+            
+            int zeroCrossings = 0;
+            
+            for (int sample = 44101; sample < received; ++sample)
+                if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                    ++zeroCrossings;
+            
+            const int expectedCrossings = (received - 44100) * 2 * 220 / 44100;
+            expectWithinAbsoluteError(zeroCrossings, expectedCrossings, expectedCrossings / 100 + 1);
+            
+            // flush() lets the rest out
+            std::vector<float> tail(4096);
+            engine->flush();
+            
+            int flushed = received;
+            
+            while (const int frames = engine->receiveSamples(tail.data(), 4096))
+                flushed += frames;
+            
+            expectGreaterOrEqual(flushed, 88200);
+        }
+        
+        beginTest("Speech Engine Stretches the Low Band");
+        {
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Speech, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(1.0f, 0.5f, 1.0f);
+            expectWithinAbsoluteError(engine->getOutputPerInput(0.5f, 1.0f), 2.0, 1.0e-9);
+            
+            // A second of input becomes two, less what is still held back
+            const auto output = runMono(*engine, 441.0f, 44100);
+            const int received = static_cast<int>(output.size());
+            expectGreaterThan(received, 88200 - 2 * engine->getInitialLatency());
+            expectLessOrEqual(received, 88200);
+            
+            // The tone keeps its frequency through the decimated SoundTouch
+            int zeroCrossings = 0;
+            
+            for (int sample = 44101; sample < received; ++sample)
+                if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                    ++zeroCrossings;
+            
+            const int expectedCrossings = (received - 44100) * 2 * 441 / 44100;
+            expectWithinAbsoluteError(zeroCrossings, expectedCrossings, expectedCrossings / 50 + 1);
+        }
+        
+        beginTest("Speech Engine Resamples the High Band");
+        {
+            // Pitch and tempo together move the grains in step, so a tone above
+            // the crossover comes out resampled, at its level
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Speech, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(0.8f, 0.8f, 1.0f);
+            
+            const auto output = runMono(*engine, 12000.0f, 44100);
+            const int received = static_cast<int>(output.size());
+            expectGreaterThan(received, 55125 - 2 * engine->getInitialLatency());
+            
+            const int settled = received / 2;
+            int zeroCrossings = 0;
+            double energy = 0.0;
+            
+            for (int sample = settled + 1; sample < received; ++sample)
+            {
+                if ((output[static_cast<size_t>(sample - 1)] < 0.0f) != (output[static_cast<size_t>(sample)] < 0.0f))
+                    ++zeroCrossings;
+                
+                energy += output[static_cast<size_t>(sample)] * output[static_cast<size_t>(sample)];
+            }
+            
+            const int counted = received - settled - 1;
+            const int expectedCrossings = counted * 2 * 9600 / 44100;
+            expectWithinAbsoluteError(zeroCrossings, expectedCrossings, expectedCrossings / 50 + 1);
+            expectWithinAbsoluteError(std::sqrt(energy / counted), std::sqrt(0.5), 0.1);
+        }
+        
+        beginTest("Speech Engine Pitches Up Without Aliasing");
+        {
+            // Read faster than one frame per frame, the high band keeps a tone
+            // that stays below Nyquist and cuts one that would fold back
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Speech, 3);
+            engine->prepare(44100.0, 1, 512);
+            engine->setRatios(1.2f, 1.2f, 1.0f);
+            expectWithinAbsoluteError(getRms(runMono(*engine, 10000.0f, 44100)), std::sqrt(0.5), 0.1);
+            
+            engine->clear();
+            expectLessThan(getRms(runMono(*engine, 20000.0f, 44100)), 0.02);
+            
+            // Three times up, all of the band would be past Nyquist
+            engine->setRatios(3.0f, 3.0f, 1.0f);
+            engine->clear();
+            expectLessThan(getRms(runMono(*engine, 12000.0f, 4 * 44100)), 0.02);
+        }
+        
+        beginTest("SoundTouch Duration Ratio");
+        {
+            // Only tempo and rate change the duration
+            auto engine = TimeStretchEngine::create(TimeStretchEngine::Type::Standard, 3);
+            expectWithinAbsoluteError(engine->getOutputPerInput(0.5f, 1.0f), 2.0, 1.0e-9);
+            expectWithinAbsoluteError(engine->getOutputPerInput(2.0f, 2.0f), 0.25, 1.0e-9);
+        }
+        
+        beginTest("SoundTouch Agrees Across CPU Levels");
+        {
+            // Vectorised differently, each level's splice search may settle a
+            // sample apart, so compare what is heard rather than every sample
+            const auto tuning = SoundTouchEngine::getTuning(TimeStretchEngine::Type::Standard, 3);
+            
+            SoundTouchEngine baseline(tuning, CpuLevel::Baseline);
+            baseline.prepare(44100.0, 1, 512);
+            baseline.setRatios(1.25f, 1.0f, 1.0f);
+            const auto expected = runMono(baseline, 440.0f, 44100);
+            
+            for (int levelIndex = static_cast<int>(CpuLevel::X86_64_V2); levelIndex <= static_cast<int>(CpuLevel::X86_64_V4); ++levelIndex)
+            {
+                const auto level = static_cast<CpuLevel>(levelIndex);
+                
+                if (! isCpuLevelAvailable(level))
+                    continue;
+                
+                SoundTouchEngine engine(tuning, level);
+                engine.prepare(44100.0, 1, 512);
+                engine.setRatios(1.25f, 1.0f, 1.0f);
+                const auto output = runMono(engine, 440.0f, 44100);
+                
+                expectEquals(static_cast<int>(output.size()), static_cast<int>(expected.size()));
+                expectEquals(engine.getInitialLatency(), baseline.getInitialLatency());
+                expectWithinAbsoluteError(countZeroCrossings(output), countZeroCrossings(expected), 10);
+                expectWithinAbsoluteError(getRms(output), getRms(expected), 0.02);
+            }
+        }
+    }
+    
+private:
+    // Streams a sine through a mono engine in 512-frame blocks
+    static std::vector<float> runMono(TimeStretchEngine& engine, float frequency, int numFrames)
+    {
+        std::vector<float> output;
+        std::vector<float> block(8192);
+        
+        for (int start = 0; start < numFrames; start += 512)
+        {
+            const auto input = makeSine(1, 512, frequency, start);
+            engine.putSamples(input.data(), 512);
+            
+            while (const int frames = engine.receiveSamples(block.data(), 8192))
+                output.insert(output.end(), block.begin(), block.begin() + frames);
+        }
+        
+        return output;
+    }
+    
+    // Past the first 4096 samples, where SoundTouch is still filling
+    static int countZeroCrossings(const std::vector<float>& samples)
+    {
+        int crossings = 0;
+        
+        for (size_t sample = 4097; sample < samples.size(); ++sample)
+            if ((samples[sample - 1] < 0.0f) != (samples[sample] < 0.0f))
+                ++crossings;
+        
+        return crossings;
+    }
+    
+    static double getRms(const std::vector<float>& samples)
+    {
+        if (samples.size() <= 4096)
+            return 0.0;
+        
+        double energy = 0.0;
+        
+        for (size_t sample = 4096; sample < samples.size(); ++sample)
+            energy += samples[sample] * samples[sample];
+        
+        return std::sqrt(energy / static_cast<double>(samples.size() - 4096));
+    }
+    
+    static std::vector<float> makeSine(int numChannels, int numFrames, float frequency, int startFrame = 0)
+    {
+        std::vector<float> samples(static_cast<size_t>(numChannels * numFrames));
+        
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            const float value = std::sin(2.0f * juce::MathConstants<float>::pi * frequency
+                                       * static_cast<float>(startFrame + frame) / 44100.0f);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                samples[static_cast<size_t>(frame * numChannels + channel)] = value;
+        }
+        
+        return samples;
+    }
+};
+
+static TimeStretchEngineTests timeStretchEngineTests;
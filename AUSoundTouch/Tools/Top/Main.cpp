@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    This file is part of AUSoundTouch.
+    Copyright (c) 2025 - Sean McNamara <smcnam@gmail.com>
+
+    AUSoundTouch is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AUSoundTouch is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with AUSoundTouch.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "StatsSegment.h"
+#include <atomic>
+#include <csignal>
+#include <iostream>
+
+// ausoundtouch-top: lists every live AUSoundTouch instance on this machine
+// from the shared stats segment, refreshing like top. Only reads the
+// segment, so it can't hold up the audio threads it watches.
+namespace
+{
+    std::atomic<bool> quitRequested { false };
+    
+    // Instances that haven't published for this long have stopped processing
+    constexpr juce::int64 idleAfterMs = 2000;
+    
+    // AUSoundTouchProcessor::QualityMode and BufferingMode, from 1
+    const char* const qualityNames[] = { "-", "Fast", "Balanced", "High", "Monophonic", "Speech" };
+    const char* const bufferingNames[] = { "-", "Minimal", "Normal", "Extra", "Live" };
+    
+    template <size_t size>
+    juce::String nameOf(const char* const (&names)[size], int mode)
+    {
+        return juce::isPositiveAndBelow(mode, static_cast<int>(size)) ? juce::String(names[mode]) : juce::String(mode);
+    }
+    
+    juce::String column(const juce::String& text, int width)
+    {
+        return text.substring(0, width).paddedRight(' ', width) + " ";
+    }
+    
+    juce::String heading(const juce::String& text, int width)
+    {
+        return text.paddedLeft(' ', width) + " ";
+    }
+    
+    juce::String number(double value, int decimals, int width)
+    {
+        return juce::String(value, decimals).paddedLeft(' ', width) + " ";
+    }
+    
+    void printTable(const StatsSegment& segment, bool clearScreen)
+    {
+        const auto instances = segment.readInstances();
+        const auto now = juce::Time::currentTimeMillis();
+        
+        if (clearScreen)
+            std::cout << "\033[H\033[2J";
+        
+        std::cout << "AUSoundTouch instances: " << instances.size() << "    "
+                  << juce::Time::getCurrentTime().toString(true, true) << "\n\n"
+                  << "    PID  INST  " << column("PROCESS", 20) << column("QUALITY", 10) << column("BUFFERING", 9)
+                  << heading("xRT", 8) << heading("P99 MS", 7) << heading("LAT MS", 7) << heading("LOAD%", 6)
+                  << heading("UNDERRUNS", 10) << heading("DROPPED", 10) << " STATE\n";
+        
+        for (const auto& instance : instances)
+        {
+            const auto& stats = instance.stats;
+            const bool idle = instance.lastUpdateMs == 0 || now - instance.lastUpdateMs > idleAfterMs;
+            
+            std::cout << juce::String(instance.processId).paddedLeft(' ', 7) << " "
+                      << juce::String(static_cast<int>(instance.instanceId)).paddedLeft(' ', 5) << "  "
+                      << column(instance.processName, 20)
+                      << column(nameOf(qualityNames, stats.qualityMode), 10)
+                      << column(nameOf(bufferingNames, stats.bufferingMode), 9)
+                      << number(stats.realtimeFactor, 1, 8)
+                      << number(stats.p99BlockMs, 2, 7)
+                      << number(stats.latencyMs, 1, 7)
+                      << number(100.0 * stats.dspLoad, 0, 6)
+                      << juce::String(stats.underruns).paddedLeft(' ', 10) << " "
+                      << juce::String(stats.droppedFrames).paddedLeft(' ', 10) << "  "
+                      << (idle ? "idle" : "running") << "\n";
+        }
+        
+        std::cout << std::flush;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::String segmentName(StatsSegment::DEFAULT_NAME);
+    double intervalSeconds = 1.0;
+    bool once = false;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String argument(argv[i]);
+        
+        if (argument == "--once")
+            once = true;
+        else if (argument == "--interval" && i + 1 < argc)
+            intervalSeconds = juce::jmax(0.1, juce::String(argv[++i]).getDoubleValue());
+        else if (argument == "--segment" && i + 1 < argc)
+            segmentName = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--once] [--interval <seconds>] [--segment <name>]" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Doesn't create the segment: with no plugin loaded there is nothing to show
+    StatsSegment segment(segmentName, false);
+    
+    if (! segment.isOpen())
+    {
+        std::cerr << "No AUSoundTouch instances have run since the system started (no segment "
+                  << segmentName << ")" << std::endl;
+        return 1;
+    }
+    
+    if (once)
+    {
+        printTable(segment, false);
+        return 0;
+    }
+    
+    std::signal(SIGINT, [](int) { quitRequested = true; });
+    std::signal(SIGTERM, [](int) { quitRequested = true; });
+    
+    while (! quitRequested)
+    {
+        printTable(segment, true);
+        
+        // Short sleeps, so Ctrl+C takes effect promptly
+        const auto until = juce::Time::getMillisecondCounterHiRes() + 1000.0 * intervalSeconds;
+        
+        while (! quitRequested && juce::Time::getMillisecondCounterHiRes() < until)
+            juce::Thread::sleep(50);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,46 @@
+# Run by the x86-64 level builds in CMakeLists.txt, on each level's object:
+#
+#   cmake -DNM=<nm> -DOBJECT=<object> -P CheckVariantSymbols.cmake
+#
+# Fails if the object exports anything but its entry points or SoundTouch
+# under the level's own namespace. Anything else it exported, above all a weak
+# copy of an inline function, the final link could use in place of the
+# baseline's, running the level's instructions on CPUs that lack them.
+
+execute_process(
+    COMMAND ${NM} -C --defined-only ${OBJECT}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} couldn't read ${OBJECT}")
+endif()
+
+# Demangled names can hold brackets and semicolons, which CMake lists don't survive
+string(REPLACE "[" "(" symbols "${symbols}")
+string(REPLACE "]" ")" symbols "${symbols}")
+string(REPLACE ";" "," symbols "${symbols}")
+string(REPLACE "\n" ";" lines "${symbols}")
+
+set(exported "")
+
+foreach(line IN LISTS lines)
+    # Local symbols have a lowercase type, except the weak (v, w) and unique (u) ones
+    if(NOT line MATCHES "^[0-9a-fA-F]* ([A-Zuvw]) (.*)$")
+        continue()
+    endif()
+    
+    set(type "${CMAKE_MATCH_1}")
+    set(name "${CMAKE_MATCH_2}")
+    
+    if(name MATCHES "(createSoundTouchProcessor|makeSoundTouchKernels)<" OR name MATCHES "soundtouch_x86_64_v[234]::")
+        continue()
+    endif()
+    
+    string(APPEND exported "\n    ${type} ${name}")
+endforeach()
+
+if(exported)
+    message(FATAL_ERROR "${OBJECT} exports symbols the baseline build may share:${exported}")
+endif()